@@ -196,7 +196,11 @@ static void print_trade(trade_t* trade)
 int main(void)
 {
   order_book_t book;
-  book_init(&book);
+  if (book_init(&book) != 0)
+  {
+    fprintf(stderr, "Failed to allocate order book\n");
+    return 1;
+  }
 
   trade_t trades[10];
   char msg[256];
@@ -3,17 +3,120 @@
 
 #include "common/types.h"
 #include "core/book.h"
+#include "core/exec_report.h"
 #include "core/order.h"
+#include "sim/market_view.h"
+#include "sim/net_latency.h"
 
 typedef struct agent agent_t;
 
-typedef void (*agent_step_fn)(agent_t* agent, order_book_t* book, timestamp_t now);
+// `view` is the current market snapshot; read the market from it, not from the
+// book's trees. `now` is the simulation clock (ns, see sim/clock.h). Returns the
+// time the agent wants to be woken next, or AGENT_NO_WAKEUP.
+typedef timestamp_t (*agent_step_fn)(agent_t* agent, order_book_t* book,
+                                     const market_view_t* view, timestamp_t now);
+
+#define AGENT_NO_WAKEUP UINT64_MAX
+
+// Steps agents[0..n), all of one type, at `now` against the same `view`;
+// next[i] gets what agents[i]'s step would have returned
+typedef void (*agent_step_all_fn)(agent_t* const* agents, size_t n, order_book_t* book,
+                                  const market_view_t* view, timestamp_t now, timestamp_t* next);
+
+// Fills and cancels of this agent's orders (routed by order_owner), `n` at a
+// time and oldest first. Called after the event that produced them, never
+// from inside the book. NULL: the agent does not track its orders.
+typedef void (*agent_exec_fn)(agent_t* agent, order_book_t* book, const exec_report_t* reports,
+                              size_t n);
+
+// Checkpoint hooks. save writes the agent's state to `out` if it fits in `cap`
+// bytes and returns the size it needs either way; load restores it from `len`
+// bytes (Return: 0 ok, -1 not this agent's kind or size). NULL: nothing to save.
+typedef size_t (*agent_save_fn)(const agent_t* agent, void* out, size_t cap);
+typedef int (*agent_load_fn)(agent_t* agent, const void* in, size_t len);
+
+// Market events an agent can sleep on instead of polling. The simulator wakes
+// a subscriber on the tick after the event; the wakeup replaces its pending
+// one, so the step returns its next wakeup as usual.
+#define AGENT_WAKE_BBO (1u << 0)       // best bid or ask price or size changed
+#define AGENT_WAKE_TRADE (1u << 1)     // any fill
+#define AGENT_WAKE_DEPLETION (1u << 2) // a price level emptied
+
+// What an agent wants to be woken for. Topics stay on until cleared. Price
+// triggers are one-shot: the simulator zeroes one when it fires, and the agent
+// re-arms it from its step. 0 leaves a trigger off.
+typedef struct
+{
+  unsigned topics;           // AGENT_WAKE_* bits
+  price_t ask_at_or_below;   // best ask <= this
+  price_t bid_at_or_above;   // best bid >= this
+  price_t trade_at_or_below; // a fill at <= this
+  price_t trade_at_or_above; // a fill at >= this
+} agent_interest_t;
+
+// One kind of agent. Each agent module exports its type; agent_create and the
+// registry (agents/agent_registry.h) build agents from it.
+typedef struct agent_type
+{
+  const char* name;
+  size_t state_size;
+  // Set up the hooks of `agent` (id and zeroed state already in place). `params`
+  // is type-specific, NULL for the defaults. Return: 0 ok, -1 error
+  int (*init)(agent_t* agent, agent_id_t id, uint64_t seed, const void* params);
+  // NULL: the simulator calls step once per agent
+  agent_step_all_fn step_all;
+  // Release what init allocated inside the state, not the state itself. NULL: nothing
+  void (*fini)(agent_t* agent);
+} agent_type_t;
+
+// Actions taken during a parallel decision phase, applied to the book later by
+// the sequencer in their original order. orders[i] == NULL marks a change to
+// resting order cancel_ids[i]: an amend to amend_prices[i] / amend_qtys[i], or
+// a cancel when amend_qtys[i] is 0. Storage is reused from tick to tick.
+typedef struct
+{
+  order_t** orders;
+  order_id_t* cancel_ids;
+  price_t* amend_prices;
+  qty_t* amend_qtys;
+  size_t count;
+  size_t capacity;
+} agent_outbox_t;
 
 struct agent
 {
   agent_id_t id;
+  const agent_type_t* type; // NULL for agents put together by hand
   agent_step_fn step;
+  agent_exec_fn on_exec;
+  agent_outbox_t* outbox; // set by the simulator while steps run in parallel
+  net_link_t* link;       // set by simulator_set_latency; NULL: no network delay
+  agent_save_fn save;
+  agent_load_fn load;
+  agent_interest_t interest; // read by the simulator after every step
+  uint32_t slot;             // set by simulator_add_agent
   void* state;
 };
 
+// Steps send orders and cancels through these, never straight to the book:
+// they go to the book now, or to the agent's outbox during a parallel phase.
+// The book takes ownership of submitted orders either way.
+void agent_submit(agent_t* agent, order_book_t* book, order_t* order);
+void agent_submit_batch(agent_t* agent, order_book_t* book, order_t** orders, size_t n);
+void agent_cancel(agent_t* agent, order_book_t* book, order_id_t id);
+// Re-price or re-size a resting order without a cancel and a new order; see
+// book_amend_order. qty <= 0 cancels.
+void agent_amend(agent_t* agent, order_book_t* book, order_id_t id, price_t price, qty_t qty);
+
+void agent_outbox_free(agent_outbox_t* box);
+
+// Best price among `levels` once our resting quote `own_id` is taken out: a level
+// holding nothing but that quote does not count. 0 if no other level is visible.
+price_t agent_best_excluding(const depth_entry_t* levels, size_t n, order_book_t* book,
+                             order_id_t own_id);
+
+// save/load for agents whose whole state is one flat struct of `size` bytes
+size_t agent_save_flat(const void* state, size_t size, void* out, size_t cap);
+int agent_load_flat(void* state, size_t size, const void* in, size_t len);
+
 #endif // !AGENT_H
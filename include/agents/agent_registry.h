@@ -0,0 +1,43 @@
+#ifndef AGENT_REGISTRY_H
+#define AGENT_REGISTRY_H
+
+#include "agent.h"
+
+/* Owns the agents of a run, grouped by type. A group's agent_t structs are
+   one array and their states another, so stepping many agents of one type
+   walks memory in order and the simulator can hand a whole group to the
+   type's step_all. Agents stay put until agent_registry_free. */
+
+typedef struct
+{
+  const agent_type_t* type;
+  agent_t* agents;
+  unsigned char* states; // count * stride bytes, agents[i].state points into it
+  size_t stride;
+  size_t count;
+} agent_group_t;
+
+typedef struct
+{
+  agent_group_t* groups;
+  size_t count;
+  size_t capacity;
+} agent_registry_t;
+
+void agent_registry_init(agent_registry_t* reg);
+
+// `n` agents of `type` with ids first_id, first_id + 1, ... Each derives its
+// own stream from `seed`; `params` goes to every init.
+// Return: the group's first agent (the rest follow it), NULL on error
+agent_t* agent_registry_add(agent_registry_t* reg, const agent_type_t* type, size_t n,
+                            agent_id_t first_id, uint64_t seed, const void* params);
+
+// Tear down every agent. Call after simulator_free, which may still use them.
+void agent_registry_free(agent_registry_t* reg);
+
+// A single agent with its own allocations, for code that builds agents one by
+// one. NULL on error. agent_destroy only takes agents from agent_create.
+agent_t* agent_create(const agent_type_t* type, agent_id_t id, uint64_t seed, const void* params);
+void agent_destroy(agent_t* agent);
+
+#endif // !AGENT_REGISTRY_H
@@ -0,0 +1,39 @@
+#ifndef AS_MARKET_MAKER_H
+#define AS_MARKET_MAKER_H
+
+#include "agent.h"
+
+/* Avellaneda-Stoikov market maker. Around the mid s it quotes
+     reservation price  r = s - q * gamma * sigma^2 * tau
+     total spread       d = gamma * sigma^2 * tau + (2 / gamma) * ln(1 + gamma / k)
+   with q its inventory in lots of AS_MM_ORDER_QTY and tau the ticks left to a
+   rolling horizon of AS_MM_HORIZON. The q * gamma * tau and gamma * tau factors
+   come from tables shared by every agent of the type, so a quote costs a few
+   multiplies. Quotes move by amending the resting order, not cancel and add. */
+
+#define AS_MM_GAMMA 0.01     // risk aversion
+#define AS_MM_K 5.0          // order arrival decay with distance from the mid
+#define AS_MM_HORIZON 200    // ticks per horizon; each agent starts at its own phase
+#define AS_MM_TAU_BUCKETS 64 // time-to-horizon resolution of the tables
+#define AS_MM_MAX_LOTS 10    // inventory limit, in lots; the side that adds to it is pulled
+#define AS_MM_ORDER_QTY 10
+
+extern const agent_type_t as_market_maker_type;
+
+// `seed` is shared by every agent of a run; each agent derives its own stream from it
+agent_t* as_market_maker_create(agent_id_t id, uint64_t seed);
+void as_market_maker_destroy(agent_t* agent);
+
+// The bid and ask the agent would quote at `now` around mid `mid` with its
+// current inventory and volatility estimate, before clamping to the book
+void as_market_maker_quote(const agent_t* agent, double mid, timestamp_t now, price_t* bid,
+                           price_t* ask);
+
+// Streaming variance of the mid, in ticks^2 per tick
+double as_market_maker_variance(const agent_t* agent);
+// Net position from the fills reported so far (positive: long)
+qty_t as_market_maker_inventory(const agent_t* agent);
+// Realized plus unrealized P&L with the position marked at `mark`
+int64_t as_market_maker_pnl(const agent_t* agent, price_t mark);
+
+#endif
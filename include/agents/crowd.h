@@ -0,0 +1,15 @@
+#ifndef CROWD_H
+#define CROWD_H
+
+#include "agent.h"
+
+// Type params: const size_t*, the number of traders
+extern const agent_type_t crowd_type;
+
+// One agent standing in for `traders` noise traders. Their parameters live in
+// flat arrays and a whole tick's decisions are generated in a few vector
+// passes; the resulting orders go to the book as one batch.
+agent_t* crowd_create(agent_id_t id, uint64_t seed, size_t traders);
+void crowd_destroy(agent_t* agent);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef INDICATOR_TRADER_H
+#define INDICATOR_TRADER_H
+
+#include "agent.h"
+#include "common/rng.h"
+#include "sim/arrival.h"
+#include "sim/indicators.h"
+
+/* What the agents trading on the book's shared indicators have in common:
+   Poisson decision times, a net position from fills, and one working order
+   that is pulled before the next one goes out. A type names the indicators it
+   reads and a signal that runs at each arrival once all of them are ready;
+   the rest (hooks, checkpointing, step_all) is here. */
+
+#define INDICATOR_TRADER_MAX_READS 4
+
+typedef struct indicator_trader indicator_trader_t;
+
+// Decide at an arrival; act through indicator_trader_take
+typedef void (*indicator_signal_fn)(agent_t* agent, indicator_trader_t* trader, order_book_t* book,
+                                    const market_view_t* view, timestamp_t now);
+
+typedef struct
+{
+  indicator_kind_t kind;
+  size_t window;
+} indicator_read_t;
+
+typedef struct
+{
+  indicator_read_t reads[INDICATOR_TRADER_MAX_READS];
+  size_t n_reads;
+  qty_t max_position; // no orders that would take it further out
+  indicator_signal_fn signal;
+} indicator_trader_spec_t;
+
+// What a checkpoint keeps: everything but the links to the shared indicators,
+// which init sets up again
+typedef struct
+{
+  order_id_t next_order_id;
+  rng_t rng;
+  arrival_t arrival;     // Poisson decision times
+  timestamp_t next_wake; // AGENT_NO_WAKEUP until the first arrival is sampled
+
+  qty_t position;     // net fills so far
+  order_id_t open_id; // last order while part of it may rest, else 0
+} indicator_trader_record_t;
+
+struct indicator_trader
+{
+  indicator_trader_record_t rec;
+  const indicator_trader_spec_t* spec;
+  const indicators_t* ind;
+  int handles[INDICATOR_TRADER_MAX_READS]; // into ind, in spec->reads order
+};
+
+// The body of a type's init: registers the spec's reads on `params`, the
+// indicators_t* attached to the book, and sets up the hooks. Return: 0 ok, -1 error
+int indicator_trader_init(agent_t* agent, agent_id_t id, uint64_t seed, const void* params,
+                          const indicator_trader_spec_t* spec);
+
+// step_all of every indicator-trading type
+void indicator_trader_step_all(agent_t* const* agents, size_t n, order_book_t* book,
+                               const market_view_t* view, timestamp_t now, timestamp_t* next);
+
+// Take `qty` at the best quote on `side`; the previous order's unfilled rest is
+// pulled first so stale orders do not pile up behind the market
+void indicator_trader_take(agent_t* agent, indicator_trader_t* trader, order_book_t* book,
+                           const market_view_t* view, side_t side, qty_t qty, timestamp_t now);
+
+// Net position from the fills reported so far (positive: long)
+qty_t indicator_trader_position(const agent_t* agent);
+
+#endif
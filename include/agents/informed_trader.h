@@ -2,8 +2,44 @@
 #define INFORMED_TRADER_H
 
 #include "agent.h"
+#include "sim/ou_process.h"
 
-agent_t* informed_trader_create(agent_id_t id);
+// params: const informed_params_t*, NULL for the defaults
+typedef struct
+{
+  price_t threshold; // trade only on quotes this far through the fair value
+} informed_params_t;
+
+#define INFORMED_DEFAULT_THRESHOLD 10
+
+extern const agent_type_t informed_trader_type;
+
+// `seed` is shared by every agent of a run; each agent derives its own stream from it
+agent_t* informed_trader_create(agent_id_t id, uint64_t seed);
 void informed_trader_destroy(agent_t* agent);
 
+// A population of informed traders reading one fair value that follows an
+// Ornstein-Uhlenbeck process, each through its own Gaussian noise. The
+// population outlives its traders.
+typedef struct
+{
+  ou_process_t latent;
+  double noise; // sd of a trader's private error on each reading, in ticks
+} informed_population_t;
+
+// Defaults for the command line and runner: a stationary sd of ~11 ticks
+// around the mean, with a half-life of ~700 ticks
+#define INFORMED_OU_REVERSION 0.001
+#define INFORMED_OU_VOLATILITY 0.5
+#define INFORMED_OU_NOISE 2.0
+
+// Return: 0 ok, -1 bad parameters
+int informed_population_init(informed_population_t* pop, double mean, double reversion,
+                             double volatility, double noise, uint64_t seed);
+void informed_population_free(informed_population_t* pop);
+
+// params: the informed_population_t* the traders share
+extern const agent_type_t ou_informed_trader_type;
+agent_t* ou_informed_trader_create(agent_id_t id, uint64_t seed, informed_population_t* pop);
+
 #endif
@@ -3,7 +3,23 @@
 
 #include "agent.h"
 
-agent_t* market_maker_create(agent_id_t id);
+// params: const market_maker_params_t*, NULL for the defaults
+typedef struct
+{
+  price_t half_spread; // quotes sit this far either side of the mid
+} market_maker_params_t;
+
+#define MM_DEFAULT_HALF_SPREAD 5
+
+extern const agent_type_t market_maker_type;
+
+// `seed` is shared by every agent of a run; each agent derives its own stream from it
+agent_t* market_maker_create(agent_id_t id, uint64_t seed);
 void market_maker_destroy(agent_t* agent);
 
+// Net position from the fills reported so far (positive: long)
+qty_t market_maker_inventory(const agent_t* agent);
+// Realized plus unrealized P&L with the position marked at `mark`
+int64_t market_maker_pnl(const agent_t* agent, price_t mark);
+
 #endif
@@ -0,0 +1,29 @@
+#ifndef MEAN_REVERSION_TRADER_H
+#define MEAN_REVERSION_TRADER_H
+
+#include "agent.h"
+#include "sim/indicators.h"
+
+/* Fades stretched prices using the book's shared indicators: at each sampled
+   arrival it buys when the last fill sits in the bottom MEAN_REV_ENTRY of the
+   way from the rolling mean down to the rolling low, sells at the mirror point
+   near the rolling high, and closes its position once the price is back
+   through the mean. Ranges under MEAN_REV_MIN_RANGE ticks are left alone. */
+
+#define MEAN_REV_WINDOW 1024 // fills, for the mean, low and high
+#define MEAN_REV_ENTRY 0.75
+#define MEAN_REV_MIN_RANGE 2
+#define MEAN_REV_ORDER_QTY 5
+#define MEAN_REV_MAX_POSITION 50 // no orders that would take it further out
+
+// params: the indicators_t* attached to the book; init registers what it reads
+extern const agent_type_t mean_reversion_trader_type;
+
+// `seed` is shared by every agent of a run; each agent derives its own stream from it
+agent_t* mean_reversion_trader_create(agent_id_t id, uint64_t seed, indicators_t* ind);
+void mean_reversion_trader_destroy(agent_t* agent);
+
+// Net position from the fills reported so far (positive: long)
+qty_t mean_reversion_trader_position(const agent_t* agent);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef MOMENTUM_TRADER_H
+#define MOMENTUM_TRADER_H
+
+#include "agent.h"
+#include "sim/indicators.h"
+
+/* Trend follower on the book's shared indicators: at each sampled arrival it
+   buys when the fast EMA of fill prices is above the slow one by more than
+   MOMENTUM_BAND ticks and the return over MOMENTUM_RETURN_WINDOW fills agrees,
+   and sells on the mirror signal, taking the best quote. */
+
+#define MOMENTUM_FAST_SPAN 64      // fills
+#define MOMENTUM_SLOW_SPAN 512     // fills
+#define MOMENTUM_RETURN_WINDOW 256 // fills
+#define MOMENTUM_BAND 0.25         // ticks between the EMAs before acting
+#define MOMENTUM_ORDER_QTY 5
+#define MOMENTUM_MAX_POSITION 50 // no orders that would take it further out
+
+// params: the indicators_t* attached to the book; init registers what it reads
+extern const agent_type_t momentum_trader_type;
+
+// `seed` is shared by every agent of a run; each agent derives its own stream from it
+agent_t* momentum_trader_create(agent_id_t id, uint64_t seed, indicators_t* ind);
+void momentum_trader_destroy(agent_t* agent);
+
+// Net position from the fills reported so far (positive: long)
+qty_t momentum_trader_position(const agent_t* agent);
+
+#endif
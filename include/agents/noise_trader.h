@@ -3,7 +3,10 @@
 
 #include "agent.h"
 
-agent_t* noise_trader_create(agent_id_t id);
+extern const agent_type_t noise_trader_type;
+
+// `seed` is shared by every agent of a run; each agent derives its own stream from it
+agent_t* noise_trader_create(agent_id_t id, uint64_t seed);
 void noise_trader_destroy(agent_t* agent);
 
 #endif
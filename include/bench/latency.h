@@ -6,6 +6,11 @@
 
 #define LATENCY_MAX_SAMPLES 100000
 
+// Log-linear histogram: 8 sub-buckets per power of two, ~12% relative error.
+// Unlike the sample ring it merges exactly across trackers.
+#define LATENCY_HIST_SUB_BITS 3
+#define LATENCY_HIST_BUCKETS ((64 - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS)
+
 typedef struct
 {
   // Counters
@@ -21,6 +26,9 @@ typedef struct
   size_t sample_count;    // How many samples stored
   size_t sample_capacity; // Max samples (LATENCY_MAX_SAMPLES)
 
+  // Mergeable distribution
+  uint64_t hist[LATENCY_HIST_BUCKETS];
+
 } latency_tracker_t;
 
 void latency_init(latency_tracker_t* tracker);
@@ -30,6 +38,12 @@ void latency_record(latency_tracker_t* tracker, uint64_t latency_ns);
 double latency_mean(latency_tracker_t* tracker);
 uint64_t latency_percentile(latency_tracker_t* tracker, double p);
 
+// Fold `src` into `dst`: counters and histogram exactly, samples while room remains.
+void latency_merge(latency_tracker_t* dst, const latency_tracker_t* src);
+
+// Percentile from the histogram (bucket lower bound); valid after merges.
+uint64_t latency_hist_percentile(const latency_tracker_t* tracker, double p);
+
 void latency_print(latency_tracker_t* tracker, const char* name);
 
 void latency_free(latency_tracker_t* tracker);
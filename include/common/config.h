@@ -6,10 +6,25 @@
 #define LOT_SIZE 1
 #define MAX_PRICE_LEVELS 100000
 #define MAX_ORDERS 1000000
+#define DEFAULT_MID_PRICE 1000 /* reference price while the book is empty */
+
+/* ---- Depth ladder (Fenwick index over [LADDER_MIN_PRICE, LADDER_MAX_PRICE]) ---- */
+#define LADDER_MIN_PRICE 1
+#define LADDER_MAX_PRICE MAX_PRICE_LEVELS
+
+/* ---- Top-of-book cache (levels kept per side) ---- */
+#define BOOK_TOP_LEVELS 10
+
+/* ---- What-if book forks (overlay capacity) ---- */
+#define BOOK_FORK_MAX_LEVELS 64
+#define BOOK_FORK_MAX_ORDERS 64
 
 /* ---- Simulation ---- */
-#define MAX_EVENTS 2000000
+#define MAX_EVENTS 16000000 /* cap on scheduled events, in-flight messages included */
 #define MAX_AGENTS 128
+#define EXEC_RING_CAPACITY 16384 /* execution reports buffered per book between drains */
+#define EXEC_BATCH 64            /* reports handed to one agent per callback, at most */
+#define VIEW_HISTORY_CAPACITY 4096 /* market snapshots kept for delayed market data */
 
 /* ---- Debug ---- */
 #define ENABLE_ASSERTS 1
@@ -0,0 +1,94 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---- xoshiro256** ----
+   One generator per stream. Streams are split from a single run seed by
+   hashing (seed, stream id) through splitmix64, so every agent gets its own
+   reproducible sequence and adding an agent never shifts another's draws. */
+
+typedef struct
+{
+  uint64_t s[4];
+} rng_t;
+
+// Lanes used by the bulk fills; a multiple of the widest vector of u64s
+#define RNG_LANES 8
+
+void rng_seed(rng_t* rng, uint64_t seed);
+void rng_init_stream(rng_t* rng, uint64_t seed, uint64_t stream);
+
+static inline uint64_t rng_rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+static inline uint64_t rng_next(rng_t* rng)
+{
+  uint64_t* s = rng->s;
+  uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rng_rotl(s[3], 45);
+
+  return result;
+}
+
+// Uniform in [0, 1), 53 bits
+static inline double rng_u64_to_unit(uint64_t x) { return (double)(x >> 11) * 0x1.0p-53; }
+
+// Uniform in (0, 1): never 0, so log() is always finite
+static inline double rng_u64_to_open_unit(uint64_t x)
+{
+  return ((double)(x >> 11) + 0.5) * 0x1.0p-53;
+}
+
+static inline double rng_uniform(rng_t* rng) { return rng_u64_to_unit(rng_next(rng)); }
+
+static inline double rng_uniform_open(rng_t* rng) { return rng_u64_to_open_unit(rng_next(rng)); }
+
+// Unbiased integer in [0, n) (Lemire's multiply-shift with rejection); n > 0
+static inline uint64_t rng_below(rng_t* rng, uint64_t n)
+{
+  __uint128_t m = (__uint128_t)rng_next(rng) * n;
+  uint64_t low = (uint64_t)m;
+  if (low < n)
+  {
+    uint64_t threshold = -n % n;
+    while (low < threshold)
+    {
+      m = (__uint128_t)rng_next(rng) * n;
+      low = (uint64_t)m;
+    }
+  }
+  return (uint64_t)(m >> 64);
+}
+
+// Uniform integer in [lo, hi]
+static inline int64_t rng_range(rng_t* rng, int64_t lo, int64_t hi)
+{
+  return lo + (int64_t)rng_below(rng, (uint64_t)(hi - lo) + 1);
+}
+
+double rng_exp(rng_t* rng, double rate);
+double rng_normal(rng_t* rng);
+
+// Standard normal by the ziggurat method (128 layers): one draw, a table lookup
+// and a compare in ~99% of calls, no log or trig. Not the same sequence as
+// rng_normal.
+double rng_normal_zig(rng_t* rng);
+
+/* bulk generation: `n` variates into `out`. Runs RNG_LANES independent lanes
+   (seeded from `rng`) in lockstep so the core loop vectorizes; the output is
+   the same with or without SIMD. */
+void rng_fill_u64(rng_t* rng, uint64_t* out, size_t n);
+void rng_fill_u32(rng_t* rng, uint32_t* out, size_t n);
+void rng_fill_uniform(rng_t* rng, double* out, size_t n);
+void rng_fill_exp(rng_t* rng, double* out, size_t n, double rate);
+void rng_fill_normal(rng_t* rng, double* out, size_t n);
+
+#endif
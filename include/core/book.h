@@ -1,24 +1,129 @@
 #ifndef BOOK_H
 #define BOOK_H
 
+#include "common/config.h"
 #include "common/types.h"
+#include "core/depth_ladder.h"
+#include "core/exec_report.h"
 #include "core/level.h"
 #include "core/order_map.h"
 #include "core/price_tree.h"
+#include "core/risk.h"
+#include "sim/clock.h"
+#include "sim/stats.h"
+
+#ifdef BENCHMARK
+#include "bench/latency.h"
+#endif
+
+/* one L2 row */
+typedef struct
+{
+  price_t price;
+  qty_t qty;
+  size_t count;
+} depth_entry_t;
+
+/* one level of a bulk load: its resting orders, front of the queue first */
+typedef struct
+{
+  price_t price;
+  order_t** orders;
+  size_t count;
+} book_level_data_t;
+
+/* best BOOK_TOP_LEVELS levels of one side, best first */
+typedef struct
+{
+  depth_entry_t levels[BOOK_TOP_LEVELS];
+  size_t n;
+} book_top_t;
+
+/* what happened in the book since its reader last cleared this; costs the
+   matching loop a few stores and drives event-triggered agent wakeups */
+typedef struct
+{
+  uint64_t trades;     /* fills */
+  price_t trade_low;   /* lowest / highest fill price, valid when trades > 0 */
+  price_t trade_high;
+  uint64_t depletions; /* price levels emptied by fills or cancels */
+} book_tape_t;
 
 typedef struct
 {
   price_tree_t bids; /* descending prices */
   price_tree_t asks; /* ascending prices */
   order_map_t orders;
+  depth_ladder_t bid_ladder; /* cumulative depth near the touch */
+  depth_ladder_t ask_ladder;
+  book_top_t top_bids; /* incrementally maintained L2 snapshot */
+  book_top_t top_asks;
+  stats_t stats;    /* trade statistics for this book only */
+  uint64_t version; /* bumped on every level change; lets readers cache views */
+  book_tape_t tape;
+  exec_ring_t reports; /* fills and cancels for the owning agents, off by default */
+  struct book_node_block* node_blocks; /* queue nodes of bulk loads, freed by book_free */
+  struct indicators* indicators; /* fed every fill when set; not owned by the book */
+  const sim_clock_t* clock; /* when set, stamps every entering order, fill and cancel */
+  risk_gate_t* risk; /* when set, every entering order must pass it; not owned */
+#ifdef BENCHMARK
+  latency_tracker_t add_latency;
+  latency_tracker_t remove_latency;
+  latency_tracker_t match_latency;
+#endif
 } order_book_t;
 
+/* the book's time: its clock's if it has one, else `fallback` */
+static inline timestamp_t book_now(const order_book_t* book, timestamp_t fallback)
+{
+  return book->clock ? book->clock->now : fallback;
+}
+
 /* lifecycle */
-void book_init(order_book_t* book);
+// Return: 0 ok, -1 allocation failure (nothing is left allocated; no book_free)
+int book_init(order_book_t* book);
 void book_free(order_book_t* book);
 
+// Start queueing an exec_report_t for every fill (both sides) and cancel.
+// Return: 0 ok, -1 allocation failure
+int book_enable_reports(order_book_t* book, size_t capacity);
+
 /* state updates */
 void book_add_order(order_book_t* book, order_t* order);
+// Same as book_add_order for each order in turn (same priority and ownership),
+// reusing level lookups across the batch.
+void book_add_orders(order_book_t* book, order_t** orders, size_t n);
 void book_remove_order(order_book_t* book, order_id_t id);
+// Change a resting order in place of a cancel and a new order. A smaller qty at
+// the same price keeps the order's place in the queue; a new price or a larger
+// qty sends it to the back at its (possibly new) level, matching first if it
+// now crosses. A qty cut is reported as a partial cancel. qty <= 0 cancels.
+// A bulk-loaded order re-enters as a heap copy; the loader keeps its memory.
+// Return: 0 ok, -1 no such resting order or no memory for the copy (order unchanged)
+int book_amend_order(order_book_t* book, order_id_t id, price_t price, qty_t qty);
+
+// Load resting orders into an empty book in O(n), skipping matching: each side's
+// levels best price first (bids descending, asks ascending), the sides not
+// crossing, every order of a level on that side and at that price with qty > 0.
+// The book takes the orders as if each had been added and rested; order ids
+// must be unique. With a risk gate attached they rest on their owners'
+// accounts unchecked. Their queue nodes share one block that is released by
+// book_free, not as the orders leave; the orders stay the caller's memory and
+// the book never frees them.
+// Return: 0 ok, -1 invalid input or allocation failure, with the book left empty
+int book_load(order_book_t* book, const book_level_data_t* bids, size_t n_bids,
+              const book_level_data_t* asks, size_t n_asks);
+
+/* level bookkeeping (tree aggregates, ladder, top-N cache); shared with matching.
+   Call after the level's queue changed by `delta` qty, before an empty level is
+   removed from its tree. */
+void book_level_changed(order_book_t* book, side_t side, price_level_t* lvl, qty_t delta);
+
+/* queries */
+// Estimated qty resting ahead of order `id` at its price level, -1 if unknown.
+qty_t book_queue_ahead(order_book_t* book, order_id_t id);
+
+// Copy up to `max` best levels of one side into `out`, best first. Returns rows copied.
+size_t book_top_levels(const order_book_t* book, side_t side, depth_entry_t* out, size_t max);
 
 #endif
@@ -0,0 +1,59 @@
+#ifndef BOOK_FORK_H
+#define BOOK_FORK_H
+
+#include "common/config.h"
+#include "common/types.h"
+#include "core/book.h"
+#include "core/trade.h"
+#include <stddef.h>
+
+// Copy-on-write view of a frozen order book for what-if evaluation.
+// The fork never writes to the base; it records per-level consumption and
+// hypothetical resting orders in a small overlay, so a hypothetical match costs
+// time proportional to the levels it touches and discarding it is O(1).
+// The base book must not change while a fork of it is in use.
+
+typedef struct
+{
+  side_t side;
+  price_t price;
+  const price_level_t* base;  // frozen base level, NULL if the level only exists in the fork
+  const order_node_t* cursor; // first base order not fully consumed
+  qty_t cursor_filled;        // qty already taken from the cursor order
+  qty_t consumed;             // base qty consumed at this level
+  qty_t added;                // hypothetical qty resting behind the base queue
+} fork_level_t;
+
+typedef struct
+{
+  order_id_t id;
+  side_t side;
+  price_t price;
+  qty_t qty;
+} fork_order_t;
+
+typedef struct
+{
+  const order_book_t* base;
+  fork_level_t levels[BOOK_FORK_MAX_LEVELS];
+  size_t level_count;
+  fork_order_t orders[BOOK_FORK_MAX_ORDERS]; // hypothetical resting orders, arrival order
+  size_t order_count;
+  int overflow; // set when the overlay ran out of room and a result was truncated
+} book_fork_t;
+
+/* lifecycle */
+void book_fork_init(book_fork_t* fork, const order_book_t* base);
+void book_fork_reset(book_fork_t* fork);
+
+/* hypothetical state updates (incoming is modified, never owned) */
+size_t book_fork_match(book_fork_t* fork, order_t* incoming, trade_t* trades, size_t max_trades);
+size_t book_fork_add_order(book_fork_t* fork, order_t* incoming, trade_t* trades,
+                           size_t max_trades);
+
+/* queries against base + overlay */
+// Best price on `side`. Return: 1 found (written to *price), 0 side is empty
+int book_fork_best(const book_fork_t* fork, side_t side, price_t* price);
+qty_t book_fork_level_qty(const book_fork_t* fork, side_t side, price_t price);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef DEPTH_LADDER_H
+#define DEPTH_LADDER_H
+
+#include "common/types.h"
+#include <stddef.h>
+
+// Fenwick (binary indexed) tree over a bounded price ladder [lo, hi].
+// Index 1 is the side's best possible price, so every query is a prefix sum
+// from the touch outward. Prices outside the ladder are not tracked.
+typedef struct
+{
+  qty_t* tree;      // 1-based BIT array, size n + 1
+  size_t n;         // number of ticks covered
+  size_t top_bit;   // highest power of two <= n (for descents)
+  price_t lo, hi;   // covered price range, inclusive
+  int descending;   // non-zero for bids: best price is hi
+} depth_ladder_t;
+
+int dl_init(depth_ladder_t* dl, price_t lo, price_t hi, int descending);
+void dl_free(depth_ladder_t* dl);
+
+// Add `delta` to the qty resting at `price`. Return: 1 tracked, 0 outside ladder
+int dl_add(depth_ladder_t* dl, price_t price, qty_t delta);
+
+// Total qty at prices at or better than `price`
+qty_t dl_depth_until(const depth_ladder_t* dl, price_t price);
+
+// Price at which cumulative depth from the best price reaches `qty`.
+// Return: 1 found (written to *price), 0 ladder is not deep enough
+int dl_price_for_qty(const depth_ladder_t* dl, qty_t qty, price_t* price);
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef EXEC_REPORT_H
+#define EXEC_REPORT_H
+
+#include "common/types.h"
+#include "core/order.h"
+#include <stddef.h>
+
+typedef enum
+{
+  EXEC_FILL,
+  EXEC_CANCEL,
+  EXEC_REJECT // refused by the book's risk gate before it could trade or rest
+} exec_type_t;
+
+// One execution event for the agent owning `order_id` (see order_owner).
+typedef struct
+{
+  exec_type_t type;
+  order_id_t order_id;
+  side_t side;
+  price_t price;    // fill price, or the cancelled or rejected order's limit
+  qty_t qty;        // qty filled, cancelled or rejected
+  qty_t leaves_qty; // qty still open after this event
+  timestamp_t ts;
+} exec_report_t;
+
+// Fixed-capacity FIFO of reports, filled by the book and drained by the
+// simulator. Storage is allocated once up front; a full ring drops and counts.
+typedef struct
+{
+  exec_report_t* items; // NULL: reporting disabled
+  size_t head;
+  size_t count;
+  size_t capacity;
+  uint64_t dropped;
+} exec_ring_t;
+
+static inline void exec_ring_push(exec_ring_t* ring, const exec_report_t* report)
+{
+  if (!ring->items)
+    return;
+  if (ring->count == ring->capacity)
+  {
+    ring->dropped++;
+    return;
+  }
+  size_t tail = ring->head + ring->count;
+  if (tail >= ring->capacity)
+    tail -= ring->capacity;
+  ring->items[tail] = *report;
+  ring->count++;
+}
+
+static inline int exec_ring_pop(exec_ring_t* ring, exec_report_t* out)
+{
+  if (ring->count == 0)
+    return 0;
+  *out = ring->items[ring->head];
+  ring->head = (ring->head + 1 == ring->capacity) ? 0 : ring->head + 1;
+  ring->count--;
+  return 1;
+}
+
+#endif
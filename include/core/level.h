@@ -3,18 +3,27 @@
 
 #include "common/types.h"
 #include "order.h"
+#include <stddef.h>
+
+struct price_level;
 
 typedef struct order_node
 {
   order_t* order;
   struct order_node* next;
   struct order_node* prev;
+  struct price_level* level; // owning level (O(1) lookup from the order map)
+  qty_t entry_offset;        // level->enqueued_qty when this order joined the queue
+  int bulk; // part of a book_load block: freed with the book, never on its own
 } order_node_t;
 
-typedef struct
+typedef struct price_level
 {
   price_t price;
   qty_t total_qty;
+  size_t order_count;
+  qty_t enqueued_qty; // cumulative qty ever pushed onto this level
+  qty_t dequeued_qty; // cumulative qty filled/popped from the front
   order_node_t* head;
   order_node_t* tail;
 } price_level_t;
@@ -17,4 +17,9 @@ void level_free_queue(price_level_t* level, void (*free_order)(order_t* order));
 
 int level_remove(price_level_t* level, order_node_t* node);
 
+// Estimated qty resting ahead of `node` in O(1).
+// Exact unless orders ahead of it were cancelled, in which case it is an upper
+// bound (clamped to the qty actually resting at the level).
+qty_t level_queue_ahead(const price_level_t* level, const order_node_t* node);
+
 #endif
\ No newline at end of file
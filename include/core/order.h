@@ -25,4 +25,16 @@ typedef struct
   timestamp_t ts;
 } order_t;
 
+// Order ids are namespaced by agent so ids from different agents never collide
+// in the book's order map.
+#define ORDER_ID_AGENT_SHIFT 40
+
+static inline order_id_t order_id_first(agent_id_t agent)
+{
+  return ((order_id_t)agent << ORDER_ID_AGENT_SHIFT) + 1;
+}
+
+// The owning agent is carried in the id itself, so routing needs no extra field
+static inline agent_id_t order_owner(order_id_t id) { return id >> ORDER_ID_AGENT_SHIFT; }
+
 #endif
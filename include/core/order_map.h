@@ -18,12 +18,24 @@ typedef struct om_entry
   struct om_entry* next; // next node in chain
 } om_entry_t;
 
+// Entries are carved out of blocks, so inserts do not call malloc; removed
+// entries are kept on a free list for reuse
+typedef struct om_block
+{
+  struct om_block* next;
+  size_t used;
+  size_t capacity;
+  om_entry_t entries[];
+} om_block_t;
+
 // The hash map itself
 typedef struct
 {
   om_entry_t** buckets; // array of linked list heads
   size_t num_buckets;   // size of the array
   size_t count;         // number of entries (optional, for stats)
+  om_block_t* blocks;   // newest first; entries are handed out from the head
+  om_entry_t* free_entries;
 } order_map_t;
 
 // What functions do you need?
@@ -31,6 +43,10 @@ void om_init(order_map_t* map, size_t num_buckets);
 int om_insert(order_map_t* map, order_id_t id, order_t* order, side_t side, price_t price,
               order_node_t* node);
 om_entry_t* om_find(order_map_t* map, order_id_t id);
+// Make room for `count` entries in total: at least that many buckets (never
+// shrinks) and entry storage for all of them, e.g. before a bulk load.
+// Return: 0 ok, -1 allocation failure (map unchanged)
+int om_reserve(order_map_t* map, size_t count);
 int om_remove(order_map_t* map, order_id_t id);
 void om_free(order_map_t* map);
 
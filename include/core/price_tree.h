@@ -17,6 +17,11 @@ typedef struct price_node
   price_level_t* level;
   pt_color_t color;
   struct price_node *left, *right, *parent;
+
+  // Augmentation: resting qty at this node and totals over its subtree.
+  qty_t qty;
+  qty_t subtree_qty;
+  size_t subtree_count;
 } price_node_t;
 
 // tree
@@ -33,12 +38,36 @@ price_level_t* pt_find(const price_tree_t* t, price_t price);
 
 int pt_insert(price_tree_t* t, price_t price, price_level_t* level);
 
+// Build an empty tree from `n` levels with strictly ascending `keys` in O(n):
+// perfectly balanced, the deepest row red, subtree aggregates from each level's
+// total_qty. Return: 0 ok, -1 not empty or allocation failure (tree unchanged)
+int pt_build_sorted(price_tree_t* t, const price_t* keys, price_level_t* const* levels, size_t n);
+
 price_level_t* pt_min(const price_tree_t* t);
 
 price_level_t* pt_max(const price_tree_t* t);
 
 int pt_remove(price_tree_t* t, price_t price);
 
+// Nearest level strictly above / below `price` (price need not be in the tree)
+price_level_t* pt_next_above(const price_tree_t* t, price_t price);
+price_level_t* pt_next_below(const price_tree_t* t, price_t price);
+
+// Adjust the resting qty tracked for `price` by `delta` in O(log n).
+// Call whenever the level's total_qty changes. Return: 1 updated, 0 not found
+int pt_add_qty(price_tree_t* t, price_t price, qty_t delta);
+
+// Cumulative depth queries in O(log n). `from_max` picks the side's best price:
+// non-zero walks down from the highest key (bids), zero up from the lowest (asks).
+
+// Total qty resting at prices at or better than `price`. Optionally returns the
+// number of levels that make up that depth.
+qty_t pt_depth_until(const price_tree_t* t, price_t price, int from_max, size_t* levels);
+
+// Price of the level at which cumulative depth from the best price reaches `qty`.
+// Return: 1 found (written to *price), 0 book is not deep enough
+int pt_price_for_qty(const price_tree_t* t, qty_t qty, int from_max, price_t* price);
+
 // Clear the tree in O(P). The tree frees its nodes.
 // free_level(level) is called for each stored level pointer (may be NULL).
 void pt_clear(price_tree_t* t, void (*free_level)(price_level_t* level));
@@ -0,0 +1,139 @@
+#ifndef RISK_H
+#define RISK_H
+
+#include "common/types.h"
+#include "core/order.h"
+#include <stddef.h>
+
+/* Pre-trade risk gate. The book checks every entering order (new orders and
+   reprices) against exchange-style limits before it can match or rest, and
+   a rejected order never reaches the trees or the order map. Each owner (the
+   agent id in the order id) has one account in a flat array indexed by that
+   id; the book keeps its position and open orders current as orders rest,
+   fill, shrink and leave. Message rate is a token bucket per owner, refilled
+   lazily from sim time when the owner next sends.
+
+   Attach the gate to an empty book: orders resting before it are on no
+   account. Orders bulk-loaded afterwards (book_load) are counted as resting
+   without being checked. */
+
+typedef enum
+{
+  RISK_OK,
+  RISK_REJECT_QTY,      // above max_order_qty (or not positive)
+  RISK_REJECT_COLLAR,   // limit price too far from the reference price
+  RISK_REJECT_POSITION, // could take the owner past max_position
+  RISK_REJECT_OPEN,     // owner already has max_open_orders resting
+  RISK_REJECT_RATE,     // owner's message bucket is empty
+  RISK_REJECT_ACCOUNT,  // no memory for the owner's account
+  RISK_REASONS
+} risk_reason_t;
+
+// 0 turns a limit off
+typedef struct
+{
+  qty_t max_order_qty;
+  price_t collar;           // max ticks between a limit price and the last trade
+  qty_t max_position;       // |position| if every open order on the order's side fills
+  uint32_t max_open_orders; // resting orders per owner
+  uint64_t msg_rate;        // new orders and reprices per second of sim time
+  uint32_t burst;           // messages an idle owner may send back to back; 0 means 1
+} risk_limits_t;
+
+typedef struct
+{
+  qty_t position;    // net filled qty, positive long
+  qty_t open_buy;    // resting qty on each side
+  qty_t open_sell;
+  uint32_t open_orders;
+  timestamp_t full_at; // the bucket is full from then on; before, it is short
+                       // (full_at - now) / interval tokens
+} risk_account_t;
+
+typedef struct risk_gate
+{
+  risk_limits_t limits;
+  timestamp_t interval; // ns of sim time per token
+  timestamp_t window;   // burst * interval
+  risk_account_t* accounts;
+  size_t capacity;      // owners 0..capacity-1 have accounts
+  uint64_t checked;
+  uint64_t rejected[RISK_REASONS]; // by reason; [RISK_OK] stays 0
+} risk_gate_t;
+
+// Return: 0 ok, -1 bad limits
+int risk_init(risk_gate_t* gate, const risk_limits_t* limits);
+void risk_free(risk_gate_t* gate);
+
+// Comma-separated name=value limits, e.g. "qty=100,collar=50,position=500,
+// open=20,rate=100000,burst=10"; unnamed limits are off.
+// Return: 0 ok, -1 bad spec (the reason goes to stderr)
+int risk_parse_limits(risk_limits_t* limits, const char* spec);
+
+// Check `order` at `now` against `reference`, the price the collar is centred
+// on, and take one token from its owner's bucket if it passes. O(1).
+risk_reason_t risk_check(risk_gate_t* gate, const order_t* order, price_t reference,
+                         timestamp_t now);
+
+const char* risk_reason_name(risk_reason_t reason);
+
+// The owner's account, or NULL if it is past every account so far
+const risk_account_t* risk_account(const risk_gate_t* gate, agent_id_t owner);
+
+// Make sure `owner` has an account, e.g. before its orders are loaded
+// unchecked. Return: 0 ok, -1 no memory
+int risk_reserve(risk_gate_t* gate, agent_id_t owner);
+
+/* Book hooks. Accounts come in blocks: every owner below `capacity` has one,
+   whether or not it has sent an order, and the hooks update it; an owner past
+   that has had nothing checked or loaded, so nothing of its rests and it is
+   left alone. */
+
+static inline risk_account_t* risk_owner(risk_gate_t* gate, order_id_t id)
+{
+  agent_id_t owner = order_owner(id);
+  return owner < gate->capacity ? &gate->accounts[owner] : NULL;
+}
+
+static inline void risk_on_rest(risk_gate_t* gate, const order_t* order)
+{
+  risk_account_t* a = risk_owner(gate, order->id);
+  if (!a)
+    return;
+  a->open_orders++;
+  if (order->side == SIDE_BUY)
+    a->open_buy += order->qty;
+  else
+    a->open_sell += order->qty;
+}
+
+// `qty` of a resting order left the book (fill, cancel or cut); `gone` if that
+// was all of it
+static inline void risk_on_shrink(risk_gate_t* gate, order_id_t id, side_t side, qty_t qty,
+                                  int gone)
+{
+  risk_account_t* a = risk_owner(gate, id);
+  if (!a)
+    return;
+  if (side == SIDE_BUY)
+    a->open_buy -= qty;
+  else
+    a->open_sell -= qty;
+  if (gone)
+    a->open_orders--;
+}
+
+// `qty` traded between `incoming` and `resting`
+static inline void risk_on_fill(risk_gate_t* gate, const order_t* incoming, const order_t* resting,
+                                qty_t qty)
+{
+  risk_account_t* taker = risk_owner(gate, incoming->id);
+  risk_account_t* maker = risk_owner(gate, resting->id);
+  if (taker)
+    taker->position += incoming->side == SIDE_BUY ? qty : -qty;
+  if (maker)
+    maker->position += resting->side == SIDE_BUY ? qty : -qty;
+  risk_on_shrink(gate, resting->id, resting->side, qty, resting->qty == qty);
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef ARRIVAL_H
+#define ARRIVAL_H
+
+#include "common/rng.h"
+#include "common/types.h"
+
+// Arrival processes for agent wakeups. Times are continuous, in ticks; the
+// agent wakes at the first tick at or after each sampled arrival instead of
+// flipping a coin every tick. Wakeups are simulation timestamps (ns).
+
+typedef enum
+{
+  ARRIVAL_POISSON,
+  ARRIVAL_HAWKES
+} arrival_kind_t;
+
+typedef struct
+{
+  arrival_kind_t kind;
+  double mu;     // baseline intensity (arrivals per tick)
+  double alpha;  // Hawkes: intensity jump per arrival
+  double beta;   // Hawkes: decay rate of the excitation
+  double excite; // Hawkes: excess intensity lambda - mu right after the last arrival
+  double last;   // time of the last arrival
+} arrival_t;
+
+void arrival_init_poisson(arrival_t* a, double rate);
+
+// Stationary rate is mu / (1 - alpha / beta); requires alpha < beta.
+void arrival_init_hawkes(arrival_t* a, double mu, double alpha, double beta);
+
+// Poisson rate giving the same chance of at least one arrival per tick as a
+// per-tick coin flip with probability p.
+double arrival_rate_for_probability(double p);
+
+// Sample the next arrival after max(a->last, now), record it, and return its time. O(1).
+double arrival_next(arrival_t* a, double now, rng_t* rng);
+
+// Time of the first whole tick at or after `t` ticks, never earlier than the
+// tick after `now`
+timestamp_t arrival_tick(double t, timestamp_t now);
+
+// Wakeup for the next arrival after `now`: arrival_tick of arrival_next
+timestamp_t arrival_next_wake(arrival_t* a, timestamp_t now, rng_t* rng);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "sim/simulator.h"
+
+/* Binary checkpoint of a whole simulation: the book's levels and queues (in
+   queue order, with queue-position offsets), trade stats and indicators, sim
+   time, pending events including in-flight messages, network links, and every
+   agent's state through its save/load hooks, RNG streams included.
+
+   The file holds no pointers, only offsets from its start. It is restored by
+   mapping it copy-on-write and threading the book through the mapped order
+   records, so a warmed-up book comes back without copying its orders. */
+
+typedef struct checkpoint checkpoint_t;
+
+// Return: 0 ok, -1 error (errno from the failing call)
+int checkpoint_save(const simulator_t* sim, const char* path);
+
+// Load `path` into `sim`, which must be freshly set up: an empty book and the
+// same agents, added in the same order, and indicators as when it was saved. The returned
+// handle owns the memory of the restored resting orders; close it only after
+// book_free. NULL on failure (the reason goes to stderr); nothing is changed
+// if the file does not match the simulator.
+checkpoint_t* checkpoint_restore(simulator_t* sim, const char* path);
+void checkpoint_close(checkpoint_t* ckpt);
+
+#endif
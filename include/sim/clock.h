@@ -3,8 +3,32 @@
 
 #include "../common/types.h"
 
-timestamp_t sim_time_now(void);
-void sim_time_advance(timestamp_t dt);
-void sim_time_set(timestamp_t t);
+/* Simulation time, in nanoseconds since the start of the run. The clock only
+   moves when the simulator jumps to its next event, so quiet stretches cost
+   nothing however fine the resolution. Agents decide on a grid of ticks
+   SIM_TICK_NS long; everything between them (network delays, order entry,
+   fills) keeps full nanosecond resolution. */
+
+#define SIM_NS_PER_US 1000ULL
+#define SIM_NS_PER_MS 1000000ULL
+#define SIM_NS_PER_SEC 1000000000ULL
+#define SIM_TICK_NS SIM_NS_PER_US // one agent decision tick
+
+typedef struct sim_clock
+{
+  timestamp_t now;
+} sim_clock_t;
+
+void sim_clock_init(sim_clock_t* clock);
+timestamp_t sim_time_now(const sim_clock_t* clock);
+
+// Jump straight to `t`, the time of the next event. Time never runs backwards.
+// Return: 0 ok, -1 `t` is in the past
+int sim_time_advance_to(sim_clock_t* clock, timestamp_t t);
+
+static inline timestamp_t sim_ticks_to_ns(timestamp_t ticks) { return ticks * SIM_TICK_NS; }
+
+// Whole ticks elapsed by `ns`
+static inline timestamp_t sim_tick_of(timestamp_t ns) { return ns / SIM_TICK_NS; }
 
 #endif
@@ -2,21 +2,94 @@
 #define EVENT_H
 
 #include "common/types.h"
+#include "core/exec_report.h"
 #include "core/order.h"
 #include "core/trade.h"
+#include <stddef.h>
+
+struct agent;
 
 typedef enum
 {
   EVENT_ORDER,
   EVENT_CANCEL,
-  EVENT_TRADE
+  EVENT_TRADE,
+  EVENT_WAKEUP,
+  EVENT_EXEC, // execution report reaching its owner after the link delay
+  EVENT_AMEND
 } event_type_t;
 
+// A resting order's new price and size (see book_amend_order)
+typedef struct
+{
+  order_id_t id;
+  price_t price;
+  qty_t qty;
+} event_amend_t;
+
 typedef struct
 {
   timestamp_t ts;
+  uint64_t seq; // assigned on push; breaks timestamp ties in FIFO order
   event_type_t type;
-  void* payload;
+  union
+  {
+    order_t* order;         // EVENT_ORDER: book takes ownership on delivery
+    order_id_t cancel_id;   // EVENT_CANCEL
+    trade_t trade;          // EVENT_TRADE
+    struct agent* agent;    // EVENT_WAKEUP
+    exec_report_t report;   // EVENT_EXEC
+    event_amend_t amend;    // EVENT_AMEND
+  } payload;
 } event_t;
 
+// Monotone radix heap keyed by timestamp.
+// Bucket 0 holds events at the last popped timestamp (kept in seq order);
+// bucket i holds events whose key first differs from it at bit i-1. Pops
+// are amortized O(log range) and events are stored by value in per-bucket
+// arrays, so scheduling never mallocs per event.
+#define EQ_BUCKETS 65
+
+typedef struct
+{
+  event_t* items;
+  size_t head; // bucket 0 drains from the front
+  size_t count;
+  size_t capacity;
+} eq_bucket_t;
+
+typedef struct
+{
+  eq_bucket_t buckets[EQ_BUCKETS];
+  timestamp_t last; // timestamp of the last popped event; pushes must not go below it
+  size_t size;
+  size_t max_size;
+  uint64_t next_seq;
+} event_queue_t;
+
+void eq_init(event_queue_t* q, size_t max_size);
+void eq_free(event_queue_t* q);
+
+// Return: 0 ok, -1 timestamp in the past, queue full, or allocation failure
+int eq_push(event_queue_t* q, const event_t* ev);
+
+// Return: 1 popped into *out, 0 empty, -1 no memory to bring the next
+// timestamp forward (nothing is lost; a later call may succeed)
+int eq_pop(event_queue_t* q, event_t* out);
+
+// Return: 1 earliest timestamp written to *ts, 0 empty, -1 as for eq_pop.
+// May move the queue's floor up to that timestamp, after which earlier pushes fail.
+int eq_peek_ts(event_queue_t* q, timestamp_t* ts);
+
+// Pop the next event only if it has the same timestamp as the last pop. Never
+// moves the floor, so pushes after the current instant still succeed.
+// Return: 1 popped into *out, 0 nothing left at that timestamp
+int eq_pop_same_ts(event_queue_t* q, event_t* out);
+
+// Copy every pending event, seq included, into `out` (room for eq_size(q)
+// events), in no particular order. Return: events copied
+size_t eq_collect(const event_queue_t* q, event_t* out);
+
+static inline size_t eq_size(const event_queue_t* q) { return q->size; }
+
 #endif
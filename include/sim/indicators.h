@@ -0,0 +1,73 @@
+#ifndef INDICATORS_H
+#define INDICATORS_H
+
+#include "common/types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Streaming indicators over the fills of one book. Agents register what they
+// read at setup and get a handle back; equal requests share one indicator, so
+// each is updated once per fill however many agents read it. Windows count
+// fills, not ticks, from the indicator's registration on: one added after the
+// first fills starts from the next one. Every update is O(1), amortized for the rolling min / max.
+// The book updates them from the matching loop and agents only read, so reads
+// from parallel decision phases need no lock.
+
+typedef enum
+{
+  IND_EMA,    // exponential moving average, alpha = 2 / (window + 1)
+  IND_MEAN,   // mean of the last `window` fill prices, from an exact ring sum
+  IND_RETURN, // (last - price `window` fills earlier) / that price
+  IND_MIN,    // lowest of the last `window` fill prices, by monotonic deque
+  IND_MAX,    // highest of the last `window` fill prices, by monotonic deque
+} indicator_kind_t;
+
+typedef struct
+{
+  indicator_kind_t kind;
+  size_t window;
+  double alpha; // IND_EMA
+  double ema;
+  int64_t sum;      // IND_MEAN: sum of the ring
+  price_t* prices;  // ring (MEAN, RETURN) or deque (MIN, MAX) of `capacity`
+  uint64_t* seqs;   // MIN / MAX: fill number of each deque entry
+  size_t capacity;
+  size_t head;      // oldest entry
+  size_t count;
+  uint64_t seen;    // fills since registration
+} indicator_t;
+
+typedef struct indicators
+{
+  indicator_t* items;
+  size_t count;
+  size_t capacity;
+  uint64_t fills; // seen so far
+  price_t last;   // last fill price, 0 before the first
+} indicators_t;
+
+void indicators_init(indicators_t* ind);
+void indicators_free(indicators_t* ind);
+
+// Register an indicator, or find the one already registered with the same kind
+// and window. Return: its handle, -1 on a zero window or out of memory
+int indicators_add(indicators_t* ind, indicator_kind_t kind, size_t window);
+
+// Called by the book for every fill
+void indicators_on_trade(indicators_t* ind, price_t price);
+
+// Current value; 0 before the indicator's first fill
+double indicators_value(const indicators_t* ind, int handle);
+
+// 1 once the indicator itself has seen a full window of fills
+int indicators_ready(const indicators_t* ind, int handle);
+
+// Checkpoint hooks, with the agent save / load size protocol: save returns the
+// size it needs and writes only if it fits in `cap`. load resumes on an engine
+// with the same registrations, in the same order. Return: 0 ok, -1 mismatch
+// (nothing changed). indicators_check is load's validation alone.
+size_t indicators_save(const indicators_t* ind, void* out, size_t cap);
+int indicators_check(const indicators_t* ind, const void* in, size_t len);
+int indicators_load(indicators_t* ind, const void* in, size_t len);
+
+#endif // !INDICATORS_H
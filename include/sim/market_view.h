@@ -0,0 +1,60 @@
+#ifndef MARKET_VIEW_H
+#define MARKET_VIEW_H
+
+#include "common/config.h"
+#include "core/book.h"
+
+// Read-only snapshot of the market handed to every agent step. The simulator
+// rebuilds it only when the book's version moved, so agents sharing a tick
+// share one snapshot and never walk the price trees themselves.
+typedef struct
+{
+  uint64_t version; // book version the snapshot was taken at
+  timestamp_t ts;
+
+  price_t best_bid; // 0 if no bids
+  price_t best_ask; // 0 if no asks
+  price_t mid;      // best-effort mid: one-sided books use that side, empty uses DEFAULT_MID_PRICE
+  price_t spread;   // 0 unless both sides are present
+
+  depth_entry_t bids[BOOK_TOP_LEVELS]; // best first
+  depth_entry_t asks[BOOK_TOP_LEVELS];
+  size_t bid_levels;
+  size_t ask_levels;
+
+  price_t last_trade_price; // 0 before the first trade
+  qty_t last_trade_qty;
+
+  // (bid qty - ask qty) / (bid qty + ask qty) over the levels above, 0 if empty
+  double imbalance;
+} market_view_t;
+
+void market_view_build(market_view_t* view, const order_book_t* book, timestamp_t now);
+
+// Rebuild only if the book changed since the last build (the view must have been
+// built once). Return: 1 rebuilt, 0 reused
+int market_view_refresh(market_view_t* view, const order_book_t* book, timestamp_t now);
+
+// Recent snapshots in time order, so an agent behind a slow feed can be shown
+// the market as it was. A fixed ring: the oldest snapshot is overwritten.
+typedef struct
+{
+  market_view_t* items;
+  size_t head; // oldest
+  size_t count;
+  size_t capacity;
+} market_view_history_t;
+
+// Return: 0 ok, -1 allocation failure
+int market_view_history_init(market_view_history_t* hist, size_t capacity);
+void market_view_history_free(market_view_history_t* hist);
+
+// Append `view` (its ts must not be older than the newest entry); a snapshot
+// with the same ts as the newest replaces it.
+void market_view_history_record(market_view_history_t* hist, const market_view_t* view);
+
+// Newest snapshot taken at or before `ts`, the oldest one if all are newer,
+// NULL if empty. O(log n).
+const market_view_t* market_view_history_at(const market_view_history_t* hist, timestamp_t ts);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef NET_LATENCY_H
+#define NET_LATENCY_H
+
+#include "common/rng.h"
+#include "common/types.h"
+
+// One-way network delays, in nanoseconds, between an agent and the exchange.
+
+typedef enum
+{
+  LATENCY_NONE,       // arrives at once
+  LATENCY_FIXED,      // base
+  LATENCY_UNIFORM,    // uniform in [base, base + spread]
+  LATENCY_EXPONENTIAL // base + exponential jitter with mean `spread`
+} latency_kind_t;
+
+typedef struct
+{
+  latency_kind_t kind;
+  double base;
+  double spread;
+} latency_dist_t;
+
+// Sampled delay rounded to whole nanoseconds. O(1).
+timestamp_t latency_sample(const latency_dist_t* dist, rng_t* rng);
+
+// An agent's link to the exchange. Each direction is FIFO, as over one TCP
+// session: a message never overtakes one sent before it on the same link.
+typedef struct
+{
+  latency_dist_t to_exchange;   // orders and cancels
+  latency_dist_t from_exchange; // market data and execution reports
+  rng_t rng;
+  timestamp_t last_out; // arrival time of the last message sent
+  timestamp_t last_in;  // arrival time of the last message received
+} net_link_t;
+
+// Link with its own RNG stream, split from `seed` by the agent id
+void net_link_init(net_link_t* link, const latency_dist_t* to_exchange,
+                   const latency_dist_t* from_exchange, uint64_t seed, agent_id_t id);
+
+// Arrival time at the exchange of a message sent at `now`
+timestamp_t net_link_send(net_link_t* link, timestamp_t now);
+
+// Arrival time at the agent of a message the exchange sent at `now`
+timestamp_t net_link_receive(net_link_t* link, timestamp_t now);
+
+// Age of the market data an agent sees at `now`: one fresh draw, no FIFO clamp
+timestamp_t net_link_data_delay(net_link_t* link);
+
+#endif
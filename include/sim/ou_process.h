@@ -0,0 +1,59 @@
+#ifndef OU_PROCESS_H
+#define OU_PROCESS_H
+
+#include "common/rng.h"
+#include "common/types.h"
+#include <pthread.h>
+
+// Ornstein-Uhlenbeck process on the tick grid:
+//   x(t+1) = mean + (x(t) - mean) * e^-reversion + step_sd * Z
+// which is the exact transition of dx = reversion * (mean - x) dt + volatility dW.
+// The path depends only on the seed, never on who reads it or when, so one
+// process can be shared by many agents and threads.
+
+#define OU_BATCH 256 // normals drawn per refill, by batched Box-Muller
+
+typedef struct
+{
+  double mean;
+  double reversion;  // per tick; 0 makes it a random walk
+  double volatility; // per square-root tick
+  double decay;      // e^-reversion
+  double step_sd;    // volatility * sqrt((1 - e^(-2 reversion)) / (2 reversion))
+
+  double value; // x(t)
+  timestamp_t t;
+
+  rng_t rng;
+  rng_t batch_rng; // state the current batch was drawn from, for snapshots
+  double z[OU_BATCH];
+  size_t next; // first unused entry of z
+
+  pthread_mutex_t lock;
+} ou_process_t;
+
+// Starts at `mean` at t = 0. Return: 0 ok, -1 bad parameters
+int ou_init(ou_process_t* ou, double mean, double reversion, double volatility, uint64_t seed);
+void ou_free(ou_process_t* ou);
+
+// x(now), stepping the path forward as needed; times before the last one read
+// give the current value. Thread-safe.
+double ou_value_at(ou_process_t* ou, timestamp_t now);
+
+// Stationary standard deviation volatility / sqrt(2 reversion); 0 if reversion is 0
+double ou_stationary_sd(const ou_process_t* ou);
+
+// The path position as a flat record, for checkpoints; ou_load resumes it on
+// a process initialised with the same parameters
+typedef struct
+{
+  double value;
+  timestamp_t t;
+  rng_t batch_rng;
+  uint64_t next;
+} ou_snapshot_t;
+
+void ou_save(ou_process_t* ou, ou_snapshot_t* out);
+void ou_load(ou_process_t* ou, const ou_snapshot_t* in);
+
+#endif // !OU_PROCESS_H
@@ -0,0 +1,121 @@
+#ifndef RUNNER_H
+#define RUNNER_H
+
+#include "agents/agent_registry.h"
+#include "agents/informed_trader.h"
+#include "common/types.h"
+#include "sim/indicators.h"
+#include "sim/simulator.h"
+#include "sim/stats.h"
+#include <stddef.h>
+
+#ifdef BENCHMARK
+#include "bench/latency.h"
+#endif
+
+/* Agent id layout of runs, sweeps and the interactive binary. Each type owns
+   the ids from its first id up to the next type's first id; order ids and
+   report routing go by agent id, so a count that does not fit its block is
+   refused rather than let it take another type's ids. */
+#define RUNNER_NOISE_ID 1
+#define RUNNER_MM_ID 100
+#define RUNNER_INFORMED_ID 200
+#define RUNNER_CROWD_ID 300 /* one agent, whatever the crowd size */
+#define RUNNER_MOMENTUM_ID 400
+#define RUNNER_MEAN_REVERSION_ID 500
+#define RUNNER_AS_MM_ID 1000
+#define RUNNER_OU_INFORMED_ID 2000
+
+#define RUNNER_MAX_NOISE (RUNNER_MM_ID - RUNNER_NOISE_ID)
+#define RUNNER_MAX_MM (RUNNER_INFORMED_ID - RUNNER_MM_ID)
+#define RUNNER_MAX_INFORMED (RUNNER_CROWD_ID - RUNNER_INFORMED_ID)
+#define RUNNER_MAX_MOMENTUM (RUNNER_MEAN_REVERSION_ID - RUNNER_MOMENTUM_ID)
+#define RUNNER_MAX_MEAN_REVERSION (RUNNER_AS_MM_ID - RUNNER_MEAN_REVERSION_ID)
+#define RUNNER_MAX_AS_MM (RUNNER_OU_INFORMED_ID - RUNNER_AS_MM_ID)
+#define RUNNER_MAX_OU_INFORMED 10000 /* the last block is open ended */
+
+/* one scenario, replayed with a different seed per run */
+typedef struct
+{
+  int num_noise;
+  int num_mm;
+  int num_informed;
+  int num_as_mm;     /* Avellaneda-Stoikov market makers */
+  int num_ou_informed; /* informed traders sharing one OU fair value */
+  int num_momentum;       /* trend followers on the book's indicators */
+  int num_mean_reversion; /* mean reverters on the book's indicators */
+  size_t crowd_size; /* 0: no crowd agent */
+  price_t mm_half_spread;     /* 0: the market makers' default */
+  price_t informed_threshold; /* 0: the informed traders' default */
+  timestamp_t ticks; /* run length, in ticks of SIM_TICK_NS */
+  uint64_t seed; /* base seed; run i uses runner_run_seed(seed, i) */
+} scenario_t;
+
+/* A scenario's agents and what they share: one registry group per type, the
+   OU fair value of the OU informed traders, and the indicators the momentum
+   and mean-reversion traders read off the book. */
+typedef struct
+{
+  agent_registry_t registry;
+  informed_population_t population;
+  indicators_t indicators;
+} runner_agents_t;
+
+typedef struct
+{
+  market_stats_t stats; /* trade stats plus final mid and spread */
+  uint64_t events;
+  int failed; /* the run could not be set up: no stats, left out of every summary */
+} run_result_t;
+
+typedef struct
+{
+  size_t runs;
+  int threads;
+  double elapsed_sec;    /* wall clock for the whole batch */
+  run_result_t* results; /* indexed by run, independent of thread count */
+  size_t failed;         /* runs that could not be set up (results[i].failed) */
+  market_stats_t merged; /* mean prices, summed volume and trades of the runs that ran */
+#ifdef BENCHMARK
+  latency_tracker_t add_latency;
+  latency_tracker_t remove_latency;
+  latency_tracker_t match_latency;
+#endif
+} runner_report_t;
+
+// Cores available to this process.
+int runner_core_count(void);
+
+// Seed for run `run` of a batch; spread out so neighbouring runs share no agent streams.
+uint64_t runner_run_seed(uint64_t base, size_t run);
+
+// Pin the calling thread to the i-th core this process may run on (mod the
+// number of cores); best effort.
+void runner_pin_to_core(int i);
+
+// Return: 0 every agent count fits its id block, -1 otherwise (the reason goes to stderr)
+int runner_scenario_check(const scenario_t* scenario);
+
+// Create the scenario's agents, one group per type in the id layout above, and
+// add them to `sim`; the indicators are attached to sim's book when a type
+// reads them. Runs, sweeps and the interactive binary all build agents here.
+// Return: 0 ok, -1 no simulator or a group could not be created (the reason
+// goes to stderr). Either way runner_agents_free, after simulator_free,
+// releases what was built.
+int runner_build_agents(runner_agents_t* agents, const scenario_t* scenario, simulator_t* sim,
+                        uint64_t seed);
+void runner_agents_free(runner_agents_t* agents);
+
+// One run of `scenario` with `seed` on the calling thread.
+// Return: 0 ok, -1 the scenario fails runner_scenario_check or its book,
+// simulator or agents could not be set up (nothing is run, out->failed is set)
+int runner_run_one(const scenario_t* scenario, uint64_t seed, run_result_t* out);
+
+// Run one scenario `runs` times on `threads` workers pinned to cores.
+// Each run owns its book, simulator and agents. A run that cannot be set up is
+// counted in report->failed rather than recorded. Return: 0 ok, -1 error, a
+// scenario that fails runner_scenario_check, or no run could be set up
+int runner_run(const scenario_t* scenario, size_t runs, int threads, runner_report_t* report);
+void runner_report_free(runner_report_t* report);
+
+#endif
@@ -2,23 +2,126 @@
 #define SIMULATOR_H
 
 #include "agents/agent.h"
+#include "common/rng.h"
 #include "core/book.h"
+#include "sim/clock.h"
 #include "sim/event.h"
+#include "sim/market_view.h"
+#include "sim/net_latency.h"
+#include "sim/subscriptions.h"
+#include "sim/tick_pool.h"
+
+// Order in which the sequencer applies the decisions of one parallel tick
+typedef enum
+{
+  SEQUENCE_BY_ID,  // ascending agent id
+  SEQUENCE_SHUFFLED // a fresh seeded permutation every tick
+} sequence_order_t;
+
+// One agent woken in the current parallel tick
+typedef struct
+{
+  agent_t* agent;
+  uint64_t seq; // wakeup event seq, breaks agent id ties
+  timestamp_t next_wake;
+} tick_slot_t;
+
+// A woken agent in decision order: grouped by type, then by the view it sees
+typedef struct
+{
+  const agent_type_t* type;
+  const market_view_t* view;
+  uint32_t tick; // index into simulator_t.tick
+} tick_batch_t;
 
 typedef struct simulator_t
 {
   order_book_t* book;
-  // event_t *event_queue;
+  event_queue_t events;
   agent_t** agents;
   size_t agent_count;
   size_t agent_capacity;
-  timestamp_t current_time;
-  timestamp_t dt;
+  sim_clock_t clock;  // the run's only time source; the book stamps orders and trades from it
+  market_view_t view; // shared by every agent step, rebuilt when the book changes
+  uint64_t events_processed;
+
+  // Execution report routing: owner id -> agent slot (open addressing, slot + 1,
+  // 0 empty), then one EXEC_BATCH inbox per slot
+  agent_id_t* owner_ids;
+  uint32_t* owner_slots;
+  size_t owner_mask;
+  exec_report_t* inbox; // agent_capacity * EXEC_BATCH
+  uint32_t* inbox_len;
+  uint8_t* inbox_queued; // slot is already on `touched`
+  uint32_t* touched; // slots with pending reports, in first-report order
+  size_t touched_count;
+
+  // Two-phase ticks (NULL pool: agents step one at a time, straight into the book)
+  tick_pool_t* pool;
+  sequence_order_t sequence;
+  rng_t sequence_rng;
+  tick_slot_t* tick;        // agents woken at the current time
+  agent_outbox_t* outboxes; // tick[i] decides into outboxes[i]
+  size_t tick_count;
+  size_t tick_capacity;
+  // Phase one hands each run of one type facing one view to the type's
+  // step_all: run r covers batch[batch_runs[r], batch_runs[r + 1])
+  tick_batch_t* batch;
+  agent_t** batch_agents;
+  timestamp_t* batch_next;
+  size_t* batch_runs; // tick_capacity + 1
+
+  // Network latency (agents without a link talk to the book directly)
+  net_link_t** links;            // owned, one per linked agent
+  size_t link_count;
+  agent_outbox_t wire;           // a linked agent's actions from one sequential step
+  market_view_history_t history; // for agents behind a market-data delay
+  uint64_t history_version;      // book version of the newest snapshot
+  uint64_t messages_dropped;     // in-flight messages the event queue had no room for
+  uint64_t wakeups_dropped;      // agent wakeups it had no room for; such an agent sleeps
+                                 // until a subscription or simulator_schedule wakes it
+
+  // Agents asleep on market events (agent->interest), checked after each event
+  // that changed the book
+  subscriptions_t subs;
+  uint64_t subs_version; // book version at the last check
+  timestamp_t* wake_at;  // per slot: time of the agent's live wakeup; any other
+                         // wakeup still queued for it is stale and skipped
 } simulator_t;
 
-void simulator_init(order_book_t* book);
-void simulator_add_agent(agent_t* agent);
-void simulator_run(timestamp_t end_time);
-void simulator_free(void);
+// Each simulator is independent; several may run concurrently on separate books.
+// The book takes its time from the simulator's clock until simulator_free.
+simulator_t* simulator_init(order_book_t* book);
+// Agents with an on_exec hook get their fills and cancels after every event.
+// An agent's `interest` is read after each of its steps; see agent_interest_t.
+void simulator_add_agent(simulator_t* sim, agent_t* agent);
+// Process every event before `end_time` (nanoseconds), jumping from one to the next
+void simulator_run(simulator_t* sim, timestamp_t end_time);
+void simulator_free(simulator_t* sim);
+
+// Two-phase ticks. Every agent woken at the same time steps in parallel on
+// `threads` threads (the caller included) against the same frozen market view,
+// its orders and cancels buffered in its own outbox; a sequencer then applies
+// the outboxes to the book one agent at a time in `order`. Results depend on
+// `order` and `seed` only, never on `threads`. threads == 0 turns it off.
+// Return: 0 ok, -1 error
+int simulator_set_parallel(simulator_t* sim, int threads, sequence_order_t order, uint64_t seed);
+
+// Put `agent` (already added) behind a network link. Its orders and cancels
+// reach the book `to_exchange` ns after it sends them, and its execution
+// reports and market data are `from_exchange` ns old when it sees them.
+// Each direction is FIFO. Delays are drawn from the agent's own stream of `seed`.
+// The link belongs to the simulator and goes away with simulator_free.
+// Return: 0 ok, -1 error
+int simulator_set_latency(simulator_t* sim, agent_t* agent, const latency_dist_t* to_exchange,
+                          const latency_dist_t* from_exchange, uint64_t seed);
+
+// Schedule an event (order, cancel, wakeup) at ev->ts >= current time. An agent
+// has one live wakeup: a wakeup earlier than its pending one replaces it, a
+// later one is ignored.
+// Return: 0 ok, -1 rejected
+int simulator_schedule(simulator_t* sim, const event_t* ev);
+
+uint64_t simulator_events_processed(const simulator_t* sim);
 
 #endif
@@ -13,8 +13,21 @@ typedef struct
   size_t trade_count;
 } market_stats_t;
 
-void stats_init(void);
-void stats_on_trade(price_t price, qty_t qty);
-market_stats_t stats_snapshot(void);
+/* per-book trade statistics context */
+typedef struct
+{
+  price_t last_price;
+  qty_t last_qty;
+  qty_t total_volume;
+  size_t trade_count;
+} stats_t;
+
+void stats_init(stats_t* stats);
+void stats_on_trade(stats_t* stats, price_t price, qty_t qty);
+market_stats_t stats_snapshot(const stats_t* stats);
+
+// Fold one run into `acc`, which already holds `merged_runs` runs:
+// prices are averaged, volume and trade counts summed.
+void stats_merge(market_stats_t* acc, size_t merged_runs, const market_stats_t* run);
 
 #endif
@@ -0,0 +1,76 @@
+#ifndef SUBSCRIPTIONS_H
+#define SUBSCRIPTIONS_H
+
+#include "agents/agent.h"
+#include "core/book.h"
+
+/* Index of what each agent (by simulator slot) wants to be woken for.
+   Topics are sorted slot lists, so subscribers wake in a fixed order. Price
+   triggers sit in one heap per kind keyed by how close they are to firing, so
+   a check pops exactly the triggers that fire: O(1) when none do, O(log n) per
+   trigger fired. Re-arming leaves the old entry behind; entries whose price no
+   longer matches the agent's armed one are skipped and swept out in bulk. */
+
+typedef enum
+{
+  SUBS_ASK_AT_OR_BELOW,
+  SUBS_BID_AT_OR_ABOVE,
+  SUBS_TRADE_AT_OR_BELOW,
+  SUBS_TRADE_AT_OR_ABOVE,
+  SUBS_TRIGGER_KINDS
+} subs_trigger_kind_t;
+
+#define SUBS_TOPICS 3 // AGENT_WAKE_BBO, AGENT_WAKE_TRADE, AGENT_WAKE_DEPLETION
+
+typedef struct
+{
+  uint32_t* slots; // ascending
+  size_t count;
+  size_t capacity;
+} subs_topic_t;
+
+typedef struct
+{
+  price_t key; // the price, negated for the "at or below" kinds: smallest fires first
+  uint32_t slot;
+} subs_trigger_t;
+
+typedef struct
+{
+  subs_trigger_t* items; // min-heap on (key, slot)
+  size_t count;
+  size_t capacity;
+  size_t live; // entries still matching an armed trigger
+} subs_heap_t;
+
+typedef struct
+{
+  subs_topic_t topics[SUBS_TOPICS];
+  subs_heap_t heaps[SUBS_TRIGGER_KINDS];
+  agent_interest_t* armed; // per slot: the interest the index holds
+  size_t capacity;
+  int dirty;         // a trigger was armed since the last check
+  depth_entry_t bid; // best levels at the last check
+  depth_entry_t ask;
+} subscriptions_t;
+
+// Called with each slot to wake; a slot may come more than once per check
+typedef void (*subs_wake_fn)(void* ctx, uint32_t slot);
+
+void subs_init(subscriptions_t* subs);
+void subs_free(subscriptions_t* subs);
+
+// Room for slots [0, slots). Return: 0 ok, -1 out of memory
+int subs_reserve(subscriptions_t* subs, size_t slots);
+
+// Make the index match `interest` for `slot`. Cheap when nothing changed.
+// Return: 0 ok, -1 out of memory
+int subs_sync(subscriptions_t* subs, uint32_t slot, const agent_interest_t* interest);
+
+// Match everything since the last check (book->tape, best level changes and
+// newly armed triggers) against the index and wake subscribers. Fired
+// triggers are cleared here and in agents[slot]->interest. Clears the tape.
+void subs_check(subscriptions_t* subs, order_book_t* book, agent_t* const* agents,
+                subs_wake_fn wake, void* ctx);
+
+#endif
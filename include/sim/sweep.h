@@ -0,0 +1,97 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "sim/runner.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Parameter sweeps: a grid over scenario fields, expanded into one job per
+   grid point and run, and run on a work-stealing pool. Job lengths vary a lot
+   across a grid, so each worker starts with its own deque of jobs, longest
+   first, and takes from the far end of another worker's deque when its own is
+   empty. Each job is a whole simulation, so the deques are plain locked ranges.
+
+   Grid spec, axes separated by spaces or ';':
+     noise=10,20,40 mm=1:4 informed=0:20:5 ticks=10000,100000
+   A value list is either comma separated or an inclusive range lo:hi[:step].
+   Axes: see sweep_axis_names(). Fields not on an axis keep the base scenario's value;
+   agent counts, swept or not, must fit their id blocks (runner.h). */
+
+#define SWEEP_MAX_AXES 16
+#define SWEEP_MAX_VALUES 256
+
+typedef struct
+{
+  int field; // index into the axis name table
+  size_t count;
+  int64_t values[SWEEP_MAX_VALUES];
+} sweep_axis_t;
+
+typedef struct
+{
+  scenario_t base;
+  sweep_axis_t axes[SWEEP_MAX_AXES];
+  size_t n_axes;
+  size_t runs; // seeds per grid point; run r uses runner_run_seed(base.seed, r) at every point
+} sweep_t;
+
+// Space-separated names of the fields an axis can sweep
+const char* sweep_axis_names(void);
+
+// Return: 0 ok, -1 bad spec (the reason goes to stderr)
+int sweep_parse(sweep_t* sweep, const scenario_t* base, size_t runs, const char* spec);
+
+// Grid points times runs
+size_t sweep_job_count(const sweep_t* sweep);
+
+// The scenario and seed of job `job`; jobs run through the grid with the last
+// axis varying fastest, and the runs of one point next to each other
+void sweep_job(const sweep_t* sweep, size_t job, scenario_t* out, uint64_t* seed);
+
+/* Output: one file of fixed columns, appended as jobs finish, in row groups:
+     header   "LOBSWEEP" magic, uint32 version, uint32 column count, then per
+              column a 32-byte record: NUL-padded name[31] and a type byte,
+              'i' for int64 or 'f' for double
+     groups   uint64 rows, then each column's `rows` 8-byte values in turn
+   Rows are in completion order; the job column gives their place in the grid. */
+
+#define SWEEP_GROUP_ROWS 256
+
+typedef struct
+{
+  size_t jobs;
+  int threads;
+  double elapsed_sec;
+  uint64_t steals;       // jobs run by a worker other than the one dealt them
+  size_t failed;         // jobs that could not be set up; they get no row
+  run_result_t* results; // indexed by job, independent of thread count
+} sweep_report_t;
+
+// Run every job of `sweep` on `threads` workers, streaming rows to `path`
+// (NULL: no file). Return: 0 ok, -1 error
+int sweep_run(const sweep_t* sweep, int threads, const char* path, sweep_report_t* report);
+void sweep_report_free(sweep_report_t* report);
+
+typedef union
+{
+  int64_t i;
+  double f;
+} sweep_value_t;
+
+// A sweep file read back into memory, one array per column
+typedef struct
+{
+  size_t columns;
+  size_t rows;
+  char (*names)[32];
+  char* types;            // 'i' or 'f' per column
+  sweep_value_t** values; // values[column][row]
+} sweep_table_t;
+
+// Return: 0 ok, -1 unreadable or not a sweep file
+int sweep_table_load(sweep_table_t* table, const char* path);
+// Column index of `name`, -1 if there is none
+int sweep_table_column(const sweep_table_t* table, const char* name);
+void sweep_table_free(sweep_table_t* table);
+
+#endif // !SWEEP_H
@@ -0,0 +1,23 @@
+#ifndef TICK_POOL_H
+#define TICK_POOL_H
+
+#include <stddef.h>
+
+/* Fixed set of worker threads that run one short batch of independent tasks
+   at a time. The caller takes part in every batch and returns only when all
+   tasks are done, so results written by the tasks are visible afterwards. */
+
+typedef struct tick_pool tick_pool_t;
+
+typedef void (*tick_pool_fn)(void* ctx, size_t i);
+
+// `threads` counts the caller: 1 runs everything inline. NULL on failure.
+tick_pool_t* tick_pool_create(int threads);
+
+// Run fn(ctx, i) for every i in [0, n), in no particular order.
+void tick_pool_run(tick_pool_t* pool, size_t n, tick_pool_fn fn, void* ctx);
+
+int tick_pool_threads(const tick_pool_t* pool);
+void tick_pool_destroy(tick_pool_t* pool);
+
+#endif
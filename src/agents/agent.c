@@ -0,0 +1,148 @@
+#include "agents/agent.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Room for `extra` more actions; grows geometrically so a steady state allocates nothing
+static void outbox_reserve(agent_outbox_t* box, size_t extra)
+{
+  if (box->count + extra <= box->capacity)
+    return;
+
+  size_t cap = box->capacity ? box->capacity : 16;
+  while (cap < box->count + extra)
+    cap *= 2;
+
+  order_t** orders = realloc(box->orders, cap * sizeof *orders);
+  if (orders)
+    box->orders = orders;
+  order_id_t* cancel_ids = realloc(box->cancel_ids, cap * sizeof *cancel_ids);
+  if (cancel_ids)
+    box->cancel_ids = cancel_ids;
+  price_t* amend_prices = realloc(box->amend_prices, cap * sizeof *amend_prices);
+  if (amend_prices)
+    box->amend_prices = amend_prices;
+  qty_t* amend_qtys = realloc(box->amend_qtys, cap * sizeof *amend_qtys);
+  if (amend_qtys)
+    box->amend_qtys = amend_qtys;
+  if (!orders || !cancel_ids || !amend_prices || !amend_qtys)
+  {
+    fprintf(stderr, "Failed to grow agent outbox\n");
+    exit(EXIT_FAILURE);
+  }
+  box->capacity = cap;
+}
+
+void agent_submit(agent_t* agent, order_book_t* book, order_t* order)
+{
+  agent_outbox_t* box = agent->outbox;
+  if (!box)
+  {
+    book_add_order(book, order);
+    return;
+  }
+
+  outbox_reserve(box, 1);
+  box->orders[box->count] = order;
+  box->cancel_ids[box->count] = 0;
+  box->count++;
+}
+
+void agent_submit_batch(agent_t* agent, order_book_t* book, order_t** orders, size_t n)
+{
+  agent_outbox_t* box = agent->outbox;
+  if (!box)
+  {
+    book_add_orders(book, orders, n);
+    return;
+  }
+
+  outbox_reserve(box, n);
+  for (size_t i = 0; i < n; i++)
+  {
+    box->orders[box->count] = orders[i];
+    box->cancel_ids[box->count] = 0;
+    box->count++;
+  }
+}
+
+void agent_cancel(agent_t* agent, order_book_t* book, order_id_t id)
+{
+  agent_outbox_t* box = agent->outbox;
+  if (!box)
+  {
+    book_remove_order(book, id);
+    return;
+  }
+
+  outbox_reserve(box, 1);
+  box->orders[box->count] = NULL;
+  box->cancel_ids[box->count] = id;
+  box->amend_prices[box->count] = 0;
+  box->amend_qtys[box->count] = 0;
+  box->count++;
+}
+
+void agent_amend(agent_t* agent, order_book_t* book, order_id_t id, price_t price, qty_t qty)
+{
+  agent_outbox_t* box = agent->outbox;
+  if (!box)
+  {
+    book_amend_order(book, id, price, qty);
+    return;
+  }
+
+  outbox_reserve(box, 1);
+  box->orders[box->count] = NULL;
+  box->cancel_ids[box->count] = id;
+  box->amend_prices[box->count] = price;
+  box->amend_qtys[box->count] = qty > 0 ? qty : 0;
+  box->count++;
+}
+
+void agent_outbox_free(agent_outbox_t* box)
+{
+  if (!box)
+    return;
+
+  // Orders never applied were never handed to the book
+  for (size_t i = 0; i < box->count; i++)
+    free(box->orders[i]);
+  free(box->orders);
+  free(box->cancel_ids);
+  free(box->amend_prices);
+  free(box->amend_qtys);
+  box->orders = NULL;
+  box->cancel_ids = NULL;
+  box->amend_prices = NULL;
+  box->amend_qtys = NULL;
+  box->count = box->capacity = 0;
+}
+
+price_t agent_best_excluding(const depth_entry_t* levels, size_t n, order_book_t* book,
+                             order_id_t own_id)
+{
+  om_entry_t* own = own_id ? om_find(&book->orders, own_id) : NULL;
+  for (size_t i = 0; i < n; i++)
+  {
+    if (own && levels[i].price == own->price && levels[i].count == 1)
+      continue;
+    return levels[i].price;
+  }
+  return 0;
+}
+
+size_t agent_save_flat(const void* state, size_t size, void* out, size_t cap)
+{
+  if (out && cap >= size)
+    memcpy(out, state, size);
+  return size;
+}
+
+int agent_load_flat(void* state, size_t size, const void* in, size_t len)
+{
+  if (len != size)
+    return -1;
+  memcpy(state, in, size);
+  return 0;
+}
@@ -0,0 +1,125 @@
+#include "agents/agent_registry.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// States start on this boundary so any state struct is aligned in the array
+#define AGENT_STATE_ALIGN _Alignof(max_align_t)
+
+void agent_registry_init(agent_registry_t* reg)
+{
+  reg->groups = NULL;
+  reg->count = 0;
+  reg->capacity = 0;
+}
+
+// Zero the agent, point it at `state` and let the type fill in the rest
+static int agent_setup(agent_t* agent, void* state, const agent_type_t* type, agent_id_t id,
+                       uint64_t seed, const void* params)
+{
+  memset(agent, 0, sizeof *agent);
+  agent->id = id;
+  agent->type = type;
+  agent->state = state;
+  return type->init(agent, id, seed, params);
+}
+
+static void group_free(agent_group_t* g, size_t initialized)
+{
+  if (g->type->fini)
+  {
+    for (size_t i = 0; i < initialized; i++)
+      g->type->fini(&g->agents[i]);
+  }
+  free(g->agents);
+  free(g->states);
+}
+
+agent_t* agent_registry_add(agent_registry_t* reg, const agent_type_t* type, size_t n,
+                            agent_id_t first_id, uint64_t seed, const void* params)
+{
+  if (!reg || !type || !type->init || n == 0)
+    return NULL;
+
+  if (reg->count == reg->capacity)
+  {
+    size_t cap = reg->capacity ? reg->capacity * 2 : 4;
+    agent_group_t* groups = realloc(reg->groups, cap * sizeof *groups);
+    if (!groups)
+      return NULL;
+    reg->groups = groups;
+    reg->capacity = cap;
+  }
+
+  agent_group_t g = {.type = type, .count = n};
+  size_t size = type->state_size ? type->state_size : 1;
+  g.stride = (size + AGENT_STATE_ALIGN - 1) / AGENT_STATE_ALIGN * AGENT_STATE_ALIGN;
+  g.agents = malloc(n * sizeof *g.agents);
+  g.states = calloc(n, g.stride);
+  if (!g.agents || !g.states)
+  {
+    fprintf(stderr, "could not allocate memory for %zu %s agents.\n", n, type->name);
+    free(g.agents);
+    free(g.states);
+    return NULL;
+  }
+
+  for (size_t i = 0; i < n; i++)
+  {
+    if (agent_setup(&g.agents[i], g.states + i * g.stride, type, first_id + (agent_id_t)i, seed,
+                    params) != 0)
+    {
+      group_free(&g, i);
+      return NULL;
+    }
+  }
+
+  reg->groups[reg->count++] = g;
+  return g.agents;
+}
+
+void agent_registry_free(agent_registry_t* reg)
+{
+  if (!reg)
+    return;
+
+  for (size_t i = 0; i < reg->count; i++)
+    group_free(&reg->groups[i], reg->groups[i].count);
+  free(reg->groups);
+  agent_registry_init(reg);
+}
+
+agent_t* agent_create(const agent_type_t* type, agent_id_t id, uint64_t seed, const void* params)
+{
+  if (!type || !type->init)
+    return NULL;
+
+  agent_t* agent = malloc(sizeof *agent);
+  void* state = calloc(1, type->state_size ? type->state_size : 1);
+  if (!agent || !state)
+  {
+    fprintf(stderr, "could not allocate memory for %s agent.\n", type->name);
+    free(agent);
+    free(state);
+    return NULL;
+  }
+  if (agent_setup(agent, state, type, id, seed, params) != 0)
+  {
+    free(state);
+    free(agent);
+    return NULL;
+  }
+  return agent;
+}
+
+void agent_destroy(agent_t* agent)
+{
+  if (!agent)
+    return;
+
+  if (agent->type && agent->type->fini)
+    agent->type->fini(agent);
+  free(agent->state);
+  free(agent);
+}
@@ -0,0 +1,293 @@
+#define _GNU_SOURCE
+#include "agents/as_market_maker.h"
+#include "agents/agent_registry.h"
+#include "common/rng.h"
+#include "core/book.h"
+#include "core/order.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+// Wake at least this often to age tau and the volatility estimate; BBO moves
+// wake the agent in between
+#define AS_MM_HEARTBEAT 10
+// The variance estimate averages over roughly this many ticks
+#define AS_MM_VAR_WINDOW 256.0
+// Variance before the first observation, in ticks^2 per tick
+#define AS_MM_VAR_PRIOR 1.0
+
+#define AS_MM_LOTS (2 * AS_MM_MAX_LOTS + 1)
+
+// Shared by every agent: tau_b is the upper edge of bucket b, in ticks
+static struct
+{
+  double skew[AS_MM_LOTS][AS_MM_TAU_BUCKETS]; // q * gamma * tau_b, q = -MAX_LOTS..MAX_LOTS
+  double spread[AS_MM_TAU_BUCKETS];           // gamma * tau_b
+  double base_spread;                         // (2 / gamma) * ln(1 + gamma / k)
+} as_tables;
+static pthread_once_t as_tables_once = PTHREAD_ONCE_INIT;
+
+static void as_tables_build(void)
+{
+  for (int b = 0; b < AS_MM_TAU_BUCKETS; b++)
+  {
+    double tau = (double)AS_MM_HORIZON * (b + 1) / AS_MM_TAU_BUCKETS;
+    as_tables.spread[b] = AS_MM_GAMMA * tau;
+    for (int q = -AS_MM_MAX_LOTS; q <= AS_MM_MAX_LOTS; q++)
+      as_tables.skew[q + AS_MM_MAX_LOTS][b] = q * AS_MM_GAMMA * tau;
+  }
+  as_tables.base_spread = 2.0 / AS_MM_GAMMA * log1p(AS_MM_GAMMA / AS_MM_K);
+}
+
+typedef struct
+{
+  order_id_t next_order_id;
+  rng_t rng;
+  timestamp_t phase; // offset of this agent's horizon, so agents do not roll together
+
+  // Volatility: exponentially weighted squared mid moves per tick
+  double variance;
+  double last_mid; // 0 before the first observation
+  timestamp_t last_mid_ts;
+
+  qty_t inventory; // net position, kept current by as_on_exec
+  int64_t cash;    // sum of signed fill notional: sells add, buys subtract
+
+  order_id_t active_bid_id;
+  order_id_t active_ask_id;
+  price_t bid_price; // where the active quotes rest, as last sent
+  price_t ask_price;
+} as_market_maker_state_t;
+
+static void as_observe_mid(as_market_maker_state_t* state, double mid, timestamp_t now)
+{
+  // Each sample weighs by the time it covers, so frequent BBO wakes and
+  // sparse heartbeats estimate the same per-tick variance
+  if (state->last_mid > 0 && now > state->last_mid_ts)
+  {
+    double dt = (double)(now - state->last_mid_ts) / SIM_TICK_NS;
+    double move = mid - state->last_mid;
+    double weight = dt < AS_MM_VAR_WINDOW ? dt / AS_MM_VAR_WINDOW : 1.0;
+    state->variance += weight * (move * move / dt - state->variance);
+  }
+  state->last_mid = mid;
+  state->last_mid_ts = now;
+}
+
+static void as_quote(const as_market_maker_state_t* state, double mid, timestamp_t now,
+                     price_t* bid, price_t* ask)
+{
+  // Ticks left in the horizon, 1..HORIZON
+  timestamp_t tau = AS_MM_HORIZON - (sim_tick_of(now) + state->phase) % AS_MM_HORIZON;
+  size_t b = (size_t)((tau * AS_MM_TAU_BUCKETS - 1) / AS_MM_HORIZON);
+
+  qty_t lots = state->inventory / AS_MM_ORDER_QTY;
+  if (lots > AS_MM_MAX_LOTS)
+    lots = AS_MM_MAX_LOTS;
+  if (lots < -AS_MM_MAX_LOTS)
+    lots = -AS_MM_MAX_LOTS;
+
+  double reservation = mid - as_tables.skew[lots + AS_MM_MAX_LOTS][b] * state->variance;
+  double half = 0.5 * (as_tables.spread[b] * state->variance + as_tables.base_spread);
+  *bid = (price_t)floor(reservation - half);
+  *ask = (price_t)ceil(reservation + half);
+}
+
+// Bring one side's quote to `price`: a new order if there is none, an amend if
+// it moved, nothing if it is already there. `allowed` 0 pulls the quote.
+static void as_requote(agent_t* agent, order_book_t* book, order_id_t* id, price_t* quoted,
+                       side_t side, price_t price, int allowed, timestamp_t now)
+{
+  as_market_maker_state_t* state = agent->state;
+
+  if (!allowed)
+  {
+    if (*id != 0)
+      agent_amend(agent, book, *id, *quoted, 0);
+    *id = 0;
+    return;
+  }
+
+  if (*id != 0)
+  {
+    if (price != *quoted)
+      agent_amend(agent, book, *id, price, AS_MM_ORDER_QTY);
+    *quoted = price;
+    return;
+  }
+
+  order_t* order = malloc(sizeof(order_t));
+  if (!order)
+    return;
+  *order = (order_t){.id = state->next_order_id++,
+                     .side = side,
+                     .type = ORDER_LIMIT,
+                     .price = price,
+                     .qty = AS_MM_ORDER_QTY,
+                     .ts = now};
+
+  // The quote is live until a report says otherwise; a fully filled incoming
+  // order is freed by the book, so do not touch it afterwards
+  *id = order->id;
+  *quoted = price;
+  agent_submit(agent, book, order);
+}
+
+static timestamp_t as_step(agent_t* agent, order_book_t* book, const market_view_t* view,
+                           timestamp_t now)
+{
+  as_market_maker_state_t* state = agent->state;
+
+  // MID PRICE, without our own quotes
+  price_t best_bid =
+      agent_best_excluding(view->bids, view->bid_levels, book, state->active_bid_id);
+  price_t best_ask =
+      agent_best_excluding(view->asks, view->ask_levels, book, state->active_ask_id);
+
+  double mid;
+  if (best_bid && best_ask)
+    mid = 0.5 * (double)(best_bid + best_ask);
+  else if (best_bid || best_ask)
+    mid = (double)(best_bid ? best_bid : best_ask);
+  else
+    mid = DEFAULT_MID_PRICE;
+
+  as_observe_mid(state, mid, now);
+
+  price_t bid_price;
+  price_t ask_price;
+  as_quote(state, mid, now, &bid_price, &ask_price);
+
+  // Rest, do not take: stay behind the other side's best
+  if (best_ask && bid_price >= best_ask)
+    bid_price = best_ask - 1;
+  if (best_bid && ask_price <= best_bid)
+    ask_price = best_bid + 1;
+  if (bid_price < 1)
+    bid_price = 1;
+  if (ask_price <= bid_price)
+    ask_price = bid_price + 1;
+
+  // On a jump up the new bid may reach our old ask: move the ask first so the
+  // two quotes never trade with each other
+  qty_t limit = (qty_t)AS_MM_MAX_LOTS * AS_MM_ORDER_QTY;
+  int ask_first = state->active_ask_id != 0 && bid_price >= state->ask_price;
+  if (ask_first)
+    as_requote(agent, book, &state->active_ask_id, &state->ask_price, SIDE_SELL, ask_price,
+               state->inventory > -limit, now);
+  as_requote(agent, book, &state->active_bid_id, &state->bid_price, SIDE_BUY, bid_price,
+             state->inventory < limit, now);
+  if (!ask_first)
+    as_requote(agent, book, &state->active_ask_id, &state->ask_price, SIDE_SELL, ask_price,
+               state->inventory > -limit, now);
+
+  return now + sim_ticks_to_ns(AS_MM_HEARTBEAT);
+}
+
+static void as_on_exec(agent_t* agent, order_book_t* book, const exec_report_t* reports, size_t n)
+{
+  (void)book;
+  as_market_maker_state_t* state = agent->state;
+
+  for (size_t i = 0; i < n; i++)
+  {
+    const exec_report_t* r = &reports[i];
+    if (r->type == EXEC_FILL)
+    {
+      state->inventory += r->side * r->qty;
+      state->cash -= r->side * r->price * r->qty;
+    }
+
+    // A quote that is fully done, filled or cancelled, is no longer ours to amend
+    if (r->leaves_qty == 0)
+    {
+      if (r->order_id == state->active_bid_id)
+        state->active_bid_id = 0;
+      else if (r->order_id == state->active_ask_id)
+        state->active_ask_id = 0;
+    }
+  }
+}
+
+static size_t as_save(const agent_t* agent, void* out, size_t cap)
+{
+  return agent_save_flat(agent->state, sizeof(as_market_maker_state_t), out, cap);
+}
+
+static int as_load(agent_t* agent, const void* in, size_t len)
+{
+  return agent_load_flat(agent->state, sizeof(as_market_maker_state_t), in, len);
+}
+
+static void as_step_all(agent_t* const* agents, size_t n, order_book_t* book,
+                        const market_view_t* view, timestamp_t now, timestamp_t* next)
+{
+  for (size_t i = 0; i < n; i++)
+    next[i] = as_step(agents[i], book, view, now);
+}
+
+static int as_init(agent_t* a, agent_id_t id, uint64_t seed, const void* params)
+{
+  (void)params;
+  pthread_once(&as_tables_once, as_tables_build);
+  as_market_maker_state_t* state = a->state;
+
+  // STATE
+  state->next_order_id = order_id_first(id);
+  rng_init_stream(&state->rng, seed, id);
+  state->phase = (timestamp_t)rng_below(&state->rng, AS_MM_HORIZON);
+  state->variance = AS_MM_VAR_PRIOR;
+  state->last_mid = 0;
+  state->last_mid_ts = 0;
+  state->inventory = 0;
+  state->cash = 0;
+  state->active_bid_id = 0;
+  state->active_ask_id = 0;
+  state->bid_price = 0;
+  state->ask_price = 0;
+
+  // AGENT
+
+  a->step = as_step;
+  a->on_exec = as_on_exec;
+  a->save = as_save;
+  a->load = as_load;
+  a->interest.topics = AGENT_WAKE_BBO;
+  return 0;
+}
+
+const agent_type_t as_market_maker_type = {.name = "Avellaneda-Stoikov market maker",
+                                           .state_size = sizeof(as_market_maker_state_t),
+                                           .init = as_init,
+                                           .step_all = as_step_all};
+
+agent_t* as_market_maker_create(agent_id_t id, uint64_t seed)
+{
+  return agent_create(&as_market_maker_type, id, seed, NULL);
+}
+
+void as_market_maker_destroy(agent_t* agent) { agent_destroy(agent); }
+
+void as_market_maker_quote(const agent_t* agent, double mid, timestamp_t now, price_t* bid,
+                           price_t* ask)
+{
+  as_quote(agent->state, mid, now, bid, ask);
+}
+
+double as_market_maker_variance(const agent_t* agent)
+{
+  const as_market_maker_state_t* state = agent->state;
+  return state->variance;
+}
+
+qty_t as_market_maker_inventory(const agent_t* agent)
+{
+  const as_market_maker_state_t* state = agent->state;
+  return state->inventory;
+}
+
+int64_t as_market_maker_pnl(const agent_t* agent, price_t mark)
+{
+  const as_market_maker_state_t* state = agent->state;
+  return state->cash + state->inventory * mark;
+}
@@ -0,0 +1,241 @@
+#define _GNU_SOURCE
+#include "agents/crowd.h"
+#include "agents/agent_registry.h"
+#include "common/rng.h"
+#include "core/book.h"
+#include "core/order.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Mean per-tick act probability of one crowd member; each member draws its own
+// in [0.5, 1.5] x this, so 100k members send ~100 orders per tick.
+#define CROWD_ACT_PROBABILITY 0.001
+
+// Traders per act-mask pass; the draws and mask for one chunk stay in L1
+#define CROWD_CHUNK 4096
+
+typedef struct
+{
+  size_t n;
+
+  // Per-trader parameters (structure of arrays)
+  uint32_t* act_threshold; // acts when a 32-bit draw is below this
+  uint32_t* price_range;
+  uint32_t* min_qty;
+  uint32_t* qty_span; // max_qty - min_qty + 1
+
+  // Per-tick scratch
+  uint32_t draws[CROWD_CHUNK]; // one 32-bit draw per trader
+  uint8_t act[CROWD_CHUNK];    // act mask
+  uint32_t* actors;            // indices of traders acting this tick
+  uint64_t* bits;              // one draw per actor: side, offset and qty
+  order_t** batch;
+
+  rng_t rng;
+  order_id_t next_order_id;
+} crowd_state_t;
+
+// Append the indices (plus `base`) of set bytes in `mask`, skipping 8 idle
+// traders at a time
+static size_t crowd_collect(const uint8_t* mask, size_t n, size_t base, uint32_t* out)
+{
+  size_t k = 0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    uint64_t word;
+    memcpy(&word, mask + i, sizeof word);
+    while (word)
+    {
+      int byte = __builtin_ctzll(word) >> 3;
+      out[k++] = (uint32_t)(base + i + byte);
+      word &= ~(0xFFULL << (byte * 8));
+    }
+  }
+  for (; i < n; i++)
+  {
+    if (mask[i])
+      out[k++] = (uint32_t)(base + i);
+  }
+  return k;
+}
+
+static timestamp_t crowd_step(agent_t* agent, order_book_t* book, const market_view_t* view,
+                              timestamp_t now)
+{
+  crowd_state_t* state = (crowd_state_t*)agent->state;
+  size_t n = state->n;
+
+  // 1. Who acts: one 32-bit draw per trader against its own threshold
+  size_t k = 0;
+  for (size_t base = 0; base < n; base += CROWD_CHUNK)
+  {
+    size_t m = n - base < CROWD_CHUNK ? n - base : CROWD_CHUNK;
+    rng_fill_u32(&state->rng, state->draws, m);
+
+    const uint32_t* restrict draws = state->draws;
+    const uint32_t* restrict threshold = state->act_threshold + base;
+    uint8_t* restrict act = state->act;
+    for (size_t i = 0; i < m; i++)
+    {
+      act[i] = draws[i] < threshold[i];
+    }
+    k += crowd_collect(act, m, base, state->actors + k);
+  }
+  if (k == 0)
+    return now + SIM_TICK_NS;
+
+  // 2. One mid for the whole crowd
+  price_t mid_price = view->mid;
+
+  // 3. Side, offset and qty from one 64-bit draw per actor: top bit picks the
+  //    side, the two 31/32-bit halves are scaled by multiply-shift
+  rng_fill_u64(&state->rng, state->bits, k);
+
+  size_t submitted = 0;
+  for (size_t j = 0; j < k; j++)
+  {
+    uint32_t i = state->actors[j];
+    uint64_t b = state->bits[j];
+
+    side_t side = (b >> 63) ? SIDE_SELL : SIDE_BUY;
+    price_t offset = (price_t)((((b >> 32) & 0x7FFFFFFFULL) * (state->price_range[i] + 1ULL)) >> 31);
+    qty_t qty = state->min_qty[i] + (qty_t)(((b & 0xFFFFFFFFULL) * state->qty_span[i]) >> 32);
+
+    price_t price = (side == SIDE_BUY) ? mid_price - offset : mid_price + offset;
+    if (price < 1)
+      price = 1;
+
+    order_t* order = malloc(sizeof(order_t));
+    if (!order)
+      break;
+    order->id = state->next_order_id++;
+    order->side = side;
+    order->type = ORDER_LIMIT;
+    order->price = price;
+    order->qty = qty;
+    order->ts = now;
+    state->batch[submitted++] = order;
+  }
+
+  // 4. One batch into the book, in trader order
+  agent_submit_batch(agent, book, state->batch, submitted);
+
+  return now + SIM_TICK_NS;
+}
+
+// Checkpoint layout: n, rng, next id, then the four per-trader arrays
+static size_t crowd_save(const agent_t* agent, void* out, size_t cap)
+{
+  const crowd_state_t* state = agent->state;
+  size_t arrays = state->n * sizeof(uint32_t);
+  size_t need = sizeof(uint64_t) + sizeof(rng_t) + sizeof(order_id_t) + 4 * arrays;
+  if (!out || cap < need)
+    return need;
+
+  uint8_t* p = out;
+  uint64_t n = state->n;
+  memcpy(p, &n, sizeof n);
+  p += sizeof n;
+  memcpy(p, &state->rng, sizeof state->rng);
+  p += sizeof state->rng;
+  memcpy(p, &state->next_order_id, sizeof state->next_order_id);
+  p += sizeof state->next_order_id;
+  memcpy(p, state->act_threshold, arrays);
+  memcpy(p + arrays, state->price_range, arrays);
+  memcpy(p + 2 * arrays, state->min_qty, arrays);
+  memcpy(p + 3 * arrays, state->qty_span, arrays);
+  return need;
+}
+
+static int crowd_load(agent_t* agent, const void* in, size_t len)
+{
+  crowd_state_t* state = agent->state;
+  size_t arrays = state->n * sizeof(uint32_t);
+  if (len != sizeof(uint64_t) + sizeof(rng_t) + sizeof(order_id_t) + 4 * arrays)
+    return -1;
+
+  const uint8_t* p = in;
+  uint64_t n;
+  memcpy(&n, p, sizeof n);
+  if (n != state->n)
+    return -1; // a crowd of another size
+  p += sizeof n;
+  memcpy(&state->rng, p, sizeof state->rng);
+  p += sizeof state->rng;
+  memcpy(&state->next_order_id, p, sizeof state->next_order_id);
+  p += sizeof state->next_order_id;
+  memcpy(state->act_threshold, p, arrays);
+  memcpy(state->price_range, p + arrays, arrays);
+  memcpy(state->min_qty, p + 2 * arrays, arrays);
+  memcpy(state->qty_span, p + 3 * arrays, arrays);
+  return 0;
+}
+
+// The per-trader arrays; the state itself belongs to whoever built the agent
+static void crowd_fini(agent_t* agent)
+{
+  crowd_state_t* state = agent->state;
+  free(state->act_threshold);
+  free(state->price_range);
+  free(state->min_qty);
+  free(state->qty_span);
+  free(state->actors);
+  free(state->bits);
+  free(state->batch);
+}
+
+// `params`: const size_t*, the number of traders
+static int crowd_init(agent_t* a, agent_id_t id, uint64_t seed, const void* params)
+{
+  size_t traders = params ? *(const size_t*)params : 0;
+  if (traders == 0 || traders > UINT32_MAX)
+    return -1;
+
+  crowd_state_t* state = a->state;
+  state->n = traders;
+  state->act_threshold = malloc(traders * sizeof(uint32_t));
+  state->price_range = malloc(traders * sizeof(uint32_t));
+  state->min_qty = malloc(traders * sizeof(uint32_t));
+  state->qty_span = malloc(traders * sizeof(uint32_t));
+  state->actors = malloc(traders * sizeof(uint32_t));
+  state->bits = malloc(traders * sizeof(uint64_t));
+  state->batch = malloc(traders * sizeof(order_t*));
+  if (!state->act_threshold || !state->price_range || !state->min_qty || !state->qty_span ||
+      !state->actors || !state->bits || !state->batch)
+  {
+    fprintf(stderr, "could not allocate memory for crowd state.\n");
+    crowd_fini(a);
+    return -1;
+  }
+
+  // Heterogeneous members: activity, aggressiveness and size vary per trader
+  rng_init_stream(&state->rng, seed, id);
+  for (size_t i = 0; i < traders; i++)
+  {
+    double p = CROWD_ACT_PROBABILITY * (0.5 + rng_uniform(&state->rng));
+    state->act_threshold[i] = (uint32_t)(p * 4294967296.0);
+    state->price_range[i] = (uint32_t)rng_range(&state->rng, 5, 15);
+    state->min_qty[i] = 1;
+    state->qty_span[i] = (uint32_t)rng_range(&state->rng, 5, 15);
+  }
+  state->next_order_id = order_id_first(id);
+
+  a->step = crowd_step;
+  a->save = crowd_save;
+  a->load = crowd_load;
+  return 0;
+}
+
+const agent_type_t crowd_type = {.name = "crowd",
+                                 .state_size = sizeof(crowd_state_t),
+                                 .init = crowd_init,
+                                 .fini = crowd_fini};
+
+agent_t* crowd_create(agent_id_t id, uint64_t seed, size_t traders)
+{
+  return agent_create(&crowd_type, id, seed, &traders);
+}
+
+void crowd_destroy(agent_t* agent) { agent_destroy(agent); }
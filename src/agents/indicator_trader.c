@@ -0,0 +1,128 @@
+#define _GNU_SOURCE
+#include "agents/indicator_trader.h"
+#include "core/book.h"
+#include "core/order.h"
+#include <stdlib.h>
+
+void indicator_trader_take(agent_t* agent, indicator_trader_t* trader, order_book_t* book,
+                           const market_view_t* view, side_t side, qty_t qty, timestamp_t now)
+{
+  indicator_trader_record_t* rec = &trader->rec;
+  if (rec->open_id != 0)
+  {
+    agent_cancel(agent, book, rec->open_id);
+    rec->open_id = 0;
+  }
+
+  price_t price = (side == SIDE_BUY) ? view->best_ask : view->best_bid;
+  qty_t exposure = rec->position + side * qty;
+  qty_t max = trader->spec->max_position;
+  if (price == 0 || exposure > max || exposure < -max)
+    return;
+
+  order_t* order = malloc(sizeof(order_t));
+  if (!order)
+    return;
+  *order = (order_t){.id = rec->next_order_id++,
+                     .side = side,
+                     .type = ORDER_LIMIT,
+                     .price = price,
+                     .qty = qty,
+                     .ts = now};
+  rec->open_id = order->id;
+  agent_submit(agent, book, order);
+}
+
+static timestamp_t indicator_trader_step(agent_t* agent, order_book_t* book,
+                                         const market_view_t* view, timestamp_t now)
+{
+  indicator_trader_t* trader = agent->state;
+  indicator_trader_record_t* rec = &trader->rec;
+
+  // ARRIVALS
+  if (rec->next_wake == AGENT_NO_WAKEUP || now < rec->next_wake)
+  {
+    if (rec->next_wake == AGENT_NO_WAKEUP)
+      rec->next_wake = arrival_next_wake(&rec->arrival, now, &rec->rng);
+    return rec->next_wake;
+  }
+  rec->next_wake = arrival_next_wake(&rec->arrival, now, &rec->rng);
+
+  // SIGNAL, once every indicator read has a full window behind it
+  for (size_t i = 0; i < trader->spec->n_reads; i++)
+  {
+    if (!indicators_ready(trader->ind, trader->handles[i]))
+      return rec->next_wake;
+  }
+  trader->spec->signal(agent, trader, book, view, now);
+  return rec->next_wake;
+}
+
+static void indicator_trader_on_exec(agent_t* agent, order_book_t* book,
+                                     const exec_report_t* reports, size_t n)
+{
+  (void)book;
+  indicator_trader_record_t* rec = &((indicator_trader_t*)agent->state)->rec;
+  for (size_t i = 0; i < n; i++)
+  {
+    const exec_report_t* r = &reports[i];
+    if (r->type == EXEC_FILL)
+      rec->position += r->side * r->qty;
+    if (r->order_id == rec->open_id && r->leaves_qty == 0)
+      rec->open_id = 0;
+  }
+}
+
+static size_t indicator_trader_save(const agent_t* agent, void* out, size_t cap)
+{
+  const indicator_trader_t* trader = agent->state;
+  return agent_save_flat(&trader->rec, sizeof trader->rec, out, cap);
+}
+
+static int indicator_trader_load(agent_t* agent, const void* in, size_t len)
+{
+  indicator_trader_t* trader = agent->state;
+  return agent_load_flat(&trader->rec, sizeof trader->rec, in, len);
+}
+
+void indicator_trader_step_all(agent_t* const* agents, size_t n, order_book_t* book,
+                               const market_view_t* view, timestamp_t now, timestamp_t* next)
+{
+  for (size_t i = 0; i < n; i++)
+    next[i] = indicator_trader_step(agents[i], book, view, now);
+}
+
+int indicator_trader_init(agent_t* agent, agent_id_t id, uint64_t seed, const void* params,
+                          const indicator_trader_spec_t* spec)
+{
+  if (!params || spec->n_reads > INDICATOR_TRADER_MAX_READS)
+    return -1;
+  indicator_trader_t* trader = agent->state;
+  indicators_t* ind = (indicators_t*)params;
+  trader->spec = spec;
+  trader->ind = ind;
+  for (size_t i = 0; i < spec->n_reads; i++)
+  {
+    trader->handles[i] = indicators_add(ind, spec->reads[i].kind, spec->reads[i].window);
+    if (trader->handles[i] < 0)
+      return -1;
+  }
+
+  indicator_trader_record_t* rec = &trader->rec;
+  rec->next_order_id = order_id_first(id);
+  rng_init_stream(&rec->rng, seed, id);
+  arrival_init_poisson(&rec->arrival, 0.02);
+  rec->next_wake = AGENT_NO_WAKEUP;
+
+  agent->step = indicator_trader_step;
+  agent->on_exec = indicator_trader_on_exec;
+  agent->save = indicator_trader_save;
+  agent->load = indicator_trader_load;
+  return 0;
+}
+
+qty_t indicator_trader_position(const agent_t* agent)
+{
+  const indicator_trader_t* trader = agent->state;
+  return trader->rec.position;
+}
@@ -1,15 +1,19 @@
 #define _GNU_SOURCE
 #include "agents/informed_trader.h"
+#include "agents/agent_registry.h"
 #include "core/book.h"
 #include "core/order.h"
-#include "core/price_tree.h"
+#include "sim/arrival.h"
+#include <math.h>
 #include <stdlib.h>
-#include <time.h>
+
+// Sleeps longer than this catch the fair value up with a normal approximation
+#define INFORMED_EXACT_DRIFT_TICKS 32
 
 typedef struct
 {
   order_id_t next_order_id;
-  unsigned int rng_seed;
+  rng_t rng;
 
   price_t fair_value;
   price_t threshold;
@@ -17,43 +21,82 @@ typedef struct
 
   price_t drift_rate;
   timestamp_t last_update_time;
+
+  arrival_t arrival;     // self-exciting (Hawkes) trading arrivals
+  timestamp_t next_wake; // AGENT_NO_WAKEUP until the first arrival is sampled
 } informed_trader_state_t;
 
-static void informed_step(agent_t* agent, order_book_t* book, timestamp_t now)
+// Apply the per-tick +-1 drift for every tick slept since the last wakeup
+static void informed_drift(informed_trader_state_t* state, timestamp_t now)
 {
-  informed_trader_state_t* state = agent->state;
+  timestamp_t ticks = sim_tick_of(now) - sim_tick_of(state->last_update_time);
+  state->last_update_time = now;
 
-  // DRIFT VALUE TO SIMULATE CHANGING INFO
+  if (ticks <= INFORMED_EXACT_DRIFT_TICKS)
+  {
+    for (timestamp_t i = 0; i < ticks; i++)
+    {
+      price_t drift = (price_t)rng_below(&state->rng, 3) - 1;
+      state->fair_value += drift * state->drift_rate;
+      if (state->fair_value < 100)
+        state->fair_value = 100;
+    }
+    return;
+  }
 
-  price_t drift = (rand_r(&state->rng_seed) % 3) - 1;
-  state->fair_value += drift * state->drift_rate;
+  // Sum of `ticks` uniform {-1, 0, 1} steps ~ N(0, 2 * ticks / 3)
+  double z = rng_normal(&state->rng);
+  state->fair_value += (price_t)llround(z * sqrt(2.0 * (double)ticks / 3.0)) * state->drift_rate;
 
   // FAIR VALUE STAYS POSITIVE
-
   if (state->fair_value < 100)
   {
     state->fair_value = 100;
   }
+}
+
+// Sleep on the prices that would make a trade worth it instead of polling:
+// the simulator wakes us once the ask drops or the bid rises past them. One
+// trade per view of the news: after trading we wait for the next arrival.
+static void informed_arm(agent_t* agent, const informed_trader_state_t* state, int armed)
+{
+  agent->interest.ask_at_or_below = armed ? state->fair_value - state->threshold - 1 : 0;
+  agent->interest.bid_at_or_above = armed ? state->fair_value + state->threshold + 1 : 0;
+}
 
-  // TRADE PROBABILITY
-  if ((rand_r(&state->rng_seed) % 100) >= 1)
+// ARRIVALS: news moves the fair value at sampled arrivals; in between, only
+// a price trigger wakes us. Return: 1 on the first step, which only schedules
+static int informed_arrival(agent_t* agent, informed_trader_state_t* state, timestamp_t now)
+{
+  if (state->next_wake == AGENT_NO_WAKEUP)
+  {
+    state->next_wake = arrival_next_wake(&state->arrival, now, &state->rng);
+    informed_arm(agent, state, 1);
+    return 1;
+  }
+  if (now >= state->next_wake)
   {
-    return; // Skip this tick 95% of the time
+    state->next_wake = arrival_next_wake(&state->arrival, now, &state->rng);
   }
+  return 0;
+}
+
+// Take a mispriced quote against the current fair value
+static timestamp_t informed_trade(agent_t* agent, informed_trader_state_t* state,
+                                  order_book_t* book, const market_view_t* view, timestamp_t now)
+{
+  informed_arm(agent, state, 1);
 
   // BEST BID AND ASK
 
-  price_level_t* bid_level = pt_max(&book->bids);
-  price_level_t* ask_level = pt_min(&book->asks);
+  price_t best_bid = view->best_bid;
+  price_t best_ask = view->best_ask;
 
-  if (!bid_level && !ask_level)
+  if (!best_bid && !best_ask)
   {
-    return;
+    return state->next_wake;
   }
 
-  price_t best_bid = bid_level ? bid_level->price : 0;
-  price_t best_ask = ask_level ? ask_level->price : 0;
-
   // CHECK BUY OPPORTUNITY
 
   if (best_ask > 0 && best_ask < (state->fair_value - state->threshold))
@@ -65,8 +108,9 @@ static void informed_step(agent_t* agent, order_book_t* book, timestamp_t now)
     order->price = best_ask;
     order->qty = state->order_qty;
     order->ts = now;
-    book_add_order(book, order);
-    return;
+    agent_submit(agent, book, order);
+    informed_arm(agent, state, 0);
+    return state->next_wake;
   }
 
   // CHECK SELL OPPORTuNITY
@@ -80,42 +124,179 @@ static void informed_step(agent_t* agent, order_book_t* book, timestamp_t now)
     order->price = best_bid;
     order->qty = state->order_qty;
     order->ts = now;
-    book_add_order(book, order);
+    agent_submit(agent, book, order);
+    informed_arm(agent, state, 0);
   }
+
+  return state->next_wake;
 }
 
-agent_t* informed_trader_create(agent_id_t id)
+static timestamp_t informed_step(agent_t* agent, order_book_t* book, const market_view_t* view,
+                                 timestamp_t now)
 {
-  agent_t* a = malloc(sizeof(agent_t));
-  if (!a)
-    return NULL;
+  informed_trader_state_t* state = agent->state;
+  if (informed_arrival(agent, state, now))
+    return state->next_wake;
 
-  informed_trader_state_t* state = malloc(sizeof(informed_trader_state_t));
-  if (!state)
-  {
-    free(a);
-    return NULL;
-  }
+  // DRIFT VALUE TO SIMULATE CHANGING INFO
+  informed_drift(state, now);
+  return informed_trade(agent, state, book, view, now);
+}
+
+static size_t informed_save(const agent_t* agent, void* out, size_t cap)
+{
+  return agent_save_flat(agent->state, sizeof(informed_trader_state_t), out, cap);
+}
 
-  state->next_order_id = 1;
-  state->rng_seed = (unsigned int)time(NULL) + id;
-  state->fair_value = 1000;
-  state->threshold = 10;
+static int informed_load(agent_t* agent, const void* in, size_t len)
+{
+  return agent_load_flat(agent->state, sizeof(informed_trader_state_t), in, len);
+}
+
+static void informed_step_all(agent_t* const* agents, size_t n, order_book_t* book,
+                              const market_view_t* view, timestamp_t now, timestamp_t* next)
+{
+  for (size_t i = 0; i < n; i++)
+    next[i] = informed_step(agents[i], book, view, now);
+}
+
+static void informed_state_init(informed_trader_state_t* state, agent_id_t id, uint64_t seed)
+{
+  state->next_order_id = order_id_first(id);
+  rng_init_stream(&state->rng, seed, id);
+  state->fair_value = DEFAULT_MID_PRICE;
+  state->threshold = INFORMED_DEFAULT_THRESHOLD;
   state->order_qty = 10;
   state->drift_rate = 1;
   state->last_update_time = 0;
 
-  a->id = id;
+  // Mean rate mu / (1 - alpha / beta) = 1% of ticks, clustered
+  arrival_init_hawkes(&state->arrival, 0.005, 0.05, 0.1);
+  state->next_wake = AGENT_NO_WAKEUP;
+}
+
+static int informed_init(agent_t* a, agent_id_t id, uint64_t seed, const void* params)
+{
+  const informed_params_t* p = params;
+  if (p && p->threshold < 0)
+    return -1;
+  informed_state_init(a->state, id, seed);
+  if (p)
+    ((informed_trader_state_t*)a->state)->threshold = p->threshold;
   a->step = informed_step;
-  a->state = state;
-  return a;
+  a->save = informed_save;
+  a->load = informed_load;
+  return 0;
+}
+
+const agent_type_t informed_trader_type = {.name = "informed trader",
+                                           .state_size = sizeof(informed_trader_state_t),
+                                           .init = informed_init,
+                                           .step_all = informed_step_all};
+
+agent_t* informed_trader_create(agent_id_t id, uint64_t seed)
+{
+  return agent_create(&informed_trader_type, id, seed, NULL);
 }
 
-void informed_trader_destroy(agent_t* agent)
+void informed_trader_destroy(agent_t* agent) { agent_destroy(agent); }
+
+/* ---- OU fair value ---- */
+
+typedef struct
 {
-  if (!agent)
+  informed_trader_state_t base; // fair_value holds the latest private estimate
+  informed_population_t* pop;
+} ou_informed_state_t;
+
+// Checkpoint record: the trader plus the shared path, which every trader of the
+// population saves and restores alike
+typedef struct
+{
+  informed_trader_state_t base;
+  ou_snapshot_t latent;
+} ou_informed_record_t;
+
+int informed_population_init(informed_population_t* pop, double mean, double reversion,
+                             double volatility, double noise, uint64_t seed)
+{
+  if (noise < 0)
+    return -1;
+  pop->noise = noise;
+  return ou_init(&pop->latent, mean, reversion, volatility, seed);
+}
+
+void informed_population_free(informed_population_t* pop)
+{
+  if (!pop)
     return;
-  if (agent->state)
-    free(agent->state);
-  free(agent);
+
+  ou_free(&pop->latent);
+}
+
+static timestamp_t ou_informed_step(agent_t* agent, order_book_t* book,
+                                    const market_view_t* view, timestamp_t now)
+{
+  ou_informed_state_t* ou_state = agent->state;
+  informed_trader_state_t* state = &ou_state->base;
+  if (informed_arrival(agent, state, now))
+    return state->next_wake;
+
+  // PRIVATE READING OF THE SHARED FAIR VALUE
+  double latent = ou_value_at(&ou_state->pop->latent, sim_tick_of(now));
+  state->fair_value = (price_t)llround(latent + ou_state->pop->noise * rng_normal_zig(&state->rng));
+  if (state->fair_value < 1)
+    state->fair_value = 1;
+  return informed_trade(agent, state, book, view, now);
+}
+
+static void ou_informed_step_all(agent_t* const* agents, size_t n, order_book_t* book,
+                                 const market_view_t* view, timestamp_t now, timestamp_t* next)
+{
+  for (size_t i = 0; i < n; i++)
+    next[i] = ou_informed_step(agents[i], book, view, now);
+}
+
+static size_t ou_informed_save(const agent_t* agent, void* out, size_t cap)
+{
+  const ou_informed_state_t* ou_state = agent->state;
+  ou_informed_record_t rec = {.base = ou_state->base};
+  ou_save(&ou_state->pop->latent, &rec.latent);
+  return agent_save_flat(&rec, sizeof rec, out, cap);
+}
+
+static int ou_informed_load(agent_t* agent, const void* in, size_t len)
+{
+  ou_informed_state_t* ou_state = agent->state;
+  ou_informed_record_t rec;
+  if (agent_load_flat(&rec, sizeof rec, in, len) != 0)
+    return -1;
+  ou_state->base = rec.base;
+  ou_load(&ou_state->pop->latent, &rec.latent);
+  return 0;
+}
+
+static int ou_informed_init(agent_t* a, agent_id_t id, uint64_t seed, const void* params)
+{
+  if (!params)
+    return -1;
+  ou_informed_state_t* ou_state = a->state;
+  informed_state_init(&ou_state->base, id, seed);
+  ou_state->pop = (informed_population_t*)params;
+  ou_state->base.fair_value = (price_t)llround(ou_state->pop->latent.mean);
+
+  a->step = ou_informed_step;
+  a->save = ou_informed_save;
+  a->load = ou_informed_load;
+  return 0;
+}
+
+const agent_type_t ou_informed_trader_type = {.name = "OU informed trader",
+                                              .state_size = sizeof(ou_informed_state_t),
+                                              .init = ou_informed_init,
+                                              .step_all = ou_informed_step_all};
+
+agent_t* ou_informed_trader_create(agent_id_t id, uint64_t seed, informed_population_t* pop)
+{
+  return agent_create(&ou_informed_trader_type, id, seed, pop);
 }
@@ -1,62 +1,65 @@
 #define _GNU_SOURCE
 #include "agents/market_maker.h"
+#include "agents/agent_registry.h"
+#include "common/rng.h"
 #include "core/book.h"
 #include "core/order.h"
-#include "core/price_tree.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 
 typedef struct
 {
   order_id_t next_order_id;
-  unsigned int rng_seed;
+  rng_t rng;
   price_t half_spread;
   qty_t order_qty;
-  qty_t inventory;
+  qty_t inventory; // net position, kept current by mm_on_exec
+  int64_t cash;    // sum of signed fill notional: sells add, buys subtract
   qty_t max_inventory;
   order_id_t active_bid_id;
   order_id_t active_ask_id;
 } market_maker_state_t;
 
-static void mm_step(agent_t* agent, order_book_t* book, timestamp_t now)
+static timestamp_t mm_step(agent_t* agent, order_book_t* book, const market_view_t* view,
+                           timestamp_t now)
 {
   market_maker_state_t* state = agent->state;
 
+  // MID PRICE, from the view but without our own quotes, which are cancelled below
+  price_t best_bid =
+      agent_best_excluding(view->bids, view->bid_levels, book, state->active_bid_id);
+  price_t best_ask =
+      agent_best_excluding(view->asks, view->ask_levels, book, state->active_ask_id);
+
   if (state->active_bid_id != 0)
   {
-    book_remove_order(book, state->active_bid_id);
+    agent_cancel(agent, book, state->active_bid_id);
     state->active_bid_id = 0;
   }
 
   if (state->active_ask_id != 0)
   {
-    book_remove_order(book, state->active_ask_id);
+    agent_cancel(agent, book, state->active_ask_id);
     state->active_ask_id = 0;
   }
 
-  // MID PRICE
-
-  price_level_t* bid_level = pt_max(&book->bids);
-  price_level_t* ask_level = pt_min(&book->asks);
-
   price_t mid_price;
 
-  if (bid_level && ask_level)
+  if (best_bid && best_ask)
   {
-    mid_price = (bid_level->price + ask_level->price) / 2;
+    mid_price = (best_bid + best_ask) / 2;
   }
-  else if (bid_level)
+  else if (best_bid)
   {
-    mid_price = bid_level->price;
+    mid_price = best_bid;
   }
-  else if (ask_level)
+  else if (best_ask)
   {
-    mid_price = ask_level->price;
+    mid_price = best_ask;
   }
   else
   {
-    mid_price = 1000; // DEF
+    mid_price = DEFAULT_MID_PRICE;
   }
 
   // PRICES
@@ -95,8 +98,10 @@ static void mm_step(agent_t* agent, order_book_t* book, timestamp_t now)
       bid->qty = state->order_qty;
       bid->ts = now;
 
-      book_add_order(book, bid);
+      // The quote is live until a report says otherwise; a fully filled
+      // incoming order is freed by the book, so do not touch it afterwards
       state->active_bid_id = bid->id;
+      agent_submit(agent, book, bid);
     }
   }
 
@@ -113,54 +118,105 @@ static void mm_step(agent_t* agent, order_book_t* book, timestamp_t now)
       ask->qty = state->order_qty;
       ask->ts = now;
 
-      book_add_order(book, ask);
+      // The quote is live until a report says otherwise; a fully filled
+      // incoming order is freed by the book, so do not touch it afterwards
       state->active_ask_id = ask->id;
+      agent_submit(agent, book, ask);
     }
   }
+
+  return now + SIM_TICK_NS;
 }
 
-agent_t* market_maker_create(agent_id_t id)
+static void mm_on_exec(agent_t* agent, order_book_t* book, const exec_report_t* reports, size_t n)
 {
-  agent_t* a = malloc(sizeof(agent_t));
-  if (!a)
-    return NULL;
-  market_maker_state_t* state = malloc(sizeof(market_maker_state_t));
-  if (!state)
+  (void)book;
+  market_maker_state_t* state = agent->state;
+
+  for (size_t i = 0; i < n; i++)
   {
-    free(a);
-    return NULL;
+    const exec_report_t* r = &reports[i];
+    if (r->type == EXEC_FILL)
+    {
+      state->inventory += r->side * r->qty;
+      state->cash -= r->side * r->price * r->qty;
+    }
+
+    // A quote that is fully done, filled or cancelled, is no longer ours to cancel
+    if (r->leaves_qty == 0)
+    {
+      if (r->order_id == state->active_bid_id)
+        state->active_bid_id = 0;
+      else if (r->order_id == state->active_ask_id)
+        state->active_ask_id = 0;
+    }
   }
+}
+
+static size_t mm_save(const agent_t* agent, void* out, size_t cap)
+{
+  return agent_save_flat(agent->state, sizeof(market_maker_state_t), out, cap);
+}
+
+static int mm_load(agent_t* agent, const void* in, size_t len)
+{
+  return agent_load_flat(agent->state, sizeof(market_maker_state_t), in, len);
+}
+
+static void mm_step_all(agent_t* const* agents, size_t n, order_book_t* book,
+                        const market_view_t* view, timestamp_t now, timestamp_t* next)
+{
+  for (size_t i = 0; i < n; i++)
+    next[i] = mm_step(agents[i], book, view, now);
+}
+
+static int mm_init(agent_t* a, agent_id_t id, uint64_t seed, const void* params)
+{
+  const market_maker_params_t* p = params;
+  if (p && p->half_spread < 1)
+    return -1;
+  market_maker_state_t* state = a->state;
 
   // STATE
-  state->next_order_id = 1;
-  state->rng_seed = time(NULL) + id;
-  state->half_spread = 5;
+  state->next_order_id = order_id_first(id);
+  rng_init_stream(&state->rng, seed, id);
+  state->half_spread = p ? p->half_spread : MM_DEFAULT_HALF_SPREAD;
   state->order_qty = 10;
   state->inventory = 0;
+  state->cash = 0;
   state->max_inventory = 100;
   state->active_ask_id = 0;
   state->active_bid_id = 0;
 
   // AGENT
 
-  a->id = id;
   a->step = mm_step;
-  a->state = state;
+  a->on_exec = mm_on_exec;
+  a->save = mm_save;
+  a->load = mm_load;
+  return 0;
+}
+
+const agent_type_t market_maker_type = {.name = "market maker",
+                                        .state_size = sizeof(market_maker_state_t),
+                                        .init = mm_init,
+                                        .step_all = mm_step_all};
 
-  return a;
+agent_t* market_maker_create(agent_id_t id, uint64_t seed)
+{
+  return agent_create(&market_maker_type, id, seed, NULL);
 }
 
-void market_maker_destroy(agent_t* agent)
+qty_t market_maker_inventory(const agent_t* agent)
 {
-  if (!agent)
-  {
-    return;
-  }
+  const market_maker_state_t* state = agent->state;
+  return state->inventory;
+}
 
-  if (agent->state)
-  {
-    free(agent->state);
-  }
+int64_t market_maker_pnl(const agent_t* agent, price_t mark)
+{
+  const market_maker_state_t* state = agent->state;
+  return state->cash + state->inventory * mark;
+}
 
-  free(agent);
-}
\ No newline at end of file
+void market_maker_destroy(agent_t* agent) { agent_destroy(agent); }
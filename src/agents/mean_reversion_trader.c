@@ -0,0 +1,68 @@
+#include "agents/mean_reversion_trader.h"
+#include "agents/agent_registry.h"
+#include "agents/indicator_trader.h"
+
+enum
+{
+  MEAN, // handles, in the order of the reads below
+  LOW,
+  HIGH
+};
+
+static void mean_rev_signal(agent_t* agent, indicator_trader_t* trader, order_book_t* book,
+                            const market_view_t* view, timestamp_t now)
+{
+  const indicators_t* ind = trader->ind;
+  double last = (double)ind->last;
+  double mean = indicators_value(ind, trader->handles[MEAN]);
+  double low = indicators_value(ind, trader->handles[LOW]);
+  double high = indicators_value(ind, trader->handles[HIGH]);
+  if (high - low < MEAN_REV_MIN_RANGE)
+    return;
+
+  // EXIT: back through the mean, close up to one order's worth
+  qty_t position = trader->rec.position;
+  qty_t close = position < 0 ? -position : position;
+  if (close > MEAN_REV_ORDER_QTY)
+    close = MEAN_REV_ORDER_QTY;
+  if (position > 0 && last >= mean)
+    indicator_trader_take(agent, trader, book, view, SIDE_SELL, close, now);
+  else if (position < 0 && last <= mean)
+    indicator_trader_take(agent, trader, book, view, SIDE_BUY, close, now);
+
+  // ENTRY: fade a price stretched towards the window's extreme
+  else if (last <= mean - MEAN_REV_ENTRY * (mean - low))
+    indicator_trader_take(agent, trader, book, view, SIDE_BUY, MEAN_REV_ORDER_QTY, now);
+  else if (last >= mean + MEAN_REV_ENTRY * (high - mean))
+    indicator_trader_take(agent, trader, book, view, SIDE_SELL, MEAN_REV_ORDER_QTY, now);
+}
+
+static const indicator_trader_spec_t mean_rev_spec = {
+    .reads = {[MEAN] = {IND_MEAN, MEAN_REV_WINDOW},
+              [LOW] = {IND_MIN, MEAN_REV_WINDOW},
+              [HIGH] = {IND_MAX, MEAN_REV_WINDOW}},
+    .n_reads = 3,
+    .max_position = MEAN_REV_MAX_POSITION,
+    .signal = mean_rev_signal};
+
+static int mean_rev_init(agent_t* a, agent_id_t id, uint64_t seed, const void* params)
+{
+  return indicator_trader_init(a, id, seed, params, &mean_rev_spec);
+}
+
+const agent_type_t mean_reversion_trader_type = {.name = "mean reversion trader",
+                                                 .state_size = sizeof(indicator_trader_t),
+                                                 .init = mean_rev_init,
+                                                 .step_all = indicator_trader_step_all};
+
+agent_t* mean_reversion_trader_create(agent_id_t id, uint64_t seed, indicators_t* ind)
+{
+  return agent_create(&mean_reversion_trader_type, id, seed, ind);
+}
+
+void mean_reversion_trader_destroy(agent_t* agent) { agent_destroy(agent); }
+
+qty_t mean_reversion_trader_position(const agent_t* agent)
+{
+  return indicator_trader_position(agent);
+}
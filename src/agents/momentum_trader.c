@@ -0,0 +1,52 @@
+#include "agents/momentum_trader.h"
+#include "agents/agent_registry.h"
+#include "agents/indicator_trader.h"
+
+enum
+{
+  FAST, // handles, in the order of the reads below
+  SLOW,
+  RET
+};
+
+// The EMAs and the return must agree on the trend
+static void momentum_signal(agent_t* agent, indicator_trader_t* trader, order_book_t* book,
+                            const market_view_t* view, timestamp_t now)
+{
+  const indicators_t* ind = trader->ind;
+  double gap =
+      indicators_value(ind, trader->handles[FAST]) - indicators_value(ind, trader->handles[SLOW]);
+  double ret = indicators_value(ind, trader->handles[RET]);
+
+  if (gap > MOMENTUM_BAND && ret > 0)
+    indicator_trader_take(agent, trader, book, view, SIDE_BUY, MOMENTUM_ORDER_QTY, now);
+  else if (gap < -MOMENTUM_BAND && ret < 0)
+    indicator_trader_take(agent, trader, book, view, SIDE_SELL, MOMENTUM_ORDER_QTY, now);
+}
+
+static const indicator_trader_spec_t momentum_spec = {
+    .reads = {[FAST] = {IND_EMA, MOMENTUM_FAST_SPAN},
+              [SLOW] = {IND_EMA, MOMENTUM_SLOW_SPAN},
+              [RET] = {IND_RETURN, MOMENTUM_RETURN_WINDOW}},
+    .n_reads = 3,
+    .max_position = MOMENTUM_MAX_POSITION,
+    .signal = momentum_signal};
+
+static int momentum_init(agent_t* a, agent_id_t id, uint64_t seed, const void* params)
+{
+  return indicator_trader_init(a, id, seed, params, &momentum_spec);
+}
+
+const agent_type_t momentum_trader_type = {.name = "momentum trader",
+                                           .state_size = sizeof(indicator_trader_t),
+                                           .init = momentum_init,
+                                           .step_all = indicator_trader_step_all};
+
+agent_t* momentum_trader_create(agent_id_t id, uint64_t seed, indicators_t* ind)
+{
+  return agent_create(&momentum_trader_type, id, seed, ind);
+}
+
+void momentum_trader_destroy(agent_t* agent) { agent_destroy(agent); }
+
+qty_t momentum_trader_position(const agent_t* agent) { return indicator_trader_position(agent); }
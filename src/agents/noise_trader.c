@@ -1,8 +1,9 @@
 #define _GNU_SOURCE
 #include "agents/noise_trader.h"
+#include "agents/agent_registry.h"
 #include "core/book.h"
 #include "core/order.h"
-#include "core/price_tree.h"
+#include "sim/arrival.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -14,46 +15,34 @@ typedef struct
   price_t price_range;
   qty_t min_qty;
   qty_t max_qty;
-  unsigned int rng_seed;
+  rng_t rng;
+  arrival_t arrival;     // Poisson arrivals matching act_probability per tick
+  timestamp_t next_wake; // AGENT_NO_WAKEUP until the first arrival is sampled
 } noise_trader_state_t;
 
-static void noise_step(agent_t* agent, order_book_t* book, timestamp_t now)
+static timestamp_t noise_step(agent_t* agent, order_book_t* book, const market_view_t* view,
+                              timestamp_t now)
 {
   noise_trader_state_t* state = (noise_trader_state_t*)agent->state;
 
-  double roll = (double)rand_r(&state->rng_seed) / (double)RAND_MAX;
-  if (roll >= state->act_probability)
+  // ARRIVALS: sleep until the next sampled arrival instead of rolling every tick
+  if (state->next_wake == AGENT_NO_WAKEUP || now < state->next_wake)
   {
-    return;
+    if (state->next_wake == AGENT_NO_WAKEUP)
+    {
+      state->next_wake = arrival_next_wake(&state->arrival, now, &state->rng);
+    }
+    return state->next_wake;
   }
+  state->next_wake = arrival_next_wake(&state->arrival, now, &state->rng);
 
-  side_t side = (rand_r(&state->rng_seed) % 2 == 0) ? SIDE_BUY : SIDE_SELL;
+  side_t side = (rng_next(&state->rng) >> 63) ? SIDE_SELL : SIDE_BUY;
 
   // MID PRICE
-  price_level_t* bid_level = pt_max(&book->bids);
-  price_level_t* ask_level = pt_min(&book->asks);
-
-  price_t mid_price = 0;
-
-  if (bid_level && ask_level)
-  {
-    mid_price = (bid_level->price + ask_level->price) / 2;
-  }
-  else if (bid_level)
-  {
-    mid_price = bid_level->price;
-  }
-  else if (ask_level)
-  {
-    mid_price = ask_level->price;
-  }
-  else
-  {
-    mid_price = 1000;
-  }
+  price_t mid_price = view->mid;
 
   // PRICE WITH OFFSET
-  unsigned int offset = rand_r(&state->rng_seed) % (state->price_range + 1);
+  price_t offset = (price_t)rng_below(&state->rng, (uint64_t)state->price_range + 1);
 
   price_t price = 0;
 
@@ -71,13 +60,12 @@ static void noise_step(agent_t* agent, order_book_t* book, timestamp_t now)
     price = 1;
   }
 
-  qty_t qty_range = state->max_qty - state->min_qty + 1;
-  qty_t qty = state->min_qty + ((rand_r(&state->rng_seed)) % qty_range);
+  qty_t qty = (qty_t)rng_range(&state->rng, state->min_qty, state->max_qty);
 
   // BUILD ORDER
   order_t* order = malloc(sizeof(order_t));
   if (!order)
-    return;
+    return state->next_wake;
 
   order->id = state->next_order_id;
   order->side = side;
@@ -87,50 +75,59 @@ static void noise_step(agent_t* agent, order_book_t* book, timestamp_t now)
   order->ts = now;
 
   // SUBMIT
-  book_add_order(book, order);
+  agent_submit(agent, book, order);
 
   // INCREMENT ID
   state->next_order_id++;
+
+  return state->next_wake;
 }
 
-agent_t* noise_trader_create(agent_id_t id)
+static size_t noise_save(const agent_t* agent, void* out, size_t cap)
 {
-  agent_t* a = malloc(sizeof(agent_t));
-  if (!a)
-  {
-    fprintf(stderr, "could not allocate memory for agent.\n");
-    return NULL;
-  }
-  a->id = id;
-  a->step = noise_step;
-  noise_trader_state_t* agent_state = malloc(sizeof(noise_trader_state_t));
-  if (!agent_state)
-  {
-    fprintf(stderr, "could not allocate memory for agent state.\n");
-    free(a);
-    return NULL;
-  }
-  agent_state->next_order_id = 1;
+  return agent_save_flat(agent->state, sizeof(noise_trader_state_t), out, cap);
+}
+
+static int noise_load(agent_t* agent, const void* in, size_t len)
+{
+  return agent_load_flat(agent->state, sizeof(noise_trader_state_t), in, len);
+}
+
+static void noise_step_all(agent_t* const* agents, size_t n, order_book_t* book,
+                           const market_view_t* view, timestamp_t now, timestamp_t* next)
+{
+  for (size_t i = 0; i < n; i++)
+    next[i] = noise_step(agents[i], book, view, now);
+}
+
+static int noise_init(agent_t* a, agent_id_t id, uint64_t seed, const void* params)
+{
+  (void)params;
+  noise_trader_state_t* agent_state = a->state;
+  agent_state->next_order_id = order_id_first(id);
   agent_state->act_probability = 0.1;
   agent_state->price_range = 10;
   agent_state->min_qty = 1;
   agent_state->max_qty = 10;
-  agent_state->rng_seed = id;
-  a->state = agent_state;
-  return a;
-}
+  rng_init_stream(&agent_state->rng, seed, id);
+  arrival_init_poisson(&agent_state->arrival,
+                       arrival_rate_for_probability(agent_state->act_probability));
+  agent_state->next_wake = AGENT_NO_WAKEUP;
 
-void noise_trader_destroy(agent_t* agent)
-{
-  if (!agent)
-  {
-    return;
-  }
+  a->step = noise_step;
+  a->save = noise_save;
+  a->load = noise_load;
+  return 0;
+}
 
-  if (agent->state)
-  {
-    free(agent->state);
-  }
+const agent_type_t noise_trader_type = {.name = "noise trader",
+                                        .state_size = sizeof(noise_trader_state_t),
+                                        .init = noise_init,
+                                        .step_all = noise_step_all};
 
-  free(agent);
+agent_t* noise_trader_create(agent_id_t id, uint64_t seed)
+{
+  return agent_create(&noise_trader_type, id, seed, NULL);
 }
+
+void noise_trader_destroy(agent_t* agent) { agent_destroy(agent); }
@@ -40,6 +40,25 @@ void latency_init(latency_tracker_t* tracker)
   tracker->sum_ns = 0;
   tracker->min_ns = UINT64_MAX;
   tracker->max_ns = 0;
+  memset(tracker->hist, 0, sizeof tracker->hist);
+}
+
+static size_t hist_bucket(uint64_t v)
+{
+  if (v < (1u << LATENCY_HIST_SUB_BITS))
+    return (size_t)v;
+  int e = 63 - __builtin_clzll(v);
+  uint64_t sub = (v >> (e - LATENCY_HIST_SUB_BITS)) & ((1u << LATENCY_HIST_SUB_BITS) - 1);
+  return ((size_t)(e - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS) + sub;
+}
+
+static uint64_t hist_lower_bound(size_t b)
+{
+  if (b < (1u << LATENCY_HIST_SUB_BITS))
+    return b;
+  int e = (int)(b >> LATENCY_HIST_SUB_BITS) + LATENCY_HIST_SUB_BITS - 1;
+  uint64_t sub = b & ((1u << LATENCY_HIST_SUB_BITS) - 1);
+  return ((1ULL << LATENCY_HIST_SUB_BITS) + sub) << (e - LATENCY_HIST_SUB_BITS);
 }
 
 // latency_record():
@@ -61,6 +80,7 @@ void latency_record(latency_tracker_t* tracker, uint64_t latency_ns)
   {
     tracker->max_ns = latency_ns;
   }
+  tracker->hist[hist_bucket(latency_ns)]++;
   tracker->samples[tracker->sample_count] = latency_ns;
   tracker->sample_count = (tracker->sample_count + 1) % tracker->sample_capacity;
 }
@@ -118,6 +138,49 @@ uint64_t latency_percentile(latency_tracker_t* tracker, double p)
   return tracker->samples[index];
 }
 
+void latency_merge(latency_tracker_t* dst, const latency_tracker_t* src)
+{
+  if (!dst || !src || src->count == 0)
+    return;
+
+  size_t src_samples = src->count < src->sample_capacity ? src->count : src->sample_capacity;
+  for (size_t i = 0; i < src_samples && dst->count + i < dst->sample_capacity; i++)
+  {
+    dst->samples[dst->count + i] = src->samples[i];
+  }
+
+  dst->count += src->count;
+  dst->sum_ns += src->sum_ns;
+  if (src->min_ns < dst->min_ns)
+    dst->min_ns = src->min_ns;
+  if (src->max_ns > dst->max_ns)
+    dst->max_ns = src->max_ns;
+  dst->sample_count = (dst->count < dst->sample_capacity) ? dst->count : 0;
+  for (size_t b = 0; b < LATENCY_HIST_BUCKETS; b++)
+  {
+    dst->hist[b] += src->hist[b];
+  }
+}
+
+uint64_t latency_hist_percentile(const latency_tracker_t* tracker, double p)
+{
+  if (tracker->count == 0)
+    return 0;
+
+  uint64_t rank = (uint64_t)(p * tracker->count);
+  if (rank >= tracker->count)
+    rank = tracker->count - 1;
+
+  uint64_t seen = 0;
+  for (size_t b = 0; b < LATENCY_HIST_BUCKETS; b++)
+  {
+    seen += tracker->hist[b];
+    if (seen > rank)
+      return hist_lower_bound(b);
+  }
+  return tracker->max_ns;
+}
+
 // latency_print():
 //   - Print name, count, min, max, mean, p50, p99
 //   - Format nicely with units (ns, μs, ms)
@@ -0,0 +1,238 @@
+#define _GNU_SOURCE
+#include "common/rng.h"
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+
+// Scratch size for the transformed fills (u64 draws are staged here first)
+#define RNG_CHUNK 256
+
+static inline uint64_t splitmix64(uint64_t* x)
+{
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+void rng_seed(rng_t* rng, uint64_t seed)
+{
+  uint64_t x = seed;
+  for (int i = 0; i < 4; i++)
+    rng->s[i] = splitmix64(&x);
+}
+
+void rng_init_stream(rng_t* rng, uint64_t seed, uint64_t stream)
+{
+  uint64_t x = seed;
+  uint64_t a = splitmix64(&x);
+  x = a ^ (stream * 0xD1B54A32D192ED03ULL);
+  uint64_t b = splitmix64(&x);
+  rng_seed(rng, a ^ b);
+}
+
+double rng_exp(rng_t* rng, double rate) { return -log(rng_uniform_open(rng)) / rate; }
+
+double rng_normal(rng_t* rng)
+{
+  double u1 = rng_uniform_open(rng);
+  double u2 = rng_uniform(rng);
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+/* ---- Ziggurat (Marsaglia & Tsang, in Doornik's ZIGNOR form) ----
+   128 layers of equal area under the density; layer i spans [0, zig_x[i]] and
+   its part below the next layer's edge, a fraction zig_ratio[i], is accepted
+   without evaluating the density. */
+
+#define ZIG_LAYERS 128
+#define ZIG_R 3.442619855899              // start of the tail
+#define ZIG_V 9.91256303526217e-3         // area of each layer
+
+static double zig_x[ZIG_LAYERS + 1];
+static double zig_ratio[ZIG_LAYERS];
+static pthread_once_t zig_once = PTHREAD_ONCE_INIT;
+
+static void zig_build(void)
+{
+  double f = exp(-0.5 * ZIG_R * ZIG_R);
+  zig_x[0] = ZIG_V / f; // the base layer and the tail, as one rectangle
+  zig_x[1] = ZIG_R;
+  zig_x[ZIG_LAYERS] = 0.0;
+  for (int i = 2; i < ZIG_LAYERS; i++)
+  {
+    zig_x[i] = sqrt(-2.0 * log(ZIG_V / zig_x[i - 1] + f));
+    f = exp(-0.5 * zig_x[i] * zig_x[i]);
+  }
+  for (int i = 0; i < ZIG_LAYERS; i++)
+    zig_ratio[i] = zig_x[i + 1] / zig_x[i];
+}
+
+// |x| > ZIG_R, by Marsaglia's exponential rejection
+static double zig_tail(rng_t* rng, int negative)
+{
+  double x, y;
+  do
+  {
+    x = log(rng_uniform_open(rng)) / ZIG_R;
+    y = log(rng_uniform_open(rng));
+  } while (-2.0 * y < x * x);
+  return negative ? x - ZIG_R : ZIG_R - x;
+}
+
+double rng_normal_zig(rng_t* rng)
+{
+  pthread_once(&zig_once, zig_build);
+  for (;;)
+  {
+    // Low 7 bits pick the layer, the top 53 the signed position in it
+    uint64_t bits = rng_next(rng);
+    int i = (int)(bits & (ZIG_LAYERS - 1));
+    double u = 2.0 * rng_u64_to_unit(bits) - 1.0;
+    if (fabs(u) < zig_ratio[i])
+      return u * zig_x[i];
+    if (i == 0)
+      return zig_tail(rng, u < 0);
+
+    // The sliver outside the next layer: test against the density
+    double x = u * zig_x[i];
+    double f0 = exp(-0.5 * (zig_x[i] * zig_x[i] - x * x));
+    double f1 = exp(-0.5 * (zig_x[i + 1] * zig_x[i + 1] - x * x));
+    if (f1 + rng_uniform(rng) * (f0 - f1) < 1.0)
+      return x;
+  }
+}
+
+// Four lanes per vector, RNG_LANES / 4 vectors per step
+typedef uint64_t rng_v4_t __attribute__((vector_size(32)));
+#define RNG_VECS (RNG_LANES / 4)
+
+// x86-64: pick an AVX2 clone at load time, plain SSE2 otherwise
+#if defined(__x86_64__) && defined(__GNUC__)
+#define RNG_DISPATCH __attribute__((target_clones("avx2", "default")))
+#else
+#define RNG_DISPATCH
+#endif
+
+RNG_DISPATCH
+static void rng_lanes_fill(uint64_t* lane_seed, void* out, size_t blocks)
+{
+  rng_v4_t s0[RNG_VECS], s1[RNG_VECS], s2[RNG_VECS], s3[RNG_VECS];
+  for (int v = 0; v < RNG_VECS; v++)
+  {
+    memcpy(&s0[v], lane_seed + 16 * v, sizeof s0[v]);
+    memcpy(&s1[v], lane_seed + 16 * v + 4, sizeof s1[v]);
+    memcpy(&s2[v], lane_seed + 16 * v + 8, sizeof s2[v]);
+    memcpy(&s3[v], lane_seed + 16 * v + 12, sizeof s3[v]);
+  }
+
+  for (size_t b = 0; b < blocks; b++)
+  {
+    for (int v = 0; v < RNG_VECS; v++)
+    {
+      // xoshiro256** with the multiplies as shift-adds (no 64-bit vector mul)
+      rng_v4_t m = (s1[v] << 2) + s1[v];
+      m = (m << 7) | (m >> 57);
+      m = (m << 3) + m;
+      memcpy((char*)out + (b * RNG_LANES + 4 * v) * sizeof(uint64_t), &m, sizeof m);
+
+      rng_v4_t t = s1[v] << 17;
+      s2[v] ^= s0[v];
+      s3[v] ^= s1[v];
+      s1[v] ^= s2[v];
+      s0[v] ^= s3[v];
+      s2[v] ^= t;
+      s3[v] = (s3[v] << 45) | (s3[v] >> 19);
+    }
+  }
+
+  for (int v = 0; v < RNG_VECS; v++)
+  {
+    memcpy(lane_seed + 16 * v, &s0[v], sizeof s0[v]);
+    memcpy(lane_seed + 16 * v + 4, &s1[v], sizeof s1[v]);
+    memcpy(lane_seed + 16 * v + 8, &s2[v], sizeof s2[v]);
+    memcpy(lane_seed + 16 * v + 12, &s3[v], sizeof s3[v]);
+  }
+}
+
+// Fill `bytes` bytes (a multiple of 4) with random bits
+static void rng_fill_bits(rng_t* rng, void* out, size_t bytes)
+{
+  const size_t block_bytes = RNG_LANES * sizeof(uint64_t);
+  if (bytes < 4 * block_bytes)
+  {
+    for (size_t i = 0; i < bytes; i += sizeof(uint64_t))
+    {
+      uint64_t x = rng_next(rng);
+      memcpy((char*)out + i, &x, bytes - i < sizeof x ? bytes - i : sizeof x);
+    }
+    return;
+  }
+
+  // Fresh lane states from one parent draw, so the parent advances by one
+  uint64_t lanes[4 * RNG_LANES];
+  uint64_t x = rng_next(rng);
+  for (int i = 0; i < 4 * RNG_LANES; i++)
+    lanes[i] = splitmix64(&x);
+
+  size_t blocks = bytes / block_bytes;
+  rng_lanes_fill(lanes, out, blocks);
+
+  size_t rest = bytes - blocks * block_bytes;
+  if (rest)
+  {
+    uint64_t tail[RNG_LANES];
+    rng_lanes_fill(lanes, tail, 1);
+    memcpy((char*)out + blocks * block_bytes, tail, rest);
+  }
+}
+
+void rng_fill_u64(rng_t* rng, uint64_t* out, size_t n) { rng_fill_bits(rng, out, n * sizeof *out); }
+
+void rng_fill_u32(rng_t* rng, uint32_t* out, size_t n) { rng_fill_bits(rng, out, n * sizeof *out); }
+
+void rng_fill_uniform(rng_t* rng, double* out, size_t n)
+{
+  uint64_t raw[RNG_CHUNK];
+  for (size_t i = 0; i < n; i += RNG_CHUNK)
+  {
+    size_t m = n - i < RNG_CHUNK ? n - i : RNG_CHUNK;
+    rng_fill_u64(rng, raw, m);
+    for (size_t k = 0; k < m; k++)
+      out[i + k] = rng_u64_to_unit(raw[k]);
+  }
+}
+
+void rng_fill_exp(rng_t* rng, double* out, size_t n, double rate)
+{
+  uint64_t raw[RNG_CHUNK];
+  double inv = 1.0 / rate;
+  for (size_t i = 0; i < n; i += RNG_CHUNK)
+  {
+    size_t m = n - i < RNG_CHUNK ? n - i : RNG_CHUNK;
+    rng_fill_u64(rng, raw, m);
+    for (size_t k = 0; k < m; k++)
+      out[i + k] = -log(rng_u64_to_open_unit(raw[k])) * inv;
+  }
+}
+
+void rng_fill_normal(rng_t* rng, double* out, size_t n)
+{
+  // Box-Muller on pairs keeps both outputs
+  uint64_t raw[RNG_CHUNK];
+  size_t pairs = n / 2;
+  for (size_t p = 0; p < pairs; p += RNG_CHUNK / 2)
+  {
+    size_t m = pairs - p < RNG_CHUNK / 2 ? pairs - p : RNG_CHUNK / 2;
+    rng_fill_u64(rng, raw, 2 * m);
+    for (size_t k = 0; k < m; k++)
+    {
+      double r = sqrt(-2.0 * log(rng_u64_to_open_unit(raw[2 * k])));
+      double theta = 2.0 * M_PI * rng_u64_to_unit(raw[2 * k + 1]);
+      out[2 * (p + k)] = r * cos(theta);
+      out[2 * (p + k) + 1] = r * sin(theta);
+    }
+  }
+  if (n % 2)
+    out[n - 1] = rng_normal(rng);
+}
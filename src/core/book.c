@@ -1,22 +1,54 @@
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "common/config.h"
 #include "core/book.h"
 #include "core/level_ops.h"
 #include "core/matching.h"
 #include "core/trade.h"
 
-#ifdef BENCHMARK
-#include "bench/latency.h"
-extern latency_tracker_t add_order_tracker;
-extern latency_tracker_t remove_order_tracker;
-#endif
+// Queue nodes of one bulk load, allocated together
+typedef struct book_node_block
+{
+  struct book_node_block* next;
+  order_node_t nodes[];
+} book_node_block_t;
 
-void book_init(order_book_t* book)
+int book_init(order_book_t* book)
 {
   pt_init(&book->bids);
   pt_init(&book->asks);
   om_init(&book->orders, 65536);
+  if (!book->orders.buckets)
+    return -1;
+  if (dl_init(&book->bid_ladder, LADDER_MIN_PRICE, LADDER_MAX_PRICE, 1) != 0)
+  {
+    om_free(&book->orders);
+    return -1;
+  }
+  if (dl_init(&book->ask_ladder, LADDER_MIN_PRICE, LADDER_MAX_PRICE, 0) != 0)
+  {
+    dl_free(&book->bid_ladder);
+    om_free(&book->orders);
+    return -1;
+  }
+  book->top_bids.n = 0;
+  book->top_asks.n = 0;
+  stats_init(&book->stats);
+  book->version = 0;
+  book->tape = (book_tape_t){0};
+  book->reports = (exec_ring_t){0};
+  book->node_blocks = NULL;
+  book->indicators = NULL;
+  book->clock = NULL;
+  book->risk = NULL;
+#ifdef BENCHMARK
+  latency_init(&book->add_latency);
+  latency_init(&book->remove_latency);
+  latency_init(&book->match_latency);
+#endif
+  return 0;
 }
 
 static void free_level_payload(price_level_t* lvl)
@@ -38,35 +70,127 @@ void book_free(order_book_t* book)
   pt_clear(&book->bids, free_level_payload);
   pt_clear(&book->asks, free_level_payload);
   om_free(&book->orders);
+  dl_free(&book->bid_ladder);
+  dl_free(&book->ask_ladder);
+  free(book->reports.items);
+  book->reports = (exec_ring_t){0};
+  while (book->node_blocks)
+  {
+    book_node_block_t* next = book->node_blocks->next;
+    free(book->node_blocks);
+    book->node_blocks = next;
+  }
+#ifdef BENCHMARK
+  latency_free(&book->add_latency);
+  latency_free(&book->remove_latency);
+  latency_free(&book->match_latency);
+#endif
 }
 
-void book_add_order(order_book_t* book, order_t* order)
+int book_enable_reports(order_book_t* book, size_t capacity)
 {
-#ifdef BENCHMARK
-  uint64_t start = time_now_ns();
-#endif
-  if (!book || !order)
-    return;
+  if (!book || capacity == 0)
+    return -1;
 
-  // MATCH FIRST
-  trade_t trades[100];
-  match_order(book, order, trades, 100);
+  exec_report_t* items = malloc(capacity * sizeof *items);
+  if (!items)
+    return -1;
 
-  // IF FILLED, FREE ORDER
-  if (order->qty == 0)
+  free(book->reports.items);
+  book->reports = (exec_ring_t){.items = items, .capacity = capacity};
+  return 0;
+}
+
+// Keep `top` equal to the best min(BOOK_TOP_LEVELS, tree size) levels.
+// Only levels inside the cached range touch it; the tree is consulted only to
+// refill the last slot when a cached level empties out.
+static void top_update(book_top_t* top, const price_tree_t* tree, const price_level_t* lvl,
+                       int descending)
+{
+  price_t price = lvl->price;
+  size_t i = 0;
+
+  // Position of the first entry not better than price
+  while (i < top->n &&
+         (descending ? top->levels[i].price > price : top->levels[i].price < price))
+  {
+    i++;
+  }
+
+  if (i < top->n && top->levels[i].price == price)
+  {
+    if (!level_is_empty(lvl))
+    {
+      top->levels[i].qty = lvl->total_qty;
+      top->levels[i].count = lvl->order_count;
+      return;
+    }
+
+    // Level fell off: close the gap and pull the next level from the tree
+    price_t worst = top->levels[top->n - 1].price;
+    memmove(&top->levels[i], &top->levels[i + 1], (top->n - i - 1) * sizeof(depth_entry_t));
+    top->n--;
+
+    if (top->n == BOOK_TOP_LEVELS - 1)
+    {
+      const price_level_t* next =
+          descending ? pt_next_below(tree, worst) : pt_next_above(tree, worst);
+      if (next)
+      {
+        top->levels[top->n].price = next->price;
+        top->levels[top->n].qty = next->total_qty;
+        top->levels[top->n].count = next->order_count;
+        top->n++;
+      }
+    }
+    return;
+  }
+
+  // Not cached: only a new level inside the top range matters
+  if (level_is_empty(lvl) || i >= BOOK_TOP_LEVELS)
   {
-    free(order);
     return;
   }
 
+  size_t keep = (top->n < BOOK_TOP_LEVELS) ? top->n : BOOK_TOP_LEVELS - 1;
+  memmove(&top->levels[i + 1], &top->levels[i], (keep - i) * sizeof(depth_entry_t));
+  top->levels[i].price = price;
+  top->levels[i].qty = lvl->total_qty;
+  top->levels[i].count = lvl->order_count;
+  top->n = keep + 1;
+}
+
+void book_level_changed(order_book_t* book, side_t side, price_level_t* lvl, qty_t delta)
+{
+  book->version++;
+  if (level_is_empty(lvl))
+    book->tape.depletions++;
+  if (side == SIDE_BUY)
+  {
+    pt_add_qty(&book->bids, lvl->price, delta);
+    dl_add(&book->bid_ladder, lvl->price, delta);
+    top_update(&book->top_bids, &book->bids, lvl, 1);
+  }
+  else
+  {
+    pt_add_qty(&book->asks, lvl->price, delta);
+    dl_add(&book->ask_ladder, lvl->price, delta);
+    top_update(&book->top_asks, &book->asks, lvl, 0);
+  }
+}
+
+// Queue an unfilled order at its level, creating the level if needed.
+// `hint` is a level of the same side that may already be the right one.
+static price_level_t* book_rest_order(order_book_t* book, order_t* order, price_level_t* hint)
+{
   price_tree_t* tree = (order->side == SIDE_BUY) ? &book->bids : &book->asks;
 
-  price_level_t* lvl = pt_find(tree, order->price);
+  price_level_t* lvl = (hint && hint->price == order->price) ? hint : pt_find(tree, order->price);
   if (!lvl)
   {
     lvl = (price_level_t*)malloc(sizeof *lvl);
     if (!lvl)
-      return; // or handle error upstream
+      return NULL; // or handle error upstream
 
     level_init(lvl, order->price);
 
@@ -76,15 +200,284 @@ void book_add_order(order_book_t* book, order_t* order)
       // rc==0 duplicate shouldn't happen because pt_find failed, but handle anyway
       // rc==-1 alloc failure inside tree
       free(lvl);
-      return;
+      return NULL;
     }
   }
 
   order_node_t* node = level_push(lvl, order);
+  book_level_changed(book, order->side, lvl, order->qty);
   om_insert(&book->orders, order->id, order, order->side, order->price, node);
+  if (book->risk)
+    risk_on_rest(book->risk, order);
+  return lvl;
+}
+
+// Run an entering order past the risk gate. A rejected one is reported to its
+// owner and freed before it can touch the trees or the map. Return: 1 rejected
+static int book_reject(order_book_t* book, order_t* order)
+{
+  price_t reference = book->stats.last_price ? book->stats.last_price : DEFAULT_MID_PRICE;
+  if (risk_check(book->risk, order, reference, order->ts) == RISK_OK)
+    return 0;
+
+  exec_report_t report = {.type = EXEC_REJECT,
+                          .order_id = order->id,
+                          .side = order->side,
+                          .price = order->price,
+                          .qty = order->qty,
+                          .leaves_qty = 0,
+                          .ts = order->ts};
+  exec_ring_push(&book->reports, &report);
+  free(order);
+  return 1;
+}
+
+void book_add_order(order_book_t* book, order_t* order)
+{
 #ifdef BENCHMARK
-  latency_record(&add_order_tracker, time_now_ns() - start);
+  uint64_t start = time_now_ns();
 #endif
+  if (!book || !order)
+    return;
+  order->ts = book_now(book, order->ts);
+  if (book->risk && book_reject(book, order))
+    return;
+
+  // MATCH FIRST
+  trade_t trades[100];
+  match_order(book, order, trades, 100);
+
+  // IF FILLED, FREE ORDER
+  if (order->qty == 0)
+  {
+    free(order);
+    return;
+  }
+
+  book_rest_order(book, order, NULL);
+#ifdef BENCHMARK
+  latency_record(&book->add_latency, time_now_ns() - start);
+#endif
+}
+
+void book_add_orders(order_book_t* book, order_t** orders, size_t n)
+{
+  if (!book || !orders)
+    return;
+
+  // Last level rested on per side: batches cluster around the mid, so most
+  // orders skip the tree search. A level can only disappear by being matched
+  // away, i.e. when an order of the other side trades.
+  price_level_t* last_bid = NULL;
+  price_level_t* last_ask = NULL;
+  trade_t trades[100];
+
+  for (size_t i = 0; i < n; i++)
+  {
+    order_t* order = orders[i];
+    if (!order)
+      continue;
+    order->ts = book_now(book, order->ts);
+    if (book->risk && book_reject(book, order))
+      continue;
+
+    if (match_order(book, order, trades, 100) > 0)
+    {
+      if (order->side == SIDE_BUY)
+        last_ask = NULL;
+      else
+        last_bid = NULL;
+    }
+
+    if (order->qty == 0)
+    {
+      free(order);
+      continue;
+    }
+
+    if (order->side == SIDE_BUY)
+      last_bid = book_rest_order(book, order, last_bid);
+    else
+      last_ask = book_rest_order(book, order, last_ask);
+  }
+}
+
+// One side of a bulk load: strictly improving prices, consistent orders.
+// Adds the side's order count to *total. Return: 0 ok, -1 invalid
+static int load_side_check(const book_level_data_t* data, size_t n, side_t side, size_t* total)
+{
+  if (n > 0 && !data)
+    return -1;
+
+  for (size_t i = 0; i < n; i++)
+  {
+    const book_level_data_t* d = &data[i];
+    if (d->count == 0 || !d->orders)
+      return -1;
+    if (i > 0 && (side == SIDE_BUY ? d->price >= data[i - 1].price : d->price <= data[i - 1].price))
+      return -1;
+
+    for (size_t k = 0; k < d->count; k++)
+    {
+      const order_t* o = d->orders[k];
+      if (!o || o->side != side || o->price != d->price || o->qty <= 0)
+        return -1;
+    }
+    *total += d->count;
+  }
+  return 0;
+}
+
+// Risk accounts for every owner on one side of a bulk load. Return: 0 ok, -1 no memory
+static int load_side_accounts(risk_gate_t* gate, const book_level_data_t* data, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    for (size_t k = 0; k < data[i].count; k++)
+    {
+      if (risk_reserve(gate, order_owner(data[i].orders[k]->id)) != 0)
+        return -1;
+    }
+  }
+  return 0;
+}
+
+static void load_side_free(price_level_t** levels, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    free_level_payload(levels[i]);
+  free(levels);
+}
+
+// Levels with their queues linked in place, in ascending price (tree) order.
+// Queue nodes come from `nodes`, advanced past the ones used.
+// Return: the levels, NULL on allocation failure
+static price_level_t** load_side_levels(const book_level_data_t* data, size_t n, side_t side,
+                                        price_t* keys, order_node_t** nodes)
+{
+  price_level_t** levels = calloc(n ? n : 1, sizeof *levels);
+  if (!levels)
+    return NULL;
+
+  order_node_t* node = *nodes;
+  for (size_t i = 0; i < n; i++)
+  {
+    const book_level_data_t* d = &data[i];
+    size_t at = (side == SIDE_BUY) ? n - 1 - i : i;
+    price_level_t* lvl = malloc(sizeof *lvl);
+    if (!lvl)
+    {
+      load_side_free(levels, n);
+      return NULL;
+    }
+    level_init(lvl, d->price);
+    levels[at] = lvl;
+    keys[at] = d->price;
+
+    lvl->head = node;
+    for (size_t k = 0; k < d->count; k++, node++)
+    {
+      node->order = d->orders[k];
+      node->next = (k + 1 < d->count) ? node + 1 : NULL;
+      node->prev = (k > 0) ? node - 1 : NULL;
+      node->level = lvl;
+      node->entry_offset = lvl->enqueued_qty;
+      node->bulk = 1;
+      lvl->enqueued_qty += node->order->qty;
+    }
+    lvl->tail = node - 1;
+    lvl->total_qty = lvl->enqueued_qty;
+    lvl->order_count = d->count;
+  }
+  *nodes = node;
+  return levels;
+}
+
+// Order map, ladder, top-N cache and risk accounts for one freshly built side
+static void load_side_index(order_book_t* book, size_t n, side_t side, price_level_t** levels)
+{
+  depth_ladder_t* ladder = (side == SIDE_BUY) ? &book->bid_ladder : &book->ask_ladder;
+  book_top_t* top = (side == SIDE_BUY) ? &book->top_bids : &book->top_asks;
+  top->n = 0;
+
+  for (size_t i = 0; i < n; i++)
+  {
+    price_level_t* lvl = levels[(side == SIDE_BUY) ? n - 1 - i : i];
+    for (order_node_t* node = lvl->head; node; node = node->next)
+    {
+      om_insert(&book->orders, node->order->id, node->order, side, lvl->price, node);
+      if (book->risk)
+        risk_on_rest(book->risk, node->order);
+    }
+
+    dl_add(ladder, lvl->price, lvl->total_qty);
+    if (top->n < BOOK_TOP_LEVELS)
+    {
+      top->levels[top->n] = (depth_entry_t){lvl->price, lvl->total_qty, lvl->order_count};
+      top->n++;
+    }
+  }
+}
+
+int book_load(order_book_t* book, const book_level_data_t* bids, size_t n_bids,
+              const book_level_data_t* asks, size_t n_asks)
+{
+  if (!book || book->bids.size != 0 || book->asks.size != 0 || book->orders.count != 0)
+    return -1;
+
+  size_t total = 0;
+  if (load_side_check(bids, n_bids, SIDE_BUY, &total) != 0 ||
+      load_side_check(asks, n_asks, SIDE_SELL, &total) != 0)
+    return -1;
+  if (n_bids > 0 && n_asks > 0 && bids[0].price >= asks[0].price)
+    return -1; // crossed: these orders would have traded
+  if (book->risk && (load_side_accounts(book->risk, bids, n_bids) != 0 ||
+                     load_side_accounts(book->risk, asks, n_asks) != 0))
+    return -1;
+
+  // Final size up front: one bucket per order, no rehash during the load
+  if (om_reserve(&book->orders, total) != 0)
+    return -1;
+
+  // Every queue node in one block, handed out in level order
+  book_node_block_t* block = malloc(sizeof *block + total * sizeof(order_node_t));
+  price_t* bid_keys = malloc((n_bids ? n_bids : 1) * sizeof *bid_keys);
+  price_t* ask_keys = malloc((n_asks ? n_asks : 1) * sizeof *ask_keys);
+  order_node_t* nodes = block ? block->nodes : NULL;
+  price_level_t** bid_levels =
+      (block && bid_keys && ask_keys) ? load_side_levels(bids, n_bids, SIDE_BUY, bid_keys, &nodes)
+                                      : NULL;
+  price_level_t** ask_levels =
+      bid_levels ? load_side_levels(asks, n_asks, SIDE_SELL, ask_keys, &nodes) : NULL;
+
+  int rc = -1;
+  if (ask_levels && pt_build_sorted(&book->bids, bid_keys, bid_levels, n_bids) == 0)
+  {
+    if (pt_build_sorted(&book->asks, ask_keys, ask_levels, n_asks) == 0)
+      rc = 0;
+    else
+      pt_clear(&book->bids, NULL);
+  }
+  free(bid_keys);
+  free(ask_keys);
+  if (rc != 0)
+  {
+    if (bid_levels)
+      load_side_free(bid_levels, n_bids);
+    if (ask_levels)
+      load_side_free(ask_levels, n_asks);
+    free(block);
+    return -1;
+  }
+  block->next = book->node_blocks;
+  book->node_blocks = block;
+
+  load_side_index(book, n_bids, SIDE_BUY, bid_levels);
+  load_side_index(book, n_asks, SIDE_SELL, ask_levels);
+  book->version++;
+  free(bid_levels); // the trees own the levels now
+  free(ask_levels);
+  return 0;
 }
 
 void book_remove_order(order_book_t* book, order_id_t id)
@@ -107,11 +500,23 @@ void book_remove_order(order_book_t* book, order_id_t id)
   // 2. Get the tree (bids or asks based on side)
   price_tree_t* tree = (entry->side == SIDE_BUY) ? &book->bids : &book->asks;
 
-  // 3. Find the level at that price
-  price_level_t* lvl = pt_find(tree, entry->price);
+  // 3. The order's node knows its level, no tree lookup needed
+  price_level_t* lvl = entry->node->level;
 
   // 4. Remove the order from the level's queue
+  qty_t qty = entry->order->qty;
+  exec_report_t report = {.type = EXEC_CANCEL,
+                          .order_id = id,
+                          .side = entry->side,
+                          .price = entry->price,
+                          .qty = qty,
+                          .leaves_qty = 0,
+                          .ts = book_now(book, entry->order->ts)};
+  exec_ring_push(&book->reports, &report);
+  if (book->risk)
+    risk_on_shrink(book->risk, id, entry->side, qty, 1);
   level_remove(lvl, entry->node);
+  book_level_changed(book, entry->side, lvl, -qty);
 
   // 5. If level is empty, remove from tree and free level
   if (level_is_empty(lvl))
@@ -123,6 +528,112 @@ void book_remove_order(order_book_t* book, order_id_t id)
   // 6. Remove from order map
   om_remove(&book->orders, id);
 #ifdef BENCHMARK
-  latency_record(&remove_order_tracker, time_now_ns() - start);
+  latency_record(&book->remove_latency, time_now_ns() - start);
 #endif
 }
+
+int book_amend_order(order_book_t* book, order_id_t id, price_t price, qty_t qty)
+{
+  if (!book)
+    return -1;
+
+  om_entry_t* entry = om_find(&book->orders, id);
+  if (!entry)
+    return -1;
+  if (qty <= 0)
+  {
+    book_remove_order(book, id);
+    return 0;
+  }
+
+  order_t* order = entry->order;
+  price_level_t* lvl = entry->node->level;
+  side_t side = entry->side;
+  qty_t cut = order->qty - qty;
+  int moves = price != entry->price || cut < 0;
+
+  // A reprice re-enters the order, and the book frees an entering order that
+  // fills or is rejected. Bulk-loaded orders belong to the loader (a checkpoint
+  // maps them from its file), so one of those re-enters as a heap copy.
+  order_t* moved = order;
+  if (moves && entry->node->bulk)
+  {
+    moved = malloc(sizeof *moved);
+    if (!moved)
+      return -1;
+    *moved = *order;
+  }
+
+  if (cut > 0)
+  {
+    exec_report_t report = {.type = EXEC_CANCEL,
+                            .order_id = id,
+                            .side = side,
+                            .price = entry->price,
+                            .qty = cut,
+                            .leaves_qty = qty,
+                            .ts = book_now(book, order->ts)};
+    exec_ring_push(&book->reports, &report);
+  }
+
+  // Less size at the same price: shrink it where it stands
+  if (!moves)
+  {
+    if (cut > 0)
+    {
+      if (book->risk)
+        risk_on_shrink(book->risk, id, side, cut, 0);
+      order->qty = qty;
+      lvl->total_qty -= cut;
+      book_level_changed(book, side, lvl, -cut);
+    }
+    return 0;
+  }
+
+  // Otherwise it loses its place: out of the queue, then in again as new
+  qty_t old_qty = order->qty;
+  if (book->risk)
+    risk_on_shrink(book->risk, id, side, old_qty, 1);
+  level_remove(lvl, entry->node);
+  book_level_changed(book, side, lvl, -old_qty);
+  if (level_is_empty(lvl))
+  {
+    pt_remove(side == SIDE_BUY ? &book->bids : &book->asks, entry->price);
+    free(lvl);
+  }
+  om_remove(&book->orders, id);
+
+  moved->price = price;
+  moved->qty = qty;
+  book_add_order(book, moved);
+  return 0;
+}
+
+qty_t book_queue_ahead(order_book_t* book, order_id_t id)
+{
+  if (!book)
+  {
+    return -1;
+  }
+
+  om_entry_t* entry = om_find(&book->orders, id);
+  if (!entry)
+  {
+    return -1;
+  }
+
+  return level_queue_ahead(entry->node->level, entry->node);
+}
+
+size_t book_top_levels(const order_book_t* book, side_t side, depth_entry_t* out, size_t max)
+{
+  if (!book || !out)
+  {
+    return 0;
+  }
+
+  const book_top_t* top = (side == SIDE_BUY) ? &book->top_bids : &book->top_asks;
+  size_t n = top->n < max ? top->n : max;
+  memcpy(out, top->levels, n * sizeof(depth_entry_t));
+  return n;
+}
@@ -0,0 +1,237 @@
+#include "core/book_fork.h"
+#include "core/price_tree.h"
+
+static const price_tree_t* fork_tree(const book_fork_t* fork, side_t side)
+{
+  return (side == SIDE_BUY) ? &fork->base->bids : &fork->base->asks;
+}
+
+static fork_level_t* fork_find_level(const book_fork_t* fork, side_t side, price_t price)
+{
+  for (size_t i = 0; i < fork->level_count; i++)
+  {
+    const fork_level_t* fl = &fork->levels[i];
+    if (fl->side == side && fl->price == price)
+      return (fork_level_t*)fl;
+  }
+  return NULL;
+}
+
+// Overlay entry for a level, created on first touch. NULL if the overlay is full.
+static fork_level_t* fork_get_level(book_fork_t* fork, side_t side, price_t price)
+{
+  fork_level_t* fl = fork_find_level(fork, side, price);
+  if (fl)
+    return fl;
+
+  if (fork->level_count == BOOK_FORK_MAX_LEVELS)
+  {
+    fork->overflow = 1;
+    return NULL;
+  }
+
+  fl = &fork->levels[fork->level_count++];
+  fl->side = side;
+  fl->price = price;
+  fl->base = pt_find(fork_tree(fork, side), price);
+  fl->cursor = fl->base ? fl->base->head : NULL;
+  fl->cursor_filled = 0;
+  fl->consumed = 0;
+  fl->added = 0;
+  return fl;
+}
+
+static qty_t fork_base_remaining(const book_fork_t* fork, side_t side, const price_level_t* lvl)
+{
+  const fork_level_t* fl = fork_find_level(fork, side, lvl->price);
+  return fl ? lvl->total_qty - fl->consumed + fl->added : lvl->total_qty;
+}
+
+// Next price on `side` with qty left in the fork, in priority order.
+// With started == 0 this is the best price; otherwise the next one after `after`.
+static int fork_next_price(const book_fork_t* fork, side_t side, int started, price_t after,
+                           price_t* out)
+{
+  const price_tree_t* tree = fork_tree(fork, side);
+  int desc = (side == SIDE_BUY);
+
+  // Base levels, skipping those the fork already emptied
+  const price_level_t* lvl;
+  if (started)
+    lvl = desc ? pt_next_below(tree, after) : pt_next_above(tree, after);
+  else
+    lvl = desc ? pt_max(tree) : pt_min(tree);
+
+  while (lvl && fork_base_remaining(fork, side, lvl) == 0)
+  {
+    lvl = desc ? pt_next_below(tree, lvl->price) : pt_next_above(tree, lvl->price);
+  }
+
+  int found = (lvl != NULL);
+  price_t best = lvl ? lvl->price : 0;
+
+  // Levels that only exist in the fork
+  for (size_t i = 0; i < fork->level_count; i++)
+  {
+    const fork_level_t* fl = &fork->levels[i];
+    if (fl->side != side || fl->base || fl->added == 0)
+      continue;
+    if (started && (desc ? fl->price >= after : fl->price <= after))
+      continue;
+    if (!found || (desc ? fl->price > best : fl->price < best))
+    {
+      best = fl->price;
+      found = 1;
+    }
+  }
+
+  if (found)
+    *out = best;
+  return found;
+}
+
+static void fork_record_trade(trade_t* t, size_t n, const order_t* incoming, order_id_t resting_id,
+                              price_t price, qty_t fill)
+{
+  t->id = n;
+  t->price = price;
+  t->qty = fill;
+  t->ts = incoming->ts;
+  t->buy_id = (incoming->side == SIDE_BUY) ? incoming->id : resting_id;
+  t->sell_id = (incoming->side == SIDE_BUY) ? resting_id : incoming->id;
+}
+
+void book_fork_init(book_fork_t* fork, const order_book_t* base)
+{
+  fork->base = base;
+  book_fork_reset(fork);
+}
+
+void book_fork_reset(book_fork_t* fork)
+{
+  fork->level_count = 0;
+  fork->order_count = 0;
+  fork->overflow = 0;
+}
+
+size_t book_fork_match(book_fork_t* fork, order_t* incoming, trade_t* trades, size_t max_trades)
+{
+  if (!fork || !fork->base || !incoming || !trades || max_trades == 0)
+  {
+    return 0;
+  }
+
+  side_t opposite = (side_t)-incoming->side;
+  size_t trade_count = 0;
+  int started = 0;
+  price_t price = 0;
+
+  while (incoming->qty > 0 && trade_count < max_trades &&
+         fork_next_price(fork, opposite, started, price, &price))
+  {
+    started = 1;
+
+    // Crossing condition
+    if ((incoming->side == SIDE_BUY && incoming->price < price) ||
+        (incoming->side == SIDE_SELL && incoming->price > price))
+    {
+      break;
+    }
+
+    fork_level_t* fl = fork_get_level(fork, opposite, price);
+    if (!fl)
+      break;
+
+    // Base queue first, resuming from where earlier what-ifs left off
+    while (incoming->qty > 0 && trade_count < max_trades && fl->cursor)
+    {
+      const order_t* resting = fl->cursor->order;
+      qty_t avail = resting->qty - fl->cursor_filled;
+      qty_t fill = (incoming->qty > avail) ? avail : incoming->qty;
+
+      fork_record_trade(&trades[trade_count], trade_count, incoming, resting->id, price, fill);
+      trade_count++;
+      incoming->qty -= fill;
+      fl->consumed += fill;
+      fl->cursor_filled += fill;
+
+      if (fl->cursor_filled == resting->qty)
+      {
+        fl->cursor = fl->cursor->next;
+        fl->cursor_filled = 0;
+      }
+    }
+
+    // Then hypothetical orders resting behind it, in arrival order
+    for (size_t i = 0; i < fork->order_count && fl->added > 0; i++)
+    {
+      fork_order_t* fo = &fork->orders[i];
+      if (fo->side != opposite || fo->price != price || fo->qty == 0)
+        continue;
+      if (incoming->qty == 0 || trade_count == max_trades)
+        break;
+
+      qty_t fill = (incoming->qty > fo->qty) ? fo->qty : incoming->qty;
+      fork_record_trade(&trades[trade_count], trade_count, incoming, fo->id, price, fill);
+      trade_count++;
+      incoming->qty -= fill;
+      fo->qty -= fill;
+      fl->added -= fill;
+    }
+  }
+
+  return trade_count;
+}
+
+size_t book_fork_add_order(book_fork_t* fork, order_t* incoming, trade_t* trades,
+                           size_t max_trades)
+{
+  size_t n = book_fork_match(fork, incoming, trades, max_trades);
+
+  if (!fork || !incoming || incoming->qty == 0 || incoming->type != ORDER_LIMIT)
+  {
+    return n;
+  }
+
+  // Rest the remainder in the overlay
+  fork_level_t* fl = fork_get_level(fork, incoming->side, incoming->price);
+  if (!fl || fork->order_count == BOOK_FORK_MAX_ORDERS)
+  {
+    fork->overflow = 1;
+    return n;
+  }
+
+  fork_order_t* fo = &fork->orders[fork->order_count++];
+  fo->id = incoming->id;
+  fo->side = incoming->side;
+  fo->price = incoming->price;
+  fo->qty = incoming->qty;
+  fl->added += incoming->qty;
+
+  return n;
+}
+
+int book_fork_best(const book_fork_t* fork, side_t side, price_t* price)
+{
+  if (!fork || !fork->base)
+  {
+    return 0;
+  }
+  return fork_next_price(fork, side, 0, 0, price);
+}
+
+qty_t book_fork_level_qty(const book_fork_t* fork, side_t side, price_t price)
+{
+  if (!fork || !fork->base)
+  {
+    return 0;
+  }
+
+  const fork_level_t* fl = fork_find_level(fork, side, price);
+  const price_level_t* lvl = fl ? fl->base : pt_find(fork_tree(fork, side), price);
+
+  qty_t qty = lvl ? lvl->total_qty : 0;
+  if (fl)
+    qty += fl->added - fl->consumed;
+  return qty;
+}
@@ -0,0 +1,100 @@
+#include "core/depth_ladder.h"
+#include <stdlib.h>
+
+// Map a price to its 1-based BIT index (0 if outside the ladder)
+static inline size_t dl_index(const depth_ladder_t* dl, price_t price)
+{
+  if (price < dl->lo || price > dl->hi)
+    return 0;
+  return dl->descending ? (size_t)(dl->hi - price) + 1 : (size_t)(price - dl->lo) + 1;
+}
+
+static inline price_t dl_price(const depth_ladder_t* dl, size_t idx)
+{
+  return dl->descending ? dl->hi - (price_t)(idx - 1) : dl->lo + (price_t)(idx - 1);
+}
+
+int dl_init(depth_ladder_t* dl, price_t lo, price_t hi, int descending)
+{
+  if (!dl || hi < lo)
+    return -1;
+
+  dl->n = (size_t)(hi - lo) + 1;
+  dl->tree = calloc(dl->n + 1, sizeof(qty_t));
+  if (!dl->tree)
+  {
+    dl->n = 0;
+    return -1;
+  }
+
+  dl->top_bit = 1;
+  while (dl->top_bit * 2 <= dl->n)
+    dl->top_bit *= 2;
+
+  dl->lo = lo;
+  dl->hi = hi;
+  dl->descending = descending;
+  return 0;
+}
+
+void dl_free(depth_ladder_t* dl)
+{
+  if (!dl)
+    return;
+  free(dl->tree);
+  dl->tree = NULL;
+  dl->n = 0;
+}
+
+int dl_add(depth_ladder_t* dl, price_t price, qty_t delta)
+{
+  size_t i = dl_index(dl, price);
+  if (i == 0)
+    return 0;
+
+  for (; i <= dl->n; i += i & (~i + 1))
+  {
+    dl->tree[i] += delta;
+  }
+  return 1;
+}
+
+qty_t dl_depth_until(const depth_ladder_t* dl, price_t price)
+{
+  size_t i;
+  if (dl->descending)
+    i = price > dl->hi ? 0 : (price < dl->lo ? dl->n : dl_index(dl, price));
+  else
+    i = price < dl->lo ? 0 : (price > dl->hi ? dl->n : dl_index(dl, price));
+
+  qty_t sum = 0;
+  for (; i > 0; i -= i & (~i + 1))
+  {
+    sum += dl->tree[i];
+  }
+  return sum;
+}
+
+int dl_price_for_qty(const depth_ladder_t* dl, qty_t qty, price_t* price)
+{
+  if (qty <= 0 || dl->n == 0)
+    return 0;
+
+  // Binary lifting: largest idx whose prefix is still short of qty
+  size_t pos = 0;
+  for (size_t step = dl->top_bit; step > 0; step >>= 1)
+  {
+    if (pos + step <= dl->n && dl->tree[pos + step] < qty)
+    {
+      pos += step;
+      qty -= dl->tree[pos];
+    }
+  }
+
+  if (pos >= dl->n)
+    return 0;
+
+  if (price)
+    *price = dl_price(dl, pos + 1);
+  return 1;
+}
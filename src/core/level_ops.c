@@ -21,6 +21,9 @@ void level_init(price_level_t* level, price_t price)
 {
   level->price = price;
   level->total_qty = 0;
+  level->order_count = 0;
+  level->enqueued_qty = 0;
+  level->dequeued_qty = 0;
   level->head = NULL;
   level->tail = NULL;
 
@@ -46,6 +49,9 @@ order_node_t* level_push(price_level_t* level, order_t* order)
   new_node->order = order;
   new_node->next = NULL;
   new_node->prev = NULL;
+  new_node->level = level;
+  new_node->entry_offset = level->enqueued_qty;
+  new_node->bulk = 0;
   if (level->tail)
   {
     level->tail->next = new_node;
@@ -59,6 +65,8 @@ order_node_t* level_push(price_level_t* level, order_t* order)
   }
 
   level->total_qty += order->qty;
+  level->enqueued_qty += order->qty;
+  level->order_count++;
   level_assert_invariants(level);
   return new_node;
 }
@@ -78,13 +86,15 @@ order_t* level_pop(price_level_t* level)
     level->tail = NULL;
   }
   // level->total_qty -= o->qty;
+  level->order_count--;
 
   if (level->head)
   {
     level->head->prev = NULL;
   }
 
-  free(temp);
+  if (!temp->bulk)
+    free(temp);
 
   level_assert_invariants(level);
   return o;
@@ -101,13 +111,15 @@ void level_free_queue(price_level_t* level, void (*free_order)(order_t* order))
     order_node_t* next = cur->next;
     if (free_order && cur->order)
       free_order(cur->order);
-    free(cur);
+    if (!cur->bulk)
+      free(cur);
     cur = next;
   }
 
   level->head = NULL;
   level->tail = NULL;
   level->total_qty = 0;
+  level->order_count = 0;
 }
 
 int level_remove(price_level_t* level, order_node_t* node)
@@ -139,8 +151,30 @@ int level_remove(price_level_t* level, order_node_t* node)
   }
 
   level->total_qty -= node->order->qty;
+  level->order_count--;
 
-  free(node);
+  if (!node->bulk)
+    free(node);
 
   return 0;
+}
+
+qty_t level_queue_ahead(const price_level_t* level, const order_node_t* node)
+{
+  if (!level || !node || node == level->head)
+  {
+    return 0;
+  }
+
+  // Everything filled off the front since we joined was ahead of us.
+  qty_t ahead = node->entry_offset - level->dequeued_qty;
+
+  // Cancels ahead are not tracked; never report more than is actually resting.
+  qty_t cap = level->total_qty - node->order->qty;
+  if (ahead > cap)
+  {
+    ahead = cap;
+  }
+
+  return ahead < 0 ? 0 : ahead;
 }
\ No newline at end of file
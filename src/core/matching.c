@@ -1,13 +1,9 @@
 #include "core/matching.h"
 #include "core/level_ops.h"
+#include "sim/indicators.h"
 #include "sim/stats.h"
 #include <stdlib.h>
 
-#ifdef BENCHMARK
-#include "bench/latency.h"
-extern latency_tracker_t match_order_tracker;
-#endif
-
 qty_t match_order(order_book_t* book, order_t* incoming, trade_t* trades, size_t max_trades)
 {
 #ifdef BENCHMARK
@@ -64,6 +60,7 @@ qty_t match_order(order_book_t* book, order_t* incoming, trade_t* trades, size_t
     }
 
     // c. Inner loop: match against orders at this price level
+    qty_t level_filled = 0;
     while (incoming->qty > 0 && trade_count < max_trades && level_peek(best) != NULL)
     {
 
@@ -81,7 +78,12 @@ qty_t match_order(order_book_t* book, order_t* incoming, trade_t* trades, size_t
       trades[trade_count].price = resting->price;
       trades[trade_count].qty = fill;
       trades[trade_count].ts = incoming->ts;
-      stats_on_trade(resting->price, fill);
+      stats_on_trade(&book->stats, resting->price, fill);
+      if (book->indicators)
+        indicators_on_trade(book->indicators, resting->price);
+      if (book->risk)
+        risk_on_fill(book->risk, incoming, resting, fill);
+      book->tape.trades++;
 
       // Now figure out buy_id and sell_id:
       if (side == SIDE_BUY)
@@ -96,21 +98,50 @@ qty_t match_order(order_book_t* book, order_t* incoming, trade_t* trades, size_t
       }
 
       best->total_qty -= fill;
+      best->dequeued_qty += fill;
+      level_filled += fill;
 
       // 4. Decrement quantities:
       incoming->qty -= fill;
       resting->qty -= fill;
 
-      // 5. If resting order is fully filled, remove it from the level
+      // Both owners hear about the fill
+      if (book->reports.items)
+      {
+        exec_report_t report = {.type = EXEC_FILL,
+                                .order_id = resting->id,
+                                .side = (side_t)-side,
+                                .price = resting->price,
+                                .qty = fill,
+                                .leaves_qty = resting->qty,
+                                .ts = incoming->ts};
+        exec_ring_push(&book->reports, &report);
+        report.order_id = incoming->id;
+        report.side = side;
+        report.leaves_qty = incoming->qty;
+        exec_ring_push(&book->reports, &report);
+      }
+
+      // 5. If resting order is fully filled, remove it from the level and the map
       if (resting->qty == 0)
       {
+        om_remove(&book->orders, resting->id);
         level_pop(best);
       }
 
       trade_count++;
     }
 
-    // d. Clean up empty level
+    // d. Publish the level's depth change, then clean up if empty
+    if (level_filled > 0)
+    {
+      book_tape_t* tape = &book->tape;
+      if (tape->trade_high == 0 || best->price > tape->trade_high)
+        tape->trade_high = best->price;
+      if (tape->trade_low == 0 || best->price < tape->trade_low)
+        tape->trade_low = best->price;
+    }
+    book_level_changed(book, (side_t)-side, best, -level_filled);
     if (level_is_empty(best))
     {
       // Remove from tree and free the level
@@ -120,7 +151,7 @@ qty_t match_order(order_book_t* book, order_t* incoming, trade_t* trades, size_t
   }
 
 #ifdef BENCHMARK
-  latency_record(&match_order_tracker, time_now_ns() - start);
+  latency_record(&book->match_latency, time_now_ns() - start);
 #endif
 
   // 4. Return trade_count
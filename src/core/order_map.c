@@ -1,6 +1,55 @@
 #include "core/order_map.h"
 #include <stdlib.h>
 
+// Order ids carry the agent in their high bits, so mix before taking the bucket
+static inline uint64_t om_bucket(const order_map_t* map, order_id_t id)
+{
+  uint64_t h = id * 0x9E3779B97F4A7C15ULL;
+  return (h ^ (h >> 32)) % map->num_buckets;
+}
+
+// Entries per block when the map grows one insert at a time
+#define OM_BLOCK_MIN 1024
+
+static om_block_t* om_add_block(order_map_t* map, size_t capacity)
+{
+  om_block_t* block = malloc(sizeof(om_block_t) + capacity * sizeof(om_entry_t));
+  if (!block)
+    return NULL;
+  block->used = 0;
+  block->capacity = capacity;
+  block->next = map->blocks;
+  map->blocks = block;
+  return block;
+}
+
+static om_entry_t* om_alloc_entry(order_map_t* map)
+{
+  om_entry_t* z = map->free_entries;
+  if (z)
+  {
+    map->free_entries = z->next;
+    return z;
+  }
+
+  om_block_t* block = map->blocks;
+  if (!block || block->used == block->capacity)
+  {
+    // Grow with the map: blocks double, so per-entry cost stays O(1)
+    size_t capacity = map->count > OM_BLOCK_MIN ? map->count : OM_BLOCK_MIN;
+    block = om_add_block(map, capacity);
+    if (!block)
+      return NULL;
+  }
+  return &block->entries[block->used++];
+}
+
+static void om_release_entry(order_map_t* map, om_entry_t* z)
+{
+  z->next = map->free_entries;
+  map->free_entries = z;
+}
+
 void om_init(order_map_t* map, size_t num_buckets)
 {
   // 1. Validate input
@@ -15,6 +64,8 @@ void om_init(order_map_t* map, size_t num_buckets)
   // 3. Set num_buckets and count
   map->count = 0;
   map->num_buckets = num_buckets;
+  map->blocks = NULL;
+  map->free_entries = NULL;
 }
 
 int om_insert(order_map_t* map, order_id_t id, order_t* order, side_t side, price_t price,
@@ -27,10 +78,14 @@ int om_insert(order_map_t* map, order_id_t id, order_t* order, side_t side, pric
   }
 
   // 2. Calculate bucket index
-  uint64_t idx = id % map->num_buckets;
+  uint64_t idx = om_bucket(map, id);
 
-  // 3. Allocate new om_entry_t node
-  om_entry_t* z = malloc(sizeof(om_entry_t));
+  // 3. Take an entry from the map's storage
+  om_entry_t* z = om_alloc_entry(map);
+  if (!z)
+  {
+    return -1;
+  }
   // 4. Fill in the node fields (key, order, side, price)
   z->key = id;
   z->order = order;
@@ -54,7 +109,7 @@ om_entry_t* om_find(order_map_t* map, order_id_t id)
     return NULL;
   }
   // 2. Calculate bucket index
-  uint64_t idx = id % map->num_buckets;
+  uint64_t idx = om_bucket(map, id);
   // 3. Walk the linked list in that bucket
   //    - If node->key == id, return that node
   om_entry_t* curr = map->buckets[idx];
@@ -74,13 +129,55 @@ om_entry_t* om_find(order_map_t* map, order_id_t id)
   return NULL;
 }
 
+int om_reserve(order_map_t* map, size_t count)
+{
+  if (!map)
+    return -1;
+
+  // Entries: one block for whatever the free list and the newest block cannot cover
+  size_t needed = count > map->count ? count - map->count : 0;
+  for (om_entry_t* z = map->free_entries; z && needed > 0; z = z->next)
+    needed--;
+  om_block_t* head = map->blocks;
+  if (needed > (head ? head->capacity - head->used : 0) && !om_add_block(map, needed))
+    return -1;
+
+  if (count <= map->num_buckets)
+    return 0;
+
+  om_entry_t** buckets = calloc(count, sizeof(om_entry_t*));
+  if (!buckets)
+    return -1;
+
+  // Move every entry over; chain order within a bucket does not matter
+  order_map_t grown = *map;
+  grown.buckets = buckets;
+  grown.num_buckets = count;
+  for (size_t i = 0; i < map->num_buckets; i++)
+  {
+    om_entry_t* curr = map->buckets[i];
+    while (curr != NULL)
+    {
+      om_entry_t* next = curr->next;
+      uint64_t idx = om_bucket(&grown, curr->key);
+      curr->next = buckets[idx];
+      buckets[idx] = curr;
+      curr = next;
+    }
+  }
+
+  free(map->buckets);
+  *map = grown;
+  return 0;
+}
+
 int om_remove(order_map_t* map, order_id_t id)
 {
   // 1. Validate input (return -1 if invalid)
   if (!map)
     return -1;
   // 2. Calculate bucket index
-  uint64_t idx = id % map->num_buckets;
+  uint64_t idx = om_bucket(map, id);
   // 3. Handle special case: if head node matches, update bucket head
   om_entry_t* curr = map->buckets[idx];
 
@@ -92,7 +189,7 @@ int om_remove(order_map_t* map, order_id_t id)
   if (curr->key == id)
   {
     map->buckets[idx] = map->buckets[idx]->next;
-    free(curr);
+    om_release_entry(map, curr);
     map->count--;
     return 0;
   }
@@ -106,7 +203,7 @@ int om_remove(order_map_t* map, order_id_t id)
     if (curr->key == id)
     {
       prev->next = curr->next;
-      free(curr);
+      om_release_entry(map, curr);
       map->count--;
       return 0;
     }
@@ -131,20 +228,16 @@ void om_free(order_map_t* map)
     return;
   }
 
-  // 2. For each bucket:
-  //    - Walk the linked list and free each node
-  size_t size = map->num_buckets;
-
-  for (size_t i = 0; i < size; i++)
+  // 2. Entries live in the blocks: free those
+  om_block_t* block = map->blocks;
+  while (block != NULL)
   {
-    om_entry_t* curr = map->buckets[i];
-    while (curr != NULL)
-    {
-      om_entry_t* next = curr->next;
-      free(curr);
-      curr = next;
-    }
+    om_block_t* next = block->next;
+    free(block);
+    block = next;
   }
+  map->blocks = NULL;
+  map->free_entries = NULL;
 
   // 3. Free the buckets array itself
   free(map->buckets);
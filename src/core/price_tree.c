@@ -10,6 +10,7 @@ static void insert_fixup(price_tree_t* t, price_node_t* z);
 static void transplant(price_tree_t* t, price_node_t* u, price_node_t* v);
 static price_node_t* tree_min_node(price_tree_t* t, price_node_t* x);
 static void delete_fixup(price_tree_t* t, price_node_t* x);
+static void pull(price_tree_t* t, price_node_t* x);
 
 void pt_init(price_tree_t* t)
 {
@@ -22,6 +23,18 @@ void pt_init(price_tree_t* t)
   t->size = 0;
   t->nil.key = 0;
   t->nil.level = NULL;
+  t->nil.qty = 0;
+  t->nil.subtree_qty = 0;
+  t->nil.subtree_count = 0;
+}
+
+// Recompute x's subtree aggregates from its children (never called on nil)
+static void pull(price_tree_t* t, price_node_t* x)
+{
+  if (x == &t->nil)
+    return;
+  x->subtree_qty = x->left->subtree_qty + x->qty + x->right->subtree_qty;
+  x->subtree_count = x->left->subtree_count + 1 + x->right->subtree_count;
 }
 
 // FIND PRICE LEVEL
@@ -83,6 +96,16 @@ int pt_insert(price_tree_t* t, price_t price, price_level_t* level)
   z->left = nil;
   z->right = nil;
   z->parent = parent;
+  z->qty = level ? level->total_qty : 0;
+  z->subtree_qty = z->qty;
+  z->subtree_count = 1;
+
+  // New leaf: every ancestor gains its qty and one level
+  for (price_node_t* p = parent; p != nil; p = p->parent)
+  {
+    p->subtree_qty += z->qty;
+    p->subtree_count++;
+  }
 
   if (parent == nil)
   {
@@ -103,6 +126,62 @@ int pt_insert(price_tree_t* t, price_t price, price_level_t* level)
   return 1;
 }
 
+// Link nodes[lo..hi] under `parent`, the middle one as subtree root
+static price_node_t* build_range(price_tree_t* t, price_node_t** nodes, size_t lo, size_t hi,
+                                 price_node_t* parent, size_t depth, size_t red_depth)
+{
+  if (lo >= hi)
+    return &t->nil;
+
+  size_t mid = lo + (hi - lo) / 2;
+  price_node_t* x = nodes[mid];
+  x->parent = parent;
+  x->color = (depth >= red_depth) ? PT_RED : PT_BLACK;
+  x->left = build_range(t, nodes, lo, mid, x, depth + 1, red_depth);
+  x->right = build_range(t, nodes, mid + 1, hi, x, depth + 1, red_depth);
+  pull(t, x);
+  return x;
+}
+
+// BUILD FROM SORTED KEYS
+int pt_build_sorted(price_tree_t* t, const price_t* keys, price_level_t* const* levels, size_t n)
+{
+  if (!t || t->root != &t->nil || (n > 0 && (!keys || !levels)))
+    return -1;
+  if (n == 0)
+    return 0;
+
+  price_node_t** nodes = malloc(n * sizeof *nodes);
+  if (!nodes)
+    return -1;
+  for (size_t i = 0; i < n; i++)
+  {
+    nodes[i] = malloc(sizeof(price_node_t));
+    if (!nodes[i])
+    {
+      while (i > 0)
+        free(nodes[--i]);
+      free(nodes);
+      return -1;
+    }
+    nodes[i]->key = keys[i];
+    nodes[i]->level = levels[i];
+    nodes[i]->qty = levels[i] ? levels[i]->total_qty : 0;
+  }
+
+  // Midpoint splits put every nil at depth floor or ceil of log2(n + 1); nodes
+  // below the full rows are red so every path has the same black height
+  size_t red_depth = 0;
+  while (((size_t)2 << red_depth) <= n + 1)
+    red_depth++;
+
+  t->root = build_range(t, nodes, 0, n, &t->nil, 0, red_depth);
+  t->root->color = PT_BLACK;
+  t->size = n;
+  free(nodes);
+  return 0;
+}
+
 // MINIMUM IN PRICE TREE
 price_level_t* pt_min(const price_tree_t* t)
 {
@@ -141,6 +220,52 @@ price_level_t* pt_max(const price_tree_t* t)
   return x->level;
 }
 
+// NEAREST LEVEL ABOVE PRICE
+price_level_t* pt_next_above(const price_tree_t* t, price_t price)
+{
+  const price_node_t* nil = &t->nil;
+  const price_node_t* x = t->root;
+  const price_node_t* best = nil;
+
+  while (x != nil)
+  {
+    if (x->key > price)
+    {
+      best = x;
+      x = x->left;
+    }
+    else
+    {
+      x = x->right;
+    }
+  }
+
+  return best == nil ? NULL : best->level;
+}
+
+// NEAREST LEVEL BELOW PRICE
+price_level_t* pt_next_below(const price_tree_t* t, price_t price)
+{
+  const price_node_t* nil = &t->nil;
+  const price_node_t* x = t->root;
+  const price_node_t* best = nil;
+
+  while (x != nil)
+  {
+    if (x->key < price)
+    {
+      best = x;
+      x = x->right;
+    }
+    else
+    {
+      x = x->left;
+    }
+  }
+
+  return best == nil ? NULL : best->level;
+}
+
 // LEFT ROTATE TREE
 static void left_rotate(price_tree_t* t, price_node_t* x)
 {
@@ -170,6 +295,9 @@ static void left_rotate(price_tree_t* t, price_node_t* x)
   }
   y->left = x;
   x->parent = y;
+
+  pull(t, x);
+  pull(t, y);
 }
 
 // RIGHT ROTATE TREE
@@ -201,6 +329,9 @@ static void right_rotate(price_tree_t* t, price_node_t* x)
   }
   y->right = x;
   x->parent = y;
+
+  pull(t, x);
+  pull(t, y);
 }
 
 // RB TREE FIXUP
@@ -424,6 +555,12 @@ int pt_remove(price_tree_t* t, price_t price)
     y->color = z->color;
   }
 
+  // Structure changed only on the path above x; refresh aggregates up to the root
+  for (price_node_t* p = x->parent; p != nil; p = p->parent)
+  {
+    pull(t, p);
+  }
+
   free(z);
   if (t->size > 0)
     t->size--;
@@ -442,6 +579,86 @@ int pt_remove(price_tree_t* t, price_t price)
   return 1;
 }
 
+int pt_add_qty(price_tree_t* t, price_t price, qty_t delta)
+{
+  price_node_t* nil = &t->nil;
+  price_node_t* x = t->root;
+
+  while (x != nil && x->key != price)
+  {
+    x = (price < x->key) ? x->left : x->right;
+  }
+  if (x == nil)
+    return 0;
+
+  x->qty += delta;
+  for (; x != nil; x = x->parent)
+  {
+    x->subtree_qty += delta;
+  }
+  return 1;
+}
+
+qty_t pt_depth_until(const price_tree_t* t, price_t price, int from_max, size_t* levels)
+{
+  const price_node_t* nil = &t->nil;
+  const price_node_t* x = t->root;
+  qty_t depth = 0;
+  size_t count = 0;
+
+  while (x != nil)
+  {
+    int inside = from_max ? (x->key >= price) : (x->key <= price);
+    if (inside)
+    {
+      // x and everything on its best side are at or better than price
+      const price_node_t* better = from_max ? x->right : x->left;
+      depth += better->subtree_qty + x->qty;
+      count += better->subtree_count + 1;
+      x = from_max ? x->left : x->right;
+    }
+    else
+    {
+      x = from_max ? x->right : x->left;
+    }
+  }
+
+  if (levels)
+    *levels = count;
+  return depth;
+}
+
+int pt_price_for_qty(const price_tree_t* t, qty_t qty, int from_max, price_t* price)
+{
+  const price_node_t* nil = &t->nil;
+  const price_node_t* x = t->root;
+
+  if (qty <= 0 || x == nil || x->subtree_qty < qty)
+    return 0;
+
+  while (x != nil)
+  {
+    const price_node_t* better = from_max ? x->right : x->left;
+    if (better->subtree_qty >= qty)
+    {
+      x = better;
+    }
+    else if (better->subtree_qty + x->qty >= qty)
+    {
+      if (price)
+        *price = x->key;
+      return 1;
+    }
+    else
+    {
+      qty -= better->subtree_qty + x->qty;
+      x = from_max ? x->left : x->right;
+    }
+  }
+
+  return 0;
+}
+
 static void pt_clear_nodes(price_tree_t* t, price_node_t* n, void (*free_level)(price_level_t*))
 {
   price_node_t* nil = &t->nil;
@@ -0,0 +1,170 @@
+#define _GNU_SOURCE
+#include "core/risk.h"
+#include "sim/clock.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RISK_MIN_ACCOUNTS 64
+
+int risk_init(risk_gate_t* gate, const risk_limits_t* limits)
+{
+  if (!gate || !limits || limits->max_order_qty < 0 || limits->collar < 0 ||
+      limits->max_position < 0 || limits->msg_rate > SIM_NS_PER_SEC)
+    return -1;
+
+  memset(gate, 0, sizeof *gate);
+  gate->limits = *limits;
+  if (limits->msg_rate)
+  {
+    uint32_t burst = limits->burst ? limits->burst : 1;
+    gate->interval = SIM_NS_PER_SEC / limits->msg_rate;
+    gate->window = burst * gate->interval;
+  }
+  return 0;
+}
+
+void risk_free(risk_gate_t* gate)
+{
+  if (!gate)
+    return;
+  free(gate->accounts);
+  gate->accounts = NULL;
+  gate->capacity = 0;
+}
+
+// Accounts for owners up to `owner`, new ones zeroed. Return: 0 ok, -1 no memory
+static int risk_grow(risk_gate_t* gate, agent_id_t owner)
+{
+  size_t cap = gate->capacity ? gate->capacity * 2 : RISK_MIN_ACCOUNTS;
+  while (cap <= owner)
+    cap *= 2;
+  risk_account_t* accounts = realloc(gate->accounts, cap * sizeof *accounts);
+  if (!accounts)
+    return -1;
+  memset(accounts + gate->capacity, 0, (cap - gate->capacity) * sizeof *accounts);
+  gate->accounts = accounts;
+  gate->capacity = cap;
+  return 0;
+}
+
+int risk_reserve(risk_gate_t* gate, agent_id_t owner)
+{
+  return owner < gate->capacity ? 0 : risk_grow(gate, owner);
+}
+
+static risk_reason_t risk_verdict(risk_gate_t* gate, const order_t* order, price_t reference,
+                                  timestamp_t now)
+{
+  const risk_limits_t* lim = &gate->limits;
+  if (order->qty <= 0 || (lim->max_order_qty && order->qty > lim->max_order_qty))
+    return RISK_REJECT_QTY;
+  if (lim->collar && order->type == ORDER_LIMIT && reference > 0 &&
+      (order->price > reference + lim->collar || order->price < reference - lim->collar))
+    return RISK_REJECT_COLLAR;
+
+  agent_id_t owner = order_owner(order->id);
+  if (risk_reserve(gate, owner) != 0)
+    return RISK_REJECT_ACCOUNT;
+  risk_account_t* a = &gate->accounts[owner];
+
+  if (lim->max_open_orders && a->open_orders >= lim->max_open_orders)
+    return RISK_REJECT_OPEN;
+  if (lim->max_position)
+  {
+    // Worst case: this order and every open one on its side fill
+    qty_t worst = (order->side == SIDE_BUY) ? a->position + a->open_buy + order->qty
+                                            : a->open_sell + order->qty - a->position;
+    if (worst > lim->max_position)
+      return RISK_REJECT_POSITION;
+  }
+  if (gate->interval)
+  {
+    // Lazy refill: the bucket has been filling since the last message
+    timestamp_t from = a->full_at > now ? a->full_at : now;
+    if (from + gate->interval - now > gate->window)
+      return RISK_REJECT_RATE;
+    a->full_at = from + gate->interval;
+  }
+  return RISK_OK;
+}
+
+risk_reason_t risk_check(risk_gate_t* gate, const order_t* order, price_t reference,
+                         timestamp_t now)
+{
+  risk_reason_t reason = risk_verdict(gate, order, reference, now);
+  gate->checked++;
+  if (reason != RISK_OK)
+    gate->rejected[reason]++;
+  return reason;
+}
+
+const char* risk_reason_name(risk_reason_t reason)
+{
+  static const char* names[RISK_REASONS] = {"ok", "qty", "collar", "position", "open", "rate",
+                                            "account"};
+  return reason < RISK_REASONS ? names[reason] : "unknown";
+}
+
+const risk_account_t* risk_account(const risk_gate_t* gate, agent_id_t owner)
+{
+  return (gate && owner < gate->capacity) ? &gate->accounts[owner] : NULL;
+}
+
+static int risk_fail(const char* token, const char* why)
+{
+  fprintf(stderr, "risk: %s: %s\n", token, why);
+  return -1;
+}
+
+int risk_parse_limits(risk_limits_t* limits, const char* spec)
+{
+  if (!limits || !spec)
+    return -1;
+  memset(limits, 0, sizeof *limits);
+
+  char* copy = strdup(spec);
+  if (!copy)
+    return -1;
+  int rc = 0;
+  char* save = NULL;
+  for (char* token = strtok_r(copy, ",", &save); token && rc == 0;
+       token = strtok_r(NULL, ",", &save))
+  {
+    char* eq = strchr(token, '=');
+    if (!eq)
+    {
+      rc = risk_fail(token, "expected name=value");
+      break;
+    }
+    *eq = '\0';
+    char* end;
+    errno = 0;
+    long long v = strtoll(eq + 1, &end, 10);
+    if (errno || end == eq + 1 || *end != '\0' || v < 0 || v > UINT32_MAX)
+    {
+      rc = risk_fail(token, "expected a count from 0 to 2^32-1");
+      break;
+    }
+
+    if (strcmp(token, "qty") == 0)
+      limits->max_order_qty = v;
+    else if (strcmp(token, "collar") == 0)
+      limits->collar = v;
+    else if (strcmp(token, "position") == 0)
+      limits->max_position = v;
+    else if (strcmp(token, "open") == 0)
+      limits->max_open_orders = (uint32_t)v;
+    else if (strcmp(token, "rate") == 0 && (uint64_t)v <= SIM_NS_PER_SEC)
+      limits->msg_rate = (uint64_t)v;
+    else if (strcmp(token, "burst") == 0)
+      limits->burst = (uint32_t)v;
+    else
+      rc = risk_fail(token, strcmp(token, "rate") == 0 ? "at most one per ns"
+                                                       : "unknown limit (qty collar position "
+                                                         "open rate burst)");
+  }
+  free(copy);
+  return rc;
+}
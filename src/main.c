@@ -6,21 +6,17 @@
 #include <time.h>
 #include <unistd.h>
 
-#include "agents/informed_trader.h"
-#include "agents/market_maker.h"
-#include "agents/noise_trader.h"
+#include "bench/latency.h"
 #include "core/book.h"
+#include "core/risk.h"
 #include "core/level_ops.h"
 #include "core/price_tree.h"
+#include "sim/checkpoint.h"
+#include "sim/runner.h"
 #include "sim/simulator.h"
 #include "sim/stats.h"
+#include "sim/sweep.h"
 
-#ifdef BENCHMARK
-#include "bench/latency.h"
-latency_tracker_t add_order_tracker;
-latency_tracker_t remove_order_tracker;
-latency_tracker_t match_order_tracker;
-#endif
 
 // Colors
 #define COLOR_RESET "\033[0m"
@@ -34,7 +30,9 @@ latency_tracker_t match_order_tracker;
 #define CLEAR_SCREEN() printf("\033[2J\033[H")
 
 #define MAX_DISPLAY_LEVELS 8
-#define MAX_AGENTS 100
+#define MAX_CLI_AGENTS 100
+#define MAX_CLI_AS_MM RUNNER_MAX_AS_MM
+#define MAX_CLI_OU_INFORMED RUNNER_MAX_OU_INFORMED
 
 // Configuration
 typedef struct
@@ -42,23 +40,27 @@ typedef struct
   int num_noise;
   int num_mm;
   int num_informed;
+  int num_as_mm;  // Avellaneda-Stoikov market makers
+  int num_ou_informed; // informed traders sharing one OU fair value
+  int num_momentum;       // trend followers on the book's indicators
+  int num_mean_reversion; // mean reverters on the book's indicators
+  int crowd_size; // noise traders simulated as one vectorized crowd agent
   int total_ticks;
   int visual_mode;
+  int runs;    // > 0 selects Monte Carlo runner mode
+  int threads; // runner workers, 0 = all cores
+  int scaling; // runner: repeat the batch from 1 thread up to all cores
+  int agent_threads; // > 0: two-phase ticks, agents decide in parallel
+  double latency;    // mean one-way network delay per agent, in ticks (fractions allowed); 0 = none
+  const char* save_path;    // checkpoint written after the run
+  const char* restore_path; // checkpoint to resume from; runs total_ticks more
+  const char* sweep_spec;   // parameter grid; selects sweep mode
+  const char* sweep_path;   // sweep output file
+  const char* risk_spec;    // pre-trade limits every order must pass
+  uint64_t seed;
+  int has_seed; // 0: seed from the wall clock
 } config_t;
 
-// Helper to count orders in a level
-static size_t count_orders(price_level_t* lvl)
-{
-  size_t count = 0;
-  order_node_t* node = lvl->head;
-  while (node)
-  {
-    count++;
-    node = node->next;
-  }
-  return count;
-}
-
 static void print_usage(const char* program)
 {
   printf("\n");
@@ -70,14 +72,53 @@ static void print_usage(const char* program)
   printf("  -n, --noise NUM       Number of noise traders (default: 5)\n");
   printf("  -m, --mm NUM          Number of market makers (default: 2)\n");
   printf("  -i, --informed NUM    Number of informed traders (default: 2)\n");
-  printf("  -t, --ticks NUM       Total simulation ticks (default: 5000)\n");
+  printf("  -a, --as-mm NUM       Avellaneda-Stoikov market makers, up to %d (default: 0)\n",
+         MAX_CLI_AS_MM);
+  printf("  -O, --ou-informed NUM Informed traders reading one shared Ornstein-Uhlenbeck\n"
+         "                        fair value, up to %d (default: 0)\n",
+         MAX_CLI_OU_INFORMED);
+  printf("  -u, --momentum NUM    Momentum traders on shared fill-price EMAs (default: 0)\n");
+  printf("  -v, --mean-reversion NUM\n"
+         "                        Mean-reversion traders on shared rolling mean, low and\n"
+         "                        high of fill prices (default: 0)\n");
+  printf("  -c, --crowd NUM       Noise traders simulated as one vectorized crowd (default: 0)\n");
+  printf("  -t, --ticks NUM       Total simulation ticks of 1us (default: 5000)\n");
+  printf("  -s, --seed NUM        RNG seed; same seed, same run (default: time)\n");
   printf("  -q, --quiet           Quiet mode (no progress bar)\n");
-  printf("  -h, --help            Show this help message\n");
+  printf("  -r, --runs NUM        Monte Carlo mode: NUM independent runs, summary only\n");
+  printf("  -T, --threads NUM     Worker threads for --runs (default: all cores)\n");
+  printf("  -S, --scaling         With --runs, report runs/sec from 1 thread to all cores\n");
+  printf("  -A, --agent-threads N Agents woken together decide in parallel on N threads,\n"
+         "                        then enter the book in agent id order (default: off)\n");
+  printf("  -L, --latency TICKS   Mean one-way network delay of every agent, exponential;\n"
+         "                        drawn to the nanosecond; orders, reports and market data\n"
+         "                        all travel (default: 0)\n");
+  printf("  -w, --sweep GRID      Sweep mode: run every point of GRID (--runs seeds each) on a\n"
+         "                        work-stealing pool, e.g. \"noise=10,20 mm=1:4 ticks=5000\".\n"
+         "                        Axes: %s\n",
+         sweep_axis_names());
+  printf("  -W, --sweep-out FILE  Columnar sweep results (default: sweep.out)\n");
+  printf("  -k, --risk LIMITS     Pre-trade risk gate on every order entering the book, e.g.\n"
+         "                        \"qty=50,collar=100,position=500,open=20,rate=50000,burst=8\"\n"
+         "                        (rate: orders per second of sim time per agent); single runs\n");
+  printf("  -o, --save FILE       Write a checkpoint of the whole simulation after the run\n");
+  printf("  -R, --restore FILE    Resume from a checkpoint taken with the same agent options,\n"
+         "                        then run --ticks more ticks\n");
+  printf("  -h, --help           Show this help message\n");
   printf("\n");
   printf("Examples:\n");
   printf("  %s                    Run with defaults\n", program);
   printf("  %s -n 10 -m 3 -i 1    10 noise, 3 MM, 1 informed\n", program);
   printf("  %s -t 100000 -q       Fast benchmark (100k ticks)\n", program);
+  printf("  %s --seed 42         Reproducible run\n", program);
+  printf("  %s -r 200 -S          200 seeds, with a thread scaling report\n", program);
+  printf("  %s -s 7 -o warm.ckpt  Warm up once, then resume with -s 7 -R warm.ckpt\n", program);
+  printf("  %s -s 7 -k open=5,rate=100000\n"
+         "                        At most 5 resting orders and 1 order per 10us per agent\n",
+         program);
+  printf("  %s -w \"noise=5:50:5 ticks=10000,50000\" -r 4\n"
+         "                        Sweep 20 grid points, 4 seeds each\n",
+         program);
   printf("\n");
 }
 
@@ -93,53 +134,22 @@ static void print_book(order_book_t* book, config_t* cfg, int tick)
   printf(COLOR_BOLD "       BIDS (Buyers)             ASKS (Sellers)\n" COLOR_RESET);
   printf("       ─────────────────────────────────────────────────\n");
 
-  // Collect ask prices (lowest first)
-  price_t ask_prices[MAX_DISPLAY_LEVELS];
-  int num_asks = 0;
-  price_level_t* lvl = pt_min(&book->asks);
-  while (lvl && num_asks < MAX_DISPLAY_LEVELS)
-  {
-    ask_prices[num_asks++] = lvl->price;
-    price_level_t* next = NULL;
-    price_t search = lvl->price + 1;
-    while (search < lvl->price + 1000 && !next)
-    {
-      next = pt_find(&book->asks, search++);
-    }
-    lvl = next;
-  }
+  // L2 snapshot straight from the book's top-of-book cache
+  depth_entry_t asks[MAX_DISPLAY_LEVELS];
+  depth_entry_t bids[MAX_DISPLAY_LEVELS];
+  int num_asks = (int)book_top_levels(book, SIDE_SELL, asks, MAX_DISPLAY_LEVELS);
+  int num_bids = (int)book_top_levels(book, SIDE_BUY, bids, MAX_DISPLAY_LEVELS);
 
   // Print asks (high to low for display)
   for (int i = num_asks - 1; i >= 0; i--)
   {
-    lvl = pt_find(&book->asks, ask_prices[i]);
-    if (lvl)
-    {
-      printf(COLOR_RED
-             "                                    %4ld @ %-6ld [%zu orders]\n" COLOR_RESET,
-             lvl->total_qty, lvl->price, count_orders(lvl));
-    }
-  }
-
-  // Collect bid prices (highest first)
-  price_t bid_prices[MAX_DISPLAY_LEVELS];
-  int num_bids = 0;
-  lvl = pt_max(&book->bids);
-  while (lvl && num_bids < MAX_DISPLAY_LEVELS)
-  {
-    bid_prices[num_bids++] = lvl->price;
-    price_level_t* next = NULL;
-    price_t search = lvl->price - 1;
-    while (search > lvl->price - 1000 && search > 0 && !next)
-    {
-      next = pt_find(&book->bids, search--);
-    }
-    lvl = next;
+    printf(COLOR_RED "                                    %4ld @ %-6ld [%zu orders]\n" COLOR_RESET,
+           asks[i].qty, asks[i].price, asks[i].count);
   }
 
   // Calculate spread
-  price_t best_bid = num_bids > 0 ? bid_prices[0] : 0;
-  price_t best_ask = num_asks > 0 ? ask_prices[0] : 0;
+  price_t best_bid = num_bids > 0 ? bids[0].price : 0;
+  price_t best_ask = num_asks > 0 ? asks[0].price : 0;
   price_t spread = (best_bid && best_ask) ? best_ask - best_bid : 0;
   price_t mid_price = (best_bid && best_ask) ? (best_bid + best_ask) / 2 : 0;
 
@@ -150,12 +160,8 @@ static void print_book(order_book_t* book, config_t* cfg, int tick)
   // Print bids (high to low)
   for (int i = 0; i < num_bids; i++)
   {
-    lvl = pt_find(&book->bids, bid_prices[i]);
-    if (lvl)
-    {
-      printf(COLOR_GREEN "          %4ld @ %-6ld [%zu orders]\n" COLOR_RESET, lvl->total_qty,
-             lvl->price, count_orders(lvl));
-    }
+    printf(COLOR_GREEN "          %4ld @ %-6ld [%zu orders]\n" COLOR_RESET, bids[i].qty,
+           bids[i].price, bids[i].count);
   }
 
   printf("\n       ─────────────────────────────────────────────────\n");
@@ -164,13 +170,24 @@ static void print_book(order_book_t* book, config_t* cfg, int tick)
   printf(COLOR_MAGENTA "       🎲 Noise Traders: %d\n" COLOR_RESET, cfg->num_noise);
   printf(COLOR_BLUE "       🏦 Market Makers: %d\n" COLOR_RESET, cfg->num_mm);
   printf(COLOR_YELLOW "       🧠 Informed Traders: %d\n" COLOR_RESET, cfg->num_informed);
+  if (cfg->num_as_mm > 0)
+    printf(COLOR_BLUE "       📐 A-S Market Makers: %d\n" COLOR_RESET, cfg->num_as_mm);
+  if (cfg->num_ou_informed > 0)
+    printf(COLOR_YELLOW "       🌊 OU Informed Traders: %d\n" COLOR_RESET, cfg->num_ou_informed);
+  if (cfg->num_momentum > 0)
+    printf(COLOR_GREEN "       🚀 Momentum Traders: %d\n" COLOR_RESET, cfg->num_momentum);
+  if (cfg->num_mean_reversion > 0)
+    printf(COLOR_GREEN "       🔁 Mean Reversion Traders: %d\n" COLOR_RESET, cfg->num_mean_reversion);
+  if (cfg->crowd_size > 0)
+    printf(COLOR_MAGENTA "       👥 Crowd Traders: %d\n" COLOR_RESET, cfg->crowd_size);
   printf("\n");
   printf(COLOR_CYAN "       📈 Mid Price: %ld\n" COLOR_RESET, mid_price);
   printf(COLOR_CYAN "       📊 Best Bid: %ld | Best Ask: %ld\n" COLOR_RESET, best_bid, best_ask);
   printf(COLOR_CYAN "\n       ⏱  Tick %d/%d\n\n" COLOR_RESET, tick, cfg->total_ticks);
 }
 
-static void print_final_stats(order_book_t* book, config_t* cfg, double elapsed_sec)
+static void print_final_stats(order_book_t* book, const simulator_t* sim, config_t* cfg,
+                              double elapsed_sec)
 {
   price_level_t* bid_lvl = pt_max(&book->bids);
   price_level_t* ask_lvl = pt_min(&book->asks);
@@ -180,7 +197,7 @@ static void print_final_stats(order_book_t* book, config_t* cfg, double elapsed_
   price_t spread = (best_bid && best_ask) ? best_ask - best_bid : 0;
   price_t mid_price = (best_bid && best_ask) ? (best_bid + best_ask) / 2 : 0;
 
-  market_stats_t stats = stats_snapshot();
+  market_stats_t stats = stats_snapshot(&book->stats);
 
   printf("\n");
   printf(COLOR_CYAN COLOR_BOLD);
@@ -201,28 +218,202 @@ static void print_final_stats(order_book_t* book, config_t* cfg, double elapsed_
          "📊 Best Bid:", best_bid,
          "📦 Total Volume:", stats.volume,
          "🚀 Ticks/Second:", cfg->total_ticks / elapsed_sec);
-  printf("%-22s %-6d | %-22s %-6ld | %-22s %-8s | %-22s %-8s\n",
+  printf("%-22s %-6d | %-22s %-6ld | %-22s %-8s | %-22s %-8.0f\n",
          "🧠 Informed Traders:", cfg->num_informed,
          "📊 Best Ask:", best_ask,
          "", "",
-         "", "");
-  printf("%-22s %-8d | %-22s %-6ld | %-22s %-8s | %-22s %-8s\n",
+         "⚡ Events/Second:", simulator_events_processed(sim) / elapsed_sec);
+  printf("%-22s %-8d | %-22s %-6ld | %-22s %-8lu | %-22s %-8s\n",
          "⏱  Total Ticks:", cfg->total_ticks,
          "📏 Spread:", spread,
-         "", "",
+         "🌱 Seed:", (unsigned long)cfg->seed,
          "", "");
 
   printf("\n");
   printf(COLOR_GREEN "  ✓ Simulation completed successfully!\n\n" COLOR_RESET);
 }
 
-int main(int argc, char* argv[])
+static void print_risk(const risk_gate_t* gate)
+{
+  uint64_t rejected = 0;
+  for (int r = RISK_OK + 1; r < RISK_REASONS; r++)
+    rejected += gate->rejected[r];
+  printf("  Risk gate: %lu orders checked, %lu rejected", (unsigned long)gate->checked,
+         (unsigned long)rejected);
+  for (int r = RISK_OK + 1; r < RISK_REASONS; r++)
+  {
+    if (gate->rejected[r])
+      printf(" | %s %lu", risk_reason_name((risk_reason_t)r), (unsigned long)gate->rejected[r]);
+  }
+  printf("\n\n");
+}
+
+static int cmp_double(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+// Mean and 5/50/95th percentiles of one per-run metric (sorts `v`)
+static void print_distribution(const char* name, double* v, size_t n)
+{
+  double sum = 0.0;
+  for (size_t i = 0; i < n; i++)
+    sum += v[i];
+  qsort(v, n, sizeof *v, cmp_double);
+  printf("%-14s | %12.2f | %12.2f | %12.2f | %12.2f\n", name, sum / n, v[(size_t)(0.05 * (n - 1))],
+         v[(size_t)(0.50 * (n - 1))], v[(size_t)(0.95 * (n - 1))]);
+}
+
+static void print_runner_report(runner_report_t* report)
 {
+  // Distributions over the runs that ran; failed ones have no results
+  size_t n = report->runs - report->failed;
+  run_result_t* ran = malloc(n * sizeof *ran);
+  double* v = malloc(n * sizeof *v);
+  if (!ran || !v)
+  {
+    free(ran);
+    free(v);
+    return;
+  }
+  for (size_t r = 0, i = 0; r < report->runs; r++)
+  {
+    if (!report->results[r].failed)
+      ran[i++] = report->results[r];
+  }
+
+  printf("\n%zu runs on %d threads in %.2fs (%.1f runs/sec)\n", report->runs, report->threads,
+         report->elapsed_sec, report->runs / report->elapsed_sec);
+  if (report->failed)
+    printf("%zu runs could not be set up and are left out\n", report->failed);
+  printf("\n");
+  printf("%-14s | %12s | %12s | %12s | %12s\n", "Metric", "Mean", "p5", "p50", "p95");
+  printf("-----------------------------------------------------------------------------\n");
+  for (size_t i = 0; i < n; i++)
+    v[i] = ran[i].stats.spread;
+  print_distribution("Final spread", v, n);
+  for (size_t i = 0; i < n; i++)
+    v[i] = ran[i].stats.mid_price;
+  print_distribution("Final mid", v, n);
+  for (size_t i = 0; i < n; i++)
+    v[i] = (double)ran[i].stats.volume;
+  print_distribution("Volume", v, n);
+  for (size_t i = 0; i < n; i++)
+    v[i] = (double)ran[i].stats.trade_count;
+  print_distribution("Trades", v, n);
+  free(ran);
+  free(v);
+
+  printf("\nTotal: %zu trades, %ld volume\n", report->merged.trade_count, report->merged.volume);
+
 #ifdef BENCHMARK
-  latency_init(&add_order_tracker);
-  latency_init(&remove_order_tracker);
-  latency_init(&match_order_tracker);
+  printf("\n%-14s | %-14s | %-16s | %-12s\n", "Merged (hist)", "book_add_order", "book_remove_order", "match_order");
+  printf("---------------------------------------------------------------\n");
+  printf("%-14s | %-14zu | %-16zu | %-12zu\n", "Count", report->add_latency.count, report->remove_latency.count, report->match_latency.count);
+  printf("%-14s | %-14.2f | %-16.2f | %-12.2f\n", "Mean (ns)",
+         latency_mean(&report->add_latency), latency_mean(&report->remove_latency), latency_mean(&report->match_latency));
+  printf("%-14s | %-14lu | %-16lu | %-12lu\n", "p50 (ns)",
+         latency_hist_percentile(&report->add_latency, 0.50),
+         latency_hist_percentile(&report->remove_latency, 0.50),
+         latency_hist_percentile(&report->match_latency, 0.50));
+  printf("%-14s | %-14lu | %-16lu | %-12lu\n", "p99 (ns)",
+         latency_hist_percentile(&report->add_latency, 0.99),
+         latency_hist_percentile(&report->remove_latency, 0.99),
+         latency_hist_percentile(&report->match_latency, 0.99));
 #endif
+}
+
+// The command line's agents and run length as a scenario, the per-job
+// configuration of the runner and of sweeps
+static scenario_t config_scenario(const config_t* cfg, uint64_t seed)
+{
+  return (scenario_t){.num_noise = cfg->num_noise,
+                      .num_mm = cfg->num_mm,
+                      .num_informed = cfg->num_informed,
+                      .num_as_mm = cfg->num_as_mm,
+                      .num_ou_informed = cfg->num_ou_informed,
+                      .num_momentum = cfg->num_momentum,
+                      .num_mean_reversion = cfg->num_mean_reversion,
+                      .crowd_size = (size_t)cfg->crowd_size,
+                      .ticks = (timestamp_t)cfg->total_ticks,
+                      .seed = seed};
+}
+
+static int run_sweep(const config_t* cfg, uint64_t seed)
+{
+  scenario_t base = config_scenario(cfg, seed);
+  size_t runs = cfg->runs > 0 ? (size_t)cfg->runs : 1;
+  static sweep_t sweep; // the grid is sizeable
+  if (sweep_parse(&sweep, &base, runs, cfg->sweep_spec) != 0)
+    return 1;
+
+  const char* path = cfg->sweep_path ? cfg->sweep_path : "sweep.out";
+  int threads = cfg->threads > 0 ? cfg->threads : runner_core_count();
+  size_t jobs = sweep_job_count(&sweep);
+  printf("Sweeping %zu grid points x %zu runs = %zu jobs (seed %lu)...\n", jobs / runs, runs, jobs,
+         (unsigned long)seed);
+
+  sweep_report_t report;
+  if (sweep_run(&sweep, threads, path, &report) != 0)
+  {
+    fprintf(stderr, "Error: sweep failed\n");
+    return 1;
+  }
+  size_t trades = 0;
+  for (size_t j = 0; j < report.jobs; j++)
+    trades += report.results[j].stats.trade_count; // zero for a failed job
+  printf("\n%zu jobs on %d threads in %.2fs (%.1f jobs/sec), %lu stolen\n", report.jobs,
+         report.threads, report.elapsed_sec, report.jobs / report.elapsed_sec,
+         (unsigned long)report.steals);
+  if (report.failed)
+    printf("%zu jobs could not be set up and have no row\n", report.failed);
+  printf("Total: %zu trades; results in %s\n", trades, path);
+  sweep_report_free(&report);
+  return 0;
+}
+
+static int run_monte_carlo(const config_t* cfg, uint64_t seed)
+{
+  scenario_t sc = config_scenario(cfg, seed);
+  int cores = runner_core_count();
+  int threads = cfg->threads > 0 ? cfg->threads : cores;
+  runner_report_t report;
+
+  printf("Running %d simulations of %d ticks (seed %lu)...\n", cfg->runs, cfg->total_ticks,
+         (unsigned long)seed);
+  if (runner_run(&sc, (size_t)cfg->runs, threads, &report) != 0)
+  {
+    fprintf(stderr, "Error: runner failed\n");
+    return 1;
+  }
+  print_runner_report(&report);
+  runner_report_free(&report);
+
+  if (cfg->scaling)
+  {
+    printf("\n%-8s | %-12s | %-8s\n", "Threads", "Runs/sec", "Speedup");
+    printf("-------------------------------\n");
+    double base = 0.0;
+    for (int t = 1;; t = (t * 2 > cores && t < cores) ? cores : t * 2)
+    {
+      if (runner_run(&sc, (size_t)cfg->runs, t, &report) != 0)
+        return 1;
+      double rate = report.runs / report.elapsed_sec;
+      if (t == 1)
+        base = rate;
+      printf("%-8d | %-12.1f | %-8.2f\n", t, rate, rate / base);
+      runner_report_free(&report);
+      if (t >= cores)
+        break;
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char* argv[])
+{
   // Default configuration
   config_t cfg = {
       .num_noise = 5, .num_mm = 2, .num_informed = 2, .total_ticks = 5000, .visual_mode = 1};
@@ -231,13 +422,29 @@ int main(int argc, char* argv[])
   static struct option long_options[] = {{"noise", required_argument, 0, 'n'},
                                          {"mm", required_argument, 0, 'm'},
                                          {"informed", required_argument, 0, 'i'},
+                                         {"as-mm", required_argument, 0, 'a'},
+                                         {"ou-informed", required_argument, 0, 'O'},
+                                         {"momentum", required_argument, 0, 'u'},
+                                         {"mean-reversion", required_argument, 0, 'v'},
+                                         {"crowd", required_argument, 0, 'c'},
                                          {"ticks", required_argument, 0, 't'},
+                                         {"seed", required_argument, 0, 's'},
                                          {"quiet", no_argument, 0, 'q'},
+                                         {"runs", required_argument, 0, 'r'},
+                                         {"threads", required_argument, 0, 'T'},
+                                         {"scaling", no_argument, 0, 'S'},
+                                         {"agent-threads", required_argument, 0, 'A'},
+                                         {"latency", required_argument, 0, 'L'},
+                                         {"sweep", required_argument, 0, 'w'},
+                                         {"sweep-out", required_argument, 0, 'W'},
+                                         {"risk", required_argument, 0, 'k'},
+                                         {"save", required_argument, 0, 'o'},
+                                         {"restore", required_argument, 0, 'R'},
                                          {"help", no_argument, 0, 'h'},
                                          {0, 0, 0, 0}};
 
   int opt;
-  while ((opt = getopt_long(argc, argv, "n:m:i:t:qh", long_options, NULL)) != -1)
+  while ((opt = getopt_long(argc, argv, "n:m:i:a:O:u:v:c:t:s:qr:T:SA:L:w:W:k:o:R:h", long_options, NULL)) != -1)
   {
     switch (opt)
     {
@@ -250,12 +457,61 @@ int main(int argc, char* argv[])
     case 'i':
       cfg.num_informed = atoi(optarg);
       break;
+    case 'a':
+      cfg.num_as_mm = atoi(optarg);
+      break;
+    case 'O':
+      cfg.num_ou_informed = atoi(optarg);
+      break;
+    case 'u':
+      cfg.num_momentum = atoi(optarg);
+      break;
+    case 'v':
+      cfg.num_mean_reversion = atoi(optarg);
+      break;
+    case 'c':
+      cfg.crowd_size = atoi(optarg);
+      break;
     case 't':
       cfg.total_ticks = atoi(optarg);
       break;
+    case 's':
+      cfg.seed = strtoull(optarg, NULL, 10);
+      cfg.has_seed = 1;
+      break;
     case 'q':
       cfg.visual_mode = 0;
       break;
+    case 'r':
+      cfg.runs = atoi(optarg);
+      break;
+    case 'T':
+      cfg.threads = atoi(optarg);
+      break;
+    case 'S':
+      cfg.scaling = 1;
+      break;
+    case 'A':
+      cfg.agent_threads = atoi(optarg);
+      break;
+    case 'L':
+      cfg.latency = atof(optarg);
+      break;
+    case 'w':
+      cfg.sweep_spec = optarg;
+      break;
+    case 'W':
+      cfg.sweep_path = optarg;
+      break;
+    case 'k':
+      cfg.risk_spec = optarg;
+      break;
+    case 'o':
+      cfg.save_path = optarg;
+      break;
+    case 'R':
+      cfg.restore_path = optarg;
+      break;
     case 'h':
       print_usage(argv[0]);
       return 0;
@@ -266,14 +522,33 @@ int main(int argc, char* argv[])
   }
 
   // Validate configuration
-  if (cfg.num_noise < 0 || cfg.num_mm < 0 || cfg.num_informed < 0)
+  if (cfg.num_noise < 0 || cfg.num_mm < 0 || cfg.num_informed < 0 || cfg.num_as_mm < 0 ||
+      cfg.num_ou_informed < 0 || cfg.num_momentum < 0 || cfg.num_mean_reversion < 0 ||
+      cfg.crowd_size < 0)
   {
     fprintf(stderr, "Error: Agent counts must be non-negative\n");
     return 1;
   }
-  if (cfg.num_noise + cfg.num_mm + cfg.num_informed > MAX_AGENTS)
+  if (cfg.num_noise + cfg.num_mm + cfg.num_informed + cfg.num_momentum + cfg.num_mean_reversion >
+      MAX_CLI_AGENTS)
+  {
+    fprintf(stderr, "Error: Total agents cannot exceed %d\n", MAX_CLI_AGENTS);
+    return 1;
+  }
+  if (cfg.num_as_mm > MAX_CLI_AS_MM)
+  {
+    fprintf(stderr, "Error: A-S market makers cannot exceed %d\n", MAX_CLI_AS_MM);
+    return 1;
+  }
+  if (cfg.num_ou_informed > MAX_CLI_OU_INFORMED)
+  {
+    fprintf(stderr, "Error: OU informed traders cannot exceed %d\n", MAX_CLI_OU_INFORMED);
+    return 1;
+  }
+  scenario_t layout = config_scenario(&cfg, 0);
+  if (runner_scenario_check(&layout) != 0)
   {
-    fprintf(stderr, "Error: Total agents cannot exceed %d\n", MAX_AGENTS);
+    fprintf(stderr, "Error: Agent counts overlap another type's ids\n");
     return 1;
   }
   if (cfg.total_ticks <= 0)
@@ -281,40 +556,102 @@ int main(int argc, char* argv[])
     fprintf(stderr, "Error: Total ticks must be positive\n");
     return 1;
   }
+  if (cfg.latency < 0)
+  {
+    fprintf(stderr, "Error: Latency must be non-negative\n");
+    return 1;
+  }
+  if (cfg.runs < 0 || cfg.threads < 0 || cfg.agent_threads < 0)
+  {
+    fprintf(stderr, "Error: Runs and threads must be non-negative\n");
+    return 1;
+  }
 
-  // Initialize book and simulator
-  order_book_t book;
-  book_init(&book);
-  simulator_init(&book);
+  // The gate's accounts are not in checkpoints and the runner has no book option
+  risk_limits_t limits;
+  if (cfg.risk_spec && (cfg.runs > 0 || cfg.sweep_spec || cfg.restore_path))
+  {
+    fprintf(stderr, "Error: --risk applies to a single fresh run\n");
+    return 1;
+  }
+  if (cfg.risk_spec && risk_parse_limits(&limits, cfg.risk_spec) != 0)
+  {
+    fprintf(stderr, "Error: bad --risk limits\n");
+    return 1;
+  }
 
-  // Create agent arrays
-  agent_t** noise_agents = malloc(cfg.num_noise * sizeof(agent_t*));
-  agent_t** mm_agents = malloc(cfg.num_mm * sizeof(agent_t*));
-  agent_t** informed_agents = malloc(cfg.num_informed * sizeof(agent_t*));
+  uint64_t seed = cfg.has_seed ? cfg.seed : (uint64_t)time(NULL);
+  cfg.seed = seed;
 
-  // Add noise traders (IDs 1-N)
-  for (int i = 0; i < cfg.num_noise; ++i)
+  if (cfg.sweep_spec)
+  {
+    return run_sweep(&cfg, seed);
+  }
+  if (cfg.runs > 0)
   {
-    noise_agents[i] = noise_trader_create(i + 1);
-    simulator_add_agent(noise_agents[i]);
+    return run_monte_carlo(&cfg, seed);
   }
 
-  // Add market makers (IDs 100+)
-  for (int i = 0; i < cfg.num_mm; ++i)
+  // Initialize book and simulator
+  order_book_t book;
+  if (book_init(&book) != 0)
   {
-    mm_agents[i] = market_maker_create(100 + i);
-    simulator_add_agent(mm_agents[i]);
+    fprintf(stderr, "Error: could not allocate the order book\n");
+    return 1;
+  }
+  simulator_t* sim = simulator_init(&book);
+  risk_gate_t gate;
+  if (cfg.risk_spec)
+  {
+    if (risk_init(&gate, &limits) != 0)
+    {
+      fprintf(stderr, "Error: bad --risk limits\n");
+      return 1;
+    }
+    book.risk = &gate;
+  }
+  if (cfg.agent_threads > 0 &&
+      simulator_set_parallel(sim, cfg.agent_threads, SEQUENCE_BY_ID, seed) != 0)
+  {
+    fprintf(stderr, "Error: could not start %d agent threads\n", cfg.agent_threads);
+    return 1;
   }
 
-  // Add informed traders (IDs 200+)
-  for (int i = 0; i < cfg.num_informed; ++i)
+  // Agents, one group per type in the runner's id layout (runner.h). The OU
+  // fair value and the book's indicators are shared by their readers and
+  // outlive them.
+  scenario_t scenario = config_scenario(&cfg, seed);
+  runner_agents_t agents;
+  if (runner_build_agents(&agents, &scenario, sim, seed) != 0)
+    return 1;
+
+  // Network: every agent gets its own link with the same delay distribution
+  if (cfg.latency > 0)
   {
-    informed_agents[i] = informed_trader_create(200 + i);
-    simulator_add_agent(informed_agents[i]);
+    latency_dist_t delay = {.kind = LATENCY_EXPONENTIAL, .base = 0, .spread = cfg.latency * SIM_TICK_NS};
+    for (size_t i = 0; i < sim->agent_count; i++)
+    {
+      if (simulator_set_latency(sim, sim->agents[i], &delay, &delay, seed) != 0)
+      {
+        fprintf(stderr, "Error: could not set up agent latency\n");
+        return 1;
+      }
+    }
+  }
+
+  // Resume: the book, clock, queue and agent states come from the file
+  checkpoint_t* ckpt = NULL;
+  timestamp_t resume_at = 0;
+  if (cfg.restore_path)
+  {
+    ckpt = checkpoint_restore(sim, cfg.restore_path);
+    if (!ckpt)
+      return 1;
+    resume_at = sim_time_now(&sim->clock);
   }
 
   // Start timer
-  clock_t start_time = clock();
+  uint64_t start_time = time_now_ns();
 
   // Run simulation with progress bar
   if (cfg.visual_mode)
@@ -330,7 +667,7 @@ int main(int argc, char* argv[])
       int end = t + step;
       if (end > cfg.total_ticks)
         end = cfg.total_ticks;
-      simulator_run(end);
+      simulator_run(sim, resume_at + sim_ticks_to_ns((timestamp_t)end));
 
       // Progress bar
       int progress = (int)((double)end / cfg.total_ticks * bar_width);
@@ -351,66 +688,57 @@ int main(int argc, char* argv[])
   {
     // Quiet mode - just run
     printf("Running simulation...\n");
-    simulator_run(cfg.total_ticks);
+    simulator_run(sim, resume_at + sim_ticks_to_ns((timestamp_t)cfg.total_ticks));
   }
 
   // Stop timer
-  clock_t end_time = clock();
-  double elapsed_sec = (double)(end_time - start_time) / CLOCKS_PER_SEC;
+  // Wall clock: with agent threads, CPU time would count every core
+  double elapsed_sec = (double)(time_now_ns() - start_time) / 1e9;
 
   // Print final book state
   print_book(&book, &cfg, cfg.total_ticks);
 
   // Print final stats
-  print_final_stats(&book, &cfg, elapsed_sec);
+  print_final_stats(&book, sim, &cfg, elapsed_sec);
+  if (book.risk)
+    print_risk(book.risk);
 
 #ifdef BENCHMARK
   printf("\n%-14s | %-14s | %-16s | %-12s\n", "Metric", "book_add_order", "book_remove_order", "match_order");
   printf("---------------------------------------------------------------\n");
-  printf("%-14s | %-14zu | %-16zu | %-12zu\n", "Count", add_order_tracker.count, remove_order_tracker.count, match_order_tracker.count);
-  printf("%-14s | %-14lu | %-16lu | %-12lu\n", "Min (ns)", add_order_tracker.min_ns, remove_order_tracker.min_ns, match_order_tracker.min_ns);
-  printf("%-14s | %-14lu | %-16lu | %-12lu\n", "Max (ns)", add_order_tracker.max_ns, remove_order_tracker.max_ns, match_order_tracker.max_ns);
+  printf("%-14s | %-14zu | %-16zu | %-12zu\n", "Count", book.add_latency.count, book.remove_latency.count, book.match_latency.count);
+  printf("%-14s | %-14lu | %-16lu | %-12lu\n", "Min (ns)", book.add_latency.min_ns, book.remove_latency.min_ns, book.match_latency.min_ns);
+  printf("%-14s | %-14lu | %-16lu | %-12lu\n", "Max (ns)", book.add_latency.max_ns, book.remove_latency.max_ns, book.match_latency.max_ns);
   printf("%-14s | %-14.2f | %-16.2f | %-12.2f\n", "Mean (ns)",
-         latency_mean(&add_order_tracker), latency_mean(&remove_order_tracker), latency_mean(&match_order_tracker));
+         latency_mean(&book.add_latency), latency_mean(&book.remove_latency), latency_mean(&book.match_latency));
   printf("%-14s | %-14lu | %-16lu | %-12lu\n", "p50 (ns)",
-         latency_percentile(&add_order_tracker, 0.50),
-         latency_percentile(&remove_order_tracker, 0.50),
-         latency_percentile(&match_order_tracker, 0.50));
+         latency_percentile(&book.add_latency, 0.50),
+         latency_percentile(&book.remove_latency, 0.50),
+         latency_percentile(&book.match_latency, 0.50));
   printf("%-14s | %-14lu | %-16lu | %-12lu\n", "p99 (ns)",
-         latency_percentile(&add_order_tracker, 0.99),
-         latency_percentile(&remove_order_tracker, 0.99),
-         latency_percentile(&match_order_tracker, 0.99));
+         latency_percentile(&book.add_latency, 0.99),
+         latency_percentile(&book.remove_latency, 0.99),
+         latency_percentile(&book.match_latency, 0.99));
 
   // Optionally keep the detailed prints below the table:
-  //   latency_print(&add_order_tracker, "book_add_order");
-  //   latency_print(&remove_order_tracker, "book_remove_order");
-  //   latency_print(&match_order_tracker, "match_order");
-
-  latency_free(&add_order_tracker);
-  latency_free(&remove_order_tracker);
-  latency_free(&match_order_tracker);
+  //   latency_print(&book.add_latency, "book_add_order");
+  //   latency_print(&book.remove_latency, "book_remove_order");
+  //   latency_print(&book.match_latency, "match_order");
 #endif
 
-  // Cleanup
-  for (int i = 0; i < cfg.num_noise; i++)
-  {
-    noise_trader_destroy(noise_agents[i]);
-  }
-  for (int i = 0; i < cfg.num_mm; i++)
-  {
-    market_maker_destroy(mm_agents[i]);
-  }
-  for (int i = 0; i < cfg.num_informed; i++)
+  if (cfg.save_path && checkpoint_save(sim, cfg.save_path) != 0)
   {
-    informed_trader_destroy(informed_agents[i]);
+    perror(cfg.save_path);
   }
 
-  free(noise_agents);
-  free(mm_agents);
-  free(informed_agents);
+  // Cleanup: the simulator first, it owns the agents' network links
+  simulator_free(sim);
+  runner_agents_free(&agents);
+  if (book.risk)
+    risk_free(book.risk);
 
-  simulator_free();
   book_free(&book);
+  checkpoint_close(ckpt); // restored orders live in the mapping
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,573 @@
+#define _DEFAULT_SOURCE
+#include "sim/checkpoint.h"
+#include "sim/indicators.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CKPT_MAGIC 0x31544B43424F4C00ULL /* "\0LOBCKT1" */
+#define CKPT_VERSION 6
+#define CKPT_ALIGN 8
+
+/* ---- File layout: header, then each array at its own 8-aligned offset ---- */
+
+typedef struct
+{
+  price_t price;
+  int64_t side;
+  uint64_t first; // index of the level's first order in the order array
+  uint64_t count;
+  qty_t enqueued_qty;
+  qty_t dequeued_qty;
+} ckpt_level_t;
+
+typedef struct
+{
+  order_t order; // the restored book points straight at this
+  qty_t entry_offset;
+} ckpt_order_t;
+
+typedef struct
+{
+  agent_id_t id;
+  uint64_t has_link;
+  net_link_t link;
+  agent_interest_t interest;
+  timestamp_t wake_at; // its live wakeup; other queued ones are stale
+  uint64_t state_offset;
+  uint64_t state_len; // 0: the agent saved nothing
+} ckpt_agent_t;
+
+typedef struct
+{
+  timestamp_t ts;
+  uint64_t seq; // only orders the queue's ties; renumbered on restore
+  uint64_t type;
+  uint64_t agent_index; // EVENT_WAKEUP: position in the simulator's agent list
+  order_t order;        // EVENT_ORDER
+  order_id_t cancel_id; // EVENT_CANCEL
+  event_amend_t amend;  // EVENT_AMEND
+  exec_report_t report; // EVENT_EXEC
+} ckpt_event_t;
+
+typedef struct
+{
+  uint64_t magic;
+  uint32_t version;
+  uint32_t header_size;
+  // Record sizes: a file from a build with other layouts is refused
+  uint32_t level_size, order_size, agent_size, event_size;
+
+  // Simulator
+  timestamp_t now;
+  timestamp_t tick_ns; // agents' decision grid; times mean nothing on another
+  uint64_t events_processed;
+  uint64_t messages_dropped;
+  uint64_t wakeups_dropped;
+  uint64_t sequence;
+  rng_t sequence_rng;
+  depth_entry_t subs_bid, subs_ask; // best levels at the last subscription check
+  uint64_t subs_version;
+
+  // Book
+  stats_t stats;
+  uint64_t book_version;
+
+  uint64_t level_count, level_offset;
+  uint64_t order_count, order_offset;
+  uint64_t agent_count, agent_offset;
+  uint64_t event_count, event_offset;
+  uint64_t indicators_offset, indicators_len; // 0: the book had no indicators
+  uint64_t file_size;
+} ckpt_header_t;
+
+struct checkpoint
+{
+  void* base;
+  size_t size;
+};
+
+/* ---- Save ---- */
+
+typedef struct
+{
+  FILE* f;
+  uint64_t pos;
+  int failed;
+} ckpt_writer_t;
+
+static void ckpt_write(ckpt_writer_t* w, const void* data, size_t len)
+{
+  if (w->failed || len == 0)
+    return;
+  if (fwrite(data, 1, len, w->f) != len)
+    w->failed = 1;
+  w->pos += len;
+}
+
+// Pad to the next record boundary and return the offset there
+static uint64_t ckpt_align(ckpt_writer_t* w)
+{
+  static const uint8_t zeros[CKPT_ALIGN] = {0};
+  size_t pad = (CKPT_ALIGN - w->pos % CKPT_ALIGN) % CKPT_ALIGN;
+  ckpt_write(w, zeros, pad);
+  return w->pos;
+}
+
+static void save_side(ckpt_writer_t* w, const price_tree_t* tree, side_t side,
+                      ckpt_level_t* levels, size_t* n_levels, uint64_t* n_orders)
+{
+  for (price_level_t* lvl = pt_min(tree); lvl; lvl = pt_next_above(tree, lvl->price))
+  {
+    ckpt_level_t rec = {.price = lvl->price,
+                        .side = side,
+                        .first = *n_orders,
+                        .count = 0,
+                        .enqueued_qty = lvl->enqueued_qty,
+                        .dequeued_qty = lvl->dequeued_qty};
+    for (order_node_t* node = lvl->head; node; node = node->next)
+    {
+      ckpt_order_t o = {.order = *node->order, .entry_offset = node->entry_offset};
+      ckpt_write(w, &o, sizeof o);
+      rec.count++;
+    }
+    *n_orders += rec.count;
+    if (levels)
+      levels[*n_levels] = rec;
+    (*n_levels)++;
+  }
+}
+
+static size_t count_levels(const price_tree_t* tree)
+{
+  size_t n = 0;
+  for (price_level_t* lvl = pt_min(tree); lvl; lvl = pt_next_above(tree, lvl->price))
+    n++;
+  return n;
+}
+
+static int cmp_event(const void* a, const void* b)
+{
+  const event_t* x = a;
+  const event_t* y = b;
+  if (x->ts != y->ts)
+    return x->ts < y->ts ? -1 : 1;
+  return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+int checkpoint_save(const simulator_t* sim, const char* path)
+{
+  if (!sim || !path)
+    return -1;
+
+  const order_book_t* book = sim->book;
+  size_t n_levels = count_levels(&book->bids) + count_levels(&book->asks);
+  size_t n_events = eq_size(&sim->events);
+  ckpt_level_t* levels = malloc((n_levels ? n_levels : 1) * sizeof *levels);
+  event_t* events = malloc((n_events ? n_events : 1) * sizeof *events);
+  ckpt_agent_t* agents = calloc(sim->agent_count ? sim->agent_count : 1, sizeof *agents);
+  FILE* f = fopen(path, "wb");
+  if (!levels || !events || !agents || !f)
+  {
+    free(levels);
+    free(events);
+    free(agents);
+    if (f)
+      fclose(f);
+    return -1;
+  }
+
+  ckpt_header_t h = {.magic = CKPT_MAGIC,
+                     .version = CKPT_VERSION,
+                     .header_size = sizeof h,
+                     .level_size = sizeof(ckpt_level_t),
+                     .order_size = sizeof(ckpt_order_t),
+                     .agent_size = sizeof(ckpt_agent_t),
+                     .event_size = sizeof(ckpt_event_t),
+                     .now = sim_time_now(&sim->clock),
+                     .tick_ns = SIM_TICK_NS,
+                     .events_processed = sim->events_processed,
+                     .messages_dropped = sim->messages_dropped,
+                     .wakeups_dropped = sim->wakeups_dropped,
+                     .sequence = sim->sequence,
+                     .sequence_rng = sim->sequence_rng,
+                     .subs_bid = sim->subs.bid,
+                     .subs_ask = sim->subs.ask,
+                     .subs_version = sim->subs_version,
+                     .stats = book->stats,
+                     .book_version = book->version};
+
+  ckpt_writer_t w = {.f = f};
+  ckpt_write(&w, &h, sizeof h); // rewritten once the offsets are known
+
+  // Orders, one level after another, bids then asks
+  h.order_offset = ckpt_align(&w);
+  size_t li = 0;
+  uint64_t n_orders = 0;
+  save_side(&w, &book->bids, SIDE_BUY, levels, &li, &n_orders);
+  save_side(&w, &book->asks, SIDE_SELL, levels, &li, &n_orders);
+  h.order_count = n_orders;
+
+  h.level_offset = ckpt_align(&w);
+  h.level_count = n_levels;
+  ckpt_write(&w, levels, n_levels * sizeof *levels);
+
+  // Agent state blobs, then the agent table pointing at them
+  for (size_t i = 0; i < sim->agent_count; i++)
+  {
+    const agent_t* a = sim->agents[i];
+    agents[i].id = a->id;
+    agents[i].interest = a->interest;
+    agents[i].wake_at = sim->wake_at[i];
+    if (a->link)
+    {
+      agents[i].has_link = 1;
+      agents[i].link = *a->link;
+    }
+    if (!a->save)
+      continue;
+
+    size_t len = a->save(a, NULL, 0);
+    void* blob = malloc(len ? len : 1);
+    if (!blob)
+    {
+      w.failed = 1;
+      break;
+    }
+    a->save(a, blob, len);
+    agents[i].state_offset = ckpt_align(&w);
+    agents[i].state_len = len;
+    ckpt_write(&w, blob, len);
+    free(blob);
+  }
+  h.agent_offset = ckpt_align(&w);
+  h.agent_count = sim->agent_count;
+  ckpt_write(&w, agents, sim->agent_count * sizeof *agents);
+
+  // The book's indicators, in their own save format
+  if (book->indicators && !w.failed)
+  {
+    size_t len = indicators_save(book->indicators, NULL, 0);
+    void* blob = malloc(len);
+    if (!blob)
+      w.failed = 1;
+    else
+    {
+      indicators_save(book->indicators, blob, len);
+      h.indicators_offset = ckpt_align(&w);
+      h.indicators_len = len;
+      ckpt_write(&w, blob, len);
+      free(blob);
+    }
+  }
+
+  // Pending events in pop order
+  n_events = eq_collect(&sim->events, events);
+  qsort(events, n_events, sizeof *events, cmp_event);
+  h.event_offset = ckpt_align(&w);
+  h.event_count = n_events;
+  for (size_t i = 0; i < n_events; i++)
+  {
+    const event_t* ev = &events[i];
+    ckpt_event_t rec = {.ts = ev->ts, .seq = ev->seq, .type = ev->type};
+    switch (ev->type)
+    {
+    case EVENT_WAKEUP:
+      rec.agent_index = UINT64_MAX;
+      for (size_t k = 0; k < sim->agent_count; k++)
+      {
+        if (sim->agents[k] == ev->payload.agent)
+        {
+          rec.agent_index = k;
+          break;
+        }
+      }
+      break;
+    case EVENT_ORDER:
+      rec.order = *ev->payload.order;
+      break;
+    case EVENT_CANCEL:
+      rec.cancel_id = ev->payload.cancel_id;
+      break;
+    case EVENT_EXEC:
+      rec.report = ev->payload.report;
+      break;
+    case EVENT_AMEND:
+      rec.amend = ev->payload.amend;
+      break;
+    case EVENT_TRADE:
+      break;
+    }
+    ckpt_write(&w, &rec, sizeof rec);
+  }
+  h.file_size = w.pos;
+
+  if (!w.failed && (fseek(f, 0, SEEK_SET) != 0 || fwrite(&h, sizeof h, 1, f) != 1))
+    w.failed = 1;
+  if (fclose(f) != 0)
+    w.failed = 1;
+
+  free(levels);
+  free(events);
+  free(agents);
+  return w.failed ? -1 : 0;
+}
+
+/* ---- Restore ---- */
+
+static int ckpt_fail(const char* path, const char* why)
+{
+  fprintf(stderr, "checkpoint %s: %s\n", path, why);
+  return -1;
+}
+
+// Every array must lie inside the file
+static int ckpt_in_bounds(const ckpt_header_t* h, uint64_t offset, uint64_t count, size_t size)
+{
+  return offset % CKPT_ALIGN == 0 && offset <= h->file_size &&
+         count <= (h->file_size - offset) / size;
+}
+
+static int ckpt_check(const ckpt_header_t* h, size_t file_size, const simulator_t* sim,
+                      const char* path)
+{
+  if (file_size < sizeof *h || h->magic != CKPT_MAGIC || h->version != CKPT_VERSION)
+    return ckpt_fail(path, "not a checkpoint file");
+  if (h->header_size != sizeof *h || h->level_size != sizeof(ckpt_level_t) ||
+      h->order_size != sizeof(ckpt_order_t) || h->agent_size != sizeof(ckpt_agent_t) ||
+      h->event_size != sizeof(ckpt_event_t))
+    return ckpt_fail(path, "written by an incompatible build");
+  if (h->tick_ns != SIM_TICK_NS)
+    return ckpt_fail(path, "saved with a different tick length");
+  if (h->file_size != file_size || !ckpt_in_bounds(h, h->level_offset, h->level_count, sizeof(ckpt_level_t)) ||
+      !ckpt_in_bounds(h, h->order_offset, h->order_count, sizeof(ckpt_order_t)) ||
+      !ckpt_in_bounds(h, h->agent_offset, h->agent_count, sizeof(ckpt_agent_t)) ||
+      !ckpt_in_bounds(h, h->event_offset, h->event_count, sizeof(ckpt_event_t)) ||
+      !ckpt_in_bounds(h, h->indicators_offset, h->indicators_len, 1))
+    return ckpt_fail(path, "truncated or corrupt");
+
+  if (pt_min(&sim->book->bids) || pt_min(&sim->book->asks))
+    return ckpt_fail(path, "the book is not empty");
+  if (h->agent_count != sim->agent_count)
+    return ckpt_fail(path, "saved with a different number of agents");
+
+  const uint8_t* base = (const uint8_t*)h;
+  const ckpt_agent_t* agents = (const ckpt_agent_t*)(base + h->agent_offset);
+  for (size_t i = 0; i < sim->agent_count; i++)
+  {
+    const agent_t* a = sim->agents[i];
+    if (agents[i].id != a->id)
+      return ckpt_fail(path, "saved with different agents");
+    if (agents[i].state_len &&
+        (!a->load || !ckpt_in_bounds(h, agents[i].state_offset, agents[i].state_len, 1)))
+      return ckpt_fail(path, "agent state cannot be loaded");
+  }
+
+  const struct indicators* ind = sim->book->indicators;
+  if ((h->indicators_len != 0) != (ind != NULL) ||
+      (ind && indicators_check(ind, base + h->indicators_offset, h->indicators_len) != 0))
+    return ckpt_fail(path, "saved with different indicators");
+
+  const ckpt_level_t* levels = (const ckpt_level_t*)(base + h->level_offset);
+  for (size_t i = 0; i < h->level_count; i++)
+  {
+    if (levels[i].first > h->order_count || levels[i].count > h->order_count - levels[i].first)
+      return ckpt_fail(path, "truncated or corrupt");
+  }
+  return 0;
+}
+
+// Bulk-load the saved levels, then put back each queue's position counters.
+// Return: 0 ok, -1 invalid or out of memory (book unchanged)
+static int restore_book(order_book_t* book, const ckpt_header_t* h, ckpt_order_t* orders,
+                        const ckpt_level_t* levels)
+{
+  order_t** queue = malloc((h->order_count ? h->order_count : 1) * sizeof *queue);
+  book_level_data_t* data = malloc((h->level_count ? h->level_count : 1) * sizeof *data);
+  if (!queue || !data)
+  {
+    free(queue);
+    free(data);
+    return -1;
+  }
+  for (size_t i = 0; i < h->order_count; i++)
+    queue[i] = &orders[i].order;
+
+  // Saved lowest price first per side; book_load wants the best first
+  size_t n_bids = 0;
+  while (n_bids < h->level_count && levels[n_bids].side == SIDE_BUY)
+    n_bids++;
+  size_t n_asks = h->level_count - n_bids;
+  for (size_t i = 0; i < h->level_count; i++)
+  {
+    const ckpt_level_t* rec = &levels[i];
+    size_t at = (i < n_bids) ? n_bids - 1 - i : i;
+    data[at] = (book_level_data_t){rec->price, queue + rec->first, rec->count};
+  }
+
+  int rc = book_load(book, data, n_bids, data + n_bids, n_asks);
+  for (size_t i = 0; rc == 0 && i < h->level_count; i++)
+  {
+    const ckpt_level_t* rec = &levels[i];
+    price_level_t* lvl = pt_find(rec->side == SIDE_BUY ? &book->bids : &book->asks, rec->price);
+    lvl->enqueued_qty = rec->enqueued_qty;
+    lvl->dequeued_qty = rec->dequeued_qty;
+    const ckpt_order_t* o = &orders[rec->first];
+    for (order_node_t* node = lvl->head; node; node = node->next, o++)
+      node->entry_offset = o->entry_offset;
+  }
+  free(queue);
+  free(data);
+  return rc;
+}
+
+checkpoint_t* checkpoint_restore(simulator_t* sim, const char* path)
+{
+  if (!sim || !path)
+    return NULL;
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    perror(path);
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(ckpt_header_t))
+  {
+    close(fd);
+    ckpt_fail(path, "not a checkpoint file");
+    return NULL;
+  }
+
+  // Private mapping: the book may change restored orders, the file never sees it
+  size_t size = (size_t)st.st_size;
+  void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+  {
+    perror(path);
+    return NULL;
+  }
+
+  checkpoint_t* ckpt = malloc(sizeof *ckpt);
+  const ckpt_header_t* h = base;
+  if (!ckpt || ckpt_check(h, size, sim, path) != 0)
+  {
+    free(ckpt);
+    munmap(base, size);
+    return NULL;
+  }
+  uint8_t* bytes = base;
+  ckpt_order_t* orders = (ckpt_order_t*)(bytes + h->order_offset);
+  const ckpt_level_t* levels = (const ckpt_level_t*)(bytes + h->level_offset);
+  const ckpt_agent_t* agents = (const ckpt_agent_t*)(bytes + h->agent_offset);
+  const ckpt_event_t* events = (const ckpt_event_t*)(bytes + h->event_offset);
+  order_book_t* book = sim->book;
+
+  // Book: the first change, and all or nothing
+  if (restore_book(book, h, orders, levels) != 0)
+  {
+    ckpt_fail(path, "levels are invalid or out of memory");
+    free(ckpt);
+    munmap(base, size);
+    return NULL;
+  }
+  ckpt->base = base;
+  ckpt->size = size;
+  book->stats = h->stats;
+  book->version = h->book_version;
+  if (book->indicators)
+    indicators_load(book->indicators, bytes + h->indicators_offset, h->indicators_len);
+
+  // Agents and their links
+  for (size_t i = 0; i < sim->agent_count; i++)
+  {
+    agent_t* a = sim->agents[i];
+    if (agents[i].state_len)
+      a->load(a, bytes + agents[i].state_offset, agents[i].state_len);
+    a->interest = agents[i].interest;
+    sim->wake_at[i] = agents[i].wake_at;
+    if (subs_sync(&sim->subs, (uint32_t)i, &a->interest) != 0)
+      ckpt_fail(path, "out of memory for subscriptions");
+    if (agents[i].has_link)
+    {
+      const net_link_t* link = &agents[i].link;
+      if (simulator_set_latency(sim, a, &link->to_exchange, &link->from_exchange, 0) == 0)
+        *a->link = *link;
+    }
+  }
+
+  // Simulator: clock, counters, and the queue as it was
+  eq_free(&sim->events);
+  eq_init(&sim->events, MAX_EVENTS);
+  sim_clock_init(&sim->clock);
+  sim_time_advance_to(&sim->clock, h->now);
+  sim->events_processed = h->events_processed;
+  sim->messages_dropped = h->messages_dropped;
+  sim->wakeups_dropped = h->wakeups_dropped;
+  sim->sequence = (sequence_order_t)h->sequence;
+  sim->sequence_rng = h->sequence_rng;
+  sim->subs.bid = h->subs_bid;
+  sim->subs.ask = h->subs_ask;
+  sim->subs.dirty = 0; // every armed trigger was checked before the save
+  sim->subs_version = h->subs_version;
+  book->tape = (book_tape_t){0};
+
+  for (size_t i = 0; i < h->event_count; i++)
+  {
+    const ckpt_event_t* rec = &events[i];
+    event_t ev = {.ts = rec->ts, .type = (event_type_t)rec->type};
+    switch (ev.type)
+    {
+    case EVENT_WAKEUP:
+      if (rec->agent_index >= sim->agent_count)
+        continue;
+      ev.payload.agent = sim->agents[rec->agent_index];
+      break;
+    case EVENT_ORDER:
+      // In flight: the book frees it if it fills on arrival, like any submission
+      ev.payload.order = malloc(sizeof(order_t));
+      if (!ev.payload.order)
+        continue;
+      *ev.payload.order = rec->order;
+      break;
+    case EVENT_CANCEL:
+      ev.payload.cancel_id = rec->cancel_id;
+      break;
+    case EVENT_EXEC:
+      ev.payload.report = rec->report;
+      break;
+    case EVENT_AMEND:
+      ev.payload.amend = rec->amend;
+      break;
+    case EVENT_TRADE:
+      break;
+    }
+    if (eq_push(&sim->events, &ev) != 0 && ev.type == EVENT_ORDER)
+      free(ev.payload.order);
+  }
+
+  // Derived state: the shared view and the snapshot history start from here
+  market_view_build(&sim->view, book, h->now);
+  if (sim->history.capacity)
+  {
+    sim->history.head = sim->history.count = 0;
+    market_view_history_record(&sim->history, &sim->view);
+    sim->history_version = book->version;
+  }
+  return ckpt;
+}
+
+void checkpoint_close(checkpoint_t* ckpt)
+{
+  if (!ckpt)
+    return;
+
+  munmap(ckpt->base, ckpt->size);
+  free(ckpt);
+}
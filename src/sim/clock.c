@@ -1,9 +1,13 @@
 #include "sim/clock.h"
 
-static timestamp_t current_time = 0;
+void sim_clock_init(sim_clock_t* clock) { clock->now = 0; }
 
-timestamp_t sim_time_now(void) { return current_time; }
+timestamp_t sim_time_now(const sim_clock_t* clock) { return clock->now; }
 
-void sim_time_advance(timestamp_t dt) { current_time += dt; }
-
-void sim_time_set(timestamp_t t) { current_time = t; }
+int sim_time_advance_to(sim_clock_t* clock, timestamp_t t)
+{
+  if (t < clock->now)
+    return -1;
+  clock->now = t;
+  return 0;
+}
@@ -1,4 +1,183 @@
-/* Minimal stub for sim/event.c */
 #include "sim/event.h"
+#include <stdlib.h>
+#include <string.h>
 
-/* No runtime logic yet; this file exists so the simulator can link. */
+#define EQ_INITIAL_BUCKET_CAPACITY 64
+
+static inline size_t eq_bucket_index(timestamp_t last, timestamp_t ts)
+{
+  if (ts == last)
+    return 0;
+  return 64 - (size_t)__builtin_clzll(ts ^ last);
+}
+
+// Room for `want` events in `b`. Return: 0 ok, -1 no memory (bucket unchanged)
+static int eq_bucket_reserve(eq_bucket_t* b, size_t want)
+{
+  if (want <= b->capacity)
+    return 0;
+  size_t new_cap = b->capacity ? b->capacity * 2 : EQ_INITIAL_BUCKET_CAPACITY;
+  while (new_cap < want)
+    new_cap *= 2;
+  event_t* items = realloc(b->items, new_cap * sizeof(event_t));
+  if (!items)
+    return -1;
+  b->items = items;
+  b->capacity = new_cap;
+  return 0;
+}
+
+static int eq_bucket_append(eq_bucket_t* b, const event_t* ev)
+{
+  if (eq_bucket_reserve(b, b->count + 1) != 0)
+    return -1;
+  b->items[b->count++] = *ev;
+  return 0;
+}
+
+static int cmp_seq(const void* a, const void* b)
+{
+  uint64_t x = ((const event_t*)a)->seq;
+  uint64_t y = ((const event_t*)b)->seq;
+  return (x > y) - (x < y);
+}
+
+void eq_init(event_queue_t* q, size_t max_size)
+{
+  memset(q, 0, sizeof *q);
+  q->max_size = max_size;
+}
+
+void eq_free(event_queue_t* q)
+{
+  if (!q)
+    return;
+  for (size_t i = 0; i < EQ_BUCKETS; i++)
+  {
+    free(q->buckets[i].items);
+  }
+  memset(q, 0, sizeof *q);
+}
+
+int eq_push(event_queue_t* q, const event_t* ev)
+{
+  if (ev->ts < q->last || q->size >= q->max_size)
+    return -1;
+
+  eq_bucket_t* b = &q->buckets[eq_bucket_index(q->last, ev->ts)];
+  if (eq_bucket_append(b, ev) != 0)
+    return -1;
+
+  b->items[b->count - 1].seq = q->next_seq++;
+  q->size++;
+  return 0;
+}
+
+// Make bucket 0 non-empty by moving `last` up to the smallest pending key.
+// Room in the destination buckets is made before anything moves, so running
+// out of memory leaves every event where it was. Return: 0 ok, -1 no memory
+static int eq_refill(event_queue_t* q)
+{
+  size_t i = 1;
+  while (q->buckets[i].count == 0)
+    i++;
+
+  eq_bucket_t* b = &q->buckets[i];
+  timestamp_t min = b->items[0].ts;
+  for (size_t k = 1; k < b->count; k++)
+  {
+    if (b->items[k].ts < min)
+      min = b->items[k].ts;
+  }
+
+  // Every item lands in a strictly lower bucket relative to the new `last`
+  size_t need[EQ_BUCKETS] = {0};
+  for (size_t k = 0; k < b->count; k++)
+    need[eq_bucket_index(min, b->items[k].ts)]++;
+  for (size_t d = 0; d < i; d++)
+  {
+    if (need[d] && eq_bucket_reserve(&q->buckets[d], q->buckets[d].count + need[d]) != 0)
+      return -1;
+  }
+
+  q->last = min;
+  for (size_t k = 0; k < b->count; k++)
+  {
+    eq_bucket_t* dst = &q->buckets[eq_bucket_index(min, b->items[k].ts)];
+    dst->items[dst->count++] = b->items[k];
+  }
+  b->count = 0;
+
+  // Usually already in seq order (one source bucket, appended in push order)
+  eq_bucket_t* b0 = &q->buckets[0];
+  for (size_t k = 1; k < b0->count; k++)
+  {
+    if (b0->items[k].seq < b0->items[k - 1].seq)
+    {
+      qsort(b0->items, b0->count, sizeof(event_t), cmp_seq);
+      break;
+    }
+  }
+  return 0;
+}
+
+int eq_pop(event_queue_t* q, event_t* out)
+{
+  if (q->size == 0)
+    return 0;
+
+  eq_bucket_t* b0 = &q->buckets[0];
+  if (b0->head == b0->count)
+  {
+    b0->head = 0;
+    b0->count = 0;
+    if (eq_refill(q) != 0)
+      return -1;
+  }
+
+  *out = b0->items[b0->head++];
+  q->size--;
+  return 1;
+}
+
+int eq_peek_ts(event_queue_t* q, timestamp_t* ts)
+{
+  if (q->size == 0)
+    return 0;
+
+  eq_bucket_t* b0 = &q->buckets[0];
+  if (b0->head == b0->count)
+  {
+    b0->head = 0;
+    b0->count = 0;
+    if (eq_refill(q) != 0)
+      return -1;
+  }
+
+  *ts = b0->items[b0->head].ts;
+  return 1;
+}
+
+int eq_pop_same_ts(event_queue_t* q, event_t* out)
+{
+  eq_bucket_t* b0 = &q->buckets[0];
+  if (b0->head == b0->count)
+    return 0;
+
+  *out = b0->items[b0->head++];
+  q->size--;
+  return 1;
+}
+
+size_t eq_collect(const event_queue_t* q, event_t* out)
+{
+  size_t n = 0;
+  for (size_t i = 0; i < EQ_BUCKETS; i++)
+  {
+    const eq_bucket_t* b = &q->buckets[i];
+    size_t from = (i == 0) ? b->head : 0;
+    for (size_t k = from; k < b->count; k++)
+      out[n++] = b->items[k];
+  }
+  return n;
+}
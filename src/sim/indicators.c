@@ -0,0 +1,292 @@
+#include "sim/indicators.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ---- Checkpoint layout: header, then per indicator a record and its buffers ---- */
+
+typedef struct
+{
+  uint64_t count;
+  uint64_t fills;
+  price_t last;
+} ind_blob_header_t;
+
+typedef struct
+{
+  uint64_t kind;
+  uint64_t window;
+  double ema;
+  int64_t sum;
+  uint64_t head;
+  uint64_t count;
+  uint64_t seen;
+} ind_blob_item_t; // then prices[capacity], and seqs[capacity] for MIN / MAX
+
+static size_t ind_capacity(indicator_kind_t kind, size_t window)
+{
+  switch (kind)
+  {
+  case IND_EMA:
+    return 0;
+  case IND_RETURN:
+    return window + 1; // the price `window` fills back, and every one since
+  default:
+    return window;
+  }
+}
+
+static size_t ind_item_size(const indicator_t* it)
+{
+  size_t buffers = it->capacity * sizeof(price_t);
+  if (it->seqs)
+    buffers += it->capacity * sizeof(uint64_t);
+  return sizeof(ind_blob_item_t) + buffers;
+}
+
+void indicators_init(indicators_t* ind) { memset(ind, 0, sizeof *ind); }
+
+void indicators_free(indicators_t* ind)
+{
+  for (size_t i = 0; i < ind->count; i++)
+  {
+    free(ind->items[i].prices);
+    free(ind->items[i].seqs);
+  }
+  free(ind->items);
+  memset(ind, 0, sizeof *ind);
+}
+
+int indicators_add(indicators_t* ind, indicator_kind_t kind, size_t window)
+{
+  if (!ind || window == 0 || kind > IND_MAX)
+    return -1;
+  for (size_t i = 0; i < ind->count; i++)
+  {
+    if (ind->items[i].kind == kind && ind->items[i].window == window)
+      return (int)i;
+  }
+
+  if (ind->count == ind->capacity)
+  {
+    size_t capacity = ind->capacity ? 2 * ind->capacity : 8;
+    indicator_t* items = realloc(ind->items, capacity * sizeof *items);
+    if (!items)
+      return -1;
+    ind->items = items;
+    ind->capacity = capacity;
+  }
+
+  indicator_t it = {.kind = kind,
+                    .window = window,
+                    .alpha = 2.0 / ((double)window + 1.0),
+                    .capacity = ind_capacity(kind, window)};
+  if (it.capacity)
+  {
+    it.prices = malloc(it.capacity * sizeof *it.prices);
+    if (kind == IND_MIN || kind == IND_MAX)
+      it.seqs = malloc(it.capacity * sizeof *it.seqs);
+    if (!it.prices || ((kind == IND_MIN || kind == IND_MAX) && !it.seqs))
+    {
+      free(it.prices);
+      free(it.seqs);
+      return -1;
+    }
+  }
+  ind->items[ind->count] = it;
+  return (int)ind->count++;
+}
+
+// Append to a ring; returns the oldest entry it drops when full, else 0
+static price_t ring_push(indicator_t* it, price_t price)
+{
+  price_t dropped = 0;
+  if (it->count == it->capacity)
+  {
+    dropped = it->prices[it->head];
+    it->prices[it->head] = price;
+    it->head = (it->head + 1) % it->capacity;
+    return dropped;
+  }
+  it->prices[(it->head + it->count) % it->capacity] = price;
+  it->count++;
+  return dropped;
+}
+
+// Keep the deque's prices monotonic from its front, the current extreme: an
+// entry that a newer one beats can never be the extreme again
+static void deque_push(indicator_t* it, price_t price, uint64_t seq)
+{
+  while (it->count && it->seqs[it->head] + it->window <= seq)
+  {
+    it->head = (it->head + 1) % it->capacity;
+    it->count--;
+  }
+  while (it->count)
+  {
+    price_t back = it->prices[(it->head + it->count - 1) % it->capacity];
+    if (it->kind == IND_MIN ? back < price : back > price)
+      break;
+    it->count--;
+  }
+  size_t at = (it->head + it->count) % it->capacity;
+  it->prices[at] = price;
+  it->seqs[at] = seq;
+  it->count++;
+}
+
+void indicators_on_trade(indicators_t* ind, price_t price)
+{
+  uint64_t seq = ++ind->fills;
+  ind->last = price;
+  for (size_t i = 0; i < ind->count; i++)
+  {
+    indicator_t* it = &ind->items[i];
+    it->seen++;
+    switch (it->kind)
+    {
+    case IND_EMA:
+      it->ema = (it->seen == 1) ? (double)price : it->ema + it->alpha * ((double)price - it->ema);
+      break;
+    case IND_MEAN:
+      it->sum += price - ring_push(it, price);
+      break;
+    case IND_RETURN:
+      ring_push(it, price);
+      break;
+    case IND_MIN:
+    case IND_MAX:
+      deque_push(it, price, seq);
+      break;
+    }
+  }
+}
+
+double indicators_value(const indicators_t* ind, int handle)
+{
+  const indicator_t* it = &ind->items[handle];
+  switch (it->kind)
+  {
+  case IND_EMA:
+    return it->ema;
+  case IND_MEAN:
+    return it->count ? (double)it->sum / (double)it->count : 0.0;
+  case IND_RETURN:
+  {
+    if (it->count < 2)
+      return 0.0;
+    price_t oldest = it->prices[it->head];
+    price_t newest = it->prices[(it->head + it->count - 1) % it->capacity];
+    return (double)(newest - oldest) / (double)oldest;
+  }
+  case IND_MIN:
+  case IND_MAX:
+    return it->count ? (double)it->prices[it->head] : 0.0;
+  }
+  return 0.0;
+}
+
+int indicators_ready(const indicators_t* ind, int handle)
+{
+  const indicator_t* it = &ind->items[handle];
+  if (it->kind == IND_MEAN || it->kind == IND_RETURN)
+    return it->count == it->capacity;
+  return it->seen >= it->window;
+}
+
+/* ---- Checkpoint ---- */
+
+size_t indicators_save(const indicators_t* ind, void* out, size_t cap)
+{
+  size_t size = sizeof(ind_blob_header_t);
+  for (size_t i = 0; i < ind->count; i++)
+    size += ind_item_size(&ind->items[i]);
+  if (!out || cap < size)
+    return size;
+
+  uint8_t* p = out;
+  ind_blob_header_t h = {.count = ind->count, .fills = ind->fills, .last = ind->last};
+  memcpy(p, &h, sizeof h);
+  p += sizeof h;
+  for (size_t i = 0; i < ind->count; i++)
+  {
+    const indicator_t* it = &ind->items[i];
+    ind_blob_item_t rec = {.kind = it->kind,
+                           .window = it->window,
+                           .ema = it->ema,
+                           .sum = it->sum,
+                           .head = it->head,
+                           .count = it->count,
+                           .seen = it->seen};
+    memcpy(p, &rec, sizeof rec);
+    p += sizeof rec;
+    if (it->prices)
+      memcpy(p, it->prices, it->capacity * sizeof(price_t));
+    p += it->capacity * sizeof(price_t);
+    if (it->seqs)
+    {
+      memcpy(p, it->seqs, it->capacity * sizeof(uint64_t));
+      p += it->capacity * sizeof(uint64_t);
+    }
+  }
+  return size;
+}
+
+int indicators_check(const indicators_t* ind, const void* in, size_t len)
+{
+  const uint8_t* p = in;
+  ind_blob_header_t h;
+  if (!in || len < sizeof h)
+    return -1;
+  memcpy(&h, p, sizeof h);
+  if (h.count != ind->count)
+    return -1;
+
+  size_t pos = sizeof h;
+  for (size_t i = 0; i < ind->count; i++)
+  {
+    const indicator_t* it = &ind->items[i];
+    ind_blob_item_t rec;
+    if (len - pos < ind_item_size(it))
+      return -1;
+    memcpy(&rec, p + pos, sizeof rec);
+    if (rec.kind != (uint64_t)it->kind || rec.window != it->window || rec.count > it->capacity ||
+        (it->capacity ? rec.head >= it->capacity : rec.head != 0))
+      return -1;
+    pos += ind_item_size(it);
+  }
+  return pos == len ? 0 : -1;
+}
+
+int indicators_load(indicators_t* ind, const void* in, size_t len)
+{
+  if (indicators_check(ind, in, len) != 0)
+    return -1;
+
+  const uint8_t* p = in;
+  ind_blob_header_t h;
+  memcpy(&h, p, sizeof h);
+  p += sizeof h;
+  ind->fills = h.fills;
+  ind->last = h.last;
+  for (size_t i = 0; i < ind->count; i++)
+  {
+    indicator_t* it = &ind->items[i];
+    ind_blob_item_t rec;
+    memcpy(&rec, p, sizeof rec);
+    p += sizeof rec;
+    it->ema = rec.ema;
+    it->sum = rec.sum;
+    it->head = rec.head;
+    it->count = rec.count;
+    it->seen = rec.seen;
+    if (it->prices)
+      memcpy(it->prices, p, it->capacity * sizeof(price_t));
+    p += it->capacity * sizeof(price_t);
+    if (it->seqs)
+    {
+      memcpy(it->seqs, p, it->capacity * sizeof(uint64_t));
+      p += it->capacity * sizeof(uint64_t);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include "sim/market_view.h"
+#include <stdlib.h>
+
+void market_view_build(market_view_t* view, const order_book_t* book, timestamp_t now)
+{
+  view->version = book->version;
+  view->ts = now;
+
+  view->bid_levels = book_top_levels(book, SIDE_BUY, view->bids, BOOK_TOP_LEVELS);
+  view->ask_levels = book_top_levels(book, SIDE_SELL, view->asks, BOOK_TOP_LEVELS);
+  view->best_bid = view->bid_levels ? view->bids[0].price : 0;
+  view->best_ask = view->ask_levels ? view->asks[0].price : 0;
+
+  if (view->bid_levels && view->ask_levels)
+  {
+    view->mid = (view->best_bid + view->best_ask) / 2;
+    view->spread = view->best_ask - view->best_bid;
+  }
+  else
+  {
+    view->mid = view->bid_levels   ? view->best_bid
+                : view->ask_levels ? view->best_ask
+                                   : DEFAULT_MID_PRICE;
+    view->spread = 0;
+  }
+
+  qty_t bid_qty = 0, ask_qty = 0;
+  for (size_t i = 0; i < view->bid_levels; i++)
+    bid_qty += view->bids[i].qty;
+  for (size_t i = 0; i < view->ask_levels; i++)
+    ask_qty += view->asks[i].qty;
+  view->imbalance =
+      (bid_qty + ask_qty) > 0 ? (double)(bid_qty - ask_qty) / (double)(bid_qty + ask_qty) : 0.0;
+
+  view->last_trade_price = book->stats.last_price;
+  view->last_trade_qty = book->stats.last_qty;
+}
+
+int market_view_refresh(market_view_t* view, const order_book_t* book, timestamp_t now)
+{
+  if (view->version == book->version)
+  {
+    view->ts = now;
+    return 0;
+  }
+  market_view_build(view, book, now);
+  return 1;
+}
+
+int market_view_history_init(market_view_history_t* hist, size_t capacity)
+{
+  hist->items = malloc(capacity * sizeof *hist->items);
+  hist->head = 0;
+  hist->count = 0;
+  hist->capacity = hist->items ? capacity : 0;
+  return hist->items ? 0 : -1;
+}
+
+void market_view_history_free(market_view_history_t* hist)
+{
+  free(hist->items);
+  hist->items = NULL;
+  hist->head = hist->count = hist->capacity = 0;
+}
+
+static inline market_view_t* history_slot(const market_view_history_t* hist, size_t i)
+{
+  size_t k = hist->head + i;
+  if (k >= hist->capacity)
+    k -= hist->capacity;
+  return &hist->items[k];
+}
+
+void market_view_history_record(market_view_history_t* hist, const market_view_t* view)
+{
+  if (hist->capacity == 0)
+    return;
+
+  if (hist->count > 0 && history_slot(hist, hist->count - 1)->ts == view->ts)
+  {
+    *history_slot(hist, hist->count - 1) = *view;
+    return;
+  }
+  if (hist->count == hist->capacity)
+  {
+    hist->head = (hist->head + 1 == hist->capacity) ? 0 : hist->head + 1;
+    hist->count--;
+  }
+  *history_slot(hist, hist->count) = *view;
+  hist->count++;
+}
+
+const market_view_t* market_view_history_at(const market_view_history_t* hist, timestamp_t ts)
+{
+  if (hist->count == 0)
+    return NULL;
+
+  // First entry newer than ts; the one before it is the answer
+  size_t lo = 0, hi = hist->count;
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (history_slot(hist, mid)->ts <= ts)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return history_slot(hist, lo > 0 ? lo - 1 : 0);
+}
@@ -0,0 +1,59 @@
+#include "sim/net_latency.h"
+#include <math.h>
+
+// Stream ids above every agent id, so a link never replays its agent's draws
+#define NET_LINK_STREAM (1ULL << 63)
+
+timestamp_t latency_sample(const latency_dist_t* dist, rng_t* rng)
+{
+  double d;
+  switch (dist->kind)
+  {
+  case LATENCY_FIXED:
+    d = dist->base;
+    break;
+  case LATENCY_UNIFORM:
+    d = dist->base + dist->spread * rng_uniform(rng);
+    break;
+  case LATENCY_EXPONENTIAL:
+    d = dist->base + (dist->spread > 0 ? rng_exp(rng, 1.0 / dist->spread) : 0.0);
+    break;
+  case LATENCY_NONE:
+  default:
+    return 0;
+  }
+  return d > 0 ? (timestamp_t)llround(d) : 0;
+}
+
+void net_link_init(net_link_t* link, const latency_dist_t* to_exchange,
+                   const latency_dist_t* from_exchange, uint64_t seed, agent_id_t id)
+{
+  link->to_exchange = *to_exchange;
+  link->from_exchange = *from_exchange;
+  rng_init_stream(&link->rng, seed, NET_LINK_STREAM | id);
+  link->last_out = 0;
+  link->last_in = 0;
+}
+
+timestamp_t net_link_send(net_link_t* link, timestamp_t now)
+{
+  timestamp_t at = now + latency_sample(&link->to_exchange, &link->rng);
+  if (at < link->last_out)
+    at = link->last_out;
+  link->last_out = at;
+  return at;
+}
+
+timestamp_t net_link_receive(net_link_t* link, timestamp_t now)
+{
+  timestamp_t at = now + latency_sample(&link->from_exchange, &link->rng);
+  if (at < link->last_in)
+    at = link->last_in;
+  link->last_in = at;
+  return at;
+}
+
+timestamp_t net_link_data_delay(net_link_t* link)
+{
+  return latency_sample(&link->from_exchange, &link->rng);
+}
@@ -0,0 +1,77 @@
+#define _GNU_SOURCE
+#include "sim/ou_process.h"
+#include <math.h>
+
+static void ou_refill(ou_process_t* ou)
+{
+  ou->batch_rng = ou->rng;
+  rng_fill_normal(&ou->rng, ou->z, OU_BATCH);
+  ou->next = 0;
+}
+
+int ou_init(ou_process_t* ou, double mean, double reversion, double volatility, uint64_t seed)
+{
+  if (reversion < 0 || volatility < 0)
+    return -1;
+
+  ou->mean = mean;
+  ou->reversion = reversion;
+  ou->volatility = volatility;
+  ou->decay = exp(-reversion);
+  ou->step_sd = reversion > 0 ? volatility * sqrt(-expm1(-2.0 * reversion) / (2.0 * reversion))
+                              : volatility;
+  ou->value = mean;
+  ou->t = 0;
+  rng_seed(&ou->rng, seed);
+  ou_refill(ou);
+  pthread_mutex_init(&ou->lock, NULL);
+  return 0;
+}
+
+void ou_free(ou_process_t* ou)
+{
+  if (!ou)
+    return;
+
+  pthread_mutex_destroy(&ou->lock);
+}
+
+double ou_value_at(ou_process_t* ou, timestamp_t now)
+{
+  pthread_mutex_lock(&ou->lock);
+  for (; ou->t < now; ou->t++)
+  {
+    if (ou->next == OU_BATCH)
+      ou_refill(ou);
+    ou->value = ou->mean + (ou->value - ou->mean) * ou->decay + ou->step_sd * ou->z[ou->next++];
+  }
+  double value = ou->value;
+  pthread_mutex_unlock(&ou->lock);
+  return value;
+}
+
+double ou_stationary_sd(const ou_process_t* ou)
+{
+  return ou->reversion > 0 ? ou->volatility / sqrt(2.0 * ou->reversion) : 0.0;
+}
+
+void ou_save(ou_process_t* ou, ou_snapshot_t* out)
+{
+  pthread_mutex_lock(&ou->lock);
+  out->value = ou->value;
+  out->t = ou->t;
+  out->batch_rng = ou->batch_rng;
+  out->next = ou->next;
+  pthread_mutex_unlock(&ou->lock);
+}
+
+void ou_load(ou_process_t* ou, const ou_snapshot_t* in)
+{
+  pthread_mutex_lock(&ou->lock);
+  ou->rng = in->batch_rng;
+  ou_refill(ou);
+  ou->next = (size_t)in->next;
+  ou->value = in->value;
+  ou->t = in->t;
+  pthread_mutex_unlock(&ou->lock);
+}
@@ -0,0 +1,349 @@
+#define _GNU_SOURCE
+#include "sim/runner.h"
+#include "agents/agent_registry.h"
+#include "agents/as_market_maker.h"
+#include "agents/crowd.h"
+#include "agents/informed_trader.h"
+#include "agents/market_maker.h"
+#include "agents/mean_reversion_trader.h"
+#include "agents/momentum_trader.h"
+#include "agents/noise_trader.h"
+#include "bench/latency.h"
+#include "core/book.h"
+#include "sim/indicators.h"
+#include "sim/simulator.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct
+{
+  const scenario_t* scenario;
+  run_result_t* results;
+  size_t runs;
+  atomic_size_t next_run; /* work queue: runs are claimed in order */
+} runner_shared_t;
+
+typedef struct
+{
+  runner_shared_t* shared;
+  int core;
+  pthread_t thread;
+#ifdef BENCHMARK
+  latency_tracker_t add_latency;
+  latency_tracker_t remove_latency;
+  latency_tracker_t match_latency;
+#endif
+} runner_worker_t;
+
+int runner_core_count(void)
+{
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof set, &set) == 0)
+    return CPU_COUNT(&set);
+
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int)n : 1;
+}
+
+uint64_t runner_run_seed(uint64_t base, size_t run)
+{
+  // splitmix64 finalizer
+  uint64_t z = base + (run + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+int runner_build_agents(runner_agents_t* agents, const scenario_t* sc, simulator_t* sim,
+                        uint64_t seed)
+{
+  agent_registry_init(&agents->registry);
+  informed_population_init(&agents->population, DEFAULT_MID_PRICE, INFORMED_OU_REVERSION,
+                           INFORMED_OU_VOLATILITY, INFORMED_OU_NOISE, seed);
+  indicators_init(&agents->indicators);
+  if (!sim)
+    return -1;
+  if (sc->num_momentum > 0 || sc->num_mean_reversion > 0)
+    sim->book->indicators = &agents->indicators;
+
+  market_maker_params_t mm_params = {.half_spread = sc->mm_half_spread};
+  informed_params_t informed_params = {.threshold = sc->informed_threshold};
+  const struct
+  {
+    const agent_type_t* type;
+    size_t count;
+    agent_id_t first_id;
+    const void* params;
+  } groups[] = {{&noise_trader_type, (size_t)sc->num_noise, RUNNER_NOISE_ID, NULL},
+                {&market_maker_type, (size_t)sc->num_mm, RUNNER_MM_ID,
+                 sc->mm_half_spread ? &mm_params : NULL},
+                {&informed_trader_type, (size_t)sc->num_informed, RUNNER_INFORMED_ID,
+                 sc->informed_threshold ? &informed_params : NULL},
+                {&crowd_type, sc->crowd_size ? 1 : 0, RUNNER_CROWD_ID, &sc->crowd_size},
+                {&momentum_trader_type, (size_t)sc->num_momentum, RUNNER_MOMENTUM_ID,
+                 &agents->indicators},
+                {&mean_reversion_trader_type, (size_t)sc->num_mean_reversion,
+                 RUNNER_MEAN_REVERSION_ID, &agents->indicators},
+                {&as_market_maker_type, (size_t)sc->num_as_mm, RUNNER_AS_MM_ID, NULL},
+                {&ou_informed_trader_type, (size_t)sc->num_ou_informed, RUNNER_OU_INFORMED_ID,
+                 &agents->population}};
+  for (size_t g = 0; g < sizeof groups / sizeof groups[0]; g++)
+  {
+    if (groups[g].count == 0)
+      continue;
+    agent_t* group = agent_registry_add(&agents->registry, groups[g].type, groups[g].count,
+                                        groups[g].first_id, seed, groups[g].params);
+    if (!group)
+    {
+      fprintf(stderr, "runner: could not create %zu %s agents (seed %lu)\n", groups[g].count,
+              groups[g].type->name, (unsigned long)seed);
+      return -1;
+    }
+    for (size_t i = 0; i < groups[g].count; i++)
+      simulator_add_agent(sim, &group[i]);
+  }
+  return 0;
+}
+
+void runner_agents_free(runner_agents_t* agents)
+{
+  agent_registry_free(&agents->registry);
+  informed_population_free(&agents->population);
+  indicators_free(&agents->indicators);
+}
+
+// Return: 0 ok, -1 the run could not be set up (out->failed is set, the
+// reason goes to stderr)
+static int run_one(const scenario_t* sc, uint64_t seed, run_result_t* out,
+                   runner_worker_t* worker)
+{
+  memset(out, 0, sizeof *out);
+  order_book_t book;
+  if (book_init(&book) != 0)
+  {
+    fprintf(stderr, "runner: could not allocate the book (seed %lu)\n", (unsigned long)seed);
+    out->failed = 1;
+    return -1;
+  }
+  simulator_t* sim = simulator_init(&book);
+
+  // A run missing a whole group would still look like a result, so it fails instead
+  runner_agents_t agents;
+  int rc = runner_build_agents(&agents, sc, sim, seed);
+  if (rc == 0)
+  {
+    simulator_run(sim, sim_ticks_to_ns(sc->ticks));
+
+    out->stats = stats_snapshot(&book.stats);
+    out->events = simulator_events_processed(sim);
+
+    depth_entry_t bid, ask;
+    if (book_top_levels(&book, SIDE_BUY, &bid, 1) && book_top_levels(&book, SIDE_SELL, &ask, 1))
+    {
+      out->stats.mid_price = (double)(bid.price + ask.price) / 2.0;
+      out->stats.spread = (double)(ask.price - bid.price);
+    }
+  }
+  out->failed = rc != 0;
+
+#ifdef BENCHMARK
+  if (worker)
+  {
+    latency_merge(&worker->add_latency, &book.add_latency);
+    latency_merge(&worker->remove_latency, &book.remove_latency);
+    latency_merge(&worker->match_latency, &book.match_latency);
+  }
+#else
+  (void)worker;
+#endif
+
+  simulator_free(sim);
+  runner_agents_free(&agents);
+  book_free(&book);
+  return rc;
+}
+
+// Map worker i onto the i-th core this process may run on
+static int nth_allowed_core(int i)
+{
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof set, &set) != 0 || CPU_COUNT(&set) == 0)
+    return i;
+
+  int want = i % CPU_COUNT(&set);
+  for (int c = 0; c < CPU_SETSIZE; c++)
+  {
+    if (CPU_ISSET(c, &set) && want-- == 0)
+      return c;
+  }
+  return 0;
+}
+
+static void pin_to(int core)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(core, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof set, &set); // best effort
+}
+
+void runner_pin_to_core(int i) { pin_to(nth_allowed_core(i)); }
+
+int runner_scenario_check(const scenario_t* sc)
+{
+  if (!sc)
+    return -1;
+  const struct
+  {
+    const char* name;
+    int count;
+    int max;
+  } blocks[] = {{"noise", sc->num_noise, RUNNER_MAX_NOISE},
+                {"mm", sc->num_mm, RUNNER_MAX_MM},
+                {"informed", sc->num_informed, RUNNER_MAX_INFORMED},
+                {"momentum", sc->num_momentum, RUNNER_MAX_MOMENTUM},
+                {"mean_reversion", sc->num_mean_reversion, RUNNER_MAX_MEAN_REVERSION},
+                {"as_mm", sc->num_as_mm, RUNNER_MAX_AS_MM},
+                {"ou_informed", sc->num_ou_informed, RUNNER_MAX_OU_INFORMED}};
+  for (size_t b = 0; b < sizeof blocks / sizeof blocks[0]; b++)
+  {
+    if (blocks[b].count < 0 || blocks[b].count > blocks[b].max)
+    {
+      fprintf(stderr, "runner: %d %s agents do not fit their id block (0 to %d)\n",
+              blocks[b].count, blocks[b].name, blocks[b].max);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int runner_run_one(const scenario_t* scenario, uint64_t seed, run_result_t* out)
+{
+  if (runner_scenario_check(scenario) != 0)
+  {
+    memset(out, 0, sizeof *out);
+    out->failed = 1;
+    return -1;
+  }
+  return run_one(scenario, seed, out, NULL);
+}
+
+static void* runner_worker(void* arg)
+{
+  runner_worker_t* worker = (runner_worker_t*)arg;
+  runner_shared_t* shared = worker->shared;
+  pin_to(worker->core);
+
+  for (;;)
+  {
+    size_t run = atomic_fetch_add(&shared->next_run, 1);
+    if (run >= shared->runs)
+      break;
+    run_one(shared->scenario, runner_run_seed(shared->scenario->seed, run), &shared->results[run],
+            worker);
+  }
+  return NULL;
+}
+
+int runner_run(const scenario_t* scenario, size_t runs, int threads, runner_report_t* report)
+{
+  if (!scenario || !report || runs == 0 || runner_scenario_check(scenario) != 0)
+    return -1;
+  if (threads < 1)
+    threads = 1;
+  if ((size_t)threads > runs)
+    threads = (int)runs;
+
+  memset(report, 0, sizeof *report);
+  report->runs = runs;
+  report->threads = threads;
+  report->results = calloc(runs, sizeof(run_result_t));
+  runner_worker_t* workers = calloc((size_t)threads, sizeof(runner_worker_t));
+  if (!report->results || !workers)
+  {
+    free(report->results);
+    free(workers);
+    report->results = NULL;
+    return -1;
+  }
+
+  runner_shared_t shared = {.scenario = scenario, .results = report->results, .runs = runs};
+  atomic_init(&shared.next_run, 0);
+
+  uint64_t start = time_now_ns();
+  int started = 0;
+  for (int i = 0; i < threads; i++)
+  {
+    workers[i].shared = &shared;
+    workers[i].core = nth_allowed_core(i);
+#ifdef BENCHMARK
+    latency_init(&workers[i].add_latency);
+    latency_init(&workers[i].remove_latency);
+    latency_init(&workers[i].match_latency);
+#endif
+    if (pthread_create(&workers[i].thread, NULL, runner_worker, &workers[i]) != 0)
+      break;
+    started++;
+  }
+  if (started == 0)
+  {
+    // No threads available: run everything on the caller
+    runner_worker(&workers[0]);
+  }
+  for (int i = 0; i < started; i++)
+  {
+    pthread_join(workers[i].thread, NULL);
+  }
+  report->elapsed_sec = (double)(time_now_ns() - start) / 1e9;
+
+  // Merge in run order so the summary does not depend on scheduling
+  for (size_t r = 0; r < runs; r++)
+  {
+    if (report->results[r].failed)
+      report->failed++;
+    else
+      stats_merge(&report->merged, r - report->failed, &report->results[r].stats);
+  }
+
+#ifdef BENCHMARK
+  latency_init(&report->add_latency);
+  latency_init(&report->remove_latency);
+  latency_init(&report->match_latency);
+  for (int i = 0; i < threads; i++)
+  {
+    latency_merge(&report->add_latency, &workers[i].add_latency);
+    latency_merge(&report->remove_latency, &workers[i].remove_latency);
+    latency_merge(&report->match_latency, &workers[i].match_latency);
+    latency_free(&workers[i].add_latency);
+    latency_free(&workers[i].remove_latency);
+    latency_free(&workers[i].match_latency);
+  }
+#endif
+
+  free(workers);
+  if (report->failed == runs)
+  {
+    runner_report_free(report);
+    return -1;
+  }
+  return 0;
+}
+
+void runner_report_free(runner_report_t* report)
+{
+  if (!report)
+    return;
+
+  free(report->results);
+  report->results = NULL;
+#ifdef BENCHMARK
+  latency_free(&report->add_latency);
+  latency_free(&report->remove_latency);
+  latency_free(&report->match_latency);
+#endif
+}
@@ -1,97 +1,793 @@
 #include "sim/simulator.h"
+#include "common/config.h"
 #include <stdio.h>
 #include <stdlib.h>
-
-static simulator_t g_sim;
+#include <string.h>
 
 #define SIMULATOR_INITIAL_CAPACITY 16
 
-void simulator_init(order_book_t* book)
+// Longest run of agents handed to one step_all call in a parallel tick
+#define TICK_RUN_MAX 32
+
+simulator_t* simulator_init(order_book_t* book)
 {
-  g_sim.book = book;
-  g_sim.current_time = 0;
-  g_sim.dt = 1;
-  g_sim.agent_capacity = SIMULATOR_INITIAL_CAPACITY;
-  g_sim.agent_count = 0;
-  g_sim.agents = malloc(g_sim.agent_capacity * sizeof(agent_t*));
+  simulator_t* sim = malloc(sizeof *sim);
+  if (!sim)
+  {
+    fprintf(stderr, "Failed to allocate simulator\n");
+    exit(EXIT_FAILURE);
+  }
+
+  sim->book = book;
+  sim_clock_init(&sim->clock);
+  book->clock = &sim->clock;
+  sim->events_processed = 0;
+  eq_init(&sim->events, MAX_EVENTS);
+  market_view_build(&sim->view, book, 0);
+  sim->owner_ids = NULL;
+  sim->owner_slots = NULL;
+  sim->owner_mask = 0;
+  sim->inbox = NULL;
+  sim->inbox_len = NULL;
+  sim->inbox_queued = NULL;
+  sim->touched = NULL;
+  sim->touched_count = 0;
+  sim->pool = NULL;
+  sim->sequence = SEQUENCE_BY_ID;
+  rng_seed(&sim->sequence_rng, 0);
+  sim->tick = NULL;
+  sim->outboxes = NULL;
+  sim->tick_count = 0;
+  sim->tick_capacity = 0;
+  sim->batch = NULL;
+  sim->batch_agents = NULL;
+  sim->batch_next = NULL;
+  sim->batch_runs = NULL;
+  sim->links = NULL;
+  sim->link_count = 0;
+  sim->wire = (agent_outbox_t){0};
+  sim->history = (market_view_history_t){0};
+  sim->history_version = 0;
+  sim->messages_dropped = 0;
+  sim->wakeups_dropped = 0;
+  subs_init(&sim->subs);
+  sim->subs_version = book->version;
+  sim->agent_capacity = SIMULATOR_INITIAL_CAPACITY;
+  sim->agent_count = 0;
+  sim->agents = malloc(sim->agent_capacity * sizeof(agent_t*));
+  sim->wake_at = malloc(sim->agent_capacity * sizeof *sim->wake_at);
 
-  if (!g_sim.agents)
+  if (!sim->agents || !sim->wake_at)
   {
     fprintf(stderr, "Failed to allocate memory for agents array\n");
     exit(EXIT_FAILURE);
   }
 
-  for (size_t i = 0; i < g_sim.agent_capacity; i++)
+  for (size_t i = 0; i < sim->agent_capacity; i++)
+  {
+    sim->agents[i] = NULL;
+  }
+
+  return sim;
+}
+
+static inline size_t owner_hash(agent_id_t id, size_t mask)
+{
+  return (size_t)((id * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+static void owner_insert(simulator_t* sim, agent_id_t id, size_t slot)
+{
+  size_t h = owner_hash(id, sim->owner_mask);
+  while (sim->owner_slots[h] != 0 && sim->owner_ids[h] != id)
+    h = (h + 1) & sim->owner_mask;
+  sim->owner_ids[h] = id;
+  sim->owner_slots[h] = (uint32_t)slot + 1;
+}
+
+// Slot of the agent owning `id`'s reports, or -1 if it has no on_exec hook
+static inline long owner_lookup(const simulator_t* sim, agent_id_t id)
+{
+  size_t h = owner_hash(id, sim->owner_mask);
+  while (sim->owner_slots[h] != 0)
   {
-    g_sim.agents[i] = NULL;
+    if (sim->owner_ids[h] == id)
+      return (long)sim->owner_slots[h] - 1;
+    h = (h + 1) & sim->owner_mask;
   }
+  return -1;
 }
 
-void simulator_add_agent(agent_t* agent)
+// Size the routing table and inboxes for agent_capacity and re-insert every
+// agent that listens for reports. Called once per capacity doubling.
+static void simulator_grow_routing(simulator_t* sim)
 {
-  if (!agent)
+  size_t cap = sim->agent_capacity;
+  size_t table = cap * 2; // capacity is a power of two, so is this
+  free(sim->owner_ids);
+  free(sim->owner_slots);
+  free(sim->inbox);
+  free(sim->inbox_len);
+  free(sim->inbox_queued);
+  free(sim->touched);
+  sim->owner_ids = malloc(table * sizeof *sim->owner_ids);
+  sim->owner_slots = calloc(table, sizeof *sim->owner_slots);
+  sim->inbox = malloc(cap * EXEC_BATCH * sizeof *sim->inbox);
+  sim->inbox_len = calloc(cap, sizeof *sim->inbox_len);
+  sim->inbox_queued = calloc(cap, sizeof *sim->inbox_queued);
+  sim->touched = malloc(cap * sizeof *sim->touched);
+  if (!sim->owner_ids || !sim->owner_slots || !sim->inbox || !sim->inbox_len ||
+      !sim->inbox_queued || !sim->touched)
+  {
+    fprintf(stderr, "Failed to allocate memory for execution reports\n");
+    exit(EXIT_FAILURE);
+  }
+  sim->owner_mask = table - 1;
+  sim->touched_count = 0;
+
+  for (size_t i = 0; i < sim->agent_count; i++)
+  {
+    if (sim->agents[i]->on_exec)
+      owner_insert(sim, sim->agents[i]->id, i);
+  }
+}
+
+// Queue `agent`'s next wakeup at `ts` unless an earlier one is already live
+static void simulator_wake_at(simulator_t* sim, agent_t* agent, timestamp_t ts)
+{
+  if (ts >= sim->wake_at[agent->slot])
+    return;
+  event_t wake = {.ts = ts, .type = EVENT_WAKEUP, .payload.agent = agent};
+  if (eq_push(&sim->events, &wake) == 0)
+    sim->wake_at[agent->slot] = ts;
+  else
+    sim->wakeups_dropped++;
+}
+
+void simulator_add_agent(simulator_t* sim, agent_t* agent)
+{
+  if (!sim || !agent)
   {
     fprintf(stderr, "Cannot add NULL agent\n");
     return;
   }
 
-  if (g_sim.agent_count >= g_sim.agent_capacity)
+  if (sim->agent_count >= sim->agent_capacity)
   {
-    size_t new_size = g_sim.agent_capacity * 2;
-    agent_t** temp = realloc(g_sim.agents, new_size * sizeof(agent_t*));
+    size_t new_size = sim->agent_capacity * 2;
+    agent_t** temp = realloc(sim->agents, new_size * sizeof(agent_t*));
     if (!temp)
     {
       fprintf(stderr, "Failed to allocate memory for agents array\n");
       exit(EXIT_FAILURE);
     }
-    g_sim.agents = temp;
+    sim->agents = temp;
+    timestamp_t* wake_at = realloc(sim->wake_at, new_size * sizeof *wake_at);
+    if (!wake_at)
+    {
+      fprintf(stderr, "Failed to allocate memory for agents array\n");
+      exit(EXIT_FAILURE);
+    }
+    sim->wake_at = wake_at;
 
-    for (size_t i = g_sim.agent_capacity; i < new_size; i++)
+    for (size_t i = sim->agent_capacity; i < new_size; i++)
     {
-      g_sim.agents[i] = NULL;
+      sim->agents[i] = NULL;
     }
-    g_sim.agent_capacity = new_size;
+    sim->agent_capacity = new_size;
   }
 
-  g_sim.agents[g_sim.agent_count] = agent;
+  sim->agents[sim->agent_count] = agent;
+  agent->slot = (uint32_t)sim->agent_count;
+  sim->wake_at[agent->slot] = AGENT_NO_WAKEUP;
+  sim->agent_count++;
+  if (subs_sync(&sim->subs, agent->slot, &agent->interest) != 0)
+  {
+    fprintf(stderr, "Failed to allocate memory for subscriptions\n");
+    exit(EXIT_FAILURE);
+  }
 
-  g_sim.agent_count++;
+  if (agent->on_exec)
+  {
+    // Reporting costs the book nothing until someone listens
+    if (!sim->book->reports.items && book_enable_reports(sim->book, EXEC_RING_CAPACITY) != 0)
+    {
+      fprintf(stderr, "Failed to allocate execution report ring\n");
+      exit(EXIT_FAILURE);
+    }
+    if (sim->owner_mask + 1 < sim->agent_capacity * 2)
+      simulator_grow_routing(sim);
+    else
+      owner_insert(sim, agent->id, sim->agent_count - 1);
+  }
+
+  // First wakeup on the current tick
+  simulator_wake_at(sim, agent, sim_time_now(&sim->clock));
 }
 
-void simulator_run(timestamp_t end_time)
+int simulator_schedule(simulator_t* sim, const event_t* ev)
 {
-  while (g_sim.current_time < end_time)
+  if (!sim || !ev || ev->ts < sim_time_now(&sim->clock))
+  {
+    return -1;
+  }
+  if (ev->type == EVENT_WAKEUP)
   {
-    for (size_t i = 0; i < g_sim.agent_count; i++)
+    agent_t* agent = ev->payload.agent;
+    if (!agent || agent->slot >= sim->agent_count || sim->agents[agent->slot] != agent)
+      return -1;
+    if (ev->ts >= sim->wake_at[agent->slot])
+      return 0; // the pending wakeup comes first
+    if (eq_push(&sim->events, ev) != 0)
+      return -1;
+    sim->wake_at[agent->slot] = ev->ts;
+    return 0;
+  }
+  return eq_push(&sim->events, ev) != 0 ? -1 : 0;
+}
+
+// A wakeup is live only if it is the one wake_at points at
+static inline int simulator_wake_live(const simulator_t* sim, const event_t* ev)
+{
+  agent_t* agent = ev->payload.agent;
+  return agent && agent->step && sim->wake_at[agent->slot] == ev->ts;
+}
+
+// A subscribed market event happened: wake the agent on the next tick
+static void simulator_wake_subscriber(void* ctx, uint32_t slot)
+{
+  simulator_t* sim = ctx;
+  simulator_wake_at(sim, sim->agents[slot], sim_time_now(&sim->clock) + SIM_TICK_NS);
+}
+
+// Pick up what an agent subscribed to during its step
+static void simulator_sync_interest(simulator_t* sim, agent_t* agent)
+{
+  if (subs_sync(&sim->subs, agent->slot, &agent->interest) != 0)
+  {
+    fprintf(stderr, "Failed to allocate memory for subscriptions\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+uint64_t simulator_events_processed(const simulator_t* sim) { return sim->events_processed; }
+
+static void inbox_flush(simulator_t* sim, uint32_t slot)
+{
+  agent_t* agent = sim->agents[slot];
+  uint32_t n = sim->inbox_len[slot];
+  sim->inbox_len[slot] = 0;
+  if (n)
+    agent->on_exec(agent, sim->book, sim->inbox + (size_t)slot * EXEC_BATCH, n);
+}
+
+static void inbox_route(simulator_t* sim, uint32_t slot, const exec_report_t* report)
+{
+  if (!sim->inbox_queued[slot])
+  {
+    sim->inbox_queued[slot] = 1;
+    sim->touched[sim->touched_count++] = slot;
+  }
+  sim->inbox[(size_t)slot * EXEC_BATCH + sim->inbox_len[slot]++] = *report;
+  if (sim->inbox_len[slot] == EXEC_BATCH)
+    inbox_flush(sim, slot);
+}
+
+// Move every pending report from the book to its owner's inbox, or onto the
+// owner's link if it has one, then give each owner one call with its batch.
+// Hooks may trade, so loop until the ring is dry.
+static void simulator_deliver_reports(simulator_t* sim)
+{
+  exec_ring_t* ring = &sim->book->reports;
+  exec_report_t report;
+  timestamp_t now = sim_time_now(&sim->clock);
+
+  if (!sim->owner_slots)
+  {
+    // Reports were switched on elsewhere but nobody here listens
+    ring->head = ring->count = 0;
+    return;
+  }
+
+  do
+  {
+    while (exec_ring_pop(ring, &report))
     {
-      agent_t* agent = g_sim.agents[i];
-      if (agent != NULL && agent->step != NULL)
+      long found = owner_lookup(sim, order_owner(report.order_id));
+      if (found < 0)
+        continue;
+
+      uint32_t slot = (uint32_t)found;
+      net_link_t* link = sim->agents[slot]->link;
+      if (link && link->from_exchange.kind != LATENCY_NONE)
       {
-        agent->step(agent, g_sim.book, g_sim.current_time);
+        event_t ev = {.ts = net_link_receive(link, now), .type = EVENT_EXEC,
+                      .payload.report = report};
+        if (eq_push(&sim->events, &ev) == 0)
+          continue;
+        sim->messages_dropped++;
+        continue;
       }
+      inbox_route(sim, slot, &report);
     }
 
-    // if (g_sim.current_time % 1000 == 0) {
-    //     printf("Time: %lu\n", g_sim.current_time);
-    // }
+    for (size_t i = 0; i < sim->touched_count; i++)
+    {
+      uint32_t slot = sim->touched[i];
+      sim->inbox_queued[slot] = 0;
+      inbox_flush(sim, slot);
+    }
+    sim->touched_count = 0;
+  } while (ring->count);
+}
 
-    g_sim.current_time += g_sim.dt;
+// Put an agent's buffered actions on its link; each reaches the book as an
+// ORDER or CANCEL event after the link delay
+static void simulator_send(simulator_t* sim, agent_t* agent, agent_outbox_t* box, timestamp_t now)
+{
+  for (size_t i = 0; i < box->count; i++)
+  {
+    event_t ev = {.ts = net_link_send(agent->link, now)};
+    if (box->orders[i])
+    {
+      ev.type = EVENT_ORDER;
+      ev.payload.order = box->orders[i];
+    }
+    else
+    {
+      ev.type = EVENT_CANCEL;
+      ev.payload.cancel_id = box->cancel_ids[i];
+      if (box->amend_qtys[i] > 0)
+      {
+        ev.type = EVENT_AMEND;
+        ev.payload.amend = (event_amend_t){box->cancel_ids[i], box->amend_prices[i],
+                                           box->amend_qtys[i]};
+      }
+    }
+    if (eq_push(&sim->events, &ev) != 0)
+    {
+      free(box->orders[i]);
+      sim->messages_dropped++;
+    }
   }
+  box->count = 0;
+}
 
-  // printf("Simulation complete at time %lu\n", g_sim.current_time);
+// The market as `agent` sees it at `now`: the current view, or an older
+// snapshot if its market data is delayed. sim->view must be current.
+static const market_view_t* simulator_agent_view(simulator_t* sim, agent_t* agent, timestamp_t now)
+{
+  net_link_t* link = agent->link;
+  if (!link || link->from_exchange.kind == LATENCY_NONE || sim->history.count == 0)
+    return &sim->view;
+
+  timestamp_t delay = net_link_data_delay(link);
+  if (delay == 0)
+    return &sim->view;
+  const market_view_t* old = market_view_history_at(&sim->history, now > delay ? now - delay : 0);
+  return old ? old : &sim->view;
 }
 
-void simulator_free()
+// Bookkeeping once the book has settled after an event: hand out reports and
+// keep a snapshot for delayed market data
+static void simulator_after_event(simulator_t* sim, timestamp_t now)
 {
+  if (sim->book->reports.count || sim->touched_count)
+    simulator_deliver_reports(sim);
 
-  if (g_sim.agents)
+  if (sim->history.capacity && sim->book->version != sim->history_version)
   {
-    free(g_sim.agents);
+    market_view_refresh(&sim->view, sim->book, now);
+    market_view_history_record(&sim->history, &sim->view);
+    sim->history_version = sim->book->version;
   }
 
-  g_sim.agents = NULL;
-  g_sim.book = NULL;
+  if (sim->book->version != sim->subs_version || sim->subs.dirty)
+  {
+    subs_check(&sim->subs, sim->book, sim->agents, simulator_wake_subscriber, sim);
+    sim->subs_version = sim->book->version;
+  }
+}
+
+static void simulator_dispatch(simulator_t* sim, const event_t* ev)
+{
+  switch (ev->type)
+  {
+  case EVENT_WAKEUP:
+  {
+    if (!simulator_wake_live(sim, ev))
+      break;
+    agent_t* agent = ev->payload.agent;
+    sim->wake_at[agent->slot] = AGENT_NO_WAKEUP;
+
+    market_view_refresh(&sim->view, sim->book, ev->ts);
+    const market_view_t* view = simulator_agent_view(sim, agent, ev->ts);
+    timestamp_t next;
+    if (agent->link)
+    {
+      agent->outbox = &sim->wire;
+      next = agent->step(agent, sim->book, view, ev->ts);
+      agent->outbox = NULL;
+      simulator_send(sim, agent, &sim->wire, ev->ts);
+    }
+    else
+    {
+      next = agent->step(agent, sim->book, view, ev->ts);
+    }
+    simulator_sync_interest(sim, agent);
+    if (next == AGENT_NO_WAKEUP)
+      break;
+
+    // Never reschedule into the past or the same instant
+    simulator_wake_at(sim, agent, next > ev->ts ? next : ev->ts + SIM_TICK_NS);
+    break;
+  }
+  case EVENT_ORDER:
+    book_add_order(sim->book, ev->payload.order);
+    break;
+  case EVENT_CANCEL:
+    book_remove_order(sim->book, ev->payload.cancel_id);
+    break;
+  case EVENT_AMEND:
+    book_amend_order(sim->book, ev->payload.amend.id, ev->payload.amend.price,
+                     ev->payload.amend.qty);
+    break;
+  case EVENT_TRADE:
+    // Trades are produced by matching, nothing consumes them from the queue yet
+    break;
+  case EVENT_EXEC:
+  {
+    // A report that has crossed its owner's link
+    long found = owner_lookup(sim, order_owner(ev->payload.report.order_id));
+    if (found >= 0)
+      inbox_route(sim, (uint32_t)found, &ev->payload.report);
+    break;
+  }
+  }
+}
+
+int simulator_set_parallel(simulator_t* sim, int threads, sequence_order_t order, uint64_t seed)
+{
+  if (!sim || threads < 0)
+    return -1;
+
+  tick_pool_destroy(sim->pool);
+  sim->pool = NULL;
+  if (threads == 0)
+    return 0;
+
+  sim->pool = tick_pool_create(threads);
+  if (!sim->pool)
+    return -1;
+  sim->sequence = order;
+  rng_seed(&sim->sequence_rng, seed);
+  return 0;
+}
+
+int simulator_set_latency(simulator_t* sim, agent_t* agent, const latency_dist_t* to_exchange,
+                          const latency_dist_t* from_exchange, uint64_t seed)
+{
+  if (!sim || !agent || !to_exchange || !from_exchange)
+    return -1;
+
+  net_link_t* link = agent->link;
+  if (!link)
+  {
+    net_link_t** links = realloc(sim->links, (sim->link_count + 1) * sizeof *links);
+    if (!links)
+      return -1;
+    sim->links = links;
+    link = malloc(sizeof *link);
+    if (!link)
+      return -1;
+    sim->links[sim->link_count++] = link;
+  }
+  net_link_init(link, to_exchange, from_exchange, seed, agent->id);
+
+  if (from_exchange->kind != LATENCY_NONE && sim->history.capacity == 0)
+  {
+    if (market_view_history_init(&sim->history, VIEW_HISTORY_CAPACITY) != 0)
+      return -1;
+    timestamp_t now = sim_time_now(&sim->clock);
+    market_view_refresh(&sim->view, sim->book, now);
+    market_view_history_record(&sim->history, &sim->view);
+    sim->history_version = sim->book->version;
+  }
+
+  agent->link = link;
+  return 0;
+}
+
+static void tick_add(simulator_t* sim, const event_t* ev)
+{
+  if (!simulator_wake_live(sim, ev))
+    return;
+  agent_t* agent = ev->payload.agent;
+
+  if (sim->tick_count == sim->tick_capacity)
+  {
+    size_t cap = sim->tick_capacity ? sim->tick_capacity * 2 : SIMULATOR_INITIAL_CAPACITY;
+    tick_slot_t* tick = realloc(sim->tick, cap * sizeof *tick);
+    agent_outbox_t* boxes = realloc(sim->outboxes, cap * sizeof *boxes);
+    if (tick)
+      sim->tick = tick;
+    if (boxes)
+      sim->outboxes = boxes;
+
+    // Scratch only, nothing to carry over
+    free(sim->batch);
+    free(sim->batch_agents);
+    free(sim->batch_next);
+    free(sim->batch_runs);
+    sim->batch = malloc(cap * sizeof *sim->batch);
+    sim->batch_agents = malloc(cap * sizeof *sim->batch_agents);
+    sim->batch_next = malloc(cap * sizeof *sim->batch_next);
+    sim->batch_runs = malloc((cap + 1) * sizeof *sim->batch_runs);
+    if (!tick || !boxes || !sim->batch || !sim->batch_agents || !sim->batch_next ||
+        !sim->batch_runs)
+    {
+      fprintf(stderr, "Failed to allocate memory for parallel tick\n");
+      exit(EXIT_FAILURE);
+    }
+    memset(sim->outboxes + sim->tick_capacity, 0,
+           (cap - sim->tick_capacity) * sizeof *sim->outboxes);
+    sim->tick_capacity = cap;
+  }
+  sim->tick[sim->tick_count++] = (tick_slot_t){.agent = agent, .seq = ev->seq};
+}
+
+static int tick_slot_cmp(const void* a, const void* b)
+{
+  const tick_slot_t* x = a;
+  const tick_slot_t* y = b;
+  if (x->agent->id != y->agent->id)
+    return x->agent->id < y->agent->id ? -1 : 1;
+  return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+typedef struct
+{
+  simulator_t* sim;
+  timestamp_t now;
+} tick_ctx_t;
+
+static int tick_batch_cmp(const void* a, const void* b)
+{
+  const tick_batch_t* x = a;
+  const tick_batch_t* y = b;
+  if (x->type != y->type)
+    return (uintptr_t)x->type < (uintptr_t)y->type ? -1 : 1;
+  if (x->view != y->view)
+    return (uintptr_t)x->view < (uintptr_t)y->view ? -1 : 1;
+  return (x->tick > y->tick) - (x->tick < y->tick);
+}
+
+// Group the n woken agents into runs of one type and one view, at most
+// TICK_RUN_MAX long so the runs still spread over the pool. Decisions do not
+// depend on each other, so this order never shows in the results.
+static size_t tick_build_runs(simulator_t* sim, size_t n, timestamp_t now)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    agent_t* agent = sim->tick[i].agent;
+    sim->batch[i] = (tick_batch_t){.type = agent->type,
+                                   .view = simulator_agent_view(sim, agent, now),
+                                   .tick = (uint32_t)i};
+  }
+  qsort(sim->batch, n, sizeof *sim->batch, tick_batch_cmp);
+
+  size_t runs = 0;
+  for (size_t k = 0; k < n; k++)
+  {
+    sim->batch_agents[k] = sim->tick[sim->batch[k].tick].agent;
+    if (k == 0 || sim->batch[k].type != sim->batch[k - 1].type ||
+        sim->batch[k].view != sim->batch[k - 1].view ||
+        k - sim->batch_runs[runs - 1] == TICK_RUN_MAX)
+      sim->batch_runs[runs++] = k;
+  }
+  sim->batch_runs[runs] = n;
+  return runs;
+}
+
+// Phase one: the book and view are read-only until every task is done
+static void tick_decide(void* arg, size_t r)
+{
+  tick_ctx_t* ctx = arg;
+  simulator_t* sim = ctx->sim;
+  size_t lo = sim->batch_runs[r];
+  size_t hi = sim->batch_runs[r + 1];
+  const agent_type_t* type = sim->batch[lo].type;
+  const market_view_t* view = sim->batch[lo].view;
+
+  if (type && type->step_all)
+  {
+    type->step_all(sim->batch_agents + lo, hi - lo, sim->book, view, ctx->now,
+                   sim->batch_next + lo);
+    return;
+  }
+  for (size_t k = lo; k < hi; k++)
+  {
+    agent_t* agent = sim->batch_agents[k];
+    sim->batch_next[k] = agent->step(agent, sim->book, view, ctx->now);
+  }
+}
+
+// Apply one agent's buffered actions in the order it took them; runs of
+// submissions go through the batch path
+static void outbox_apply(order_book_t* book, agent_outbox_t* box)
+{
+  size_t i = 0;
+  while (i < box->count)
+  {
+    if (box->orders[i] == NULL)
+    {
+      book_amend_order(book, box->cancel_ids[i], box->amend_prices[i], box->amend_qtys[i]);
+      i++;
+      continue;
+    }
+    size_t j = i;
+    while (j < box->count && box->orders[j] != NULL)
+      j++;
+    book_add_orders(book, box->orders + i, j - i);
+    i = j;
+  }
+  box->count = 0;
+}
+
+// Every agent woken at `now`: decide in parallel, then sequence into the book
+static void simulator_parallel_tick(simulator_t* sim, timestamp_t now)
+{
+  size_t n = sim->tick_count;
+  if (n == 0)
+    return;
+
+  // Canonical order first, so the outcome does not depend on queue history
+  qsort(sim->tick, n, sizeof *sim->tick, tick_slot_cmp);
+
+  // An agent woken twice at the same instant steps once
+  size_t k = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    if (k == 0 || sim->tick[k - 1].agent != sim->tick[i].agent)
+      sim->tick[k++] = sim->tick[i];
+  }
+  n = k;
+
+  if (sim->sequence == SEQUENCE_SHUFFLED)
+  {
+    for (size_t i = n - 1; i > 0; i--)
+    {
+      size_t j = (size_t)rng_below(&sim->sequence_rng, i + 1);
+      tick_slot_t t = sim->tick[i];
+      sim->tick[i] = sim->tick[j];
+      sim->tick[j] = t;
+    }
+  }
+
+  // Phase one
+  market_view_refresh(&sim->view, sim->book, now);
+  for (size_t i = 0; i < n; i++)
+  {
+    sim->tick[i].agent->outbox = &sim->outboxes[i];
+    sim->wake_at[sim->tick[i].agent->slot] = AGENT_NO_WAKEUP;
+  }
+  tick_ctx_t ctx = {.sim = sim, .now = now};
+  size_t runs = tick_build_runs(sim, n, now);
+  tick_pool_run(sim->pool, runs, tick_decide, &ctx);
+  for (size_t k = 0; k < n; k++)
+    sim->tick[sim->batch[k].tick].next_wake = sim->batch_next[k];
+  for (size_t i = 0; i < n; i++)
+    sim->tick[i].agent->outbox = NULL;
+
+  // Phase two
+  for (size_t i = 0; i < n; i++)
+  {
+    agent_t* agent = sim->tick[i].agent;
+    if (agent->link)
+      simulator_send(sim, agent, &sim->outboxes[i], now);
+    else
+      outbox_apply(sim->book, &sim->outboxes[i]);
+
+    timestamp_t next = sim->tick[i].next_wake;
+    if (next != AGENT_NO_WAKEUP)
+      simulator_wake_at(sim, agent, next > now ? next : now + SIM_TICK_NS);
+    simulator_sync_interest(sim, agent);
+    simulator_after_event(sim, now);
+  }
+  sim->tick_count = 0;
+}
+
+void simulator_run(simulator_t* sim, timestamp_t end_time)
+{
+  timestamp_t ts;
+  event_t ev;
+  int pending;
+
+  // Jump from event to event instead of stepping every agent every tick
+  while ((pending = eq_peek_ts(&sim->events, &ts)) == 1 && ts < end_time)
+  {
+    eq_pop(&sim->events, &ev);
+    sim_time_advance_to(&sim->clock, ev.ts);
+
+    if (sim->pool && ev.type == EVENT_WAKEUP)
+    {
+      // Gather the whole instant: other events apply now, wakeups wait for the tick
+      tick_add(sim, &ev);
+      sim->events_processed++;
+      event_t other;
+      while (eq_pop_same_ts(&sim->events, &other))
+      {
+        if (other.type == EVENT_WAKEUP)
+          tick_add(sim, &other);
+        else
+          simulator_dispatch(sim, &other);
+        simulator_after_event(sim, ev.ts);
+        sim->events_processed++;
+      }
+      simulator_parallel_tick(sim, ev.ts);
+      continue;
+    }
+
+    simulator_dispatch(sim, &ev);
+    simulator_after_event(sim, ev.ts);
+    sim->events_processed++;
+  }
+
+  // The queue kept its events; the run stops short rather than skip them
+  if (pending < 0)
+  {
+    fprintf(stderr, "simulator: out of memory in the event queue, stopped at %lu ns\n",
+            (unsigned long)sim_time_now(&sim->clock));
+    return;
+  }
+  sim_time_advance_to(&sim->clock, end_time);
+}
+
+void simulator_free(simulator_t* sim)
+{
+  if (!sim)
+  {
+    return;
+  }
+
+  if (sim->book->clock == &sim->clock)
+    sim->book->clock = NULL;
+
+  // Links die with the simulator. Agents may already be gone, so their
+  // `link` pointers are left alone: an agent must not be reused afterwards.
+  for (size_t i = 0; i < sim->link_count; i++)
+    free(sim->links[i]);
+  free(sim->links);
+  agent_outbox_free(&sim->wire);
+  market_view_history_free(&sim->history);
+
+  free(sim->agents);
+  free(sim->wake_at);
+  subs_free(&sim->subs);
+  free(sim->owner_ids);
+  free(sim->owner_slots);
+  free(sim->inbox);
+  free(sim->inbox_len);
+  free(sim->inbox_queued);
+  free(sim->touched);
+  tick_pool_destroy(sim->pool);
+  for (size_t i = 0; i < sim->tick_capacity; i++)
+    agent_outbox_free(&sim->outboxes[i]);
+  free(sim->outboxes);
+  free(sim->tick);
+  free(sim->batch);
+  free(sim->batch_agents);
+  free(sim->batch_next);
+  free(sim->batch_runs);
+
+  // Orders still in flight were never handed to the book
+  event_t ev;
+  while (eq_pop(&sim->events, &ev) == 1)
+  {
+    if (ev.type == EVENT_ORDER)
+      free(ev.payload.order);
+  }
+  eq_free(&sim->events);
 
-  g_sim.agent_count = 0;
-  g_sim.agent_capacity = 0;
+  free(sim);
 }
@@ -1,31 +1,39 @@
 #include "sim/stats.h"
 
 /* Very small stats implementation to collect basic metrics. */
-static price_t last_price = 0;
-static qty_t total_volume = 0;
-static size_t trade_count = 0;
-
-void stats_init(void)
+void stats_init(stats_t* stats)
 {
-  last_price = 0;
-  total_volume = 0;
-  trade_count = 0;
+  stats->last_price = 0;
+  stats->last_qty = 0;
+  stats->total_volume = 0;
+  stats->trade_count = 0;
 }
 
-void stats_on_trade(price_t price, qty_t qty)
+void stats_on_trade(stats_t* stats, price_t price, qty_t qty)
 {
-  last_price = price;
-  total_volume += qty;
-  trade_count++;
+  stats->last_price = price;
+  stats->last_qty = qty;
+  stats->total_volume += qty;
+  stats->trade_count++;
 }
 
-market_stats_t stats_snapshot(void)
+market_stats_t stats_snapshot(const stats_t* stats)
 {
   market_stats_t s = {0};
-  s.mid_price = (double)last_price;
+  s.mid_price = (double)stats->last_price;
   s.spread = 0.0;
   s.volatility = 0.0;
-  s.volume = total_volume;
-  s.trade_count = trade_count;
+  s.volume = stats->total_volume;
+  s.trade_count = stats->trade_count;
   return s;
 }
+
+void stats_merge(market_stats_t* acc, size_t merged_runs, const market_stats_t* run)
+{
+  double w = 1.0 / (double)(merged_runs + 1);
+  acc->mid_price += (run->mid_price - acc->mid_price) * w;
+  acc->spread += (run->spread - acc->spread) * w;
+  acc->volatility += (run->volatility - acc->volatility) * w;
+  acc->volume += run->volume;
+  acc->trade_count += run->trade_count;
+}
@@ -0,0 +1,292 @@
+#include "sim/subscriptions.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Sweep a heap once stale entries outnumber live ones by this much
+#define SUBS_STALE_SLACK 64
+
+static const unsigned topic_bits[SUBS_TOPICS] = {AGENT_WAKE_BBO, AGENT_WAKE_TRADE,
+                                                 AGENT_WAKE_DEPLETION};
+
+static price_t* trigger_field(agent_interest_t* in, int kind)
+{
+  switch (kind)
+  {
+  case SUBS_ASK_AT_OR_BELOW:
+    return &in->ask_at_or_below;
+  case SUBS_BID_AT_OR_ABOVE:
+    return &in->bid_at_or_above;
+  case SUBS_TRADE_AT_OR_BELOW:
+    return &in->trade_at_or_below;
+  default:
+    return &in->trade_at_or_above;
+  }
+}
+
+static inline int trigger_below(int kind)
+{
+  return kind == SUBS_ASK_AT_OR_BELOW || kind == SUBS_TRADE_AT_OR_BELOW;
+}
+
+void subs_init(subscriptions_t* subs) { memset(subs, 0, sizeof *subs); }
+
+void subs_free(subscriptions_t* subs)
+{
+  if (!subs)
+    return;
+
+  for (int i = 0; i < SUBS_TOPICS; i++)
+    free(subs->topics[i].slots);
+  for (int k = 0; k < SUBS_TRIGGER_KINDS; k++)
+    free(subs->heaps[k].items);
+  free(subs->armed);
+  memset(subs, 0, sizeof *subs);
+}
+
+int subs_reserve(subscriptions_t* subs, size_t slots)
+{
+  if (slots <= subs->capacity)
+    return 0;
+
+  size_t cap = subs->capacity ? subs->capacity : 16;
+  while (cap < slots)
+    cap *= 2;
+  agent_interest_t* armed = realloc(subs->armed, cap * sizeof *armed);
+  if (!armed)
+    return -1;
+  memset(armed + subs->capacity, 0, (cap - subs->capacity) * sizeof *armed);
+  subs->armed = armed;
+  subs->capacity = cap;
+  return 0;
+}
+
+/* ---- Topics ---- */
+
+// First position in `t` holding a slot >= `slot`
+static size_t topic_find(const subs_topic_t* t, uint32_t slot)
+{
+  size_t lo = 0;
+  size_t hi = t->count;
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (t->slots[mid] < slot)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static int topic_add(subs_topic_t* t, uint32_t slot)
+{
+  if (t->count == t->capacity)
+  {
+    size_t cap = t->capacity ? t->capacity * 2 : 16;
+    uint32_t* slots = realloc(t->slots, cap * sizeof *slots);
+    if (!slots)
+      return -1;
+    t->slots = slots;
+    t->capacity = cap;
+  }
+  size_t at = topic_find(t, slot);
+  memmove(t->slots + at + 1, t->slots + at, (t->count - at) * sizeof *t->slots);
+  t->slots[at] = slot;
+  t->count++;
+  return 0;
+}
+
+static void topic_remove(subs_topic_t* t, uint32_t slot)
+{
+  size_t at = topic_find(t, slot);
+  if (at == t->count || t->slots[at] != slot)
+    return;
+  memmove(t->slots + at, t->slots + at + 1, (t->count - at - 1) * sizeof *t->slots);
+  t->count--;
+}
+
+/* ---- Trigger heaps ---- */
+
+static inline int trigger_less(subs_trigger_t a, subs_trigger_t b)
+{
+  return a.key < b.key || (a.key == b.key && a.slot < b.slot);
+}
+
+static void heap_sift_down(subs_heap_t* h, size_t i)
+{
+  subs_trigger_t item = h->items[i];
+  for (;;)
+  {
+    size_t c = 2 * i + 1;
+    if (c >= h->count)
+      break;
+    if (c + 1 < h->count && trigger_less(h->items[c + 1], h->items[c]))
+      c++;
+    if (!trigger_less(h->items[c], item))
+      break;
+    h->items[i] = h->items[c];
+    i = c;
+  }
+  h->items[i] = item;
+}
+
+static int heap_push(subs_heap_t* h, subs_trigger_t item)
+{
+  if (h->count == h->capacity)
+  {
+    size_t cap = h->capacity ? h->capacity * 2 : 16;
+    subs_trigger_t* items = realloc(h->items, cap * sizeof *items);
+    if (!items)
+      return -1;
+    h->items = items;
+    h->capacity = cap;
+  }
+  size_t i = h->count++;
+  while (i > 0)
+  {
+    size_t parent = (i - 1) / 2;
+    if (!trigger_less(item, h->items[parent]))
+      break;
+    h->items[i] = h->items[parent];
+    i = parent;
+  }
+  h->items[i] = item;
+  return 0;
+}
+
+static subs_trigger_t heap_pop(subs_heap_t* h)
+{
+  subs_trigger_t top = h->items[0];
+  h->items[0] = h->items[--h->count];
+  if (h->count)
+    heap_sift_down(h, 0);
+  return top;
+}
+
+// An entry counts only while its slot is still armed at its price
+static inline int trigger_live(const subscriptions_t* subs, int kind, subs_trigger_t t)
+{
+  price_t price = trigger_below(kind) ? -t.key : t.key;
+  return *trigger_field(&subs->armed[t.slot], kind) == price;
+}
+
+// Drop stale entries and re-heapify, O(n)
+static void heap_compact(subscriptions_t* subs, int kind)
+{
+  subs_heap_t* h = &subs->heaps[kind];
+  size_t k = 0;
+  for (size_t i = 0; i < h->count; i++)
+  {
+    if (trigger_live(subs, kind, h->items[i]))
+      h->items[k++] = h->items[i];
+  }
+  h->count = k;
+  for (size_t i = k / 2; i-- > 0;)
+    heap_sift_down(h, i);
+}
+
+int subs_sync(subscriptions_t* subs, uint32_t slot, const agent_interest_t* interest)
+{
+  if (subs_reserve(subs, (size_t)slot + 1) != 0)
+    return -1;
+  agent_interest_t* armed = &subs->armed[slot];
+
+  unsigned changed = armed->topics ^ interest->topics;
+  for (int i = 0; changed && i < SUBS_TOPICS; i++)
+  {
+    if (!(changed & topic_bits[i]))
+      continue;
+    if (interest->topics & topic_bits[i])
+    {
+      if (topic_add(&subs->topics[i], slot) != 0)
+        return -1;
+    }
+    else
+    {
+      topic_remove(&subs->topics[i], slot);
+    }
+  }
+  armed->topics = interest->topics;
+
+  agent_interest_t wanted = *interest;
+  for (int kind = 0; kind < SUBS_TRIGGER_KINDS; kind++)
+  {
+    price_t want = *trigger_field(&wanted, kind);
+    price_t* have = trigger_field(armed, kind);
+    if (want == *have)
+      continue;
+
+    subs_heap_t* h = &subs->heaps[kind];
+    if (*have)
+      h->live--;
+    *have = 0;
+    if (want)
+    {
+      subs_trigger_t t = {.key = trigger_below(kind) ? -want : want, .slot = slot};
+      if (heap_push(h, t) != 0)
+        return -1;
+      *have = want;
+      h->live++;
+      subs->dirty = 1;
+    }
+    if (h->count > 2 * h->live + SUBS_STALE_SLACK)
+      heap_compact(subs, kind);
+  }
+  return 0;
+}
+
+// Pop every trigger of `kind` that `value` satisfies
+static void fire_triggers(subscriptions_t* subs, int kind, price_t value, agent_t* const* agents,
+                          subs_wake_fn wake, void* ctx)
+{
+  subs_heap_t* h = &subs->heaps[kind];
+  price_t limit = trigger_below(kind) ? -value : value;
+  while (h->count && h->items[0].key <= limit)
+  {
+    subs_trigger_t t = heap_pop(h);
+    if (!trigger_live(subs, kind, t))
+      continue;
+    *trigger_field(&subs->armed[t.slot], kind) = 0;
+    *trigger_field(&agents[t.slot]->interest, kind) = 0;
+    h->live--;
+    wake(ctx, t.slot);
+  }
+}
+
+static void wake_topic(const subs_topic_t* t, subs_wake_fn wake, void* ctx)
+{
+  for (size_t i = 0; i < t->count; i++)
+    wake(ctx, t->slots[i]);
+}
+
+void subs_check(subscriptions_t* subs, order_book_t* book, agent_t* const* agents,
+                subs_wake_fn wake, void* ctx)
+{
+  book_tape_t tape = book->tape;
+  book->tape = (book_tape_t){0};
+
+  depth_entry_t bid = book->top_bids.n ? book->top_bids.levels[0] : (depth_entry_t){0};
+  depth_entry_t ask = book->top_asks.n ? book->top_asks.levels[0] : (depth_entry_t){0};
+  int bbo_changed = bid.price != subs->bid.price || bid.qty != subs->bid.qty ||
+                    ask.price != subs->ask.price || ask.qty != subs->ask.qty;
+  subs->bid = bid;
+  subs->ask = ask;
+  subs->dirty = 0;
+
+  if (ask.price)
+    fire_triggers(subs, SUBS_ASK_AT_OR_BELOW, ask.price, agents, wake, ctx);
+  if (bid.price)
+    fire_triggers(subs, SUBS_BID_AT_OR_ABOVE, bid.price, agents, wake, ctx);
+  if (tape.trades)
+  {
+    fire_triggers(subs, SUBS_TRADE_AT_OR_BELOW, tape.trade_low, agents, wake, ctx);
+    fire_triggers(subs, SUBS_TRADE_AT_OR_ABOVE, tape.trade_high, agents, wake, ctx);
+  }
+
+  if (bbo_changed)
+    wake_topic(&subs->topics[0], wake, ctx);
+  if (tape.trades)
+    wake_topic(&subs->topics[1], wake, ctx);
+  if (tape.depletions)
+    wake_topic(&subs->topics[2], wake, ctx);
+}
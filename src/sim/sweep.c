@@ -0,0 +1,658 @@
+#define _GNU_SOURCE
+#include "sim/sweep.h"
+#include "bench/latency.h"
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SWEEP_MAGIC "LOBSWEEP"
+#define SWEEP_VERSION 1
+#define SWEEP_MAX_COLUMNS 64
+
+/* ---- Grid ---- */
+
+static const struct
+{
+  const char* name;
+  size_t offset;
+  size_t size; // int, or a 64-bit field
+  int64_t min;
+  int64_t max;
+} sweep_fields[] = {
+    // agent counts stop at their id blocks (runner.h)
+    {"noise", offsetof(scenario_t, num_noise), sizeof(int), 0, RUNNER_MAX_NOISE},
+    {"mm", offsetof(scenario_t, num_mm), sizeof(int), 0, RUNNER_MAX_MM},
+    {"informed", offsetof(scenario_t, num_informed), sizeof(int), 0, RUNNER_MAX_INFORMED},
+    {"as_mm", offsetof(scenario_t, num_as_mm), sizeof(int), 0, RUNNER_MAX_AS_MM},
+    {"ou_informed", offsetof(scenario_t, num_ou_informed), sizeof(int), 0, RUNNER_MAX_OU_INFORMED},
+    {"momentum", offsetof(scenario_t, num_momentum), sizeof(int), 0, RUNNER_MAX_MOMENTUM},
+    {"mean_reversion", offsetof(scenario_t, num_mean_reversion), sizeof(int), 0,
+     RUNNER_MAX_MEAN_REVERSION},
+    {"crowd", offsetof(scenario_t, crowd_size), sizeof(size_t), 0, INT_MAX},
+    {"mm_spread", offsetof(scenario_t, mm_half_spread), sizeof(price_t), 0, 1000000},
+    {"informed_threshold", offsetof(scenario_t, informed_threshold), sizeof(price_t), 0, 1000000},
+    {"ticks", offsetof(scenario_t, ticks), sizeof(timestamp_t), 1, INT64_MAX},
+};
+#define SWEEP_FIELDS (sizeof sweep_fields / sizeof sweep_fields[0])
+
+static void field_set(scenario_t* sc, size_t f, int64_t v)
+{
+  unsigned char* at = (unsigned char*)sc + sweep_fields[f].offset;
+  if (sweep_fields[f].size == sizeof(int))
+  {
+    int x = (int)v;
+    memcpy(at, &x, sizeof x);
+  }
+  else
+    memcpy(at, &v, sizeof v); // size_t, price_t and timestamp_t are all 64-bit
+}
+
+static int64_t field_get(const scenario_t* sc, size_t f)
+{
+  const unsigned char* at = (const unsigned char*)sc + sweep_fields[f].offset;
+  if (sweep_fields[f].size == sizeof(int))
+  {
+    int x;
+    memcpy(&x, at, sizeof x);
+    return x;
+  }
+  int64_t v;
+  memcpy(&v, at, sizeof v);
+  return v;
+}
+
+const char* sweep_axis_names(void)
+{
+  return "noise mm informed as_mm ou_informed momentum mean_reversion crowd mm_spread "
+         "informed_threshold ticks";
+}
+
+static int sweep_fail(const char* token, const char* why)
+{
+  fprintf(stderr, "sweep: %s: %s\n", token, why);
+  return -1;
+}
+
+static int parse_int(const char* s, int64_t* out)
+{
+  char* end;
+  errno = 0;
+  long long v = strtoll(s, &end, 10);
+  if (errno || end == s || *end != '\0')
+    return -1;
+  *out = v;
+  return 0;
+}
+
+// "a,b,c" or "lo:hi[:step]" into axis->values
+static int parse_values(sweep_axis_t* axis, char* list, const char* token)
+{
+  char* colon = strchr(list, ':');
+  if (colon)
+  {
+    int64_t lo, hi, step = 1;
+    char* second = strchr(colon + 1, ':');
+    *colon = '\0';
+    if (second)
+      *second = '\0';
+    if (parse_int(list, &lo) || parse_int(colon + 1, &hi) || (second && parse_int(second + 1, &step)))
+      return sweep_fail(token, "bad range");
+    if (step < 1 || hi < lo)
+      return sweep_fail(token, "a range needs lo <= hi and a positive step");
+    for (int64_t v = lo; v <= hi; v += step)
+    {
+      if (axis->count == SWEEP_MAX_VALUES)
+        return sweep_fail(token, "too many values");
+      axis->values[axis->count++] = v;
+      if (hi - v < step)
+        break;
+    }
+    return 0;
+  }
+
+  char* save = NULL;
+  for (char* item = strtok_r(list, ",", &save); item; item = strtok_r(NULL, ",", &save))
+  {
+    if (axis->count == SWEEP_MAX_VALUES)
+      return sweep_fail(token, "too many values");
+    if (parse_int(item, &axis->values[axis->count]))
+      return sweep_fail(token, "bad value");
+    axis->count++;
+  }
+  return axis->count ? 0 : sweep_fail(token, "no values");
+}
+
+int sweep_parse(sweep_t* sweep, const scenario_t* base, size_t runs, const char* spec)
+{
+  if (!sweep || !base || !spec || runs == 0)
+    return -1;
+  memset(sweep, 0, sizeof *sweep);
+  sweep->base = *base;
+  sweep->runs = runs;
+
+  char* copy = strdup(spec);
+  if (!copy)
+    return -1;
+  int rc = 0;
+  char* save = NULL;
+  for (char* token = strtok_r(copy, " ;", &save); token && rc == 0;
+       token = strtok_r(NULL, " ;", &save))
+  {
+    char* eq = strchr(token, '=');
+    if (!eq)
+    {
+      rc = sweep_fail(token, "expected name=values");
+      break;
+    }
+    *eq = '\0';
+    size_t f = 0;
+    while (f < SWEEP_FIELDS && strcmp(sweep_fields[f].name, token) != 0)
+      f++;
+    if (f == SWEEP_FIELDS)
+    {
+      rc = sweep_fail(token, "unknown parameter");
+      break;
+    }
+    for (size_t a = 0; a < sweep->n_axes; a++)
+    {
+      if (sweep->axes[a].field == (int)f)
+        rc = sweep_fail(token, "swept twice");
+    }
+    if (rc == 0 && sweep->n_axes == SWEEP_MAX_AXES)
+      rc = sweep_fail(token, "too many axes");
+    if (rc != 0)
+      break;
+
+    sweep_axis_t* axis = &sweep->axes[sweep->n_axes];
+    axis->field = (int)f;
+    axis->count = 0;
+    rc = parse_values(axis, eq + 1, token);
+    for (size_t i = 0; rc == 0 && i < axis->count; i++)
+    {
+      if (axis->values[i] < sweep_fields[f].min || axis->values[i] > sweep_fields[f].max)
+        rc = sweep_fail(token, "value out of range");
+    }
+    sweep->n_axes++;
+  }
+  free(copy);
+  if (rc == 0)
+  {
+    // Axes are in range; the counts they leave at the base's must be too
+    scenario_t first;
+    uint64_t seed;
+    sweep_job(sweep, 0, &first, &seed);
+    rc = runner_scenario_check(&first);
+  }
+  return rc;
+}
+
+size_t sweep_job_count(const sweep_t* sweep)
+{
+  size_t points = 1;
+  for (size_t a = 0; a < sweep->n_axes; a++)
+    points *= sweep->axes[a].count;
+  return points * sweep->runs;
+}
+
+void sweep_job(const sweep_t* sweep, size_t job, scenario_t* out, uint64_t* seed)
+{
+  size_t point = job / sweep->runs;
+  size_t run = job % sweep->runs;
+  *out = sweep->base;
+  for (size_t a = sweep->n_axes; a-- > 0;)
+  {
+    const sweep_axis_t* axis = &sweep->axes[a];
+    field_set(out, (size_t)axis->field, axis->values[point % axis->count]);
+    point /= axis->count;
+  }
+  *seed = runner_run_seed(sweep->base.seed, run);
+}
+
+/* ---- Output ---- */
+
+typedef struct
+{
+  const char* name;
+  char type;
+} sweep_column_t;
+
+// job, run and seed, the scenario fields in sweep_fields order, then these
+static const sweep_column_t sweep_result_columns[] = {
+    {"trades", 'i'}, {"volume", 'i'}, {"mid", 'f'},
+    {"spread", 'f'}, {"events", 'i'}, {"wall_ms", 'f'},
+};
+#define SWEEP_RESULT_COLUMNS (sizeof sweep_result_columns / sizeof sweep_result_columns[0])
+#define SWEEP_COLUMNS (3 + SWEEP_FIELDS + SWEEP_RESULT_COLUMNS)
+
+typedef struct
+{
+  FILE* f;
+  pthread_mutex_t lock;
+  size_t rows; // buffered in the current group
+  sweep_value_t group[SWEEP_COLUMNS][SWEEP_GROUP_ROWS];
+  int failed;
+} sweep_writer_t;
+
+static void writer_put(sweep_writer_t* w, const void* data, size_t len)
+{
+  if (!w->failed && fwrite(data, 1, len, w->f) != len)
+    w->failed = 1;
+}
+
+static void writer_header(sweep_writer_t* w)
+{
+  uint32_t version = SWEEP_VERSION;
+  uint32_t columns = SWEEP_COLUMNS;
+  writer_put(w, SWEEP_MAGIC, 8);
+  writer_put(w, &version, sizeof version);
+  writer_put(w, &columns, sizeof columns);
+  for (size_t c = 0; c < SWEEP_COLUMNS; c++)
+  {
+    char rec[32] = {0};
+    const char* name;
+    char type = 'i';
+    if (c == 0)
+      name = "job";
+    else if (c == 1)
+      name = "run";
+    else if (c == 2)
+      name = "seed";
+    else if (c < 3 + SWEEP_FIELDS)
+      name = sweep_fields[c - 3].name;
+    else
+    {
+      name = sweep_result_columns[c - 3 - SWEEP_FIELDS].name;
+      type = sweep_result_columns[c - 3 - SWEEP_FIELDS].type;
+    }
+    strncpy(rec, name, 31);
+    rec[31] = type;
+    writer_put(w, rec, sizeof rec);
+  }
+}
+
+// Caller holds the lock
+static void writer_flush(sweep_writer_t* w)
+{
+  if (w->rows == 0)
+    return;
+  uint64_t rows = w->rows;
+  writer_put(w, &rows, sizeof rows);
+  for (size_t c = 0; c < SWEEP_COLUMNS; c++)
+    writer_put(w, w->group[c], w->rows * sizeof(sweep_value_t));
+  if (!w->failed && fflush(w->f) != 0)
+    w->failed = 1;
+  w->rows = 0;
+}
+
+static void writer_row(sweep_writer_t* w, size_t job, size_t run, uint64_t seed,
+                       const scenario_t* sc, const run_result_t* r, double wall_ms)
+{
+  pthread_mutex_lock(&w->lock);
+  size_t row = w->rows;
+  size_t c = 0;
+  w->group[c++][row].i = (int64_t)job;
+  w->group[c++][row].i = (int64_t)run;
+  w->group[c++][row].i = (int64_t)seed;
+  for (size_t f = 0; f < SWEEP_FIELDS; f++)
+    w->group[c++][row].i = field_get(sc, f);
+  w->group[c++][row].i = (int64_t)r->stats.trade_count;
+  w->group[c++][row].i = (int64_t)r->stats.volume;
+  w->group[c++][row].f = r->stats.mid_price;
+  w->group[c++][row].f = r->stats.spread;
+  w->group[c++][row].i = (int64_t)r->events;
+  w->group[c++][row].f = wall_ms;
+  if (++w->rows == SWEEP_GROUP_ROWS)
+    writer_flush(w);
+  pthread_mutex_unlock(&w->lock);
+}
+
+/* ---- Work-stealing pool ---- */
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  size_t* jobs; // jobs[lo..hi) are left: the owner takes from lo, thieves from hi
+  size_t lo;
+  size_t hi;
+} sweep_deque_t;
+
+typedef struct
+{
+  const sweep_t* sweep;
+  sweep_deque_t* deques;
+  int threads;
+  run_result_t* results;
+  sweep_writer_t* writer; // NULL: no file
+  atomic_uint_fast64_t steals;
+  atomic_size_t failed;
+} sweep_shared_t;
+
+typedef struct
+{
+  sweep_shared_t* shared;
+  int index;
+  pthread_t thread;
+} sweep_worker_t;
+
+static int deque_take(sweep_deque_t* d, int steal, size_t* job)
+{
+  int ok = 0;
+  pthread_mutex_lock(&d->lock);
+  if (d->lo < d->hi)
+  {
+    *job = steal ? d->jobs[--d->hi] : d->jobs[d->lo++];
+    ok = 1;
+  }
+  pthread_mutex_unlock(&d->lock);
+  return ok;
+}
+
+static void run_job(sweep_shared_t* shared, size_t job)
+{
+  scenario_t sc;
+  uint64_t seed;
+  sweep_job(shared->sweep, job, &sc, &seed);
+  uint64_t start = time_now_ns();
+  if (runner_run_one(&sc, seed, &shared->results[job]) != 0)
+  {
+    atomic_fetch_add(&shared->failed, 1);
+    return;
+  }
+  double wall_ms = (double)(time_now_ns() - start) / 1e6;
+  if (shared->writer)
+    writer_row(shared->writer, job, job % shared->sweep->runs, seed, &sc, &shared->results[job],
+               wall_ms);
+}
+
+static void* sweep_worker(void* arg)
+{
+  sweep_worker_t* worker = arg;
+  sweep_shared_t* shared = worker->shared;
+  runner_pin_to_core(worker->index);
+
+  for (;;)
+  {
+    size_t job;
+    if (deque_take(&shared->deques[worker->index], 0, &job))
+    {
+      run_job(shared, job);
+      continue;
+    }
+    // Own deque empty: steal from the others, nearest first. No job makes
+    // new ones, so a sweep that finds nothing anywhere means we are done.
+    int found = 0;
+    for (int k = 1; k < shared->threads && !found; k++)
+    {
+      int victim = (worker->index + k) % shared->threads;
+      found = deque_take(&shared->deques[victim], 1, &job);
+    }
+    if (!found)
+      break;
+    atomic_fetch_add(&shared->steals, 1);
+    run_job(shared, job);
+  }
+  return NULL;
+}
+
+// Rough cost of a job: ticks times everything that acts in them
+static double job_cost(const sweep_t* sweep, size_t job)
+{
+  scenario_t sc;
+  uint64_t seed;
+  sweep_job(sweep, job, &sc, &seed);
+  double agents = 1.0 + sc.num_noise + sc.num_mm + sc.num_informed + sc.num_as_mm +
+                  sc.num_ou_informed + sc.num_momentum + sc.num_mean_reversion +
+                  (double)sc.crowd_size;
+  return (double)sc.ticks * agents;
+}
+
+static int cmp_cost_desc(const void* a, const void* b, void* arg)
+{
+  const double* costs = arg;
+  size_t x = *(const size_t*)a;
+  size_t y = *(const size_t*)b;
+  if (costs[x] != costs[y])
+    return costs[x] < costs[y] ? 1 : -1;
+  return (x > y) - (x < y);
+}
+
+static void free_deques(sweep_deque_t* deques, int threads)
+{
+  for (int t = 0; deques && t < threads; t++)
+  {
+    pthread_mutex_destroy(&deques[t].lock);
+    free(deques[t].jobs);
+  }
+  free(deques);
+}
+
+// Deal the jobs longest first, round robin, so every deque starts with its
+// longest and keeps its shortest at the end thieves take from. NULL: out of memory
+static sweep_deque_t* deal_jobs(const sweep_t* sweep, size_t jobs, int threads)
+{
+  sweep_deque_t* deques = calloc((size_t)threads, sizeof *deques);
+  size_t* order = malloc(jobs * sizeof *order);
+  double* costs = malloc(jobs * sizeof *costs);
+  int ok = deques && order && costs;
+  for (int t = 0; ok && t < threads; t++)
+  {
+    pthread_mutex_init(&deques[t].lock, NULL);
+    deques[t].jobs = malloc((jobs / (size_t)threads + 1) * sizeof(size_t));
+    ok = deques[t].jobs != NULL;
+  }
+  if (ok)
+  {
+    for (size_t j = 0; j < jobs; j++)
+    {
+      order[j] = j;
+      costs[j] = job_cost(sweep, j);
+    }
+    qsort_r(order, jobs, sizeof *order, cmp_cost_desc, costs);
+    for (size_t k = 0; k < jobs; k++)
+    {
+      sweep_deque_t* d = &deques[k % (size_t)threads];
+      d->jobs[d->hi++] = order[k];
+    }
+  }
+  free(order);
+  free(costs);
+  if (!ok)
+  {
+    free_deques(deques, threads);
+    return NULL;
+  }
+  return deques;
+}
+
+static sweep_writer_t* writer_open(const char* path)
+{
+  sweep_writer_t* w = calloc(1, sizeof *w);
+  if (!w)
+    return NULL;
+  w->f = fopen(path, "wb");
+  if (!w->f)
+  {
+    perror(path);
+    free(w);
+    return NULL;
+  }
+  pthread_mutex_init(&w->lock, NULL);
+  writer_header(w);
+  return w;
+}
+
+// Flush what is left and close. Return: 0 ok, -1 a write failed
+static int writer_close(sweep_writer_t* w, const char* path)
+{
+  writer_flush(w);
+  if (fclose(w->f) != 0)
+    w->failed = 1;
+  int failed = w->failed;
+  if (failed)
+    fprintf(stderr, "sweep: %s: write failed\n", path);
+  pthread_mutex_destroy(&w->lock);
+  free(w);
+  return failed ? -1 : 0;
+}
+
+int sweep_run(const sweep_t* sweep, int threads, const char* path, sweep_report_t* report)
+{
+  if (!sweep || !report)
+    return -1;
+  size_t jobs = sweep_job_count(sweep);
+  if (jobs == 0)
+    return -1;
+  if (threads < 1)
+    threads = 1;
+  if ((size_t)threads > jobs)
+    threads = (int)jobs;
+
+  memset(report, 0, sizeof *report);
+  report->jobs = jobs;
+  report->threads = threads;
+  report->results = calloc(jobs, sizeof(run_result_t));
+  sweep_worker_t* workers = calloc((size_t)threads, sizeof *workers);
+  sweep_deque_t* deques = deal_jobs(sweep, jobs, threads);
+  sweep_writer_t* writer = (path && deques) ? writer_open(path) : NULL;
+  if (!report->results || !workers || !deques || (path && !writer))
+  {
+    free(report->results);
+    report->results = NULL;
+    free(workers);
+    free_deques(deques, threads);
+    return -1;
+  }
+
+  sweep_shared_t shared = {.sweep = sweep,
+                           .deques = deques,
+                           .threads = threads,
+                           .results = report->results,
+                           .writer = writer};
+  atomic_init(&shared.steals, 0);
+  atomic_init(&shared.failed, 0);
+
+  uint64_t start = time_now_ns();
+  int started = 0;
+  for (int t = 0; t < threads; t++)
+  {
+    workers[t] = (sweep_worker_t){.shared = &shared, .index = t};
+    if (pthread_create(&workers[t].thread, NULL, sweep_worker, &workers[t]) != 0)
+      break;
+    started++;
+  }
+  if (started == 0)
+  {
+    // No threads available: run everything on the caller
+    sweep_worker(&workers[0]);
+  }
+  // Jobs dealt to threads that did not start are stolen by those that did
+  for (int t = 0; t < started; t++)
+    pthread_join(workers[t].thread, NULL);
+  report->elapsed_sec = (double)(time_now_ns() - start) / 1e9;
+  report->steals = atomic_load(&shared.steals);
+  report->failed = atomic_load(&shared.failed);
+
+  int rc = writer ? writer_close(writer, path) : 0;
+  free(workers);
+  free_deques(deques, threads);
+  return rc;
+}
+
+void sweep_report_free(sweep_report_t* report)
+{
+  if (!report)
+    return;
+  free(report->results);
+  report->results = NULL;
+}
+
+/* ---- Reading a sweep file back ---- */
+
+int sweep_table_load(sweep_table_t* table, const char* path)
+{
+  memset(table, 0, sizeof *table);
+  FILE* f = fopen(path, "rb");
+  if (!f)
+    return -1;
+
+  char magic[8];
+  uint32_t version, columns;
+  if (fread(magic, 1, 8, f) != 8 || memcmp(magic, SWEEP_MAGIC, 8) != 0 ||
+      fread(&version, sizeof version, 1, f) != 1 || version != SWEEP_VERSION ||
+      fread(&columns, sizeof columns, 1, f) != 1 || columns == 0 ||
+      columns > SWEEP_MAX_COLUMNS)
+  {
+    fclose(f);
+    return -1;
+  }
+
+  table->columns = columns;
+  table->names = calloc(columns, sizeof *table->names);
+  table->types = calloc(columns, 1);
+  table->values = calloc(columns, sizeof *table->values);
+  int rc = (table->names && table->types && table->values) ? 0 : -1;
+  for (size_t c = 0; rc == 0 && c < columns; c++)
+  {
+    char rec[32];
+    if (fread(rec, 1, sizeof rec, f) != sizeof rec)
+      rc = -1;
+    memcpy(table->names[c], rec, 31);
+    table->names[c][31] = '\0';
+    table->types[c] = rec[31];
+  }
+
+  uint64_t rows;
+  while (rc == 0 && fread(&rows, sizeof rows, 1, f) == 1)
+  {
+    if (rows == 0 || rows > SWEEP_GROUP_ROWS)
+    {
+      rc = -1;
+      break;
+    }
+    for (size_t c = 0; rc == 0 && c < columns; c++)
+    {
+      sweep_value_t* grown =
+          realloc(table->values[c], (table->rows + rows) * sizeof(sweep_value_t));
+      if (!grown)
+      {
+        rc = -1;
+        break;
+      }
+      table->values[c] = grown;
+      if (fread(grown + table->rows, sizeof(sweep_value_t), rows, f) != rows)
+        rc = -1;
+    }
+    table->rows += rows;
+  }
+  fclose(f);
+  if (rc != 0)
+    sweep_table_free(table);
+  return rc;
+}
+
+int sweep_table_column(const sweep_table_t* table, const char* name)
+{
+  for (size_t c = 0; c < table->columns; c++)
+  {
+    if (strcmp(table->names[c], name) == 0)
+      return (int)c;
+  }
+  return -1;
+}
+
+void sweep_table_free(sweep_table_t* table)
+{
+  if (!table)
+    return;
+  for (size_t c = 0; table->values && c < table->columns; c++)
+    free(table->values[c]);
+  free(table->values);
+  free(table->names);
+  free(table->types);
+  memset(table, 0, sizeof *table);
+}
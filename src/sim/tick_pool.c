@@ -0,0 +1,139 @@
+#include "sim/tick_pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct tick_pool
+{
+  pthread_t* workers;
+  int worker_count; // threads besides the caller
+
+  pthread_mutex_t lock;
+  pthread_cond_t start; // a new batch is posted, or stop
+  pthread_cond_t idle;  // the last worker left the batch
+  uint64_t generation;  // batch number, bumped on post
+  int busy;             // workers still in the current batch
+  int stop;
+
+  tick_pool_fn fn;
+  void* ctx;
+  size_t n;
+  atomic_size_t next; // tasks are claimed one at a time
+};
+
+static void pool_drain(tick_pool_t* pool)
+{
+  for (;;)
+  {
+    size_t i = atomic_fetch_add_explicit(&pool->next, 1, memory_order_relaxed);
+    if (i >= pool->n)
+      break;
+    pool->fn(pool->ctx, i);
+  }
+}
+
+static void* pool_worker(void* arg)
+{
+  tick_pool_t* pool = arg;
+  uint64_t seen = 0;
+
+  pthread_mutex_lock(&pool->lock);
+  for (;;)
+  {
+    while (!pool->stop && pool->generation == seen)
+      pthread_cond_wait(&pool->start, &pool->lock);
+    if (pool->stop)
+      break;
+    seen = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+
+    pool_drain(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->busy == 0)
+      pthread_cond_signal(&pool->idle);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+tick_pool_t* tick_pool_create(int threads)
+{
+  if (threads < 1)
+    threads = 1;
+
+  tick_pool_t* pool = calloc(1, sizeof *pool);
+  if (!pool)
+    return NULL;
+  pool->workers = calloc((size_t)threads, sizeof(pthread_t));
+  if (!pool->workers)
+  {
+    free(pool);
+    return NULL;
+  }
+
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->idle, NULL);
+  atomic_init(&pool->next, 0);
+
+  for (int i = 0; i < threads - 1; i++)
+  {
+    if (pthread_create(&pool->workers[i], NULL, pool_worker, pool) != 0)
+      break; // run with fewer workers
+    pool->worker_count++;
+  }
+  return pool;
+}
+
+void tick_pool_run(tick_pool_t* pool, size_t n, tick_pool_fn fn, void* ctx)
+{
+  if (n == 0)
+    return;
+
+  if (pool->worker_count == 0 || n == 1)
+  {
+    for (size_t i = 0; i < n; i++)
+      fn(ctx, i);
+    return;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  pool->fn = fn;
+  pool->ctx = ctx;
+  pool->n = n;
+  atomic_store_explicit(&pool->next, 0, memory_order_relaxed);
+  pool->busy = pool->worker_count;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  pool_drain(pool);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->busy > 0)
+    pthread_cond_wait(&pool->idle, &pool->lock);
+  pthread_mutex_unlock(&pool->lock);
+}
+
+int tick_pool_threads(const tick_pool_t* pool) { return pool->worker_count + 1; }
+
+void tick_pool_destroy(tick_pool_t* pool)
+{
+  if (!pool)
+    return;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = 1;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for (int i = 0; i < pool->worker_count; i++)
+    pthread_join(pool->workers[i], NULL);
+
+  pthread_cond_destroy(&pool->start);
+  pthread_cond_destroy(&pool->idle);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool->workers);
+  free(pool);
+}
@@ -0,0 +1,148 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "agents/agent_registry.h"
+#include "agents/crowd.h"
+#include "agents/noise_trader.h"
+#include "core/book.h"
+#include "sim/simulator.h"
+
+/*
+  Smoke test for the agent type registry:
+  - a group's agents and states are contiguous, with ids in order
+  - parallel ticks step a type through step_all, a run at a time
+  - the registry runs each type's teardown; a failed init leaves nothing behind
+*/
+
+typedef struct
+{
+  int steps;
+  int value;
+} counter_state_t;
+
+static atomic_int step_all_calls;
+static atomic_int single_steps;
+static int finis;
+
+static timestamp_t counter_step(agent_t* agent, order_book_t* book, const market_view_t* view,
+                                timestamp_t now)
+{
+  (void)book;
+  (void)view;
+  atomic_fetch_add(&single_steps, 1);
+  ((counter_state_t*)agent->state)->steps++;
+  return now + 1;
+}
+
+static void counter_step_all(agent_t* const* agents, size_t n, order_book_t* book,
+                             const market_view_t* view, timestamp_t now, timestamp_t* next)
+{
+  (void)book;
+  (void)view;
+  atomic_fetch_add(&step_all_calls, 1);
+  for (size_t i = 0; i < n; i++)
+  {
+    ((counter_state_t*)agents[i]->state)->steps++;
+    next[i] = now + 1;
+  }
+}
+
+// params: const int*, agents with an id above it fail to set up
+static int counter_init(agent_t* agent, agent_id_t id, uint64_t seed, const void* params)
+{
+  (void)seed;
+  if (params && id > (agent_id_t) * (const int*)params)
+    return -1;
+  ((counter_state_t*)agent->state)->value = (int)id * 10;
+  agent->step = counter_step;
+  return 0;
+}
+
+static void counter_fini(agent_t* agent)
+{
+  (void)agent;
+  finis++;
+}
+
+static const agent_type_t counter_type = {.name = "counter",
+                                          .state_size = sizeof(counter_state_t),
+                                          .init = counter_init,
+                                          .step_all = counter_step_all,
+                                          .fini = counter_fini};
+
+static void test_layout(void)
+{
+  agent_registry_t reg;
+  agent_registry_init(&reg);
+  agent_t* a = agent_registry_add(&reg, &counter_type, 100, 1, 7, NULL);
+  agent_t* b = agent_registry_add(&reg, &noise_trader_type, 50, 1000, 7, NULL);
+  assert(a && b && reg.count == 2);
+
+  const agent_group_t* g = &reg.groups[0];
+  for (size_t i = 0; i < 100; i++)
+  {
+    assert(a[i].id == 1 + i && a[i].type == &counter_type);
+    assert((unsigned char*)a[i].state == g->states + i * g->stride);
+    assert(((counter_state_t*)a[i].state)->value == (int)(1 + i) * 10);
+  }
+  assert(g->stride >= sizeof(counter_state_t) && g->stride % _Alignof(max_align_t) == 0);
+  for (size_t i = 0; i < 50; i++)
+    assert(b[i].id == 1000 + i && b[i].step != NULL);
+
+  finis = 0;
+  agent_registry_free(&reg);
+  assert(finis == 100 && reg.count == 0);
+
+  // Half the group fails: the half that was set up is torn down again
+  agent_registry_init(&reg);
+  int last_ok = 5;
+  assert(agent_registry_add(&reg, &counter_type, 10, 1, 7, &last_ok) == NULL);
+  assert(finis == 105 && reg.count == 0);
+  size_t no_traders = 0;
+  assert(agent_registry_add(&reg, &crowd_type, 1, 300, 7, &no_traders) == NULL);
+  size_t traders = 1000;
+  assert(agent_registry_add(&reg, &crowd_type, 1, 300, 7, &traders) != NULL);
+  agent_registry_free(&reg);
+}
+
+static void test_step_all(void)
+{
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+  assert(simulator_set_parallel(sim, 2, SEQUENCE_SHUFFLED, 3) == 0);
+
+  agent_registry_t reg;
+  agent_registry_init(&reg);
+  agent_t* a = agent_registry_add(&reg, &counter_type, 100, 1, 7, NULL);
+  for (size_t i = 0; i < 100; i++)
+    simulator_add_agent(sim, &a[i]);
+
+  // A hand-built agent takes the per-agent path in the same tick
+  counter_state_t lone_state = {0};
+  agent_t lone = {.id = 500, .step = counter_step, .state = &lone_state};
+  simulator_add_agent(sim, &lone);
+
+  atomic_store(&step_all_calls, 0);
+  atomic_store(&single_steps, 0);
+  simulator_run(sim, 10);
+  for (size_t i = 0; i < 100; i++)
+    assert(((counter_state_t*)a[i].state)->steps == 10);
+  assert(lone_state.steps == 10 && atomic_load(&single_steps) == 10);
+  assert(atomic_load(&step_all_calls) == 10 * 4); // runs of at most 32
+
+  simulator_free(sim);
+  agent_registry_free(&reg);
+  book_free(&book);
+}
+
+int main(void)
+{
+  test_layout();
+  test_step_all();
+
+  printf("agent_registry_test passed\n");
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "sim/arrival.h"
+#include "sim/clock.h"
+
+/*
+  Statistical smoke test for arrival.c (fixed seeds, so deterministic):
+  - Poisson inter-arrival mean matches 1 / rate
+  - coin-flip equivalent rate gives the same per-tick hit probability
+  - Hawkes long-run rate matches mu / (1 - alpha / beta)
+  - wakeup ticks are always in the future
+*/
+
+static void test_poisson_rate(void)
+{
+  arrival_t a;
+  arrival_init_poisson(&a, 0.25);
+  rng_t rng;
+  rng_seed(&rng, 1);
+
+  enum
+  {
+    N = 200000
+  };
+  double t = 0.0;
+  for (int i = 0; i < N; i++)
+  {
+    double next = arrival_next(&a, t, &rng);
+    assert(next > t);
+    t = next;
+  }
+
+  double rate = N / t;
+  assert(fabs(rate - 0.25) < 0.01);
+}
+
+static void test_coin_flip_equivalence(void)
+{
+  // P(at least one arrival in a tick) must equal the old per-tick probability
+  double lambda = arrival_rate_for_probability(0.1);
+  assert(fabs((1.0 - exp(-lambda)) - 0.1) < 1e-12);
+
+  arrival_t a;
+  arrival_init_poisson(&a, lambda);
+  rng_t rng;
+  rng_seed(&rng, 2);
+
+  // Waking at the tick after each arrival: mean gap is 1 / p ticks
+  enum
+  {
+    N = 200000
+  };
+  timestamp_t now = 0;
+  for (int i = 0; i < N; i++)
+  {
+    timestamp_t wake = arrival_next_wake(&a, now, &rng);
+    assert(wake > now && wake % SIM_TICK_NS == 0);
+    now = wake;
+  }
+
+  double gap = (double)sim_tick_of(now) / N;
+  assert(fabs(gap - 10.0) < 0.2);
+}
+
+static void test_hawkes_rate(void)
+{
+  arrival_t a;
+  arrival_init_hawkes(&a, 0.005, 0.05, 0.1);
+  rng_t rng;
+  rng_seed(&rng, 3);
+
+  enum
+  {
+    N = 200000
+  };
+  double t = 0.0;
+  for (int i = 0; i < N; i++)
+  {
+    t = arrival_next(&a, t, &rng);
+  }
+
+  double rate = N / t;
+  assert(fabs(rate - 0.01) < 0.001);
+}
+
+int main(void)
+{
+  test_poisson_rate();
+  test_coin_flip_equivalence();
+  test_hawkes_rate();
+
+  printf("arrival_test: OK\n");
+  return 0;
+}
@@ -0,0 +1,198 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "agents/agent_registry.h"
+#include "agents/as_market_maker.h"
+#include "agents/noise_trader.h"
+#include "core/book.h"
+#include "sim/simulator.h"
+
+/*
+  Smoke test for the Avellaneda-Stoikov market maker:
+  - table quotes equal the closed form at the bucketed time to horizon
+  - a long position skews both quotes down, a short one up
+  - quotes follow the market by amending the same two orders
+  - hundreds of agents share a book, stay inside their limits and run the
+    same with any number of decision threads
+*/
+
+static void fill(agent_t* agent, side_t side, qty_t qty, price_t price)
+{
+  exec_report_t r = {.type = EXEC_FILL, .side = side, .qty = qty, .price = price};
+  agent->on_exec(agent, NULL, &r, 1);
+}
+
+// Closed form, with tau rounded up to the end of its table bucket
+static void direct_quote(double mid, double variance, qty_t inventory, timestamp_t tau,
+                         price_t* bid, price_t* ask)
+{
+  long bucket = (tau * AS_MM_TAU_BUCKETS + AS_MM_HORIZON - 1) / AS_MM_HORIZON;
+  double t = (double)AS_MM_HORIZON * bucket / AS_MM_TAU_BUCKETS;
+  double q = (double)(inventory / AS_MM_ORDER_QTY);
+  double r = mid - q * AS_MM_GAMMA * variance * t;
+  double d = AS_MM_GAMMA * variance * t + 2.0 / AS_MM_GAMMA * log(1.0 + AS_MM_GAMMA / AS_MM_K);
+  *bid = (price_t)floor(r - d / 2);
+  *ask = (price_t)ceil(r + d / 2);
+}
+
+// Some horizon phase reproduces every quote of a whole horizon
+static int matches_closed_form(const agent_t* a, double mid)
+{
+  for (timestamp_t phase = 0; phase < AS_MM_HORIZON; phase++)
+  {
+    int ok = 1;
+    for (timestamp_t now = 0; ok && now < AS_MM_HORIZON; now++)
+    {
+      price_t bid, ask, want_bid, want_ask;
+      as_market_maker_quote(a, mid, sim_ticks_to_ns(now), &bid, &ask);
+      direct_quote(mid, as_market_maker_variance(a), as_market_maker_inventory(a),
+                   AS_MM_HORIZON - (now + phase) % AS_MM_HORIZON, &want_bid, &want_ask);
+      ok = bid == want_bid && ask == want_ask;
+    }
+    if (ok)
+      return 1;
+  }
+  return 0;
+}
+
+static void test_quotes(void)
+{
+  agent_t* a = as_market_maker_create(1000, 7);
+  assert(as_market_maker_variance(a) > 0);
+
+  price_t flat_bid, flat_ask, bid, ask;
+  as_market_maker_quote(a, 1000.5, 0, &flat_bid, &flat_ask);
+  assert(flat_bid < 1000.5 && flat_ask > 1000.5);
+  assert(matches_closed_form(a, 1000.5));
+
+  // Long 5 lots: lean towards selling
+  fill(a, SIDE_BUY, 5 * AS_MM_ORDER_QTY, 1000);
+  assert(as_market_maker_inventory(a) == 5 * AS_MM_ORDER_QTY);
+  assert(matches_closed_form(a, 1000.5));
+  as_market_maker_quote(a, 1000.5, 0, &bid, &ask);
+  assert(bid <= flat_bid && ask <= flat_ask && bid + ask < flat_bid + flat_ask);
+
+  // Short 5 lots: lean towards buying
+  fill(a, SIDE_SELL, 10 * AS_MM_ORDER_QTY, 1010);
+  assert(matches_closed_form(a, 1000.5));
+  as_market_maker_quote(a, 1000.5, 0, &bid, &ask);
+  assert(bid >= flat_bid && ask >= flat_ask && bid + ask > flat_bid + flat_ask);
+  assert(as_market_maker_pnl(a, 1000) == 10 * AS_MM_ORDER_QTY * 10);
+
+  as_market_maker_destroy(a);
+}
+
+static void test_amends(void)
+{
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+  agent_t* a = as_market_maker_create(1000, 7);
+  simulator_add_agent(sim, a);
+
+  // Someone else's wide market; the agent quotes inside it
+  order_t* wide_bid = malloc(sizeof(order_t));
+  order_t* wide_ask = malloc(sizeof(order_t));
+  *wide_bid = (order_t){.id = 1, .side = SIDE_BUY, .type = ORDER_LIMIT, .price = 990, .qty = 50};
+  *wide_ask = (order_t){.id = 2, .side = SIDE_SELL, .type = ORDER_LIMIT, .price = 1010, .qty = 50};
+  book_add_order(&book, wide_bid);
+  book_add_order(&book, wide_ask);
+  simulator_run(sim, sim_ticks_to_ns(100));
+
+  order_id_t bid_id = order_id_first(1000);
+  order_id_t ask_id = bid_id + 1;
+  om_entry_t* bid = om_find(&book.orders, bid_id);
+  om_entry_t* ask = om_find(&book.orders, ask_id);
+  assert(bid && ask && bid->price < 1000 && ask->price > 1000);
+  assert(book.orders.count == 4);
+
+  // A better bid moves the mid up: the same two orders move with it
+  price_t old_bid = bid->price;
+  price_t old_ask = ask->price;
+  order_t* lift = malloc(sizeof(order_t));
+  *lift = (order_t){.id = 3, .side = SIDE_BUY, .type = ORDER_LIMIT, .price = 1000, .qty = 50};
+  event_t ev = {.ts = sim_ticks_to_ns(150), .type = EVENT_ORDER, .payload.order = lift};
+  assert(simulator_schedule(sim, &ev) == 0);
+  simulator_run(sim, sim_ticks_to_ns(300));
+
+  bid = om_find(&book.orders, bid_id);
+  ask = om_find(&book.orders, ask_id);
+  assert(bid && ask && bid->price > old_bid && ask->price > old_ask);
+  assert(book.orders.count == 5 && om_find(&book.orders, ask_id + 1) == NULL);
+
+  simulator_free(sim);
+  as_market_maker_destroy(a);
+  book_free(&book);
+  free(wide_bid);
+  free(wide_ask);
+  free(lift);
+}
+
+// 300 agents against a noisy book; returns the trade count
+static size_t run_crowd(int threads, qty_t* inventories)
+{
+  enum { N = 300 };
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+  if (threads)
+    assert(simulator_set_parallel(sim, threads, SEQUENCE_BY_ID, 11) == 0);
+
+  agent_registry_t reg;
+  agent_registry_init(&reg);
+  agent_t* noise = agent_registry_add(&reg, &noise_trader_type, 40, 1, 11, NULL);
+  agent_t* makers = agent_registry_add(&reg, &as_market_maker_type, N, 1000, 11, NULL);
+  assert(noise && makers);
+  for (size_t i = 0; i < 40; i++)
+    simulator_add_agent(sim, &noise[i]);
+  for (size_t i = 0; i < N; i++)
+    simulator_add_agent(sim, &makers[i]);
+  simulator_run(sim, sim_ticks_to_ns(5000));
+
+  qty_t limit = (qty_t)AS_MM_MAX_LOTS * AS_MM_ORDER_QTY;
+  size_t resting = 0;
+  for (size_t i = 0; i < N; i++)
+  {
+    inventories[i] = as_market_maker_inventory(&makers[i]);
+    assert(inventories[i] <= limit + AS_MM_ORDER_QTY);
+    assert(inventories[i] >= -limit - AS_MM_ORDER_QTY);
+    order_id_t first = order_id_first(makers[i].id);
+    for (order_id_t id = first; id < first + 64; id++)
+      resting += om_find(&book.orders, id) != NULL;
+  }
+  assert(resting <= 2 * N);
+  size_t trades = stats_snapshot(&book.stats).trade_count;
+
+  simulator_free(sim);
+  agent_registry_free(&reg);
+  book_free(&book);
+  return trades;
+}
+
+static void test_crowd(void)
+{
+  static qty_t serial[300];
+  static qty_t parallel[300];
+  size_t a = run_crowd(1, serial);
+  size_t b = run_crowd(4, parallel);
+  assert(a > 0 && a == b);
+  int traded = 0;
+  for (size_t i = 0; i < 300; i++)
+  {
+    assert(serial[i] == parallel[i]);
+    traded += serial[i] != 0;
+  }
+  assert(traded > 0);
+}
+
+int main(void)
+{
+  test_quotes();
+  test_amends();
+  test_crowd();
+
+  printf("as_market_maker_test passed\n");
+  return 0;
+}
@@ -0,0 +1,198 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "core/book.h"
+#include "core/book_fork.h"
+#include "core/level_ops.h"
+
+// Helper to create an order
+static order_t* make_order(order_id_t id, side_t side, price_t price, qty_t qty)
+{
+  order_t* o = (order_t*)malloc(sizeof(order_t));
+  o->id = id;
+  o->side = side;
+  o->type = ORDER_LIMIT;
+  o->price = price;
+  o->qty = qty;
+  o->ts = 0;
+  return o;
+}
+
+static order_t what_if(order_id_t id, side_t side, price_t price, qty_t qty)
+{
+  order_t o = {.id = id, .side = side, .type = ORDER_LIMIT, .price = price, .qty = qty, .ts = 0};
+  return o;
+}
+
+// Base: asks 10@101 (id 1), 20@101 (id 2), 30@102 (id 3); bid 50@99 (id 4)
+static void build_base(order_book_t* book, order_t* orders[4])
+{
+  book_init(book);
+  orders[0] = make_order(1, SIDE_SELL, 101, 10);
+  orders[1] = make_order(2, SIDE_SELL, 101, 20);
+  orders[2] = make_order(3, SIDE_SELL, 102, 30);
+  orders[3] = make_order(4, SIDE_BUY, 99, 50);
+  for (int i = 0; i < 4; i++)
+    book_add_order(book, orders[i]);
+}
+
+static void free_base(order_book_t* book, order_t* orders[4])
+{
+  book_free(book);
+  for (int i = 0; i < 4; i++)
+    free(orders[i]);
+}
+
+static void expect_base_untouched(const order_book_t* book, order_t* orders[4])
+{
+  assert(orders[0]->qty == 10 && orders[1]->qty == 20 && orders[2]->qty == 30);
+  assert(pt_find(&book->asks, 101)->total_qty == 30);
+  assert(pt_find(&book->asks, 102)->total_qty == 30);
+  assert(pt_depth_until(&book->asks, 102, 0, NULL) == 60);
+  assert(book->orders.count == 4);
+}
+
+// Test 1: Sweep in the fork leaves the base alone
+static void test_sweep_does_not_touch_base(void)
+{
+  printf("test_sweep_does_not_touch_base... ");
+
+  order_book_t book;
+  order_t* orders[4];
+  build_base(&book, orders);
+
+  book_fork_t fork;
+  book_fork_init(&fork, &book);
+
+  order_t buy = what_if(100, SIDE_BUY, 102, 35);
+  trade_t trades[10];
+  size_t n = book_fork_match(&fork, &buy, trades, 10);
+
+  assert(n == 3);
+  assert(buy.qty == 0);
+  assert(trades[0].sell_id == 1 && trades[0].qty == 10 && trades[0].price == 101);
+  assert(trades[1].sell_id == 2 && trades[1].qty == 20);
+  assert(trades[2].sell_id == 3 && trades[2].qty == 5 && trades[2].price == 102);
+
+  price_t best;
+  assert(book_fork_best(&fork, SIDE_SELL, &best) == 1 && best == 102);
+  assert(book_fork_level_qty(&fork, SIDE_SELL, 101) == 0);
+  assert(book_fork_level_qty(&fork, SIDE_SELL, 102) == 25);
+
+  expect_base_untouched(&book, orders);
+
+  free_base(&book, orders);
+  printf("PASSED\n");
+}
+
+// Test 2: Successive what-ifs resume from the fork's queue cursor
+static void test_successive_matches(void)
+{
+  printf("test_successive_matches... ");
+
+  order_book_t book;
+  order_t* orders[4];
+  build_base(&book, orders);
+
+  book_fork_t fork;
+  book_fork_init(&fork, &book);
+  trade_t trades[10];
+
+  order_t b1 = what_if(100, SIDE_BUY, 101, 4);
+  assert(book_fork_match(&fork, &b1, trades, 10) == 1);
+
+  order_t b2 = what_if(101, SIDE_BUY, 101, 10);
+  assert(book_fork_match(&fork, &b2, trades, 10) == 2);
+  assert(trades[0].sell_id == 1 && trades[0].qty == 6);
+  assert(trades[1].sell_id == 2 && trades[1].qty == 4);
+
+  assert(book_fork_level_qty(&fork, SIDE_SELL, 101) == 16);
+  expect_base_untouched(&book, orders);
+
+  free_base(&book, orders);
+  printf("PASSED\n");
+}
+
+// Test 3: Hypothetical resting orders can be hit, then discarded
+static void test_rest_then_hit_then_reset(void)
+{
+  printf("test_rest_then_hit_then_reset... ");
+
+  order_book_t book;
+  order_t* orders[4];
+  build_base(&book, orders);
+
+  book_fork_t fork;
+  book_fork_init(&fork, &book);
+  trade_t trades[10];
+
+  // New best bid at 100 that only exists in the fork
+  order_t bid = what_if(200, SIDE_BUY, 100, 15);
+  assert(book_fork_add_order(&fork, &bid, trades, 10) == 0);
+
+  price_t best;
+  assert(book_fork_best(&fork, SIDE_BUY, &best) == 1 && best == 100);
+  assert(book_fork_level_qty(&fork, SIDE_BUY, 100) == 15);
+
+  // Sell sweeps the hypothetical bid, then the base bid at 99
+  order_t sell = what_if(201, SIDE_SELL, 99, 20);
+  assert(book_fork_match(&fork, &sell, trades, 10) == 2);
+  assert(trades[0].buy_id == 200 && trades[0].qty == 15 && trades[0].price == 100);
+  assert(trades[1].buy_id == 4 && trades[1].qty == 5 && trades[1].price == 99);
+
+  assert(book_fork_best(&fork, SIDE_BUY, &best) == 1 && best == 99);
+  assert(book_fork_level_qty(&fork, SIDE_BUY, 99) == 45);
+
+  // Discard: fork sees the base again
+  book_fork_reset(&fork);
+  assert(book_fork_level_qty(&fork, SIDE_BUY, 99) == 50);
+  assert(book_fork_level_qty(&fork, SIDE_BUY, 100) == 0);
+  assert(book_fork_best(&fork, SIDE_SELL, &best) == 1 && best == 101);
+  assert(orders[3]->qty == 50);
+  expect_base_untouched(&book, orders);
+
+  free_base(&book, orders);
+  printf("PASSED\n");
+}
+
+// Test 4: Emptied side and no-cross limits
+static void test_empty_and_no_cross(void)
+{
+  printf("test_empty_and_no_cross... ");
+
+  order_book_t book;
+  order_t* orders[4];
+  build_base(&book, orders);
+
+  book_fork_t fork;
+  book_fork_init(&fork, &book);
+  trade_t trades[10];
+
+  order_t low = what_if(300, SIDE_BUY, 100, 10);
+  assert(book_fork_match(&fork, &low, trades, 10) == 0);
+  assert(low.qty == 10);
+
+  order_t all = what_if(301, SIDE_BUY, 200, 100);
+  assert(book_fork_match(&fork, &all, trades, 10) == 3);
+  assert(all.qty == 40);
+
+  price_t best;
+  assert(book_fork_best(&fork, SIDE_SELL, &best) == 0);
+
+  free_base(&book, orders);
+  printf("PASSED\n");
+}
+
+int main(void)
+{
+  printf("\n=== Running book fork tests ===\n\n");
+
+  test_sweep_does_not_touch_base();
+  test_successive_matches();
+  test_rest_then_hit_then_reset();
+  test_empty_and_no_cross();
+
+  printf("\n=== All tests PASSED ===\n\n");
+  return 0;
+}
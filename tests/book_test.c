@@ -1,3 +1,4 @@
+#define _DEFAULT_SOURCE
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -24,10 +25,11 @@ static void test_init_free(void)
   printf("test_init_free... ");
 
   order_book_t book;
-  book_init(&book);
+  assert(book_init(&book) == 0);
 
   assert(book.orders.buckets != NULL);
   assert(book.orders.count == 0);
+  assert(book.bid_ladder.tree != NULL && book.ask_ladder.tree != NULL);
 
   book_free(&book);
 
@@ -338,6 +340,420 @@ static void test_null_inputs(void)
   printf("PASSED\n");
 }
 
+// Test 13: O(1) order count and queue position
+static void test_queue_position(void)
+{
+  printf("test_queue_position... ");
+
+  order_book_t book;
+  book_init(&book);
+
+  order_t* o1 = make_order(1, SIDE_BUY, 100, 10);
+  order_t* o2 = make_order(2, SIDE_BUY, 100, 20);
+  order_t* o3 = make_order(3, SIDE_BUY, 100, 30);
+
+  book_add_order(&book, o1);
+  book_add_order(&book, o2);
+  book_add_order(&book, o3);
+
+  price_level_t* lvl = pt_find(&book.bids, 100);
+  assert(lvl->order_count == 3);
+  assert(book_queue_ahead(&book, 1) == 0);
+  assert(book_queue_ahead(&book, 2) == 10);
+  assert(book_queue_ahead(&book, 3) == 30);
+  assert(book_queue_ahead(&book, 999) == -1);
+
+  // Sell 15 fills o1 and 5 of o2
+  order_t* sell = make_order(4, SIDE_SELL, 100, 15);
+  book_add_order(&book, sell);
+
+  assert(lvl->order_count == 2);
+  assert(book_queue_ahead(&book, 2) == 0);
+  assert(book_queue_ahead(&book, 3) == 15);
+
+  // Cancel ahead of o3: estimate is clamped to what actually rests
+  book_remove_order(&book, 2);
+  assert(lvl->order_count == 1);
+  assert(book_queue_ahead(&book, 3) == 0);
+
+  free(o1);
+  free(o2);
+  free(o3);
+  book_free(&book);
+  printf("PASSED\n");
+}
+
+// Test 14: Tree depth aggregates follow adds, cancels and fills
+static void test_depth_tracking(void)
+{
+  printf("test_depth_tracking... ");
+
+  order_book_t book;
+  book_init(&book);
+
+  order_t* a1 = make_order(1, SIDE_SELL, 101, 10);
+  order_t* a2 = make_order(2, SIDE_SELL, 102, 20);
+  order_t* a3 = make_order(3, SIDE_SELL, 103, 30);
+  book_add_order(&book, a1);
+  book_add_order(&book, a2);
+  book_add_order(&book, a3);
+
+  assert(pt_depth_until(&book.asks, 102, 0, NULL) == 30);
+  price_t px;
+  assert(pt_price_for_qty(&book.asks, 31, 0, &px) == 1 && px == 103);
+
+  // Buy 15 sweeps 101 and takes 5 from 102
+  order_t* buy = make_order(4, SIDE_BUY, 102, 15);
+  book_add_order(&book, buy);
+  assert(pt_depth_until(&book.asks, 103, 0, NULL) == 45);
+  assert(pt_price_for_qty(&book.asks, 15, 0, &px) == 1 && px == 102);
+
+  assert(dl_depth_until(&book.ask_ladder, 103) == 45);
+  assert(dl_price_for_qty(&book.ask_ladder, 15, &px) == 1 && px == 102);
+
+  // Cancel part of the ladder
+  book_remove_order(&book, 3);
+  assert(pt_depth_until(&book.asks, 103, 0, NULL) == 15);
+  assert(pt_price_for_qty(&book.asks, 16, 0, &px) == 0);
+  assert(dl_depth_until(&book.ask_ladder, 103) == 15);
+  assert(dl_price_for_qty(&book.ask_ladder, 16, &px) == 0);
+
+  free(a1);
+  free(a2);
+  free(a3);
+  book_free(&book);
+  printf("PASSED\n");
+}
+
+// Walk one side from the tree and compare with the top-of-book cache
+static void expect_top_matches_tree(const order_book_t* book, side_t side)
+{
+  const price_tree_t* tree = (side == SIDE_BUY) ? &book->bids : &book->asks;
+  depth_entry_t top[BOOK_TOP_LEVELS];
+  size_t n = book_top_levels(book, side, top, BOOK_TOP_LEVELS);
+
+  size_t expected = tree->size < BOOK_TOP_LEVELS ? tree->size : BOOK_TOP_LEVELS;
+  assert(n == expected);
+
+  price_level_t* lvl = (side == SIDE_BUY) ? pt_max(tree) : pt_min(tree);
+  for (size_t i = 0; i < n; i++)
+  {
+    assert(lvl != NULL);
+    assert(top[i].price == lvl->price);
+    assert(top[i].qty == lvl->total_qty);
+    assert(top[i].count == lvl->order_count);
+    lvl = (side == SIDE_BUY) ? pt_next_below(tree, lvl->price) : pt_next_above(tree, lvl->price);
+  }
+}
+
+// Test 15: Top-N cache stays equal to the tree under random churn
+static void test_top_levels_cache(void)
+{
+  printf("test_top_levels_cache... ");
+
+  order_book_t book;
+  book_init(&book);
+
+  enum
+  {
+    N = 3000
+  };
+  order_t* owned[N];
+  size_t owned_count = 0;
+  unsigned int seed = 3;
+
+  for (order_id_t id = 1; id <= N; id++)
+  {
+    if (owned_count > 0 && rand_r(&seed) % 3 == 0)
+    {
+      // Cancel a random earlier order (no-op if it already traded away)
+      book_remove_order(&book, owned[rand_r(&seed) % owned_count]->id);
+    }
+
+    side_t side = (rand_r(&seed) % 2) ? SIDE_BUY : SIDE_SELL;
+    price_t price = (side == SIDE_BUY) ? 960 + rand_r(&seed) % 45 : 995 + rand_r(&seed) % 45;
+    order_t* o = make_order(id, side, price, 1 + rand_r(&seed) % 20);
+    book_add_order(&book, o);
+
+    // Fully filled incoming orders are freed by the book
+    if (om_find(&book.orders, id))
+      owned[owned_count++] = o;
+
+    expect_top_matches_tree(&book, SIDE_BUY);
+    expect_top_matches_tree(&book, SIDE_SELL);
+  }
+
+  book_free(&book);
+  for (size_t i = 0; i < owned_count; i++)
+    free(owned[i]);
+  printf("PASSED\n");
+}
+
+// Batched adds must leave the book exactly as one-by-one adds would
+static void test_batch_add(void)
+{
+  printf("test_batch_add... ");
+
+  order_book_t single, batched;
+  book_init(&single);
+  book_init(&batched);
+
+  enum
+  {
+    N = 2000,
+    BATCH = 50
+  };
+  order_t* owned[2 * N];
+  size_t owned_count = 0;
+  order_t* batch[BATCH];
+  unsigned int seed = 11;
+
+  for (order_id_t id = 1; id <= N; id += BATCH)
+  {
+    for (int k = 0; k < BATCH; k++)
+    {
+      side_t side = (rand_r(&seed) % 2) ? SIDE_BUY : SIDE_SELL;
+      // Narrow band so batches cross and share levels
+      price_t price = 995 + rand_r(&seed) % 10;
+      qty_t qty = 1 + rand_r(&seed) % 20;
+      order_t* a = make_order(id + k, side, price, qty);
+      batch[k] = make_order(id + k, side, price, qty);
+      book_add_order(&single, a);
+      if (om_find(&single.orders, id + k))
+        owned[owned_count++] = a;
+    }
+    book_add_orders(&batched, batch, BATCH);
+    for (int k = 0; k < BATCH; k++)
+    {
+      if (om_find(&batched.orders, id + k))
+        owned[owned_count++] = batch[k];
+    }
+
+    assert(single.orders.count == batched.orders.count);
+    assert(single.stats.trade_count == batched.stats.trade_count);
+    assert(single.stats.total_volume == batched.stats.total_volume);
+    for (int side = -1; side <= 1; side += 2)
+    {
+      depth_entry_t x[BOOK_TOP_LEVELS], y[BOOK_TOP_LEVELS];
+      size_t nx = book_top_levels(&single, (side_t)side, x, BOOK_TOP_LEVELS);
+      size_t ny = book_top_levels(&batched, (side_t)side, y, BOOK_TOP_LEVELS);
+      assert(nx == ny);
+      for (size_t i = 0; i < nx; i++)
+        assert(x[i].price == y[i].price && x[i].qty == y[i].qty && x[i].count == y[i].count);
+    }
+    expect_top_matches_tree(&batched, SIDE_BUY);
+    expect_top_matches_tree(&batched, SIDE_SELL);
+  }
+
+  book_free(&single);
+  book_free(&batched);
+  for (size_t i = 0; i < owned_count; i++)
+    free(owned[i]);
+  printf("PASSED\n");
+}
+
+// Test 17: Bulk load gives the same book as adding the orders one by one
+static void test_bulk_load(void)
+{
+  printf("test_bulk_load... ");
+
+  enum
+  {
+    LEVELS = 300,
+    PER_LEVEL = 7
+  };
+  order_book_t loaded, added;
+  book_init(&loaded);
+  book_init(&added);
+
+  // Bids 999 down, asks 1001 up; each level's queue in arrival order
+  static order_t* queues[2][LEVELS][PER_LEVEL];
+  book_level_data_t sides[2][LEVELS];
+  order_id_t id = 1;
+  for (int s = 0; s < 2; s++)
+  {
+    side_t side = s ? SIDE_SELL : SIDE_BUY;
+    for (int i = 0; i < LEVELS; i++)
+    {
+      price_t price = s ? 1001 + i : 999 - i;
+      for (int k = 0; k < PER_LEVEL; k++, id++)
+        queues[s][i][k] = make_order(id, side, price, 1 + (id * 7) % 13);
+      sides[s][i] = (book_level_data_t){price, queues[s][i], PER_LEVEL};
+    }
+  }
+  order_t* copies[2 * LEVELS * PER_LEVEL];
+  size_t n_copies = 0;
+  for (int k = 0; k < PER_LEVEL; k++)
+  {
+    for (int s = 0; s < 2; s++)
+    {
+      for (int i = 0; i < LEVELS; i++)
+      {
+        order_t* c = make_order(0, SIDE_BUY, 0, 0);
+        *c = *queues[s][i][k];
+        book_add_order(&added, c);
+        copies[n_copies++] = c;
+      }
+    }
+  }
+
+  uint64_t version = loaded.version;
+  assert(book_load(&loaded, sides[0], LEVELS, sides[1], LEVELS) == 0);
+  assert(loaded.version > version);
+  assert(loaded.orders.count == added.orders.count);
+  assert(loaded.bids.size == LEVELS && loaded.asks.size == LEVELS);
+  expect_top_matches_tree(&loaded, SIDE_BUY);
+  expect_top_matches_tree(&loaded, SIDE_SELL);
+  for (int s = 0; s < 2; s++)
+  {
+    const price_tree_t* tree = s ? &loaded.asks : &loaded.bids;
+    const price_tree_t* other = s ? &added.asks : &added.bids;
+    depth_ladder_t* ladder = s ? &loaded.ask_ladder : &loaded.bid_ladder;
+    depth_ladder_t* other_ladder = s ? &added.ask_ladder : &added.bid_ladder;
+    assert(tree->root->subtree_qty == other->root->subtree_qty);
+    assert(pt_depth_until(tree, 1100, s, NULL) == pt_depth_until(other, 1100, s, NULL));
+    assert(dl_depth_until(ladder, s ? 1100 : 900) == dl_depth_until(other_ladder, s ? 1100 : 900));
+  }
+  for (order_id_t q = 1; q < id; q++)
+    assert(book_queue_ahead(&loaded, q) == book_queue_ahead(&added, q));
+
+  // Matching, cancels and new levels work on the loaded book as usual
+  book_add_order(&loaded, make_order(id, SIDE_BUY, 1003, 50));
+  book_add_order(&added, make_order(id, SIDE_BUY, 1003, 50));
+  book_remove_order(&loaded, 3);
+  book_remove_order(&added, 3);
+  book_add_order(&loaded, make_order(id + 1, SIDE_SELL, 1000, 5));
+  book_add_order(&added, make_order(id + 1, SIDE_SELL, 1000, 5));
+  assert(loaded.stats.trade_count == added.stats.trade_count);
+  assert(loaded.stats.total_volume == added.stats.total_volume);
+  assert(loaded.orders.count == added.orders.count);
+  expect_top_matches_tree(&loaded, SIDE_BUY);
+  expect_top_matches_tree(&loaded, SIDE_SELL);
+
+  // Rejected: non-empty book, crossed sides, unsorted levels, wrong side
+  assert(book_load(&loaded, sides[0], 1, NULL, 0) == -1);
+  order_book_t bad;
+  book_init(&bad);
+  book_level_data_t crossed = {999, queues[1][0], PER_LEVEL};
+  assert(book_load(&bad, sides[0], 2, &crossed, 1) == -1);
+  book_level_data_t unsorted[2] = {sides[1][1], sides[1][0]};
+  assert(book_load(&bad, NULL, 0, unsorted, 2) == -1);
+  assert(book_load(&bad, sides[1], 1, NULL, 0) == -1);
+  assert(bad.bids.size == 0 && bad.asks.size == 0 && bad.orders.count == 0);
+  assert(book_load(&bad, NULL, 0, NULL, 0) == 0);
+  book_free(&bad);
+
+  book_free(&loaded);
+  book_free(&added);
+  for (int s = 0; s < 2; s++)
+    for (int i = 0; i < LEVELS; i++)
+      for (int k = 0; k < PER_LEVEL; k++)
+        free(queues[s][i][k]);
+  for (size_t i = 0; i < n_copies; i++)
+    free(copies[i]);
+  printf("PASSED\n");
+}
+
+// Test 18: Amend keeps queue priority only when it just takes size off
+static void test_amend(void)
+{
+  printf("test_amend... ");
+
+  order_book_t book;
+  book_init(&book);
+  assert(book_enable_reports(&book, 16) == 0);
+
+  order_t* o1 = make_order(1, SIDE_BUY, 100, 10);
+  order_t* o2 = make_order(2, SIDE_BUY, 100, 20);
+  order_t* o3 = make_order(3, SIDE_BUY, 99, 5);
+  book_add_order(&book, o1);
+  book_add_order(&book, o2);
+  book_add_order(&book, o3);
+
+  // Smaller at the same price: stays first, the cut is a partial cancel
+  assert(book_amend_order(&book, 1, 100, 4) == 0);
+  assert(book_queue_ahead(&book, 1) == 0 && book_queue_ahead(&book, 2) == 4);
+  assert(pt_find(&book.bids, 100)->total_qty == 24);
+  exec_report_t r;
+  assert(exec_ring_pop(&book.reports, &r));
+  assert(r.type == EXEC_CANCEL && r.order_id == 1 && r.qty == 6 && r.leaves_qty == 4);
+  assert(!exec_ring_pop(&book.reports, &r));
+  expect_top_matches_tree(&book, SIDE_BUY);
+
+  // Larger: back of the queue, no report
+  assert(book_amend_order(&book, 1, 100, 8) == 0);
+  assert(book_queue_ahead(&book, 2) == 0 && book_queue_ahead(&book, 1) == 20);
+  assert(!exec_ring_pop(&book.reports, &r));
+
+  // New price: leaves its level, the emptied level goes away
+  assert(book_amend_order(&book, 3, 101, 5) == 0);
+  assert(pt_find(&book.bids, 99) == NULL && pt_max(&book.bids)->price == 101);
+  assert(book_queue_ahead(&book, 3) == 0 && book.orders.count == 3);
+  expect_top_matches_tree(&book, SIDE_BUY);
+
+  // Crossing: matches like a new order, the rest rests at the new price
+  order_t* ask = make_order(4, SIDE_SELL, 103, 3);
+  book_add_order(&book, ask);
+  assert(book_amend_order(&book, 3, 103, 5) == 0);
+  assert(pt_min(&book.asks) == NULL && pt_max(&book.bids)->price == 103);
+  assert(o3->qty == 2 && book_queue_ahead(&book, 3) == 0);
+  while (exec_ring_pop(&book.reports, &r))
+    assert(r.type == EXEC_FILL && r.qty == 3);
+  expect_top_matches_tree(&book, SIDE_SELL);
+
+  // qty 0 cancels, unknown ids are refused
+  assert(book_amend_order(&book, 2, 100, 0) == 0);
+  assert(book_queue_ahead(&book, 2) == -1 && book_queue_ahead(&book, 1) == 0);
+  assert(book_amend_order(&book, 999, 100, 5) == -1);
+  assert(book_amend_order(&book, 2, 100, 5) == -1);
+
+  free(o1);
+  free(o2);
+  free(o3);
+  free(ask);
+  book_free(&book);
+  printf("PASSED\n");
+}
+
+// Test 19: Amending bulk-loaded orders leaves the loader's memory alone
+static void test_amend_bulk_loaded(void)
+{
+  printf("test_amend_bulk_loaded... ");
+
+  order_book_t book;
+  book_init(&book);
+
+  // One array, like a restored checkpoint's orders: free() on any of them aborts
+  order_t arena[3] = {
+      {.id = 1, .side = SIDE_BUY, .type = ORDER_LIMIT, .price = 99, .qty = 10},
+      {.id = 2, .side = SIDE_SELL, .type = ORDER_LIMIT, .price = 101, .qty = 10},
+      {.id = 3, .side = SIDE_SELL, .type = ORDER_LIMIT, .price = 110, .qty = 5}};
+  order_t* bid_queue[] = {&arena[0]};
+  order_t* near_queue[] = {&arena[1]};
+  order_t* far_queue[] = {&arena[2]};
+  book_level_data_t bids[] = {{99, bid_queue, 1}};
+  book_level_data_t asks[] = {{101, near_queue, 1}, {110, far_queue, 1}};
+  assert(book_load(&book, bids, 1, asks, 2) == 0);
+
+  // Through the ask: the re-entered bid fills completely and is freed by the book
+  assert(book_amend_order(&book, 1, 101, 10) == 0);
+  assert(!om_find(&book.orders, 1) && !om_find(&book.orders, 2));
+  assert(pt_max(&book.bids) == NULL && pt_min(&book.asks)->price == 110);
+  assert(arena[0].price == 99 && arena[0].qty == 10);
+
+  // To a new price: a heap copy rests there, the original stays as loaded
+  assert(book_amend_order(&book, 3, 108, 7) == 0);
+  om_entry_t* e = om_find(&book.orders, 3);
+  assert(e && e->price == 108 && e->order != &arena[2] && e->order->qty == 7);
+  assert(pt_find(&book.asks, 110) == NULL && arena[2].price == 110);
+  expect_top_matches_tree(&book, SIDE_SELL);
+
+  order_t* copy = e->order;
+  book_free(&book);
+  free(copy);
+  printf("PASSED\n");
+}
+
 int main(void)
 {
   printf("\n=== Running book tests ===\n\n");
@@ -354,6 +770,13 @@ int main(void)
   test_multiple_price_levels();
   test_remove_all_orders();
   test_null_inputs();
+  test_queue_position();
+  test_depth_tracking();
+  test_top_levels_cache();
+  test_batch_add();
+  test_bulk_load();
+  test_amend();
+  test_amend_bulk_loaded();
 
   printf("\n=== All tests PASSED ===\n\n");
   return 0;
@@ -0,0 +1,233 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "agents/crowd.h"
+#include "agents/informed_trader.h"
+#include "agents/market_maker.h"
+#include "agents/noise_trader.h"
+#include "core/book.h"
+#include "sim/checkpoint.h"
+#include "sim/simulator.h"
+
+/*
+  Smoke test for checkpoint/restore:
+  - a warmed-up run saved and restored into a fresh simulator continues
+    exactly like the original (trades, top of book, events, MM inventory),
+    with orders and reports still in flight at the save
+  - restored orders can be amended: a reprice that fills or rests again
+    works on a copy, since the originals live in the checkpoint's mapping
+  - mismatched agents, a non-empty book and a garbage file are refused
+    without touching the simulator
+*/
+
+#define CKPT_PATH "/tmp/lob_checkpoint_test.ckpt"
+#define N_NOISE 10
+#define N_MM 2
+#define N_INFORMED 2
+#define N_AGENTS (N_NOISE + N_MM + N_INFORMED + 1)
+
+typedef struct
+{
+  order_book_t book;
+  simulator_t* sim;
+  agent_t* agents[N_AGENTS];
+  size_t n_agents;
+} world_t;
+
+static void world_init(world_t* w, uint64_t seed, size_t n_agents)
+{
+  book_init(&w->book);
+  w->sim = simulator_init(&w->book);
+  w->n_agents = n_agents;
+
+  latency_dist_t delay = {.kind = LATENCY_EXPONENTIAL, .base = 1, .spread = 2.0};
+  for (size_t i = 0; i < n_agents; i++)
+  {
+    if (i < N_NOISE)
+      w->agents[i] = noise_trader_create((agent_id_t)(i + 1), seed);
+    else if (i < N_NOISE + N_MM)
+      w->agents[i] = market_maker_create((agent_id_t)(100 + i - N_NOISE), seed);
+    else if (i < N_NOISE + N_MM + N_INFORMED)
+      w->agents[i] = informed_trader_create((agent_id_t)(200 + i - N_NOISE - N_MM), seed);
+    else
+      w->agents[i] = crowd_create(300, seed, 2000);
+    simulator_add_agent(w->sim, w->agents[i]);
+
+    // Half the agents trade over a slow link
+    if (i % 2 == 0 && simulator_set_latency(w->sim, w->agents[i], &delay, &delay, seed) != 0)
+    {
+      fprintf(stderr, "Failed to set up latency\n");
+      exit(1);
+    }
+  }
+}
+
+static void world_free(world_t* w)
+{
+  simulator_free(w->sim);
+  for (size_t i = 0; i < w->n_agents; i++)
+  {
+    if (i < N_NOISE)
+      noise_trader_destroy(w->agents[i]);
+    else if (i < N_NOISE + N_MM)
+      market_maker_destroy(w->agents[i]);
+    else if (i < N_NOISE + N_MM + N_INFORMED)
+      informed_trader_destroy(w->agents[i]);
+    else
+      crowd_destroy(w->agents[i]);
+  }
+  book_free(&w->book);
+}
+
+typedef struct
+{
+  stats_t stats;
+  uint64_t events;
+  price_t bid, ask;
+  size_t bid_levels, ask_levels;
+  qty_t inventory[N_MM];
+} outcome_t;
+
+static outcome_t world_outcome(world_t* w)
+{
+  outcome_t o;
+  memset(&o, 0, sizeof o);
+  o.stats = w->book.stats;
+  o.events = simulator_events_processed(w->sim);
+
+  depth_entry_t bid, ask;
+  if (book_top_levels(&w->book, SIDE_BUY, &bid, 1))
+    o.bid = bid.price;
+  if (book_top_levels(&w->book, SIDE_SELL, &ask, 1))
+    o.ask = ask.price;
+  for (price_level_t* l = pt_min(&w->book.bids); l; l = pt_next_above(&w->book.bids, l->price))
+    o.bid_levels++;
+  for (price_level_t* l = pt_min(&w->book.asks); l; l = pt_next_above(&w->book.asks, l->price))
+    o.ask_levels++;
+  for (size_t i = 0; i < N_MM; i++)
+    o.inventory[i] = market_maker_inventory(w->agents[N_NOISE + i]);
+  return o;
+}
+
+static void test_roundtrip(void)
+{
+  world_t a;
+  world_init(&a, 11, N_AGENTS);
+  simulator_run(a.sim, sim_ticks_to_ns(3000));
+  assert(eq_size(&a.sim->events) > 0);
+  assert(checkpoint_save(a.sim, CKPT_PATH) == 0);
+  timestamp_t saved_at = sim_time_now(&a.sim->clock);
+
+  simulator_run(a.sim, sim_ticks_to_ns(6000));
+  outcome_t want = world_outcome(&a);
+  assert(want.stats.trade_count > 0);
+
+  world_t b;
+  world_init(&b, 11, N_AGENTS);
+  checkpoint_t* ckpt = checkpoint_restore(b.sim, CKPT_PATH);
+  assert(ckpt != NULL);
+  assert(sim_time_now(&b.sim->clock) == saved_at);
+  simulator_run(b.sim, sim_ticks_to_ns(6000));
+  outcome_t got = world_outcome(&b);
+
+  assert(got.stats.trade_count == want.stats.trade_count);
+  assert(got.stats.total_volume == want.stats.total_volume);
+  assert(got.events == want.events);
+  assert(got.bid == want.bid && got.ask == want.ask);
+  assert(got.bid_levels == want.bid_levels && got.ask_levels == want.ask_levels);
+  for (size_t i = 0; i < N_MM; i++)
+    assert(got.inventory[i] == want.inventory[i]);
+
+  world_free(&b);
+  checkpoint_close(ckpt);
+  world_free(&a);
+}
+
+static order_t* make_order(order_id_t id, side_t side, price_t price, qty_t qty)
+{
+  order_t* o = (order_t*)malloc(sizeof(order_t));
+  o->id = id;
+  o->side = side;
+  o->type = ORDER_LIMIT;
+  o->price = price;
+  o->qty = qty;
+  o->ts = 0;
+  return o;
+}
+
+static void test_amend_restored(void)
+{
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+  order_id_t bid = order_id_first(1), ask = order_id_first(2), far = order_id_first(3);
+  book_add_order(&book, make_order(bid, SIDE_BUY, 99, 10));
+  book_add_order(&book, make_order(ask, SIDE_SELL, 101, 10));
+  book_add_order(&book, make_order(far, SIDE_SELL, 110, 5));
+  assert(checkpoint_save(sim, CKPT_PATH) == 0);
+  simulator_free(sim);
+  book_free(&book);
+
+  book_init(&book);
+  sim = simulator_init(&book);
+  checkpoint_t* ckpt = checkpoint_restore(sim, CKPT_PATH);
+  assert(ckpt != NULL);
+
+  // The bid crosses the whole ask and is done; the far ask moves and rests
+  assert(book_amend_order(&book, bid, 101, 10) == 0);
+  assert(book.stats.trade_count == 1 && om_find(&book.orders, bid) == NULL);
+  assert(om_find(&book.orders, ask) == NULL);
+  assert(book_amend_order(&book, far, 108, 7) == 0);
+  om_entry_t* moved = om_find(&book.orders, far);
+  assert(moved && moved->order->price == 108 && moved->order->qty == 7);
+  assert(pt_min(&book.asks)->price == 108 && pt_max(&book.bids) == NULL);
+  book_remove_order(&book, far);
+  assert(pt_min(&book.asks) == NULL);
+
+  simulator_free(sim);
+  book_free(&book);
+  checkpoint_close(ckpt);
+  remove(CKPT_PATH);
+}
+
+static void test_refused(void)
+{
+  // Different agents
+  world_t w;
+  world_init(&w, 11, N_AGENTS - 1);
+  assert(checkpoint_restore(w.sim, CKPT_PATH) == NULL);
+  assert(pt_min(&w.book.bids) == NULL && pt_min(&w.book.asks) == NULL);
+  world_free(&w);
+
+  // A book that already holds orders
+  world_init(&w, 11, N_AGENTS);
+  simulator_run(w.sim, sim_ticks_to_ns(10));
+  uint64_t events = simulator_events_processed(w.sim);
+  assert(checkpoint_restore(w.sim, CKPT_PATH) == NULL);
+  assert(simulator_events_processed(w.sim) == events);
+  world_free(&w);
+
+  // Not a checkpoint
+  FILE* f = fopen(CKPT_PATH, "wb");
+  assert(f);
+  for (int i = 0; i < 1000; i++)
+    fputc(i & 0xFF, f);
+  fclose(f);
+  world_init(&w, 11, N_AGENTS);
+  assert(checkpoint_restore(w.sim, CKPT_PATH) == NULL);
+  assert(checkpoint_restore(w.sim, "/nonexistent/lob.ckpt") == NULL);
+  world_free(&w);
+  remove(CKPT_PATH);
+}
+
+int main(void)
+{
+  test_roundtrip();
+  test_amend_restored();
+  test_refused();
+
+  printf("checkpoint_test passed\n");
+  return 0;
+}
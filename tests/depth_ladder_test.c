@@ -0,0 +1,112 @@
+#define _DEFAULT_SOURCE
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "core/depth_ladder.h"
+
+/*
+  Regression test for depth_ladder.c:
+  - prefix depth from the touch on both sides
+  - price-at-cumulative-qty descent
+  - out-of-range prices are ignored
+  - random churn against a brute-force ladder
+*/
+
+static void test_asks_basic(void)
+{
+  depth_ladder_t dl;
+  assert(dl_init(&dl, 100, 199, 0) == 0);
+
+  assert(dl_add(&dl, 101, 10) == 1);
+  assert(dl_add(&dl, 103, 20) == 1);
+  assert(dl_add(&dl, 150, 5) == 1);
+  assert(dl_add(&dl, 500, 99) == 0); // outside
+
+  assert(dl_depth_until(&dl, 100) == 0);
+  assert(dl_depth_until(&dl, 101) == 10);
+  assert(dl_depth_until(&dl, 149) == 30);
+  assert(dl_depth_until(&dl, 1000) == 35);
+  assert(dl_depth_until(&dl, 1) == 0);
+
+  price_t p;
+  assert(dl_price_for_qty(&dl, 1, &p) == 1 && p == 101);
+  assert(dl_price_for_qty(&dl, 10, &p) == 1 && p == 101);
+  assert(dl_price_for_qty(&dl, 11, &p) == 1 && p == 103);
+  assert(dl_price_for_qty(&dl, 35, &p) == 1 && p == 150);
+  assert(dl_price_for_qty(&dl, 36, &p) == 0);
+
+  dl_free(&dl);
+}
+
+static void test_bids_basic(void)
+{
+  depth_ladder_t dl;
+  assert(dl_init(&dl, 1, 1000, 1) == 0);
+
+  dl_add(&dl, 999, 10);
+  dl_add(&dl, 990, 20);
+  dl_add(&dl, 500, 30);
+
+  assert(dl_depth_until(&dl, 999) == 10);
+  assert(dl_depth_until(&dl, 990) == 30);
+  assert(dl_depth_until(&dl, 1) == 60);
+  assert(dl_depth_until(&dl, 2000) == 0);
+
+  price_t p;
+  assert(dl_price_for_qty(&dl, 25, &p) == 1 && p == 990);
+  assert(dl_price_for_qty(&dl, 60, &p) == 1 && p == 500);
+
+  // Level drains away
+  dl_add(&dl, 990, -20);
+  assert(dl_price_for_qty(&dl, 25, &p) == 1 && p == 500);
+
+  dl_free(&dl);
+}
+
+static void test_random_against_brute_force(void)
+{
+  enum
+  {
+    N = 257
+  };
+  qty_t ref[N] = {0};
+  depth_ladder_t dl;
+  assert(dl_init(&dl, 1000, 1000 + N - 1, 0) == 0);
+  unsigned int seed = 11;
+
+  for (int step = 0; step < 20000; step++)
+  {
+    int i = rand_r(&seed) % N;
+    qty_t delta = (ref[i] > 0 && rand_r(&seed) % 2) ? -(1 + rand_r(&seed) % ref[i]) : rand_r(&seed) % 40;
+    dl_add(&dl, 1000 + i, delta);
+    ref[i] += delta;
+
+    int probe = rand_r(&seed) % N;
+    qty_t sum = 0;
+    for (int k = 0; k <= probe; k++)
+      sum += ref[k];
+    assert(dl_depth_until(&dl, 1000 + probe) == sum);
+
+    if (sum > 0)
+    {
+      price_t p;
+      assert(dl_price_for_qty(&dl, sum, &p) == 1);
+      assert(p <= 1000 + probe);
+      assert(dl_depth_until(&dl, p) >= sum);
+      assert(dl_depth_until(&dl, p - 1) < sum);
+    }
+  }
+
+  dl_free(&dl);
+}
+
+int main(void)
+{
+  test_asks_basic();
+  test_bids_basic();
+  test_random_against_brute_force();
+
+  printf("depth_ladder_test: OK\n");
+  return 0;
+}
@@ -0,0 +1,190 @@
+#define _DEFAULT_SOURCE
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim/event.h"
+
+/*
+  Regression test for the radix-heap event queue in event.c:
+  - pops in timestamp order
+  - FIFO among equal timestamps
+  - rejects pushes into the past and beyond max_size
+  - eq_pop_same_ts drains one instant without moving time forward
+  - a refill that pours one bucket into another keeps every event
+  - random interleaved push/pop against a brute-force reference
+*/
+
+static event_t make_event(timestamp_t ts, order_id_t tag)
+{
+  event_t ev = {.ts = ts, .type = EVENT_CANCEL, .payload.cancel_id = tag};
+  return ev;
+}
+
+static void test_order_and_ties(void)
+{
+  event_queue_t q;
+  eq_init(&q, 100);
+
+  timestamp_t ts[] = {50, 3, 7, 3, 1000000, 7, 0};
+  for (size_t i = 0; i < sizeof ts / sizeof ts[0]; i++)
+  {
+    event_t ev = make_event(ts[i], i);
+    assert(eq_push(&q, &ev) == 0);
+  }
+  assert(eq_size(&q) == 7);
+
+  order_id_t expected[] = {6, 1, 3, 2, 5, 0, 4};
+  event_t ev;
+  for (size_t i = 0; i < 7; i++)
+  {
+    assert(eq_pop(&q, &ev) == 1);
+    assert(ev.payload.cancel_id == expected[i]);
+  }
+  assert(eq_pop(&q, &ev) == 0);
+
+  // Past timestamps are rejected once time has moved on
+  event_t past = make_event(10, 99);
+  assert(eq_push(&q, &past) == -1);
+
+  eq_free(&q);
+}
+
+static void test_capacity(void)
+{
+  event_queue_t q;
+  eq_init(&q, 2);
+  event_t ev = make_event(1, 0);
+  assert(eq_push(&q, &ev) == 0);
+  assert(eq_push(&q, &ev) == 0);
+  assert(eq_push(&q, &ev) == -1);
+  eq_free(&q);
+}
+
+static void test_pop_same_ts(void)
+{
+  event_queue_t q;
+  eq_init(&q, 100);
+
+  timestamp_t ts[] = {5, 5, 5, 9};
+  for (size_t i = 0; i < 4; i++)
+  {
+    event_t ev = make_event(ts[i], i);
+    assert(eq_push(&q, &ev) == 0);
+  }
+
+  event_t ev;
+  assert(eq_pop_same_ts(&q, &ev) == 0); // nothing popped yet
+  assert(eq_pop(&q, &ev) == 1 && ev.ts == 5);
+  assert(eq_pop_same_ts(&q, &ev) == 1 && ev.payload.cancel_id == 1);
+  assert(eq_pop_same_ts(&q, &ev) == 1 && ev.payload.cancel_id == 2);
+  assert(eq_pop_same_ts(&q, &ev) == 0);
+
+  // Time is still 5: an event between now and the next pending one is accepted
+  event_t mid = make_event(7, 42);
+  assert(eq_push(&q, &mid) == 0);
+  assert(eq_pop(&q, &ev) == 1 && ev.payload.cancel_id == 42);
+  assert(eq_pop(&q, &ev) == 1 && ev.payload.cancel_id == 3);
+  assert(eq_size(&q) == 0);
+
+  eq_free(&q);
+}
+
+static void test_random_against_reference(void)
+{
+  enum
+  {
+    N = 20000
+  };
+  event_queue_t q;
+  eq_init(&q, N);
+  static timestamp_t ref[N];
+  static uint64_t ref_tag[N];
+  size_t ref_n = 0;
+  timestamp_t now = 0;
+  uint64_t tag = 0;
+  unsigned int seed = 5;
+
+  for (int step = 0; step < 3 * N; step++)
+  {
+    if (ref_n < N && (ref_n == 0 || rand_r(&seed) % 3 != 0))
+    {
+      timestamp_t ts = now + (rand_r(&seed) % 4 == 0 ? 0 : (timestamp_t)(rand_r(&seed) % 5000));
+      event_t ev = make_event(ts, tag);
+      assert(eq_push(&q, &ev) == 0);
+      ref[ref_n] = ts;
+      ref_tag[ref_n] = tag++;
+      ref_n++;
+    }
+    else
+    {
+      // Reference: smallest ts, then smallest tag (= push order)
+      size_t best = 0;
+      for (size_t i = 1; i < ref_n; i++)
+      {
+        if (ref[i] < ref[best] || (ref[i] == ref[best] && ref_tag[i] < ref_tag[best]))
+          best = i;
+      }
+
+      timestamp_t peek;
+      assert(eq_peek_ts(&q, &peek) == 1 && peek == ref[best]);
+
+      event_t ev;
+      assert(eq_pop(&q, &ev) == 1);
+      assert(ev.ts == ref[best]);
+      assert(ev.payload.cancel_id == ref_tag[best]);
+
+      now = ev.ts;
+      ref[best] = ref[ref_n - 1];
+      ref_tag[best] = ref_tag[ref_n - 1];
+      ref_n--;
+    }
+    assert(eq_size(&q) == ref_n);
+  }
+
+  eq_free(&q);
+}
+
+// Hundreds of events sharing one far timestamp all move into bucket 0 at
+// once, well past its first allocation; none may go missing
+static void test_refill_keeps_all(void)
+{
+  enum
+  {
+    N = 500
+  };
+  event_queue_t q;
+  eq_init(&q, N + 2);
+
+  event_t ev = make_event(1, N);
+  assert(eq_push(&q, &ev) == 0);
+  for (order_id_t i = 0; i < N; i++)
+  {
+    ev = make_event(1u << 20, i);
+    assert(eq_push(&q, &ev) == 0);
+  }
+  ev = make_event((1u << 20) + 1, N + 1);
+  assert(eq_push(&q, &ev) == 0);
+
+  assert(eq_pop(&q, &ev) == 1 && ev.payload.cancel_id == N);
+  for (order_id_t i = 0; i < N; i++)
+  {
+    assert(eq_pop(&q, &ev) == 1);
+    assert(ev.ts == 1u << 20 && ev.payload.cancel_id == i);
+  }
+  assert(eq_pop(&q, &ev) == 1 && ev.payload.cancel_id == N + 1);
+  assert(eq_pop(&q, &ev) == 0);
+  eq_free(&q);
+}
+
+int main(void)
+{
+  test_order_and_ties();
+  test_capacity();
+  test_pop_same_ts();
+  test_random_against_reference();
+  test_refill_keeps_all();
+
+  printf("event_queue_test: OK\n");
+  return 0;
+}
@@ -0,0 +1,258 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "agents/agent_registry.h"
+#include "agents/informed_trader.h"
+#include "agents/mean_reversion_trader.h"
+#include "agents/momentum_trader.h"
+#include "agents/noise_trader.h"
+#include "common/rng.h"
+#include "core/book.h"
+#include "sim/indicators.h"
+#include "sim/simulator.h"
+
+/*
+  Smoke test for the streaming indicators and the agents reading them:
+  - every kind matches a brute-force recomputation over the same fills
+  - equal registrations share one indicator
+  - one registered after fills starts from its own first fill
+  - save / load resumes exactly, and refuses an engine set up differently
+  - momentum and mean-reversion traders share one engine, trade, and run the
+    same on 1 and 4 threads
+*/
+
+enum { FILLS = 20000 };
+
+static price_t prices[FILLS];
+
+static void random_walk(void)
+{
+  rng_t rng;
+  rng_init_stream(&rng, 99, 0);
+  price_t p = 1000;
+  for (size_t i = 0; i < FILLS; i++)
+  {
+    p += (price_t)rng_below(&rng, 7) - 3;
+    prices[i] = p;
+  }
+}
+
+// The value of `kind` over window `w` after fills 0..n-1
+static double brute(indicator_kind_t kind, size_t w, size_t n)
+{
+  size_t first = n > w ? n - w : 0;
+  double v = 0.0;
+  switch (kind)
+  {
+  case IND_EMA:
+    v = (double)prices[0];
+    for (size_t i = 1; i < n; i++)
+      v += 2.0 / ((double)w + 1.0) * ((double)prices[i] - v);
+    return v;
+  case IND_MEAN:
+    for (size_t i = first; i < n; i++)
+      v += (double)prices[i];
+    return v / (double)(n - first);
+  case IND_RETURN:
+    first = n > w + 1 ? n - w - 1 : 0;
+    return (double)(prices[n - 1] - prices[first]) / (double)prices[first];
+  case IND_MIN:
+  case IND_MAX:
+    v = (double)prices[first];
+    for (size_t i = first; i < n; i++)
+      v = (kind == IND_MIN) ? fmin(v, (double)prices[i]) : fmax(v, (double)prices[i]);
+    return v;
+  }
+  return 0.0;
+}
+
+static void test_against_brute_force(void)
+{
+  static const size_t windows[] = {1, 2, 7, 64, 500};
+  indicators_t ind;
+  indicators_init(&ind);
+  int handles[5][5];
+  for (int k = IND_EMA; k <= IND_MAX; k++)
+    for (size_t w = 0; w < 5; w++)
+      handles[k][w] = indicators_add(&ind, (indicator_kind_t)k, windows[w]);
+  assert(ind.count == 25);
+
+  for (size_t n = 1; n <= FILLS; n++)
+  {
+    indicators_on_trade(&ind, prices[n - 1]);
+    if (n % 97 != 0 && n > 600)
+      continue;
+    for (int k = IND_EMA; k <= IND_MAX; k++)
+    {
+      for (size_t w = 0; w < 5; w++)
+      {
+        int h = handles[k][w];
+        size_t need = (k == IND_RETURN) ? windows[w] + 1 : windows[w];
+        assert(indicators_ready(&ind, h) == (n >= need));
+        assert(fabs(indicators_value(&ind, h) - brute((indicator_kind_t)k, windows[w], n)) < 1e-6);
+      }
+    }
+  }
+  assert(ind.fills == FILLS && ind.last == prices[FILLS - 1]);
+  indicators_free(&ind);
+}
+
+static void test_sharing(void)
+{
+  indicators_t ind;
+  indicators_init(&ind);
+  int a = indicators_add(&ind, IND_EMA, 20);
+  int b = indicators_add(&ind, IND_EMA, 21);
+  assert(a >= 0 && b >= 0 && a != b);
+  assert(indicators_add(&ind, IND_EMA, 20) == a);
+  assert(indicators_add(&ind, IND_MAX, 20) != a);
+  assert(indicators_add(&ind, IND_MIN, 0) == -1);
+  assert(ind.count == 3);
+  assert(indicators_value(&ind, a) == 0.0 && !indicators_ready(&ind, a));
+  indicators_free(&ind);
+}
+
+static void test_late_registration(void)
+{
+  enum { EARLY = 300, WINDOW = 20 };
+  indicators_t ind;
+  indicators_init(&ind);
+  int early = indicators_add(&ind, IND_EMA, 5);
+  for (size_t i = 0; i < EARLY; i++)
+    indicators_on_trade(&ind, prices[i]);
+  assert(indicators_ready(&ind, early));
+
+  int ema = indicators_add(&ind, IND_EMA, WINDOW);
+  int low = indicators_add(&ind, IND_MIN, WINDOW);
+  assert(!indicators_ready(&ind, ema) && indicators_value(&ind, ema) == 0.0);
+  double want = 0.0;
+  for (size_t i = EARLY; i < EARLY + 2 * WINDOW; i++)
+  {
+    indicators_on_trade(&ind, prices[i]);
+    want = (i == EARLY) ? (double)prices[i] : want + 2.0 / (WINDOW + 1.0) * ((double)prices[i] - want);
+    size_t seen = i - EARLY + 1;
+    assert(indicators_ready(&ind, ema) == (seen >= WINDOW));
+    assert(indicators_ready(&ind, low) == (seen >= WINDOW));
+    assert(fabs(indicators_value(&ind, ema) - want) < 1e-9);
+  }
+  indicators_free(&ind);
+}
+
+static void setup(indicators_t* ind, int swapped)
+{
+  indicators_init(ind);
+  indicators_add(ind, IND_EMA, 30);
+  indicators_add(ind, swapped ? IND_MAX : IND_MIN, 50);
+  indicators_add(ind, swapped ? IND_MIN : IND_MAX, 50);
+  indicators_add(ind, IND_MEAN, 40);
+  indicators_add(ind, IND_RETURN, 10);
+}
+
+static void test_save_load(void)
+{
+  indicators_t ind, resumed, other;
+  setup(&ind, 0);
+  setup(&resumed, 0);
+  setup(&other, 1);
+  for (size_t i = 0; i < 1234; i++)
+    indicators_on_trade(&ind, prices[i]);
+
+  size_t len = indicators_save(&ind, NULL, 0);
+  void* blob = malloc(len);
+  assert(blob && indicators_save(&ind, blob, len) == len);
+  assert(indicators_load(&other, blob, len) == -1 && other.fills == 0);
+  assert(indicators_load(&resumed, blob, len - 8) == -1);
+  assert(indicators_load(&resumed, blob, len) == 0);
+
+  for (size_t i = 1234; i < 3000; i++)
+  {
+    indicators_on_trade(&ind, prices[i]);
+    indicators_on_trade(&resumed, prices[i]);
+  }
+  for (int h = 0; h < 5; h++)
+    assert(indicators_value(&ind, h) == indicators_value(&resumed, h));
+
+  free(blob);
+  indicators_free(&ind);
+  indicators_free(&resumed);
+  indicators_free(&other);
+}
+
+// Both kinds of trader on one engine; returns the trade count
+static size_t run_traders(int threads, qty_t* positions)
+{
+  enum { N = 20 };
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+  assert(simulator_set_parallel(sim, threads, SEQUENCE_BY_ID, 9) == 0);
+  indicators_t ind;
+  indicators_init(&ind);
+  book.indicators = &ind;
+
+  agent_registry_t reg;
+  agent_registry_init(&reg);
+  agent_t* noise = agent_registry_add(&reg, &noise_trader_type, 60, 1, 9, NULL);
+  agent_t* informed = agent_registry_add(&reg, &informed_trader_type, 20, 200, 9, NULL);
+  agent_t* momentum = agent_registry_add(&reg, &momentum_trader_type, N, 400, 9, &ind);
+  agent_t* reverting = agent_registry_add(&reg, &mean_reversion_trader_type, N, 500, 9, &ind);
+  assert(noise && informed && momentum && reverting);
+  assert(agent_registry_add(&reg, &momentum_trader_type, 1, 600, 9, NULL) == NULL);
+  assert(ind.count == 6); // 3 each, however many agents read them
+
+  agent_t* groups[] = {noise, informed, momentum, reverting};
+  size_t counts[] = {60, 20, N, N};
+  for (size_t g = 0; g < 4; g++)
+    for (size_t i = 0; i < counts[g]; i++)
+      simulator_add_agent(sim, &groups[g][i]);
+  simulator_run(sim, sim_ticks_to_ns(50000));
+
+  for (size_t i = 0; i < N; i++)
+  {
+    positions[i] = momentum_trader_position(&momentum[i]);
+    positions[N + i] = mean_reversion_trader_position(&reverting[i]);
+    assert(positions[i] >= -MOMENTUM_MAX_POSITION && positions[i] <= MOMENTUM_MAX_POSITION);
+    assert(positions[N + i] >= -MEAN_REV_MAX_POSITION && positions[N + i] <= MEAN_REV_MAX_POSITION);
+  }
+  size_t trades = stats_snapshot(&book.stats).trade_count;
+  assert(ind.fills == trades);
+
+  simulator_free(sim);
+  agent_registry_free(&reg);
+  indicators_free(&ind);
+  book_free(&book);
+  return trades;
+}
+
+static void test_traders(void)
+{
+  static qty_t serial[40], parallel[40];
+  size_t a = run_traders(1, serial);
+  size_t b = run_traders(4, parallel);
+  assert(a > 0 && a == b);
+  int momentum_traded = 0, reverting_traded = 0;
+  for (size_t i = 0; i < 40; i++)
+  {
+    assert(serial[i] == parallel[i]);
+    if (i < 20)
+      momentum_traded += serial[i] != 0;
+    else
+      reverting_traded += serial[i] != 0;
+  }
+  assert(momentum_traded > 0 && reverting_traded > 0);
+}
+
+int main(void)
+{
+  random_walk();
+  test_against_brute_force();
+  test_sharing();
+  test_late_registration();
+  test_save_load();
+  test_traders();
+
+  printf("indicators_test passed\n");
+  return 0;
+}
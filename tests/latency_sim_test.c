@@ -0,0 +1,234 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "core/book.h"
+#include "sim/market_view.h"
+#include "sim/net_latency.h"
+#include "sim/simulator.h"
+
+/*
+  Smoke test for simulated network latency:
+  - delay distributions stay in range; a link never reorders its messages
+  - view history returns the newest snapshot at or before a time
+  - an order reaches the book only after its one-way delay, and is stamped
+    with the clock when it gets there; so are its fill reports
+  - execution reports and market data reach a slow agent late
+  - a million messages in flight at once
+  - a wakeup the event queue has no room for is counted
+*/
+
+typedef struct
+{
+  size_t reports;
+  timestamp_t report_ts; // of the last report
+  price_t seen_bid[16];  // best bid in the view, per tick
+} probe_state_t;
+
+// t=0: rest a bid at 100. Every tick: note the best bid it is shown.
+static timestamp_t probe_step(agent_t* agent, order_book_t* book, const market_view_t* view,
+                              timestamp_t now)
+{
+  probe_state_t* st = agent->state;
+  if (now < 16)
+    st->seen_bid[now] = view->best_bid;
+  if (now == 0)
+  {
+    order_t* o = malloc(sizeof(order_t));
+    *o = (order_t){.id = order_id_first(agent->id), .side = SIDE_BUY, .type = ORDER_LIMIT,
+                   .price = 100, .qty = 5, .ts = now};
+    agent_submit(agent, book, o);
+  }
+  return now + 1;
+}
+
+static void probe_on_exec(agent_t* agent, order_book_t* book, const exec_report_t* reports,
+                          size_t n)
+{
+  (void)book;
+  probe_state_t* st = agent->state;
+  for (size_t i = 0; i < n; i++)
+  {
+    assert(reports[i].type == EXEC_FILL && reports[i].leaves_qty == 0);
+    st->report_ts = reports[i].ts;
+  }
+  st->reports += n;
+}
+
+// Hits the bid at t=8, with no delay of its own
+static timestamp_t hitter_step(agent_t* agent, order_book_t* book, const market_view_t* view,
+                               timestamp_t now)
+{
+  (void)view;
+  if (now < 8)
+    return 8;
+  order_t* o = malloc(sizeof(order_t));
+  *o = (order_t){.id = order_id_first(agent->id), .side = SIDE_SELL, .type = ORDER_LIMIT,
+                 .price = 100, .qty = 5, .ts = now};
+  agent_submit(agent, book, o);
+  return AGENT_NO_WAKEUP;
+}
+
+static size_t flood_n;
+
+// Sends flood_n cancels at t=0; they land over the next thousand ticks
+static timestamp_t flood_step(agent_t* agent, order_book_t* book, const market_view_t* view,
+                              timestamp_t now)
+{
+  (void)view;
+  (void)now;
+  for (size_t i = 0; i < flood_n; i++)
+    agent_cancel(agent, book, order_id_first(agent->id) + i);
+  return AGENT_NO_WAKEUP;
+}
+
+static void test_distributions(void)
+{
+  rng_t rng;
+  rng_seed(&rng, 3);
+  latency_dist_t none = {.kind = LATENCY_NONE};
+  latency_dist_t fixed = {.kind = LATENCY_FIXED, .base = 7};
+  latency_dist_t uni = {.kind = LATENCY_UNIFORM, .base = 2, .spread = 10};
+  latency_dist_t ex = {.kind = LATENCY_EXPONENTIAL, .base = 3, .spread = 20};
+  double mean = 0;
+  for (int i = 0; i < 100000; i++)
+  {
+    assert(latency_sample(&none, &rng) == 0);
+    assert(latency_sample(&fixed, &rng) == 7);
+    timestamp_t u = latency_sample(&uni, &rng);
+    assert(u >= 2 && u <= 12);
+    timestamp_t e = latency_sample(&ex, &rng);
+    assert(e >= 3);
+    mean += (double)e;
+  }
+  mean /= 100000;
+  assert(mean > 22.0 && mean < 24.0);
+
+  net_link_t link;
+  net_link_init(&link, &ex, &ex, 1, 5);
+  timestamp_t last = 0;
+  for (timestamp_t t = 0; t < 10000; t++)
+  {
+    timestamp_t at = net_link_send(&link, t);
+    assert(at >= t + 3 && at >= last);
+    last = at;
+  }
+}
+
+static void test_history(void)
+{
+  market_view_history_t hist;
+  assert(market_view_history_init(&hist, 3) == 0);
+  assert(market_view_history_at(&hist, 5) == NULL);
+
+  market_view_t v = {0};
+  for (timestamp_t ts = 10; ts <= 40; ts += 10)
+  {
+    v.ts = ts;
+    v.best_bid = (price_t)ts;
+    market_view_history_record(&hist, &v);
+  }
+  v.best_bid = 41; // same ts replaces the newest
+  market_view_history_record(&hist, &v);
+
+  assert(hist.count == 3);                                 // 10 was overwritten
+  assert(market_view_history_at(&hist, 5)->best_bid == 20); // older than all: oldest
+  assert(market_view_history_at(&hist, 29)->best_bid == 20);
+  assert(market_view_history_at(&hist, 30)->best_bid == 30);
+  assert(market_view_history_at(&hist, 99)->best_bid == 41);
+  market_view_history_free(&hist);
+}
+
+static void test_delays_in_sim(void)
+{
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+
+  probe_state_t st = {0};
+  agent_t probe = {.id = 1, .step = probe_step, .on_exec = probe_on_exec, .state = &st};
+  agent_t hitter = {.id = 2, .step = hitter_step};
+  simulator_add_agent(sim, &probe);
+  simulator_add_agent(sim, &hitter);
+
+  latency_dist_t out = {.kind = LATENCY_FIXED, .base = 5};
+  latency_dist_t in = {.kind = LATENCY_FIXED, .base = 3};
+  assert(simulator_set_latency(sim, &probe, &out, &in, 1) == 0);
+
+  // Sent at 0, in the book at 5
+  simulator_run(sim, 5);
+  assert(book.version == 0);
+  simulator_run(sim, 6);
+  om_entry_t* e = om_find(&book.orders, order_id_first(1));
+  assert(e != NULL && e->order->ts == 5); // sent at 0
+  order_t* resting = e->order;
+
+  // Hit at 8; the fill report crosses the link and lands at 11
+  simulator_run(sim, 11);
+  assert(book.stats.trade_count == 1 && st.reports == 0);
+  simulator_run(sim, 12);
+  assert(st.reports == 1 && st.report_ts == 8);
+  assert(sim_time_now(&sim->clock) == 12 && sim_time_advance_to(&sim->clock, 11) == -1);
+
+  // Market data is 3 ticks old: the bid that rested at 5 is visible from 8 on
+  // and the fill at 8 is seen at 11
+  assert(st.seen_bid[7] == 0 && st.seen_bid[8] == 100);
+  assert(st.seen_bid[10] == 100 && st.seen_bid[11] == 0);
+
+  simulator_free(sim);
+  book_free(&book);
+  free(resting);
+}
+
+static void test_flood(void)
+{
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+  agent_t flood = {.id = 3, .step = flood_step};
+  simulator_add_agent(sim, &flood);
+  latency_dist_t out = {.kind = LATENCY_UNIFORM, .base = 1, .spread = 1000};
+  latency_dist_t none = {.kind = LATENCY_NONE};
+  assert(simulator_set_latency(sim, &flood, &out, &none, 9) == 0);
+
+  flood_n = 1000000;
+  simulator_run(sim, 1);
+  assert(eq_size(&sim->events) == flood_n && sim->messages_dropped == 0);
+  simulator_run(sim, 2000);
+  assert(eq_size(&sim->events) == 0);
+  assert(simulator_events_processed(sim) == flood_n + 1);
+
+  simulator_free(sim);
+  book_free(&book);
+}
+
+static void test_full_queue_wakeup(void)
+{
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+  sim->events.max_size = 1;
+  event_t filler = {.ts = 5, .type = EVENT_CANCEL, .payload.cancel_id = 1};
+  assert(simulator_schedule(sim, &filler) == 0);
+
+  // The first wakeup of a new agent does not fit
+  agent_t sleeper = {.id = 4, .step = flood_step};
+  simulator_add_agent(sim, &sleeper);
+  assert(eq_size(&sim->events) == 1 && sim->wakeups_dropped == 1);
+  assert(sim->messages_dropped == 0);
+
+  simulator_free(sim);
+  book_free(&book);
+}
+
+int main(void)
+{
+  test_distributions();
+  test_history();
+  test_delays_in_sim();
+  test_flood();
+  test_full_queue_wakeup();
+
+  printf("latency_sim_test passed\n");
+  return 0;
+}
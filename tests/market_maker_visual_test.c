@@ -127,7 +127,7 @@ int main(void)
 {
   order_book_t book;
   book_init(&book);
-  simulator_init(&book);
+  simulator_t* sim = simulator_init(&book);
 
   // Create agents
   int num_noise = 5;
@@ -139,15 +139,15 @@ int main(void)
   // Add noise traders
   for (int i = 0; i < num_noise; ++i)
   {
-    noise_agents[i] = noise_trader_create(i + 1);
-    simulator_add_agent(noise_agents[i]);
+    noise_agents[i] = noise_trader_create(i + 1, 0);
+    simulator_add_agent(sim, noise_agents[i]);
   }
 
   // Add market makers
   for (int i = 0; i < num_mm; ++i)
   {
-    mm_agents[i] = market_maker_create(100 + i);
-    simulator_add_agent(mm_agents[i]);
+    mm_agents[i] = market_maker_create(100 + i, 0);
+    simulator_add_agent(sim, mm_agents[i]);
   }
 
   int total_ticks = 5000;
@@ -156,7 +156,7 @@ int main(void)
 
   for (int t = 0; t < total_ticks; t += display_every)
   {
-    simulator_run(t + display_every);
+    simulator_run(sim, sim_ticks_to_ns((timestamp_t)(t + display_every)));
     snprintf(msg, sizeof(msg), "Tick %d/%d", t + display_every, total_ticks);
     print_book(&book, msg, num_noise, num_mm);
     usleep(80000);
@@ -172,7 +172,7 @@ int main(void)
     market_maker_destroy(mm_agents[i]);
   }
 
-  simulator_free();
+  simulator_free(sim);
   book_free(&book);
 
   printf(COLOR_GREEN "\n  Simulation complete!\n" COLOR_RESET);
@@ -0,0 +1,85 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "core/book.h"
+#include "sim/market_view.h"
+
+/*
+  Smoke test for market_view.c:
+  - empty book falls back to DEFAULT_MID_PRICE
+  - one-sided and two-sided books: best prices, mid, spread, depth, imbalance
+  - refresh reuses the snapshot until the book changes
+  - last trade is picked up after matching
+*/
+
+static order_t* make_order(order_id_t id, side_t side, price_t price, qty_t qty)
+{
+  order_t* o = (order_t*)malloc(sizeof(order_t));
+  o->id = id;
+  o->side = side;
+  o->type = ORDER_LIMIT;
+  o->price = price;
+  o->qty = qty;
+  o->ts = 0;
+  return o;
+}
+
+int main(void)
+{
+  order_book_t book;
+  book_init(&book);
+  market_view_t view;
+
+  // Empty
+  market_view_build(&view, &book, 0);
+  assert(view.best_bid == 0 && view.best_ask == 0);
+  assert(view.mid == DEFAULT_MID_PRICE && view.spread == 0);
+  assert(view.bid_levels == 0 && view.ask_levels == 0 && view.imbalance == 0.0);
+  assert(market_view_refresh(&view, &book, 1) == 0);
+
+  // One-sided
+  order_t* b1 = make_order(1, SIDE_BUY, 99, 30);
+  book_add_order(&book, b1);
+  assert(market_view_refresh(&view, &book, 2) == 1);
+  assert(view.best_bid == 99 && view.best_ask == 0 && view.mid == 99 && view.spread == 0);
+  assert(view.imbalance == 1.0);
+
+  // Two-sided
+  order_t* b2 = make_order(2, SIDE_BUY, 98, 10);
+  order_t* a1 = make_order(3, SIDE_SELL, 103, 20);
+  book_add_order(&book, b2);
+  book_add_order(&book, a1);
+  assert(market_view_refresh(&view, &book, 3) == 1);
+  assert(view.best_bid == 99 && view.best_ask == 103);
+  assert(view.mid == 101 && view.spread == 4);
+  assert(view.bid_levels == 2 && view.bids[1].price == 98 && view.bids[1].qty == 10);
+  assert(view.ask_levels == 1 && view.asks[0].qty == 20);
+  assert(fabs(view.imbalance - (40.0 - 20.0) / 60.0) < 1e-12);
+  assert(view.last_trade_price == 0);
+
+  // Unchanged book: same snapshot
+  assert(market_view_refresh(&view, &book, 4) == 0);
+  assert(view.ts == 4);
+
+  // A trade moves the book and records the last trade
+  order_t* s1 = make_order(4, SIDE_SELL, 99, 5);
+  book_add_order(&book, s1);
+  assert(market_view_refresh(&view, &book, 5) == 1);
+  assert(view.last_trade_price == 99 && view.last_trade_qty == 5);
+  assert(view.bids[0].qty == 25);
+
+  // Cancel
+  book_remove_order(&book, 2);
+  assert(market_view_refresh(&view, &book, 6) == 1);
+  assert(view.bid_levels == 1);
+
+  book_free(&book);
+  free(b1);
+  free(b2);
+  free(a1);
+
+  printf("market_view_test: OK\n");
+  return 0;
+}
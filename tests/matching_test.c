@@ -339,6 +339,38 @@ static void test_null_inputs(void)
   printf("PASSED\n");
 }
 
+// Test 11: A fully filled resting order leaves the order map
+static void test_filled_order_leaves_map(void)
+{
+  printf("test_filled_order_leaves_map... ");
+
+  order_book_t book;
+  book_init(&book);
+
+  order_t* ask1 = make_order(1, SIDE_SELL, 100, 5);
+  order_t* ask2 = make_order(2, SIDE_SELL, 100, 5);
+  book_add_order(&book, ask1);
+  book_add_order(&book, ask2);
+
+  order_t* buy = make_order(3, SIDE_BUY, 100, 7);
+  trade_t trades[10];
+  assert(match_order(&book, buy, trades, 10) == 2);
+
+  assert(om_find(&book.orders, 1) == NULL);
+  assert(om_find(&book.orders, 2) != NULL);
+
+  // Cancelling the filled order is a no-op, not a walk over a freed node
+  book_remove_order(&book, 1);
+  assert(om_find(&book.orders, 2) != NULL);
+  assert(pt_find(&book.asks, 100)->total_qty == 3);
+
+  free(ask1);
+  free(ask2);
+  free(buy);
+  book_free(&book);
+  printf("PASSED\n");
+}
+
 int main(void)
 {
   printf("\n=== Running match_order tests ===\n\n");
@@ -353,6 +385,7 @@ int main(void)
   test_sell_order_matching();
   test_max_trades_limit();
   test_null_inputs();
+  test_filled_order_leaves_map();
 
   printf("\n=== All tests PASSED ===\n\n");
   return 0;
@@ -11,27 +11,48 @@ int main(void)
   book_init(&book);
 
   // 2. Initialize the simulator
-  simulator_init(&book);
+  simulator_t* sim = simulator_init(&book);
 
   // 3. Create and add noise traders
   int num_agents = 3;
   for (int i = 0; i < num_agents; ++i)
   {
-    agent_t* nt = noise_trader_create(i + 1);
+    agent_t* nt = noise_trader_create(i + 1, 0);
     if (!nt)
     {
       fprintf(stderr, "Failed to create noise trader %d\n", i + 1);
       return 1;
     }
-    simulator_add_agent(nt);
+    simulator_add_agent(sim, nt);
   }
 
   // 4. Run the simulation for 5000 ticks
   printf("Running simulation with %d noise traders for 5000 ticks...\n", num_agents);
-  simulator_run(5000);
+  simulator_run(sim, sim_ticks_to_ns(5000));
 
-  // 5. Cleanup
-  simulator_free();
+  // 5. A second simulator on its own book runs alongside the first
+  order_book_t other_book;
+  book_init(&other_book);
+  simulator_t* other = simulator_init(&other_book);
+  agent_t* lone = noise_trader_create(num_agents + 1, 0);
+  simulator_add_agent(other, lone);
+
+  size_t trades_before = book.stats.trade_count;
+  uint64_t events_before = simulator_events_processed(sim);
+  simulator_run(other, sim_ticks_to_ns(1000));
+
+  if (simulator_events_processed(other) == 0 || book.stats.trade_count != trades_before ||
+      simulator_events_processed(sim) != events_before)
+  {
+    fprintf(stderr, "Simulators are not independent\n");
+    return 1;
+  }
+
+  // 6. Cleanup
+  simulator_free(other);
+  noise_trader_destroy(lone);
+  book_free(&other_book);
+  simulator_free(sim);
   book_free(&book);
   printf("Simulation complete.\n");
   return 0;
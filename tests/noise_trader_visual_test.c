@@ -132,20 +132,20 @@ int main(void)
 {
   order_book_t book;
   book_init(&book);
-  simulator_init(&book);
+  simulator_t* sim = simulator_init(&book);
   int num_agents = 3;
   agent_t* agents[num_agents];
   for (int i = 0; i < num_agents; ++i)
   {
-    agents[i] = noise_trader_create(i + 1);
-    simulator_add_agent(agents[i]);
+    agents[i] = noise_trader_create(i + 1, 0);
+    simulator_add_agent(sim, agents[i]);
   }
   int total_ticks = 5000;
   int display_every = 100;
   char msg[128];
   for (int t = 0; t < total_ticks; t += display_every)
   {
-    simulator_run(t + display_every);
+    simulator_run(sim, sim_ticks_to_ns((timestamp_t)(t + display_every)));
     snprintf(msg, sizeof(msg), "Tick %d/%d", t + display_every, total_ticks);
     print_book(&book, msg);
     usleep(100000); // 0.1s delay for animation
@@ -156,7 +156,7 @@ int main(void)
     noise_trader_destroy(agents[i]);
   }
 
-  simulator_free();
+  simulator_free(sim);
   book_free(&book);
   return 0;
 }
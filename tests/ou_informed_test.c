@@ -0,0 +1,179 @@
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "agents/agent_registry.h"
+#include "agents/informed_trader.h"
+#include "agents/noise_trader.h"
+#include "core/book.h"
+#include "sim/ou_process.h"
+#include "sim/simulator.h"
+
+/*
+  Smoke test for the OU fair value and the informed traders sharing it:
+  - the path has the stationary mean, sd and autocorrelation of the process
+  - the path depends only on the seed, not on when or from how many threads
+    it is read, and resumes exactly from a snapshot
+  - 10k traders on one latent value run the same on 1 and 4 threads, and a
+    trader's save / load carries the shared path with it
+*/
+
+static void test_moments(void)
+{
+  enum { T = 2000000, LAG = 500 };
+  ou_process_t ou;
+  assert(ou_init(&ou, 1000.0, 0.002, 0.5, 3) == 0);
+  assert(ou_init(&(ou_process_t){0}, 1000.0, -1.0, 0.5, 3) == -1);
+
+  double* x = malloc(T * sizeof *x);
+  assert(x);
+  for (timestamp_t t = 0; t < T; t++)
+    x[t] = ou_value_at(&ou, t);
+
+  double mean = 0.0, var = 0.0, cov = 0.0;
+  for (size_t t = 0; t < T; t++)
+    mean += x[t];
+  mean /= T;
+  for (size_t t = 0; t < T; t++)
+    var += (x[t] - mean) * (x[t] - mean);
+  var /= T;
+  for (size_t t = 0; t + LAG < T; t++)
+    cov += (x[t] - mean) * (x[t + LAG] - mean);
+  cov /= T - LAG;
+
+  double sd = ou_stationary_sd(&ou); // 0.5 / sqrt(0.004) ~ 7.9
+  assert(fabs(mean - 1000.0) < 0.5);
+  assert(fabs(sqrt(var) / sd - 1.0) < 0.05);
+  assert(fabs(cov / var - exp(-0.002 * LAG)) < 0.05);
+
+  free(x);
+  ou_free(&ou);
+}
+
+typedef struct
+{
+  ou_process_t* ou;
+  timestamp_t start;
+  double seen[100];
+} reader_t;
+
+static void* read_every_tenth(void* arg)
+{
+  reader_t* r = arg;
+  for (int i = 0; i < 100; i++)
+    r->seen[i] = ou_value_at(r->ou, r->start + 10 * (timestamp_t)i);
+  return NULL;
+}
+
+static void test_shared_path(void)
+{
+  ou_process_t dense, sparse, shared;
+  ou_init(&dense, 50.0, 0.01, 1.0, 42);
+  ou_init(&sparse, 50.0, 0.01, 1.0, 42);
+  ou_init(&shared, 50.0, 0.01, 1.0, 42);
+
+  // Read every tick, every 37 ticks, and from four racing threads
+  static double path[5001];
+  for (timestamp_t t = 0; t <= 5000; t++)
+  {
+    path[t] = ou_value_at(&dense, t);
+    if (t % 37 == 0)
+      assert(ou_value_at(&sparse, t) == path[t]);
+  }
+  pthread_t threads[4];
+  reader_t readers[4];
+  for (int i = 0; i < 4; i++)
+  {
+    readers[i] = (reader_t){.ou = &shared, .start = 1000 + (timestamp_t)i};
+    pthread_create(&threads[i], NULL, read_every_tenth, &readers[i]);
+  }
+  for (int i = 0; i < 4; i++)
+    pthread_join(threads[i], NULL);
+  // A reader gets the path at its time, or later if another thread got there first
+  for (int i = 0; i < 4; i++)
+  {
+    for (int k = 0; k < 100; k++)
+    {
+      timestamp_t t = readers[i].start + 10 * (timestamp_t)k;
+      while (t <= 2100 && path[t] != readers[i].seen[k])
+        t++;
+      assert(t <= 2100);
+    }
+  }
+  assert(ou_value_at(&shared, 5000) == path[5000]);
+
+  // Snapshot partway into a batch, resume in a fresh process
+  ou_snapshot_t snap;
+  ou_value_at(&sparse, 6003);
+  ou_save(&sparse, &snap);
+  ou_process_t resumed;
+  ou_init(&resumed, 50.0, 0.01, 1.0, 7);
+  ou_load(&resumed, &snap);
+  assert(ou_value_at(&resumed, 9000) == ou_value_at(&dense, 9000));
+
+  ou_free(&dense);
+  ou_free(&sparse);
+  ou_free(&shared);
+  ou_free(&resumed);
+}
+
+// 10k traders on one latent value; returns the trade count
+static size_t run_population(int threads, size_t* saved_len, void* saved)
+{
+  enum { N = 10000 };
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+  assert(simulator_set_parallel(sim, threads, SEQUENCE_BY_ID, 5) == 0);
+
+  informed_population_t pop;
+  assert(informed_population_init(&pop, DEFAULT_MID_PRICE, INFORMED_OU_REVERSION,
+                                  INFORMED_OU_VOLATILITY, INFORMED_OU_NOISE, 5) == 0);
+  agent_registry_t reg;
+  agent_registry_init(&reg);
+  agent_t* noise = agent_registry_add(&reg, &noise_trader_type, 30, 1, 5, NULL);
+  agent_t* informed = agent_registry_add(&reg, &ou_informed_trader_type, N, 2000, 5, &pop);
+  assert(noise && informed);
+  assert(agent_registry_add(&reg, &ou_informed_trader_type, 1, 90000, 5, NULL) == NULL);
+  for (size_t i = 0; i < 30; i++)
+    simulator_add_agent(sim, &noise[i]);
+  for (size_t i = 0; i < N; i++)
+    simulator_add_agent(sim, &informed[i]);
+  simulator_run(sim, sim_ticks_to_ns(3000));
+
+  // save / load round trip through one trader rewinds the shared path too
+  timestamp_t saved_at = pop.latent.t;
+  *saved_len = informed[0].save(&informed[0], saved, 4096);
+  assert(*saved_len <= 4096 && saved_at > 2000);
+  double at_4000 = ou_value_at(&pop.latent, 4000);
+  assert(informed[0].load(&informed[0], saved, *saved_len) == 0);
+  assert(pop.latent.t == saved_at && ou_value_at(&pop.latent, 4000) == at_4000);
+
+  size_t trades = stats_snapshot(&book.stats).trade_count;
+  simulator_free(sim);
+  agent_registry_free(&reg);
+  informed_population_free(&pop);
+  book_free(&book);
+  return trades;
+}
+
+static void test_population(void)
+{
+  static unsigned char a[4096], b[4096];
+  size_t a_len, b_len;
+  size_t serial = run_population(1, &a_len, a);
+  size_t parallel = run_population(4, &b_len, b);
+  assert(serial > 0 && serial == parallel);
+}
+
+int main(void)
+{
+  test_moments();
+  test_shared_path();
+  test_population();
+
+  printf("ou_informed_test passed\n");
+  return 0;
+}
@@ -0,0 +1,146 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "agents/informed_trader.h"
+#include "agents/market_maker.h"
+#include "agents/noise_trader.h"
+#include "core/book.h"
+#include "sim/simulator.h"
+
+/*
+  Smoke test for two-phase ticks:
+  - an agent with an outbox buffers instead of touching the book
+  - the same scenario gives the same book on 1 and 4 decision threads
+  - shuffled sequencing is reproducible from its seed
+  - agents waking at the same instant all see the book as it was before any of them
+*/
+
+typedef struct
+{
+  uint64_t trades;
+  uint64_t volume;
+  price_t best_bid;
+  price_t best_ask;
+  uint64_t events;
+} outcome_t;
+
+static outcome_t run_scenario(int threads, sequence_order_t order, uint64_t seq_seed)
+{
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+  if (threads > 0)
+    assert(simulator_set_parallel(sim, threads, order, seq_seed) == 0);
+
+  agent_t* agents[20];
+  size_t k = 0;
+  for (int i = 0; i < 12; i++)
+    agents[k++] = noise_trader_create(i + 1, 11);
+  for (int i = 0; i < 4; i++)
+    agents[k++] = market_maker_create(100 + i, 11);
+  for (int i = 0; i < 4; i++)
+    agents[k++] = informed_trader_create(200 + i, 11);
+  for (size_t i = 0; i < k; i++)
+    simulator_add_agent(sim, agents[i]);
+
+  simulator_run(sim, sim_ticks_to_ns(20000));
+
+  outcome_t out = {.trades = book.stats.trade_count,
+                   .volume = book.stats.total_volume,
+                   .events = simulator_events_processed(sim)};
+  depth_entry_t bid, ask;
+  out.best_bid = book_top_levels(&book, SIDE_BUY, &bid, 1) ? bid.price : 0;
+  out.best_ask = book_top_levels(&book, SIDE_SELL, &ask, 1) ? ask.price : 0;
+
+  simulator_free(sim);
+  for (size_t i = 0; i < 12; i++)
+    noise_trader_destroy(agents[i]);
+  for (size_t i = 12; i < 16; i++)
+    market_maker_destroy(agents[i]);
+  for (size_t i = 16; i < 20; i++)
+    informed_trader_destroy(agents[i]);
+  book_free(&book);
+  return out;
+}
+
+static int same(outcome_t a, outcome_t b)
+{
+  return a.trades == b.trades && a.volume == b.volume && a.best_bid == b.best_bid &&
+         a.best_ask == b.best_ask && a.events == b.events;
+}
+
+// Both buy at whatever the best ask was when the tick started
+static timestamp_t lift_step(agent_t* agent, order_book_t* book, const market_view_t* view,
+                             timestamp_t now)
+{
+  order_t* o = malloc(sizeof(order_t));
+  *o = (order_t){.id = order_id_first(agent->id), .side = SIDE_BUY, .type = ORDER_LIMIT,
+                 .price = view->best_ask, .qty = 5, .ts = now};
+  agent_submit(agent, book, o);
+  return AGENT_NO_WAKEUP;
+}
+
+int main(void)
+{
+  // Buffered actions stay out of the book until applied
+  order_book_t book;
+  book_init(&book);
+  agent_outbox_t box = {0};
+  agent_t agent = {.id = 1, .outbox = &box};
+  order_t* o = malloc(sizeof(order_t));
+  *o = (order_t){.id = order_id_first(1), .side = SIDE_BUY, .type = ORDER_LIMIT, .price = 10,
+                 .qty = 1};
+  agent_submit(&agent, &book, o);
+  agent_cancel(&agent, &book, 12345);
+  assert(box.count == 2 && box.orders[0] == o && box.orders[1] == NULL);
+  assert(box.cancel_ids[1] == 12345);
+  depth_entry_t top;
+  assert(book_top_levels(&book, SIDE_BUY, &top, 1) == 0 && book.version == 0);
+  agent_outbox_free(&box); // frees the unapplied order
+  book_free(&book);
+
+  // Thread count never changes the outcome
+  outcome_t one = run_scenario(1, SEQUENCE_BY_ID, 0);
+  outcome_t four = run_scenario(4, SEQUENCE_BY_ID, 0);
+  assert(one.trades > 0);
+  assert(same(one, four));
+
+  // Shuffled sequencing: same seed, same outcome
+  outcome_t s1 = run_scenario(1, SEQUENCE_SHUFFLED, 99);
+  outcome_t s4 = run_scenario(4, SEQUENCE_SHUFFLED, 99);
+  assert(same(s1, s4));
+
+  // Frozen view: two lifters woken together both price off the same ask, so
+  // the second one finds it gone and rests at that price
+  book_init(&book);
+  order_t* ask = malloc(sizeof(order_t));
+  *ask = (order_t){.id = 1, .side = SIDE_SELL, .type = ORDER_LIMIT, .price = 101, .qty = 5};
+  book_add_order(&book, ask);
+  order_t* ask2 = malloc(sizeof(order_t));
+  *ask2 = (order_t){.id = 2, .side = SIDE_SELL, .type = ORDER_LIMIT, .price = 102, .qty = 5};
+  book_add_order(&book, ask2);
+
+  simulator_t* sim = simulator_init(&book);
+  assert(simulator_set_parallel(sim, 2, SEQUENCE_BY_ID, 0) == 0);
+  agent_t a = {.id = 7, .step = lift_step};
+  agent_t b = {.id = 8, .step = lift_step};
+  simulator_add_agent(sim, &b);
+  simulator_add_agent(sim, &a);
+  simulator_run(sim, 1);
+
+  assert(book.stats.trade_count == 1 && book.stats.last_price == 101);
+  assert(book_top_levels(&book, SIDE_BUY, &top, 1) == 1 && top.price == 101 && top.qty == 5);
+  om_entry_t* rest = om_find(&book.orders, order_id_first(8));
+  assert(rest != NULL); // id order: agent 7 filled, agent 8 rests
+  order_t* resting = rest->order;
+
+  simulator_free(sim);
+  book_free(&book);
+  free(ask);
+  free(ask2);
+  free(resting);
+
+  printf("parallel_tick_test passed\n");
+  return 0;
+}
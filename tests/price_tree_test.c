@@ -1,3 +1,4 @@
+#define _DEFAULT_SOURCE
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -179,11 +180,182 @@ static void test_bulk_insert_remove(void)
   }
 }
 
+// Verify every node's subtree aggregates against its children
+static qty_t check_aug(const price_tree_t* t, const price_node_t* x, size_t* count)
+{
+  if (x == &t->nil)
+  {
+    *count = 0;
+    return 0;
+  }
+  size_t lc, rc;
+  qty_t sum = check_aug(t, x->left, &lc) + x->qty + check_aug(t, x->right, &rc);
+  *count = lc + 1 + rc;
+  assert(x->subtree_qty == sum);
+  assert(x->subtree_count == *count);
+  return sum;
+}
+
+static void test_depth_queries(void)
+{
+  price_tree_t t;
+  pt_init(&t);
+
+  enum
+  {
+    P = 200
+  };
+  price_level_t levels[P];
+  qty_t qty[P] = {0};
+  unsigned int seed = 7;
+
+  // Random insert / qty change / remove churn, checked against brute force
+  for (int step = 0; step < 5000; step++)
+  {
+    int i = rand_r(&seed) % P;
+    price_t price = i + 1;
+    int op = rand_r(&seed) % 3;
+
+    if (!pt_find(&t, price))
+    {
+      level_init(&levels[i], price);
+      levels[i].total_qty = 1 + rand_r(&seed) % 50;
+      qty[i] = levels[i].total_qty;
+      assert(pt_insert(&t, price, &levels[i]) == 1);
+    }
+    else if (op == 0)
+    {
+      assert(pt_remove(&t, price) == 1);
+      qty[i] = 0;
+    }
+    else
+    {
+      qty_t delta = (op == 1) ? 5 : -qty[i] / 2;
+      assert(pt_add_qty(&t, price, delta) == 1);
+      qty[i] += delta;
+    }
+
+    size_t count;
+    check_aug(&t, t.root, &count);
+    assert(count == t.size);
+
+    // Spot check both directions at a random price
+    price_t probe = 1 + rand_r(&seed) % P;
+    qty_t asks = 0, bids = 0;
+    size_t ask_levels = 0, bid_levels = 0;
+    for (int k = 0; k < P; k++)
+    {
+      if (!pt_find(&t, k + 1))
+        continue;
+      if (k + 1 <= probe)
+      {
+        asks += qty[k];
+        ask_levels++;
+      }
+      if (k + 1 >= probe)
+      {
+        bids += qty[k];
+        bid_levels++;
+      }
+    }
+    size_t n;
+    assert(pt_depth_until(&t, probe, 0, &n) == asks && n == ask_levels);
+    assert(pt_depth_until(&t, probe, 1, &n) == bids && n == bid_levels);
+
+    // The price reached by a sweep of `asks` qty from below is at most probe
+    price_t reached;
+    if (asks > 0)
+    {
+      assert(pt_price_for_qty(&t, asks, 0, &reached) == 1);
+      assert(reached <= probe);
+      assert(pt_depth_until(&t, reached, 0, NULL) >= asks);
+    }
+  }
+
+  price_t reached;
+  assert(pt_price_for_qty(&t, t.root->subtree_qty + 1, 0, &reached) == 0);
+
+  pt_clear(&t, NULL);
+  expect_empty(&t);
+  assert(pt_depth_until(&t, 100, 0, NULL) == 0);
+  assert(pt_price_for_qty(&t, 1, 1, &reached) == 0);
+}
+
+// Black height of x's subtree; asserts the red-black rules along the way
+static int check_rb(const price_tree_t* t, const price_node_t* x)
+{
+  if (x == &t->nil)
+    return 1;
+  if (x->color == PT_RED)
+    assert(x->left->color == PT_BLACK && x->right->color == PT_BLACK);
+  if (x->left != &t->nil)
+    assert(x->left->parent == x && x->left->key < x->key);
+  if (x->right != &t->nil)
+    assert(x->right->parent == x && x->right->key > x->key);
+  int lh = check_rb(t, x->left);
+  assert(lh == check_rb(t, x->right));
+  return lh + (x->color == PT_BLACK);
+}
+
+static void test_build_sorted(void)
+{
+  enum
+  {
+    M = 300
+  };
+  static price_level_t levels[M];
+  price_level_t* ptrs[M];
+  price_t keys[M];
+  for (int i = 0; i < M; i++)
+  {
+    level_init(&levels[i], (price_t)(10 * i + 5));
+    levels[i].total_qty = i % 17 + 1;
+    ptrs[i] = &levels[i];
+    keys[i] = levels[i].price;
+  }
+
+  // Every size: valid red-black tree with correct aggregates
+  for (size_t n = 0; n <= M; n++)
+  {
+    price_tree_t t;
+    pt_init(&t);
+    assert(pt_build_sorted(&t, keys, ptrs, n) == 0);
+    assert(t.size == n);
+    assert(t.root->color == PT_BLACK);
+    assert(t.root->parent == &t.nil);
+    check_rb(&t, t.root);
+    size_t count;
+    check_aug(&t, t.root, &count);
+    assert(count == n);
+    for (size_t i = 0; i < n; i++)
+      expect_found(&t, keys[i], ptrs[i]);
+    pt_clear(&t, NULL);
+  }
+
+  // Only into an empty tree; afterwards inserts and removes work as usual
+  price_tree_t t;
+  pt_init(&t);
+  assert(pt_build_sorted(&t, keys, ptrs, M) == 0);
+  assert(pt_build_sorted(&t, keys, ptrs, M) == -1);
+  price_level_t extra;
+  level_init(&extra, 7);
+  assert(pt_insert(&t, 7, &extra) == 1);
+  for (int i = 0; i < M; i += 2)
+    assert(pt_remove(&t, keys[i]) == 1);
+  check_rb(&t, t.root);
+  size_t count;
+  check_aug(&t, t.root, &count);
+  assert(count == t.size && t.size == M / 2 + 1);
+  pt_clear(&t, NULL);
+}
+
 int main(void)
 {
   test_basic_insert_find_min_max();
   test_remove_leaf_one_child_two_children();
   test_bulk_insert_remove();
+  test_depth_queries();
+  test_build_sorted();
 
   printf("price_tree_test: OK\n");
   return 0;
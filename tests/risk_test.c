@@ -0,0 +1,316 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "agents/as_market_maker.h"
+#include "agents/market_maker.h"
+#include "agents/noise_trader.h"
+#include "core/book.h"
+#include "core/risk.h"
+#include "sim/simulator.h"
+
+/*
+  Smoke test for the pre-trade risk gate:
+  - limit specs parse; bad ones are refused
+  - each limit rejects with its own reason, and passing orders are untouched
+  - a rejected order reaches neither the trees nor the map, and its owner gets
+    a reject report
+  - open orders and position follow rests, fills, cancels and amends
+  - bulk-loaded orders rest on their owners' accounts
+  - the message bucket allows a burst, then refills with sim time
+  - a simulation behind the gate still trades, and its accounts match the book
+*/
+
+static order_t* make_order(order_id_t id, side_t side, price_t price, qty_t qty)
+{
+  order_t* o = (order_t*)malloc(sizeof(order_t));
+  o->id = id;
+  o->side = side;
+  o->type = ORDER_LIMIT;
+  o->price = price;
+  o->qty = qty;
+  o->ts = 0;
+  return o;
+}
+
+static void test_parse(void)
+{
+  risk_limits_t lim;
+  assert(risk_parse_limits(&lim, "qty=100,collar=50,position=500,open=20,rate=1000,burst=4") == 0);
+  assert(lim.max_order_qty == 100 && lim.collar == 50 && lim.max_position == 500);
+  assert(lim.max_open_orders == 20 && lim.msg_rate == 1000 && lim.burst == 4);
+  assert(risk_parse_limits(&lim, "") == 0 && lim.max_order_qty == 0 && lim.msg_rate == 0);
+  assert(risk_parse_limits(&lim, "qty") == -1);
+  assert(risk_parse_limits(&lim, "qty=-1") == -1);
+  assert(risk_parse_limits(&lim, "qty=1x") == -1);
+  assert(risk_parse_limits(&lim, "bogus=1") == -1);
+  assert(risk_parse_limits(&lim, "rate=2000000000") == -1);
+}
+
+static void test_reasons(void)
+{
+  risk_limits_t lim = {.max_order_qty = 100, .collar = 50, .max_position = 150, .max_open_orders = 2};
+  risk_gate_t gate;
+  assert(risk_init(&gate, &lim) == 0);
+
+  order_id_t id = order_id_first(7);
+  order_t o = {.id = id, .side = SIDE_BUY, .type = ORDER_LIMIT, .price = 1000, .qty = 100};
+  assert(risk_check(&gate, &o, 1000, 0) == RISK_OK);
+  o.qty = 101;
+  assert(risk_check(&gate, &o, 1000, 0) == RISK_REJECT_QTY);
+  o.qty = 0;
+  assert(risk_check(&gate, &o, 1000, 0) == RISK_REJECT_QTY);
+  o.qty = 10;
+  o.price = 1051;
+  assert(risk_check(&gate, &o, 1000, 0) == RISK_REJECT_COLLAR);
+  o.price = 949;
+  assert(risk_check(&gate, &o, 1000, 0) == RISK_REJECT_COLLAR);
+  o.type = ORDER_MARKET; // no limit price to collar
+  assert(risk_check(&gate, &o, 1000, 0) == RISK_OK);
+  o.type = ORDER_LIMIT;
+  o.price = 1000;
+
+  // Two resting buys of 60: a third order is over the open limit, and a buy of
+  // 40 more could take the owner past 150 long
+  order_t rest = o;
+  rest.qty = 60;
+  risk_on_rest(&gate, &rest);
+  risk_on_rest(&gate, &rest);
+  const risk_account_t* a = risk_account(&gate, 7);
+  assert(a && a->open_orders == 2 && a->open_buy == 120 && a->open_sell == 0);
+  assert(risk_check(&gate, &o, 1000, 0) == RISK_REJECT_OPEN);
+  risk_on_shrink(&gate, id, SIDE_BUY, 60, 1);
+  assert(a->open_orders == 1 && a->open_buy == 60);
+  o.qty = 90;
+  assert(risk_check(&gate, &o, 1000, 0) == RISK_OK);
+  o.qty = 91;
+  assert(risk_check(&gate, &o, 1000, 0) == RISK_REJECT_POSITION);
+  o.side = SIDE_SELL; // sells only count against the short side
+  assert(risk_check(&gate, &o, 1000, 0) == RISK_OK);
+
+  assert(risk_account(&gate, 8) != NULL && risk_account(&gate, 8)->open_orders == 0);
+  assert(risk_account(&gate, 1000) == NULL); // past the first block of accounts
+  assert(gate.checked == 10 && gate.rejected[RISK_OK] == 0);
+  assert(gate.rejected[RISK_REJECT_QTY] == 2 && gate.rejected[RISK_REJECT_COLLAR] == 2);
+  assert(gate.rejected[RISK_REJECT_OPEN] == 1 && gate.rejected[RISK_REJECT_POSITION] == 1);
+  risk_free(&gate);
+}
+
+static void test_rate(void)
+{
+  // 1000 per second: one token per ms, up to 3 back to back
+  risk_limits_t lim = {.msg_rate = 1000, .burst = 3};
+  risk_gate_t gate;
+  assert(risk_init(&gate, &lim) == 0);
+  order_t o = {.id = order_id_first(2), .side = SIDE_SELL, .type = ORDER_LIMIT, .price = 1000, .qty = 1};
+
+  timestamp_t t = 5 * SIM_NS_PER_SEC;
+  for (int i = 0; i < 3; i++)
+    assert(risk_check(&gate, &o, 0, t) == RISK_OK);
+  assert(risk_check(&gate, &o, 0, t) == RISK_REJECT_RATE);
+  assert(risk_check(&gate, &o, 0, t + SIM_NS_PER_MS - 1) == RISK_REJECT_RATE);
+  assert(risk_check(&gate, &o, 0, t + SIM_NS_PER_MS) == RISK_OK);
+  assert(risk_check(&gate, &o, 0, t + SIM_NS_PER_MS) == RISK_REJECT_RATE);
+
+  // Idle long enough and the whole burst is back, but no more
+  t += SIM_NS_PER_SEC;
+  for (int i = 0; i < 3; i++)
+    assert(risk_check(&gate, &o, 0, t) == RISK_OK);
+  assert(risk_check(&gate, &o, 0, t) == RISK_REJECT_RATE);
+
+  // Another owner has its own bucket
+  o.id = order_id_first(3);
+  assert(risk_check(&gate, &o, 0, t) == RISK_OK);
+  assert(gate.rejected[RISK_REJECT_RATE] == 4);
+  risk_free(&gate);
+
+  lim.msg_rate = SIM_NS_PER_SEC + 1;
+  assert(risk_init(&gate, &lim) == -1);
+}
+
+static void test_book(void)
+{
+  order_book_t book;
+  book_init(&book);
+  assert(book_enable_reports(&book, 64) == 0);
+  risk_limits_t lim = {.max_order_qty = 50, .collar = 100, .max_open_orders = 2};
+  risk_gate_t gate;
+  assert(risk_init(&gate, &lim) == 0);
+  book.risk = &gate;
+
+  order_id_t maker = order_id_first(1);
+  order_id_t taker = order_id_first(2);
+  exec_report_t r;
+
+  // Rejected: too big, then too far from DEFAULT_MID_PRICE on an empty tape
+  book_add_order(&book, make_order(maker, SIDE_SELL, 1010, 51));
+  book_add_order(&book, make_order(maker + 1, SIDE_SELL, DEFAULT_MID_PRICE + 101, 5));
+  assert(om_find(&book.orders, maker) == NULL && om_find(&book.orders, maker + 1) == NULL);
+  assert(pt_min(&book.asks) == NULL);
+  assert(exec_ring_pop(&book.reports, &r) && r.type == EXEC_REJECT && r.order_id == maker);
+  assert(r.qty == 51 && r.leaves_qty == 0);
+  assert(exec_ring_pop(&book.reports, &r) && r.type == EXEC_REJECT && r.order_id == maker + 1);
+  assert(!exec_ring_pop(&book.reports, &r));
+
+  // Two asks rest; a third is over the open limit
+  book_add_order(&book, make_order(maker + 2, SIDE_SELL, 1010, 30));
+  book_add_order(&book, make_order(maker + 3, SIDE_SELL, 1020, 20));
+  book_add_order(&book, make_order(maker + 4, SIDE_SELL, 1030, 10));
+  assert(om_find(&book.orders, maker + 4) == NULL);
+  const risk_account_t* m = risk_account(&gate, 1);
+  assert(m->open_orders == 2 && m->open_sell == 50 && m->position == 0);
+  while (exec_ring_pop(&book.reports, &r))
+    assert(r.type == EXEC_REJECT && r.order_id == maker + 4);
+
+  // A buy of 40 takes all of the first ask and part of the second
+  book_add_order(&book, make_order(taker, SIDE_BUY, 1020, 40));
+  const risk_account_t* t = risk_account(&gate, 2);
+  assert(t->position == 40 && t->open_orders == 0 && t->open_buy == 0);
+  assert(m->position == -40 && m->open_orders == 1 && m->open_sell == 10);
+
+  // The collar is now centred on the last trade at 1020
+  book_add_order(&book, make_order(taker + 1, SIDE_BUY, 919, 1));
+  assert(om_find(&book.orders, taker + 1) == NULL);
+  book_add_order(&book, make_order(taker + 2, SIDE_BUY, 920, 5));
+  assert(om_find(&book.orders, taker + 2) != NULL && t->open_buy == 5);
+
+  // A cut keeps the order open; a reprice goes through the gate again
+  assert(book_amend_order(&book, maker + 3, 1020, 4) == 0);
+  assert(m->open_orders == 1 && m->open_sell == 4);
+  assert(book_amend_order(&book, maker + 3, 1025, 8) == 0);
+  assert(m->open_orders == 1 && m->open_sell == 8);
+  assert(book_amend_order(&book, maker + 3, 2000, 8) == 0); // outside the collar: gone
+  assert(om_find(&book.orders, maker + 3) == NULL && pt_min(&book.asks) == NULL);
+  assert(m->open_orders == 0 && m->open_sell == 0);
+
+  book_remove_order(&book, taker + 2);
+  assert(t->open_orders == 0 && t->open_buy == 0 && t->position == 40);
+
+  // Bulk entry is gated too
+  order_t* batch[2] = {make_order(maker + 5, SIDE_SELL, 1030, 60), make_order(maker + 6, SIDE_SELL, 1030, 6)};
+  book_add_orders(&book, batch, 2);
+  assert(om_find(&book.orders, maker + 5) == NULL && om_find(&book.orders, maker + 6) != NULL);
+  assert(m->open_orders == 1 && m->open_sell == 6);
+
+  book.risk = NULL;
+  risk_free(&gate);
+  book_free(&book);
+}
+
+static void test_load(void)
+{
+  order_book_t book;
+  book_init(&book);
+  risk_limits_t lim = {.max_open_orders = 3};
+  risk_gate_t gate;
+  assert(risk_init(&gate, &lim) == 0);
+  book.risk = &gate;
+
+  // Owner 70 is past the gate's first accounts, so the load has to make room
+  order_id_t maker = order_id_first(70);
+  order_t a = {.id = maker, .side = SIDE_SELL, .type = ORDER_LIMIT, .price = 1010, .qty = 10};
+  order_t b = {.id = maker + 1, .side = SIDE_SELL, .type = ORDER_LIMIT, .price = 1010, .qty = 5};
+  order_t c = {.id = order_id_first(3), .side = SIDE_BUY, .type = ORDER_LIMIT, .price = 990, .qty = 4};
+  order_t* ask_orders[] = {&a, &b};
+  order_t* bid_orders[] = {&c};
+  book_level_data_t asks = {1010, ask_orders, 2}, bids = {990, bid_orders, 1};
+  assert(book_load(&book, &bids, 1, &asks, 1) == 0);
+  const risk_account_t* m = risk_account(&gate, 70);
+  assert(m && m->open_orders == 2 && m->open_sell == 15 && m->position == 0);
+  assert(risk_account(&gate, 3)->open_buy == 4);
+
+  // Fills of loaded orders come off what the load counted
+  book_add_order(&book, make_order(order_id_first(2), SIDE_BUY, 1010, 12));
+  assert(m->open_orders == 1 && m->open_sell == 3 && m->position == -12);
+  book_add_order(&book, make_order(maker + 2, SIDE_SELL, 1020, 1));
+  book_add_order(&book, make_order(maker + 3, SIDE_SELL, 1020, 1));
+  assert(om_find(&book.orders, maker + 3) != NULL && m->open_orders == 3);
+  book_add_order(&book, make_order(maker + 4, SIDE_SELL, 1020, 1));
+  assert(om_find(&book.orders, maker + 4) == NULL);
+  assert(gate.rejected[RISK_REJECT_OPEN] == 1);
+
+  book.risk = NULL;
+  risk_free(&gate);
+  book_free(&book);
+}
+
+// Sum of the resting orders of `owner` must match its account
+static void check_accounts(order_book_t* book, const risk_gate_t* gate)
+{
+  for (agent_id_t owner = 0; owner < gate->capacity; owner++)
+  {
+    const risk_account_t* a = risk_account(gate, owner);
+    qty_t open[2] = {0, 0};
+    uint32_t count = 0;
+    price_tree_t* trees[2] = {&book->bids, &book->asks};
+    for (int s = 0; s < 2; s++)
+    {
+      for (price_level_t* lvl = pt_min(trees[s]); lvl; lvl = pt_next_above(trees[s], lvl->price))
+      {
+        for (order_node_t* n = lvl->head; n; n = n->next)
+        {
+          if (order_owner(n->order->id) != owner)
+            continue;
+          open[s] += n->order->qty;
+          count++;
+        }
+      }
+    }
+    assert(a->open_buy == open[0] && a->open_sell == open[1] && a->open_orders == count);
+  }
+}
+
+static void test_simulation(void)
+{
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+  risk_limits_t lim;
+  assert(risk_parse_limits(&lim, "qty=40,collar=60,position=2000,open=50,rate=200000,burst=4") == 0);
+  risk_gate_t gate;
+  assert(risk_init(&gate, &lim) == 0);
+  book.risk = &gate;
+
+  agent_t* agents[8];
+  size_t n = 0;
+  for (agent_id_t i = 1; i <= 5; i++)
+    agents[n++] = noise_trader_create(i, 3);
+  agents[n++] = market_maker_create(100, 3);
+  agents[n++] = as_market_maker_create(1000, 3);
+  for (size_t i = 0; i < n; i++)
+  {
+    assert(agents[i]);
+    simulator_add_agent(sim, agents[i]);
+  }
+
+  simulator_run(sim, sim_ticks_to_ns(20000));
+  assert(book.stats.trade_count > 0);
+  assert(gate.checked > book.stats.trade_count);
+  uint64_t rejected = 0;
+  for (int r = 0; r < RISK_REASONS; r++)
+    rejected += gate.rejected[r];
+  assert(rejected > 0 && rejected < gate.checked);
+  check_accounts(&book, &gate);
+
+  simulator_free(sim);
+  for (size_t i = 0; i < 5; i++)
+    noise_trader_destroy(agents[i]);
+  market_maker_destroy(agents[5]);
+  as_market_maker_destroy(agents[6]);
+  book.risk = NULL;
+  risk_free(&gate);
+  book_free(&book);
+}
+
+int main(void)
+{
+  test_parse();
+  test_reasons();
+  test_rate();
+  test_book();
+  test_load();
+  test_simulation();
+
+  printf("risk_test passed\n");
+  return 0;
+}
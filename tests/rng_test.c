@@ -0,0 +1,160 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common/rng.h"
+
+/*
+  Smoke test for rng.c (fixed seeds, so deterministic):
+  - same seed and stream give the same sequence, other streams differ
+  - rng_below stays in range and is roughly flat
+  - bulk fills match their distribution's mean / variance
+  - bulk fills are reproducible, including ragged lengths
+  - the ziggurat normal has the right moments, CDF and tails
+*/
+
+static void test_streams(void)
+{
+  rng_t a, b, c;
+  rng_init_stream(&a, 42, 7);
+  rng_init_stream(&b, 42, 7);
+  rng_init_stream(&c, 42, 8);
+
+  int same_as_other = 0;
+  for (int i = 0; i < 1000; i++)
+  {
+    uint64_t x = rng_next(&a);
+    assert(x == rng_next(&b));
+    same_as_other += (x == rng_next(&c));
+  }
+  assert(same_as_other == 0);
+}
+
+static void test_below(void)
+{
+  rng_t r;
+  rng_seed(&r, 1);
+
+  enum
+  {
+    N = 7,
+    DRAWS = 700000
+  };
+  size_t hits[N] = {0};
+  for (int i = 0; i < DRAWS; i++)
+  {
+    uint64_t v = rng_below(&r, N);
+    assert(v < N);
+    hits[v]++;
+  }
+  for (int k = 0; k < N; k++)
+    assert(fabs((double)hits[k] / DRAWS - 1.0 / N) < 0.005);
+
+  for (int i = 0; i < 1000; i++)
+  {
+    int64_t v = rng_range(&r, -3, 3);
+    assert(v >= -3 && v <= 3);
+  }
+}
+
+static void moments(const double* v, size_t n, double* mean, double* var)
+{
+  double s = 0.0, s2 = 0.0;
+  for (size_t i = 0; i < n; i++)
+  {
+    s += v[i];
+    s2 += v[i] * v[i];
+  }
+  *mean = s / n;
+  *var = s2 / n - *mean * *mean;
+}
+
+static void test_fills(void)
+{
+  enum
+  {
+    N = 200001 // odd, ragged against the lane count and chunk size
+  };
+  double* v = malloc(N * sizeof *v);
+  double* w = malloc(N * sizeof *w);
+  assert(v && w);
+  rng_t r;
+  double mean, var;
+
+  rng_seed(&r, 5);
+  rng_fill_uniform(&r, v, N);
+  for (size_t i = 0; i < N; i++)
+    assert(v[i] >= 0.0 && v[i] < 1.0);
+  moments(v, N, &mean, &var);
+  assert(fabs(mean - 0.5) < 0.005 && fabs(var - 1.0 / 12) < 0.002);
+
+  rng_fill_exp(&r, v, N, 4.0);
+  for (size_t i = 0; i < N; i++)
+    assert(v[i] >= 0.0 && isfinite(v[i]));
+  moments(v, N, &mean, &var);
+  assert(fabs(mean - 0.25) < 0.005 && fabs(var - 0.0625) < 0.005);
+
+  rng_fill_normal(&r, v, N);
+  moments(v, N, &mean, &var);
+  assert(fabs(mean) < 0.01 && fabs(var - 1.0) < 0.02);
+
+  // Reproducible from the same state
+  rng_t x, y;
+  rng_seed(&x, 9);
+  rng_seed(&y, 9);
+  rng_fill_normal(&x, v, 1001);
+  rng_fill_normal(&y, w, 1001);
+  for (size_t i = 0; i < 1001; i++)
+    assert(v[i] == w[i]);
+  assert(rng_next(&x) == rng_next(&y));
+
+  free(v);
+  free(w);
+}
+
+static void test_ziggurat(void)
+{
+  enum
+  {
+    N = 1000000
+  };
+  double* v = malloc(N * sizeof *v);
+  assert(v);
+  rng_t r;
+  rng_seed(&r, 11);
+  size_t below_one = 0, tail = 0;
+  double m4 = 0.0;
+  for (size_t i = 0; i < N; i++)
+  {
+    v[i] = rng_normal_zig(&r);
+    assert(isfinite(v[i]));
+    below_one += v[i] < 1.0;
+    tail += fabs(v[i]) > 3.442619855899; // past the ziggurat's base layer
+    m4 += v[i] * v[i] * v[i] * v[i];
+  }
+  double mean, var;
+  moments(v, N, &mean, &var);
+  assert(fabs(mean) < 0.005 && fabs(var - 1.0) < 0.01);
+  assert(fabs(m4 / N - 3.0) < 0.05);
+  assert(fabs((double)below_one / N - 0.841345) < 0.002);
+  assert(fabs((double)tail / N - 5.76e-4) < 1.5e-4);
+
+  rng_t x, y;
+  rng_seed(&x, 3);
+  rng_seed(&y, 3);
+  for (int i = 0; i < 1000; i++)
+    assert(rng_normal_zig(&x) == rng_normal_zig(&y));
+  free(v);
+}
+
+int main(void)
+{
+  test_streams();
+  test_below();
+  test_fills();
+  test_ziggurat();
+
+  printf("rng_test: OK\n");
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sim/runner.h"
+
+/*
+  Smoke test for runner.c:
+  - every run produces results
+  - results are identical whatever the thread count (seed per run, not per worker)
+  - merged totals are the sum of the runs
+  - a scenario whose agent counts overflow their id blocks is refused
+  - a run whose agents cannot be created fails instead of reporting results
+  - runner_build_agents lays the groups out in their id blocks
+*/
+
+static void test_deterministic_across_threads(void)
+{
+  scenario_t sc = {.num_noise = 6, .num_mm = 1, .num_informed = 1, .ticks = 2000, .seed = 42};
+  enum
+  {
+    RUNS = 6
+  };
+
+  runner_report_t one, many;
+  assert(runner_run(&sc, RUNS, 1, &one) == 0);
+  assert(runner_run(&sc, RUNS, 3, &many) == 0);
+  assert(one.runs == RUNS && many.runs == RUNS);
+  assert(many.threads == 3);
+
+  size_t trades = 0;
+  for (size_t r = 0; r < RUNS; r++)
+  {
+    assert(one.results[r].events > 0);
+    assert(one.results[r].events == many.results[r].events);
+    assert(one.results[r].stats.trade_count == many.results[r].stats.trade_count);
+    assert(one.results[r].stats.volume == many.results[r].stats.volume);
+    assert(one.results[r].stats.spread == many.results[r].stats.spread);
+    trades += one.results[r].stats.trade_count;
+  }
+  assert(one.merged.trade_count == trades);
+  assert(many.merged.trade_count == trades);
+
+  // Different seeds give different runs
+  assert(one.results[0].events != one.results[1].events ||
+         one.results[0].stats.volume != one.results[1].stats.volume);
+
+  runner_report_free(&one);
+  runner_report_free(&many);
+}
+
+static void test_bad_input(void)
+{
+  scenario_t sc = {.num_noise = 1, .ticks = 10, .seed = 1};
+  runner_report_t report;
+  assert(runner_run(NULL, 1, 1, &report) == -1);
+  assert(runner_run(&sc, 0, 1, &report) == -1);
+
+  // A count past its id block would share the next type's ids
+  run_result_t one;
+  scenario_t crowded = sc;
+  crowded.num_noise = RUNNER_MAX_NOISE + 1;
+  assert(runner_scenario_check(&crowded) == -1);
+  assert(runner_run(&crowded, 1, 1, &report) == -1);
+  assert(runner_run_one(&crowded, 1, &one) == -1);
+  crowded.num_noise = RUNNER_MAX_NOISE;
+  crowded.num_mean_reversion = RUNNER_MAX_MEAN_REVERSION + 1;
+  assert(runner_scenario_check(&crowded) == -1);
+  crowded.num_mean_reversion = RUNNER_MAX_MEAN_REVERSION;
+  assert(runner_scenario_check(&crowded) == 0);
+
+  // More threads than runs is clamped
+  assert(runner_run(&sc, 2, 16, &report) == 0);
+  assert(report.threads == 2);
+  runner_report_free(&report);
+}
+
+static void test_failed_setup(void)
+{
+  // The crowd refuses more members than it can index, so its group is never created
+  scenario_t sc = {.num_noise = 4, .crowd_size = (size_t)UINT32_MAX + 1, .ticks = 100, .seed = 3};
+  assert(runner_scenario_check(&sc) == 0);
+
+  run_result_t one = {.events = 7};
+  assert(runner_run_one(&sc, 3, &one) == -1);
+  assert(one.failed && one.events == 0 && one.stats.trade_count == 0);
+
+  runner_report_t report;
+  assert(runner_run(&sc, 3, 2, &report) == -1);
+  assert(report.results == NULL);
+
+  sc.crowd_size = 0;
+  assert(runner_run_one(&sc, 3, &one) == 0 && !one.failed && one.events > 0);
+}
+
+static void test_build_agents(void)
+{
+  scenario_t sc = {.num_noise = 3, .num_mm = 2, .crowd_size = 5, .num_momentum = 1};
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+  runner_agents_t agents;
+  assert(runner_build_agents(&agents, &sc, sim, 9) == 0);
+
+  // Group order, each group from the start of its block
+  agent_id_t expected[] = {RUNNER_NOISE_ID,     RUNNER_NOISE_ID + 1, RUNNER_NOISE_ID + 2,
+                           RUNNER_MM_ID,        RUNNER_MM_ID + 1,    RUNNER_CROWD_ID,
+                           RUNNER_MOMENTUM_ID};
+  assert(sim->agent_count == sizeof expected / sizeof expected[0]);
+  for (size_t i = 0; i < sim->agent_count; i++)
+    assert(sim->agents[i]->id == expected[i]);
+  assert(agents.registry.count == 4);
+  assert(book.indicators == &agents.indicators);
+
+  simulator_free(sim);
+  runner_agents_free(&agents);
+  book_free(&book);
+}
+
+int main(void)
+{
+  test_deterministic_across_threads();
+  test_bad_input();
+  test_failed_setup();
+  test_build_agents();
+
+  printf("runner_test: OK\n");
+  return 0;
+}
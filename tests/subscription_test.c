@@ -0,0 +1,197 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "core/book.h"
+#include "sim/simulator.h"
+#include "sim/subscriptions.h"
+
+/*
+  Smoke test for event subscriptions:
+  - a price trigger wakes its agent once, on the tick after it is crossed
+  - the trigger wakeup replaces the pending one; the old one never runs
+  - BBO, trade and depletion subscribers wake on their events only
+  - a check pops only the triggers that fire, and re-arming does not grow
+    the index without bound
+*/
+
+#define MAX_WAKES 16
+
+typedef struct
+{
+  agent_interest_t arm; // armed on the first step
+  timestamp_t period;   // wake again this long after each step; 0: sleep
+  size_t wakes;
+  timestamp_t woke[MAX_WAKES];
+  price_t seen_ask[MAX_WAKES];
+} watcher_t;
+
+static timestamp_t watcher_step(agent_t* agent, order_book_t* book, const market_view_t* view,
+                                timestamp_t now)
+{
+  (void)book;
+  watcher_t* w = agent->state;
+  if (w->wakes < MAX_WAKES)
+  {
+    w->woke[w->wakes] = now;
+    w->seen_ask[w->wakes] = view->best_ask;
+  }
+  if (w->wakes++ == 0)
+    agent->interest = w->arm;
+  if (w->period == 0)
+    return AGENT_NO_WAKEUP;
+  return now + w->period;
+}
+
+// Test times are in agent ticks
+static timestamp_t tick(timestamp_t n) { return sim_ticks_to_ns(n); }
+
+static void schedule_order(simulator_t* sim, timestamp_t ts, order_id_t id, side_t side,
+                           price_t price, qty_t qty)
+{
+  order_t* o = malloc(sizeof(order_t));
+  *o = (order_t){.id = id, .side = side, .type = ORDER_LIMIT, .price = price, .qty = qty, .ts = ts};
+  event_t ev = {.ts = ts, .type = EVENT_ORDER, .payload.order = o};
+  assert(simulator_schedule(sim, &ev) == 0);
+}
+
+static void test_price_trigger(void)
+{
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+
+  // Wants the ask at 95 or better; also has its own wakeup every 100 ticks
+  watcher_t w = {.arm = {.ask_at_or_below = 95}, .period = tick(100)};
+  agent_t a = {.id = 1, .step = watcher_step, .state = &w};
+  simulator_add_agent(sim, &a);
+
+  schedule_order(sim, tick(5), 1000, SIDE_SELL, 100, 5);
+  schedule_order(sim, tick(10), 1001, SIDE_SELL, 95, 5);
+  schedule_order(sim, tick(12), 1002, SIDE_SELL, 90, 5); // already fired: one-shot
+  schedule_order(sim, tick(300), 1003, SIDE_BUY, 50, 5);  // keeps the queue open below 311
+  simulator_run(sim, tick(250));
+
+  assert(w.wakes == 4);
+  assert(w.woke[0] == 0);
+  assert(w.woke[1] == tick(11) && w.seen_ask[1] == 95);
+  assert(w.woke[2] == tick(111)); // the wakeup at 100 was replaced
+  assert(w.woke[3] == tick(211));
+  assert(a.interest.ask_at_or_below == 0);
+
+  // A later wakeup than the pending one (311) is ignored, an earlier one replaces it
+  event_t late = {.ts = tick(400), .type = EVENT_WAKEUP, .payload.agent = &a};
+  event_t early = {.ts = tick(305), .type = EVENT_WAKEUP, .payload.agent = &a};
+  assert(simulator_schedule(sim, &late) == 0);
+  assert(simulator_schedule(sim, &early) == 0);
+  simulator_run(sim, tick(410));
+  assert(w.wakes == 6 && w.woke[4] == tick(305) && w.woke[5] == tick(405));
+
+  simulator_free(sim);
+  book_free(&book);
+}
+
+static void test_topics(void)
+{
+  order_book_t book;
+  book_init(&book);
+  simulator_t* sim = simulator_init(&book);
+
+  watcher_t bbo = {.arm = {.topics = AGENT_WAKE_BBO}, .period = 0};
+  watcher_t trade = {.arm = {.topics = AGENT_WAKE_TRADE, .trade_at_or_above = 101}, .period = 0};
+  watcher_t depleted = {.arm = {.topics = AGENT_WAKE_DEPLETION}, .period = 0};
+  agent_t a = {.id = 1, .step = watcher_step, .state = &bbo};
+  agent_t b = {.id = 2, .step = watcher_step, .state = &trade};
+  agent_t c = {.id = 3, .step = watcher_step, .state = &depleted};
+  simulator_add_agent(sim, &a);
+  simulator_add_agent(sim, &b);
+  simulator_add_agent(sim, &c);
+
+  schedule_order(sim, tick(5), 1000, SIDE_BUY, 100, 5);  // new best bid
+  schedule_order(sim, tick(8), 1001, SIDE_BUY, 99, 5);   // behind the best: nobody
+  schedule_order(sim, tick(10), 1002, SIDE_SELL, 100, 5); // trade at 100, level gone
+  schedule_order(sim, tick(20), 1003, SIDE_SELL, 99, 2);  // trade at 99, level stays
+  simulator_run(sim, tick(50));
+
+  assert(bbo.wakes == 4 && bbo.woke[1] == tick(6) && bbo.woke[2] == tick(11) &&
+         bbo.woke[3] == tick(21));
+  assert(trade.wakes == 3 && trade.woke[1] == tick(11) && trade.woke[2] == tick(21));
+  assert(b.interest.trade_at_or_above == 101); // no fill that high
+  assert(depleted.wakes == 2 && depleted.woke[1] == tick(11));
+
+  simulator_free(sim);
+  book_free(&book);
+}
+
+static size_t fired;
+static void count_wake(void* ctx, uint32_t slot)
+{
+  (void)ctx;
+  (void)slot;
+  fired++;
+}
+
+static void test_index(void)
+{
+  enum { N = 10000 };
+  order_book_t book;
+  book_init(&book);
+  agent_t* agents[N];
+  subscriptions_t subs;
+  subs_init(&subs);
+  for (uint32_t i = 0; i < N; i++)
+  {
+    agents[i] = calloc(1, sizeof(agent_t));
+    agents[i]->slot = i;
+    agents[i]->interest.ask_at_or_below = 1 + i; // prices 1..N
+    assert(subs_sync(&subs, i, &agents[i]->interest) == 0);
+  }
+
+  order_t ask = {.id = 1, .side = SIDE_SELL, .type = ORDER_LIMIT, .price = N - 99, .qty = 1};
+  book_add_order(&book, &ask);
+  fired = 0;
+  subs_check(&subs, &book, agents, count_wake, NULL);
+  assert(fired == 100);
+  assert(subs.heaps[SUBS_ASK_AT_OR_BELOW].count == N - 100);
+  fired = 0;
+  subs_check(&subs, &book, agents, count_wake, NULL);
+  assert(fired == 0);
+  for (uint32_t i = 0; i < N; i++)
+    assert((agents[i]->interest.ask_at_or_below == 0) == (i >= N - 100));
+
+  // One agent re-arming far from the market over and over
+  for (int round = 0; round < 100000; round++)
+  {
+    agents[0]->interest.ask_at_or_below = 1 + round % 50;
+    assert(subs_sync(&subs, 0, &agents[0]->interest) == 0);
+  }
+  subs_heap_t* h = &subs.heaps[SUBS_ASK_AT_OR_BELOW];
+  assert(h->live == N - 100 && h->count <= 2 * h->live + 64 + 1);
+
+  // Unsubscribed: the entries go stale and never fire
+  for (uint32_t i = 0; i < N; i++)
+  {
+    agents[i]->interest.ask_at_or_below = 0;
+    assert(subs_sync(&subs, i, &agents[i]->interest) == 0);
+  }
+  order_t low = {.id = 2, .side = SIDE_SELL, .type = ORDER_LIMIT, .price = 1, .qty = 1};
+  book_add_order(&book, &low);
+  fired = 0;
+  subs_check(&subs, &book, agents, count_wake, NULL);
+  assert(fired == 0 && h->live == 0);
+
+  subs_free(&subs);
+  for (uint32_t i = 0; i < N; i++)
+    free(agents[i]);
+  book_free(&book);
+}
+
+int main(void)
+{
+  test_price_trigger();
+  test_topics();
+  test_index();
+
+  printf("subscription_test passed\n");
+  return 0;
+}
@@ -0,0 +1,124 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim/runner.h"
+#include "sim/sweep.h"
+
+/*
+  Smoke test for parameter sweeps:
+  - bad specs are refused; good ones expand last axis fastest
+  - each job matches a standalone run of its scenario and seed
+  - 1 and 4 workers give the same per-job results
+  - the columnar file reads back with every job exactly once
+*/
+
+static sweep_t sweep; // large grid arrays
+
+static const scenario_t base = {.num_noise = 20, .num_mm = 2, .num_informed = 4, .ticks = 3000, .seed = 11};
+
+static void test_parse(void)
+{
+  assert(sweep_parse(&sweep, &base, 3, "") == 0); // just the base scenario
+  assert(sweep.n_axes == 0 && sweep_job_count(&sweep) == 3);
+  assert(sweep_parse(&sweep, &base, 1, "bogus=1") == -1);
+  assert(sweep_parse(&sweep, &base, 1, "noise") == -1);
+  assert(sweep_parse(&sweep, &base, 1, "noise=1,x") == -1);
+  assert(sweep_parse(&sweep, &base, 1, "noise=5:1") == -1);
+  assert(sweep_parse(&sweep, &base, 1, "ticks=0") == -1);
+  assert(sweep_parse(&sweep, &base, 1, "noise=1 noise=2") == -1);
+  assert(sweep_parse(&sweep, &base, 0, "noise=1") == -1);
+  assert(sweep_parse(&sweep, &base, 1, "noise=0:1000") == -1);
+  assert(sweep_parse(&sweep, &base, 1, "noise=100") == -1); // into the market makers' ids
+  assert(sweep_parse(&sweep, &base, 1, "noise=99 mm=100") == 0);
+  scenario_t crowded = base;
+  crowded.num_informed = RUNNER_MAX_INFORMED + 1;
+  assert(sweep_parse(&sweep, &crowded, 1, "noise=10") == -1);
+  assert(sweep_parse(&sweep, &crowded, 1, "informed=5") == 0); // the axis replaces it
+
+  assert(sweep_parse(&sweep, &base, 2, "noise=10:30:10; mm_spread=3,8") == 0);
+  assert(sweep.n_axes == 2 && sweep_job_count(&sweep) == 12);
+
+  scenario_t sc;
+  uint64_t seed;
+  sweep_job(&sweep, 0, &sc, &seed);
+  assert(sc.num_noise == 10 && sc.mm_half_spread == 3 && seed == runner_run_seed(11, 0));
+  assert(sc.num_mm == 2 && sc.num_informed == 4 && sc.ticks == 3000);
+  sweep_job(&sweep, 1, &sc, &seed);
+  assert(sc.num_noise == 10 && sc.mm_half_spread == 3 && seed == runner_run_seed(11, 1));
+  sweep_job(&sweep, 2, &sc, &seed);
+  assert(sc.num_noise == 10 && sc.mm_half_spread == 8);
+  sweep_job(&sweep, 11, &sc, &seed);
+  assert(sc.num_noise == 30 && sc.mm_half_spread == 8 && seed == runner_run_seed(11, 1));
+}
+
+static void test_run(void)
+{
+  assert(sweep_parse(&sweep, &base, 2, "noise=10,40 informed_threshold=0,3 ticks=2000,6000") == 0);
+  size_t jobs = sweep_job_count(&sweep);
+  assert(jobs == 16);
+
+  const char* path = "sweep_test.out";
+  sweep_report_t serial, pooled;
+  assert(sweep_run(&sweep, 1, NULL, &serial) == 0);
+  assert(sweep_run(&sweep, 4, path, &pooled) == 0);
+  assert(serial.jobs == jobs && pooled.jobs == jobs && pooled.threads == 4);
+
+  for (size_t j = 0; j < jobs; j++)
+  {
+    scenario_t sc;
+    uint64_t seed;
+    run_result_t alone;
+    sweep_job(&sweep, j, &sc, &seed);
+    runner_run_one(&sc, seed, &alone);
+    assert(serial.results[j].stats.trade_count == alone.stats.trade_count);
+    assert(serial.results[j].stats.volume == alone.stats.volume);
+    assert(serial.results[j].events == alone.events);
+    assert(pooled.results[j].stats.trade_count == alone.stats.trade_count);
+    assert(pooled.results[j].stats.mid_price == alone.stats.mid_price);
+    assert(pooled.results[j].events == alone.events);
+    assert(alone.stats.trade_count > 0);
+  }
+
+  sweep_table_t table;
+  assert(sweep_table_load(&table, path) == 0);
+  assert(table.rows == jobs);
+  int job = sweep_table_column(&table, "job");
+  int noise = sweep_table_column(&table, "noise");
+  int ticks = sweep_table_column(&table, "ticks");
+  int trades = sweep_table_column(&table, "trades");
+  int mid = sweep_table_column(&table, "mid");
+  assert(job >= 0 && noise >= 0 && ticks >= 0 && trades >= 0 && mid >= 0);
+  assert(sweep_table_column(&table, "nope") == -1);
+  assert(table.types[trades] == 'i' && table.types[mid] == 'f');
+
+  int seen[16] = {0};
+  for (size_t r = 0; r < table.rows; r++)
+  {
+    size_t j = (size_t)table.values[job][r].i;
+    assert(j < jobs && !seen[j]);
+    seen[j] = 1;
+    scenario_t sc;
+    uint64_t seed;
+    sweep_job(&sweep, j, &sc, &seed);
+    assert(table.values[noise][r].i == sc.num_noise && (timestamp_t)table.values[ticks][r].i == sc.ticks);
+    assert((size_t)table.values[trades][r].i == pooled.results[j].stats.trade_count);
+    assert(table.values[mid][r].f == pooled.results[j].stats.mid_price);
+  }
+  sweep_table_free(&table);
+  remove(path);
+
+  assert(sweep_table_load(&table, path) == -1);
+  sweep_report_free(&serial);
+  sweep_report_free(&pooled);
+}
+
+int main(void)
+{
+  test_parse();
+  test_run();
+
+  printf("sweep_test passed\n");
+  return 0;
+}